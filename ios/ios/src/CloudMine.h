@@ -49,8 +49,13 @@
 #import "CMMimeType.h"
 #import "CMObject.h"
 #import "CMObjectClassNameRegistry.h"
+#import "CMClassMetadata.h"
+#import "CMChangeJournal.h"
 #import "CMObjectDecoder.h"
 #import "CMObjectEncoder.h"
+#import "CMStreamingObjectEncoder.h"
+#import "CMJSONObjectEncoder.h"
+#import "CMMessagePackObjectEncoder.h"
 #import "CMObjectOwnershipLevel.h"
 #import "CMObjectSerialization.h"
 #import "CMPagingDescriptor.h"
@@ -61,10 +66,15 @@
 #import "CMStore.h"
 #import "CMStoreCallbacks.h"
 #import "CMStoreOptions.h"
+#import "CMObjectCache.h"
+#import "CMMemoryCache.h"
+#import "CMOutbox.h"
 #import "CMNullStore.h"
 #import "CMUser.h"
 #import "CMUserAccountResult.h"
 #import "CMWebService.h"
+#import "CMBodyCodec.h"
+#import "CMBackgroundTransferService.h"
 #import "CMAppDelegateBase.h"
 #import "CMActiveUser.h"
 
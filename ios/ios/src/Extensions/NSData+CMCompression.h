@@ -0,0 +1,25 @@
+//
+//  NSData+CMCompression.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <Foundation/Foundation.h>
+
+@interface NSData (CMCompression)
+
+/**
+ * The data compressed in the gzip format, as sent with <tt>Content-Encoding: gzip</tt>, or <tt>nil</tt> if it could
+ * not be compressed.
+ */
+- (NSData *)gzippedData;
+
+/**
+ * The data compressed in the zlib format, as sent with <tt>Content-Encoding: deflate</tt>, or <tt>nil</tt> if it could
+ * not be compressed.
+ */
+- (NSData *)deflatedData;
+
+@end
@@ -0,0 +1,51 @@
+//
+//  NSData+CMCompression.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <zlib.h>
+
+#import "NSData+CMCompression.h"
+
+@implementation NSData (CMCompression)
+
+- (NSData *)gzippedData;
+{
+    // Adding 16 to the window size makes zlib write a gzip header and trailer instead of its own.
+    return [self compressedDataWithWindowBits:MAX_WBITS + 16];
+}
+
+- (NSData *)deflatedData;
+{
+    return [self compressedDataWithWindowBits:MAX_WBITS];
+}
+
+- (NSData *)compressedDataWithWindowBits:(int)windowBits;
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+
+    NSMutableData *compressed = [NSMutableData dataWithLength:deflateBound(&stream, (uLong)self.length)];
+    stream.next_in = (Bytef *)self.bytes;
+    stream.avail_in = (uInt)self.length;
+    stream.next_out = compressed.mutableBytes;
+    stream.avail_out = (uInt)compressed.length;
+
+    // The output buffer is as large as the worst case, so a single call compresses everything.
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+
+    compressed.length = stream.total_out;
+    return compressed;
+}
+
+@end
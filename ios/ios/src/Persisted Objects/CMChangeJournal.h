@@ -0,0 +1,92 @@
+//
+//  CMChangeJournal.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <Foundation/Foundation.h>
+
+@class CMChangeJournal;
+
+/**
+ * Implemented by objects whose changes are recorded in a <tt>CMChangeJournal</tt>.
+ */
+@protocol CMChangeJournaling <NSObject>
+
+/**
+ * The journal changes to the receiver are recorded in, or <tt>nil</tt> while changes aren't being tracked.
+ */
+- (CMChangeJournal *)changeJournal;
+
+/**
+ * Called after a change to one of the receiver's properties has been recorded in its journal.
+ *
+ * @param key The name of the property that changed.
+ */
+- (void)didRecordChangeOfKey:(NSString *)key;
+
+@end
+
+/**
+ * Records which properties of an object changed and what their values were before the first change. The setters of
+ * the tracked properties of a class are wrapped once, the first time <tt>+prepareClass:</tt> is called with it, so
+ * instances need nothing more than a journal of their own. The tracked properties are the
+ * <tt>userDefinedPropertyNames</tt> of the class's <tt>CMClassMetadata</tt>.
+ *
+ * Setters that take a type that can't be wrapped, such as a struct, are left alone. Their instances have to observe
+ * those keys, listed by <tt>+observedKeysOfClass:</tt>, with KVO and report changes through
+ * <tt>-recordChangeOfKey:fromValue:</tt>. Changes made by a subclass's override of a setter that doesn't call
+ * <tt>super</tt> aren't recorded.
+ */
+@interface CMChangeJournal : NSObject
+
+/**
+ * Wraps the setters of the tracked properties of a class conforming to <tt>CMChangeJournaling</tt>. Does nothing
+ * after the first call for a class. Safe to call from any thread.
+ *
+ * @param klass The class whose instances will keep journals.
+ */
++ (void)prepareClass:(Class)klass;
+
+/**
+ * The tracked properties of a prepared class whose setters couldn't be wrapped.
+ *
+ * @param klass A class passed to <tt>+prepareClass:</tt>.
+ */
++ (NSArray *)observedKeysOfClass:(Class)klass;
+
+/** The names of the properties changed since the journal was created or last reset. */
+@property (nonatomic, readonly) NSSet *changedKeys;
+
+/**
+ * The values the changed properties had before their first change, keyed by property name. <tt>NSNull</tt> stands in
+ * for <tt>nil</tt>.
+ */
+@property (nonatomic, readonly) NSDictionary *originalValues;
+
+/**
+ * Records a change if the current value of the property differs from <tt>oldValue</tt>.
+ *
+ * @param key The name of the property that was set.
+ * @param object The object the property belongs to.
+ * @param oldValue The value of the property before it was set.
+ * @return <tt>YES</tt> if the value changed.
+ */
+- (BOOL)recordChangeOfKey:(NSString *)key ofObject:(id)object fromValue:(id)oldValue;
+
+/**
+ * Records a change that is already known to have happened.
+ *
+ * @param key The name of the property that changed.
+ * @param oldValue The value of the property before the change.
+ */
+- (void)recordChangeOfKey:(NSString *)key fromValue:(id)oldValue;
+
+/**
+ * Forgets every recorded change, typically once the object has been saved.
+ */
+- (void)reset;
+
+@end
@@ -0,0 +1,184 @@
+//
+//  CMChangeJournal.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <objc/runtime.h>
+
+#import "CMChangeJournal.h"
+#import "CMClassMetadata.h"
+
+static char CMChangeJournalObservedKeysKey;
+
+/** Whether a setter taking the given argument type can be wrapped, and if so, the wrapper. */
+static IMP CMJournaledSetter(const char *argumentType, IMP original, SEL selector, NSString *key);
+
+@implementation CMChangeJournal {
+    NSMutableDictionary *_originalValues;
+}
+
+#pragma mark - Instrumenting classes
+
++ (void)prepareClass:(Class)klass;
+{
+    NSParameterAssert([klass conformsToProtocol:@protocol(CMChangeJournaling)]);
+
+    // Associated objects are read without taking a lock, so classes that are already prepared cost a single lookup.
+    if (objc_getAssociatedObject(klass, &CMChangeJournalObservedKeysKey)) {
+        return;
+    }
+
+    @synchronized(self) {
+        if (objc_getAssociatedObject(klass, &CMChangeJournalObservedKeysKey)) {
+            return;
+        }
+
+        static NSMutableSet *wrappedSetters;
+        if (!wrappedSetters) {
+            wrappedSetters = [NSMutableSet set];
+        }
+
+        NSSet *trackedKeys = [NSSet setWithArray:[CMClassMetadata metadataForClass:klass].userDefinedPropertyNames];
+        NSMutableArray *observedKeys = [NSMutableArray array];
+
+        // Each setter is wrapped on the class that declares its property, so subclasses share their ancestors' wrappers.
+        for (Class declaringClass = klass; declaringClass && declaringClass != [NSObject class]; declaringClass = class_getSuperclass(declaringClass)) {
+            for (NSString *key in [CMClassMetadata metadataForClass:declaringClass].propertyNames) {
+                if (![trackedKeys containsObject:key]) {
+                    continue;
+                }
+
+                NSString *wrappedSetterName = [NSString stringWithFormat:@"%@.%@", NSStringFromClass(declaringClass), key];
+                if ([wrappedSetters containsObject:wrappedSetterName]) {
+                    continue;
+                }
+
+                objc_property_t property = class_getProperty(declaringClass, [key UTF8String]);
+                char *readonly = property ? property_copyAttributeValue(property, "R") : NULL;
+                char *customSetter = property ? property_copyAttributeValue(property, "S") : NULL;
+                SEL selector = customSetter ? sel_registerName(customSetter) :
+                    NSSelectorFromString([NSString stringWithFormat:@"set%@%@:", [[key substringToIndex:1] uppercaseString], [key substringFromIndex:1]]);
+                BOOL isReadonly = (readonly != NULL);
+                free(readonly);
+                free(customSetter);
+
+                Method method = class_getInstanceMethod(declaringClass, selector);
+                if (isReadonly || !method) {
+                    // Nothing to wrap. Readonly properties can only change through KVC, which KVO still notices.
+                    [observedKeys addObject:key];
+                    continue;
+                }
+
+                char *argumentType = method_copyArgumentType(method, 2);
+                IMP wrapper = CMJournaledSetter(argumentType, method_getImplementation(method), selector, key);
+                free(argumentType);
+
+                if (wrapper) {
+                    class_replaceMethod(declaringClass, selector, wrapper, method_getTypeEncoding(method));
+                    [wrappedSetters addObject:wrappedSetterName];
+                } else {
+                    [observedKeys addObject:key];
+                }
+            }
+        }
+
+        objc_setAssociatedObject(klass, &CMChangeJournalObservedKeysKey, [observedKeys copy], OBJC_ASSOCIATION_RETAIN);
+    }
+}
+
++ (NSArray *)observedKeysOfClass:(Class)klass;
+{
+    return objc_getAssociatedObject(klass, &CMChangeJournalObservedKeysKey);
+}
+
+#pragma mark - Recording changes
+
+- (BOOL)recordChangeOfKey:(NSString *)key ofObject:(id)object fromValue:(id)oldValue;
+{
+    id newValue = [object valueForKey:key];
+    if (oldValue == newValue || [oldValue isEqual:newValue]) {
+        return NO;
+    }
+
+    [self recordChangeOfKey:key fromValue:oldValue];
+    return YES;
+}
+
+- (void)recordChangeOfKey:(NSString *)key fromValue:(id)oldValue;
+{
+    @synchronized(self) {
+        if (!_originalValues) {
+            _originalValues = [NSMutableDictionary dictionary];
+        }
+        if (![_originalValues objectForKey:key]) {
+            [_originalValues setObject:(oldValue ?: [NSNull null]) forKey:key];
+        }
+    }
+}
+
+- (NSSet *)changedKeys;
+{
+    @synchronized(self) {
+        return [NSSet setWithArray:[_originalValues allKeys]];
+    }
+}
+
+- (NSDictionary *)originalValues;
+{
+    @synchronized(self) {
+        return [_originalValues copy] ?: @{};
+    }
+}
+
+- (void)reset;
+{
+    @synchronized(self) {
+        [_originalValues removeAllObjects];
+    }
+}
+
+@end
+
+#pragma mark - Setter wrappers
+
+#define CM_JOURNALED_SETTER(type) \
+    imp_implementationWithBlock(^(id<CMChangeJournaling> object, type value) { \
+        CMChangeJournal *journal = [object changeJournal]; \
+        if (!journal) { \
+            ((void (*)(id, SEL, type))original)(object, selector, value); \
+            return; \
+        } \
+        id oldValue = [(id)object valueForKey:key]; \
+        ((void (*)(id, SEL, type))original)(object, selector, value); \
+        if ([journal recordChangeOfKey:key ofObject:object fromValue:oldValue]) { \
+            [object didRecordChangeOfKey:key]; \
+        } \
+    })
+
+static IMP CMJournaledSetter(const char *argumentType, IMP original, SEL selector, NSString *key) {
+    // Skip method type qualifiers such as const, in, out and oneway.
+    while (*argumentType && strchr("rnNoORV", *argumentType)) {
+        argumentType++;
+    }
+
+    switch (*argumentType) {
+        case _C_ID: return CM_JOURNALED_SETTER(id);
+        case _C_CHR: return CM_JOURNALED_SETTER(char);
+        case _C_UCHR: return CM_JOURNALED_SETTER(unsigned char);
+        case _C_SHT: return CM_JOURNALED_SETTER(short);
+        case _C_USHT: return CM_JOURNALED_SETTER(unsigned short);
+        case _C_INT: return CM_JOURNALED_SETTER(int);
+        case _C_UINT: return CM_JOURNALED_SETTER(unsigned int);
+        case _C_LNG: return CM_JOURNALED_SETTER(long);
+        case _C_ULNG: return CM_JOURNALED_SETTER(unsigned long);
+        case _C_LNG_LNG: return CM_JOURNALED_SETTER(long long);
+        case _C_ULNG_LNG: return CM_JOURNALED_SETTER(unsigned long long);
+        case _C_FLT: return CM_JOURNALED_SETTER(float);
+        case _C_DBL: return CM_JOURNALED_SETTER(double);
+        case _C_BOOL: return CM_JOURNALED_SETTER(bool);
+        default: return NULL;
+    }
+}
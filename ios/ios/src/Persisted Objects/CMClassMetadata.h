@@ -0,0 +1,48 @@
+//
+//  CMClassMetadata.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * What the SDK needs to know about a class in order to observe, serialize and describe its instances, read from the
+ * Objective-C runtime once per class and kept for the lifetime of the app. Instances are immutable. Use
+ * <tt>+metadataForClass:</tt>, which is safe to call from any thread, to get the metadata of a class.
+ */
+@interface CMClassMetadata : NSObject
+
+/**
+ * The metadata of the given class, built the first time it is asked for.
+ *
+ * @param klass The class to describe.
+ */
++ (CMClassMetadata *)metadataForClass:(Class)klass;
+
+/** The class this metadata describes. */
+@property (nonatomic, readonly) Class describedClass;
+
+/**
+ * The name instances of the class are stored under: the value of <tt>+className</tt> if the class implements it, or
+ * else the name of the class itself.
+ */
+@property (nonatomic, readonly, copy) NSString *className;
+
+/** The names of the properties the class itself declares, in runtime order. */
+@property (nonatomic, readonly, copy) NSArray *propertyNames;
+
+/** The names of the instance variables the class itself declares, in runtime order. */
+@property (nonatomic, readonly, copy) NSArray *ivarNames;
+
+/**
+ * The properties whose changes mark an instance dirty. For a subclass of <tt>CMObject</tt>, these are the properties
+ * declared from the class up to and including <tt>CMObject</tt>, minus those of <tt>CMObject</tt> itself other than
+ * <tt>aclIds</tt>. For a subclass of <tt>CMUser</tt>, these are the properties the class itself declares that
+ * <tt>CMUser</tt> doesn't. For any other class, this is empty.
+ */
+@property (nonatomic, readonly, copy) NSArray *userDefinedPropertyNames;
+
+@end
@@ -0,0 +1,118 @@
+//
+//  CMClassMetadata.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMClassMetadata.h"
+#import "CMObject.h"
+#import "CMUser.h"
+#import "MARTNSObject.h"
+#import "RTProperty.h"
+#import "RTIvar.h"
+
+@interface CMClassMetadata ()
+- (instancetype)initWithClass:(Class)klass;
++ (NSArray *)userDefinedPropertiesOfClass:(Class)klass;
+@end
+
+@implementation CMClassMetadata
+
+#pragma mark - Shared cache
+
++ (dispatch_queue_t)cacheQueue;
+{
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("com.cloudmine.classmetadata", DISPATCH_QUEUE_CONCURRENT);
+    });
+    return queue;
+}
+
++ (NSMapTable *)cache;
+{
+    static NSMapTable *cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // Classes are never deallocated, so they can be held strongly and compared by pointer.
+        cache = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                      valueOptions:NSPointerFunctionsStrongMemory];
+    });
+    return cache;
+}
+
++ (CMClassMetadata *)metadataForClass:(Class)klass;
+{
+    NSParameterAssert(klass);
+
+    __block CMClassMetadata *metadata = nil;
+    dispatch_sync([self cacheQueue], ^{
+        metadata = [[self cache] objectForKey:klass];
+    });
+    if (metadata) {
+        return metadata;
+    }
+
+    // Built outside the barrier so lookups of other classes aren't held up. If another thread got here first, its
+    // metadata wins and this one is thrown away.
+    CMClassMetadata *built = [[CMClassMetadata alloc] initWithClass:klass];
+    dispatch_barrier_sync([self cacheQueue], ^{
+        metadata = [[self cache] objectForKey:klass];
+        if (!metadata) {
+            metadata = built;
+            [[self cache] setObject:built forKey:klass];
+        }
+    });
+    return metadata;
+}
+
+#pragma mark - Building
+
+- (instancetype)initWithClass:(Class)klass;
+{
+    if (self = [super init]) {
+        _describedClass = klass;
+        _className = [klass respondsToSelector:@selector(className)] ? [klass className] : NSStringFromClass(klass);
+
+        _propertyNames = [[[klass rt_properties] valueForKey:@"name"] copy];
+        _ivarNames = [[klass rt_ivars] valueForKey:@"name"];
+
+        _userDefinedPropertyNames = [[[CMClassMetadata userDefinedPropertiesOfClass:klass] valueForKey:@"name"] copy];
+    }
+    return self;
+}
+
++ (NSArray *)userDefinedPropertiesOfClass:(Class)klass;
+{
+    if ([klass isSubclassOfClass:[CMObject class]]) {
+        // Add every property on the class, up the class hierarchy the CMObject
+        NSMutableArray *allProperties = [NSMutableArray array];
+        for (Class class = klass; [class isSubclassOfClass:[CMObject class]]; class = [class superclass]) {
+            [allProperties addObjectsFromArray:[class rt_properties]];
+        }
+
+        // Remove all properties on CMObject itself, minus aclIDs
+        for (RTProperty *property in [[CMObject class] rt_properties]) {
+            if (![[property name] isEqualToString:@"aclIds"]) {
+                [allProperties removeObject:property];
+            }
+        }
+        return allProperties;
+    } else if ([klass isSubclassOfClass:[CMUser class]]) {
+        // None of the properties of CMUser are user profile fields, so ignore them
+        NSArray *ignoredProperties = [[CMUser class] rt_properties];
+        NSMutableArray *properties = [NSMutableArray array];
+        for (RTProperty *property in [klass rt_properties]) {
+            if (![ignoredProperties containsObject:property]) {
+                [properties addObject:property];
+            }
+        }
+        return properties;
+    }
+    return @[];
+}
+
+@end
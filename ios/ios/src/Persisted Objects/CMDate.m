@@ -9,6 +9,7 @@
 #import <objc/runtime.h>
 #import "CMDate.h"
 #import "CMObjectSerialization.h"
+#import "CMObjectClassNameRegistry.h"
 
 NSString * const CMDateClassName = @"datetime";
 
@@ -99,3 +100,6 @@ NSString * const CMDateClassName = @"datetime";
 }
 
 @end
+
+// Dates turn up in most objects, and decoding the first one shouldn't have to scan the runtime.
+CM_REGISTER_CLASS(CMDate)
@@ -16,10 +16,18 @@
 @interface CMFile : NSObject <CMSerializable>
 
 /**
- * The raw data of the file.
+ * The raw data of the file. For a file backed by <tt>fileURL</tt>, the contents of that file are mapped into memory on
+ * each access rather than kept by the instance.
  */
 @property (atomic, strong, readonly) NSData *fileData;
 
+/**
+ * The location on disk of the file's contents, or <tt>nil</tt> if the file is held in memory as <tt>fileData</tt>.
+ *
+ * @see CMStore#fileWithName:toURL:additionalOptions:progress:callback:
+ */
+@property (atomic, strong, readonly) NSURL *fileURL;
+
 /**
  * A human-readable filename. This is how you will perform requests for specific files.
  */
@@ -83,6 +91,15 @@
  */
 - (instancetype)initWithData:(NSData *)theFileData named:(NSString *)theName mimeType:(NSString *)theMimeType NS_DESIGNATED_INITIALIZER;;
 
+/**
+ * Creates a new file instance whose contents stay on disk. Saving it streams the contents from disk as well.
+ *
+ * @param theFileURL The file URL of the file's contents.
+ * @param theName The human-readable name of the file. This must be unique in your app, just like when there are many files in the same directory on a filesystem.
+ * @param theMimeType The MIME type of this file. Common MIME types keyed on file extensions can be accessed via CMMimeType#mimeTypeForExtension:. Defaults to <tt>application/octet-stream</tt>.
+ */
+- (instancetype)initWithContentsOfURL:(NSURL *)theFileURL named:(NSString *)theName mimeType:(NSString *)theMimeType NS_DESIGNATED_INITIALIZER;
+
 /**
  * @deprecated
  * Modifying the owner of a CMFile directly is no longer supported. Instead, go through CMStore as you would
@@ -22,6 +22,7 @@ NSString * const _mimeTypeKey = @"mime";
 }
 
 @synthesize fileData;
+@synthesize fileURL;
 @synthesize fileName;
 @synthesize mimeType;
 @synthesize store;
@@ -45,6 +46,19 @@ NSString * const _mimeTypeKey = @"mime";
     return self;
 }
 
+- (instancetype)initWithContentsOfURL:(NSURL *)theFileURL named:(NSString *)theName mimeType:(NSString *)theMimeType {
+    NSParameterAssert([theFileURL isFileURL]);
+    if (self = [super init]) {
+        fileURL = theFileURL;
+        cacheLocation = nil;
+        fileName = theName;
+        mimeType = (theMimeType == nil ? @"application/octet-stream" : theMimeType);
+        uuid = [NSString stringWithUUID];
+        store = nil;
+    }
+    return self;
+}
+
 - (instancetype)initWithData:(NSData *)theFileData named:(NSString *)theName belongingToUser:(CMUser *)theUser mimeType:(NSString *)theMimeType {
     NSLog(@"*** DEPRECATION WARNING: CMFile#initWithData:named:belongingToUser:mimeType: has been deprecated. Use CMFile#initWithData:named:mimeType: instead.");
     return [self initWithData:theFileData named:theName mimeType:theMimeType];
@@ -153,6 +167,16 @@ NSString * const _mimeTypeKey = @"mime";
     }
 }
 
+#pragma mark - Accessors
+
+- (NSData *)fileData {
+    if (fileData || !fileURL) {
+        return fileData;
+    }
+    // Not kept, so a large file is only paged in while someone holds on to the data.
+    return [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil];
+}
+
 #pragma CMStore interactions
 
 - (void)save:(CMStoreFileUploadCallback)callback {
@@ -163,12 +187,20 @@ NSString * const _mimeTypeKey = @"mime";
     switch ([self.store objectOwnershipLevel:self]) {
         case CMObjectOwnershipAppLevel:
         {
-            [self.store saveFileWithData:self.fileData named:self.fileName additionalOptions:nil callback:callback];
+            if (fileURL) {
+                [self.store saveFileAtURL:fileURL named:self.fileName additionalOptions:nil callback:callback];
+            } else {
+                [self.store saveFileWithData:self.fileData named:self.fileName additionalOptions:nil callback:callback];
+            }
             break;
         }
         case CMObjectOwnershipUserLevel:
         {
-            [self.store saveUserFileWithData:self.fileData named:self.fileName additionalOptions:nil callback:callback];
+            if (fileURL) {
+                [self.store saveUserFileAtURL:fileURL named:self.fileName additionalOptions:nil callback:callback];
+            } else {
+                [self.store saveUserFileWithData:self.fileData named:self.fileName additionalOptions:nil callback:callback];
+            }
             break;
         }
         default:
@@ -190,7 +222,7 @@ NSString * const _mimeTypeKey = @"mime";
 #pragma mark - Persisting to disk
 
 - (void)encodeWithCoder:(NSCoder *)coder {
-    [coder encodeObject:fileData forKey:_dataKey];
+    [coder encodeObject:self.fileData forKey:_dataKey];
     [coder encodeObject:fileName forKey:_nameKey];
     [coder encodeObject:uuid forKey:_uuidKey];
     [coder encodeObject:mimeType forKey:_mimeTypeKey];
@@ -13,8 +13,17 @@
 @interface CMObject ()
 
 @property (readwrite, getter = isDirty) BOOL dirty;
+
+/** <tt>YES</tt> once the object has matched its server-side state, by being fetched or saved. */
+@property (readonly, getter = isPersisted) BOOL persisted;
 @property (readwrite, strong, nonatomic) NSString *ownerId;
 @property (strong, nonatomic) CMACL *sharedACL;
 @property (strong, nonatomic) NSArray *aclIds;
 
+/**
+ * Points the object at a store without adding it to the store's memory cache, for objects the store only keeps track
+ * of the ownership level of.
+ */
+- (void)setStoreWithoutCaching:(CMStore *)newStore;
+
 @end
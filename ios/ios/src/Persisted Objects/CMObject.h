@@ -41,6 +41,18 @@
  */
 @property (readonly, getter = isDirty) BOOL dirty;
 
+/**
+ * The names of the properties that have changed locally since the object was created, fetched or last saved.
+ * Resets whenever the object stops being dirty.
+ */
+@property (nonatomic, readonly) NSSet *changedKeys;
+
+/**
+ * The values the properties in <tt>changedKeys</tt> had before they were first changed, keyed by property name.
+ * <tt>NSNull</tt> stands in for <tt>nil</tt>.
+ */
+@property (nonatomic, readonly) NSDictionary *originalValuesOfChangedKeys;
+
 
 /**
  * The ID of the user that owns the object. This will differ from the user of the store if the object has been shared.
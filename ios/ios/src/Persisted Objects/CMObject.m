@@ -15,10 +15,17 @@
 #import "CMObjectSerialization.h"
 #import "CMObjectDecoder.h"
 
-#import "MARTNSObject.h"
-#import "RTProperty.h"
+#import "CMClassMetadata.h"
+#import "CMChangeJournal.h"
+
+@interface CMObject () <CMChangeJournaling>
+@end
+
+@implementation CMObject {
+    CMChangeJournal *_changeJournal;
+    BOOL _persisted;
+}
 
-@implementation CMObject
 @synthesize objectId;
 @synthesize ownerId;
 @synthesize store;
@@ -38,7 +45,7 @@
         objectId = theObjectId;
         store = nil;
         dirty = YES;
-        [self registerAllPropertiesForKVO];
+        [self startTrackingChanges];
     }
     return self;
 }
@@ -55,11 +62,13 @@
 
     objectId = deserializedObjectId;
     store = nil;
-    [self registerAllPropertiesForKVO];
+    [self startTrackingChanges];
     self.aclIds = [aDecoder decodeObjectForKey:CMInternalObjectACLsKey];
 
     if ([aDecoder isKindOfClass:[CMObjectDecoder class]]) {
         dirty = NO;
+        _persisted = YES;
+        [_changeJournal reset];
     } else {
         dirty = YES;
     }
@@ -69,7 +78,7 @@
 
 - (void)dealloc;
 {
-    [self deregisterAllPropertiesForKVO];
+    [self stopTrackingChanges];
 }
 
 - (NSString *)ownerId;
@@ -81,36 +90,60 @@
 
 #pragma mark - Dirty tracking
 
-- (void)executeBlockForAllUserDefinedProperties:(void (^)(RTProperty *property))block;
+- (void)startTrackingChanges;
 {
-    // Add every property on the class, up the class hierarchy the CMObject
-    NSMutableArray *allProperties = [NSMutableArray array];
-    for (Class class = [self class]; [class isSubclassOfClass:[CMObject class]]; class = [class superclass]) {
-        [allProperties addObjectsFromArray:[class rt_properties]];
+    [CMChangeJournal prepareClass:[self class]];
+    _changeJournal = [[CMChangeJournal alloc] init];
+    for (NSString *key in [CMChangeJournal observedKeysOfClass:[self class]]) {
+        [self addObserver:self forKeyPath:key options:NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld context:NULL];
     }
+}
 
-    // Remove all properties on CMObject itself, minus aclIDs
-    [[[CMObject class] rt_properties] enumerateObjectsUsingBlock:^(RTProperty *property, NSUInteger idx, BOOL *stop) {
-        if (![[property name] isEqualToString:@"aclIds"]) {
-            [allProperties removeObject:property];
-        }
-    }];
+- (void)stopTrackingChanges;
+{
+    for (NSString *key in [CMChangeJournal observedKeysOfClass:[self class]]) {
+        [self removeObserver:self forKeyPath:key];
+    }
+    _changeJournal = nil;
+}
 
-    [allProperties enumerateObjectsUsingBlock:^(RTProperty *property, NSUInteger idx, BOOL *stop) { block(property); }];
+- (CMChangeJournal *)changeJournal;
+{
+    return _changeJournal;
 }
 
-- (void)registerAllPropertiesForKVO;
+- (void)didRecordChangeOfKey:(NSString *)key;
 {
-    [self executeBlockForAllUserDefinedProperties:^(RTProperty *property) {
-        [self addObserver:self forKeyPath:[property name] options:NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld context:NULL];
-    }];
+    dirty = YES;
 }
 
-- (void)deregisterAllPropertiesForKVO;
+- (NSSet *)changedKeys;
 {
-    [self executeBlockForAllUserDefinedProperties:^(RTProperty *property) {
-        [self removeObserver:self forKeyPath:[property name]];
-    }];
+    return _changeJournal.changedKeys ?: [NSSet set];
+}
+
+- (NSDictionary *)originalValuesOfChangedKeys;
+{
+    return _changeJournal.originalValues ?: @{};
+}
+
+- (BOOL)isDirty;
+{
+    return dirty;
+}
+
+- (void)setDirty:(BOOL)isDirty;
+{
+    dirty = isDirty;
+    if (!isDirty) {
+        _persisted = YES;
+        [_changeJournal reset];
+    }
+}
+
+- (BOOL)isPersisted;
+{
+    return _persisted;
 }
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context;
@@ -118,6 +151,7 @@
     id oldValue = [change objectForKey:NSKeyValueChangeOldKey];
     id newValue = [change objectForKey:NSKeyValueChangeNewKey];
     if (![oldValue isEqual:newValue]) {
+        [_changeJournal recordChangeOfKey:keyPath fromValue:(oldValue == [NSNull null] ? nil : oldValue)];
         dirty = YES;
     }
 }
@@ -231,6 +265,13 @@
     }
 }
 
+- (void)setStoreWithoutCaching:(CMStore *)newStore;
+{
+    @synchronized(self) {
+        store = newStore;
+    }
+}
+
 #pragma mark - ACLs
 
 - (void)getACLs:(CMStoreACLFetchCallback)callback;
@@ -361,11 +402,11 @@
 {
     NSString *string = [[NSString alloc] init];
     
-    NSArray *properties = [[self class] rt_ivars];
+    NSArray *names = [CMClassMetadata metadataForClass:[self class]].ivarNames;
     
-    for (RTProperty *prop in properties) {
-        if (!([prop.name isEqualToString:@"description"] || [prop.name isEqualToString:@"debugDescription"] )) {
-            string = [string stringByAppendingFormat:@"\n%@: %@", prop.name, [self safe_valueForKey:prop.name]];
+    for (NSString *name in names) {
+        if (!([name isEqualToString:@"description"] || [name isEqualToString:@"debugDescription"] )) {
+            string = [string stringByAppendingFormat:@"\n%@: %@", name, [self safe_valueForKey:name]];
         }
     }
     
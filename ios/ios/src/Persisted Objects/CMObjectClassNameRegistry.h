@@ -8,16 +8,34 @@
 
 #import <Foundation/Foundation.h>
 
+/**
+ * Registers a class with <tt>CMObjectClassNameRegistry</tt> when the binary it is in is loaded, so it is found by
+ * name without a scan of the runtime. Put it at file scope, usually next to the <tt>\@implementation</tt>:
+ *
+ * <pre>CM_REGISTER_CLASS(Venue)</pre>
+ *
+ * @see CMObjectClassNameRegistry#registerClass:
+ */
+#define CM_REGISTER_CLASS(klass) \
+    __attribute__((constructor)) static void _CMRegisterClass_##klass(void) { [CMObjectClassNameRegistry registerClass:[klass class]]; }
+
 /**
  * The registry that tracks all the custom class names you've registered by overriding +className in
  * your subclasses of <tt>CMObject</tt>. This is a singleton. <b>Do not call <tt>init</tt></b>. Instead use
  * <tt>+sharedInstance</tt> to get the instance of this class.
  *
- * The way this works is by looking up all the subclasses of <tt>CMObject</tt> by using the Objective-C runtime
- * and sends <tt>+className</tt> to each of them. It then records that name as a mapping to the class itself. Remember
- * that <tt>CMObjec</tt> provides a default implementation of <tt>+className</tt> that simply evaluates to
+ * Names are looked up in an immutable table that is replaced whenever a name is added, so lookups from any thread
+ * cost one dictionary access. The table is filled lazily: classes registered with <tt>+registerClass:</tt> or
+ * <tt>CM_REGISTER_CLASS</tt> are added the first time any name is looked up, and a class whose name is its own
+ * (see below) is added the first time that name is looked up. Only a name found neither way makes the registry look
+ * up all the subclasses of <tt>CMObject</tt> and all the implementors of <tt>CMCoding</tt> with the Objective-C runtime,
+ * once, sending <tt>+className</tt> to each of them. Names that are still unknown after that are remembered, so
+ * looking them up again is as cheap as any other.
+ *
+ * Remember that <tt>CMObject</tt> provides a default implementation of <tt>+className</tt> that simply evaluates to
  * <tt>NSStringFromClass([self class])</tt> so you only need to override that method if you are writing a cross-platform
- * app with multiple codebases and need to keep the class names in sync.
+ * app with multiple codebases and need to keep the class names in sync. Registering classes that do spares the first
+ * decode the scan of every class in the app.
  *
  * @see CMObject#className
  */
@@ -28,20 +46,31 @@
  */
 + (instancetype)sharedInstance;
 
+/**
+ * Registers a subclass of <tt>CMObject</tt> or an implementor of <tt>CMCoding</tt> under its <tt>+className</tt>.
+ * That method is only called the first time a name is looked up, so this is safe to call as early as load time.
+ * A registered class replaces any other class found under the same name.
+ *
+ * @param klass The class to register.
+ */
++ (void)registerClass:(Class)klass;
+
 /**
  * Given a class name, look up the actual class.
  *
  * <b>Implementation details</b>:
  * This first looks in the mapping of custom class names to ObjC classes. If it finds a class that matches
- * the name you gave, it returns that. If that fails, it tries to just use <tt>NSClassFromString()</tt>. If
- * that fails, it returns <tt>nil</tt>.
+ * the name you gave, it returns that. If that fails, it tries to just use <tt>NSClassFromString()</tt>, which is
+ * accepted if the class is stored under its own name. If that fails, it scans the runtime as described above, once.
+ * If that fails, it returns <tt>nil</tt>.
  *
  * @return The Class found in the registry, or nil if no match was found.
  */
 - (Class)classForName:(NSString *)name;
 
 /**
- * Drops all the entries in the registry and re-runs the detection method.
+ * Drops all the entries in the registry other than the registered classes, forgets the unknown names, and re-runs
+ * the scan of the runtime. Call this after loading code that defines classes with custom names.
  */
 - (void)refreshRegistry;
 
@@ -9,16 +9,26 @@
 #import "CMObjectClassNameRegistry.h"
 #import "CMObject.h"
 #import "CMCoding.h"
-#import "MARTNSObject.h"
 #import <objc/runtime.h>
 
+/** Unknown names come from response data, so only this many are remembered before they are all forgotten. */
+static NSUInteger const CMObjectClassNameRegistryMissingNameLimit = 1024;
+
 @interface CMObjectClassNameRegistry ()
 
-@property NSMutableDictionary *classNameMappings;
+// Replaced rather than mutated, so lookups can read them from any thread without taking the lock.
+@property (atomic, copy) NSDictionary *lookupTable;
+@property (atomic, copy) NSSet *missingNames;
 
 @end
 
-@implementation CMObjectClassNameRegistry
+@implementation CMObjectClassNameRegistry {
+    // Everything below is guarded by @synchronized(self).
+    NSMutableArray *_pendingClasses;
+    NSMutableDictionary *_registeredClasses;
+    NSMutableDictionary *_foundClasses;
+    NSDictionary *_scannedClasses;
+}
 
 #pragma mark - Singleton methods
 
@@ -34,21 +44,66 @@
 
 #pragma mark - Public interface
 
++ (void)registerClass:(Class)klass;
+{
+    NSParameterAssert(klass);
+    [[self sharedInstance] addPendingClass:klass];
+}
+
 - (Class)classForName:(NSString *)name;
 {
-    NSString *className = [self.classNameMappings objectForKey:name];
-    if (className) {
-        return NSClassFromString(className);
-    } else {
+    if (!name) {
+        return nil;
+    }
+
+    Class klass = [self.lookupTable objectForKey:name];
+    if (klass || [self.missingNames containsObject:name]) {
+        return klass;
+    }
+
+    @synchronized(self) {
+        [self resolvePendingClasses];
+        klass = [self.lookupTable objectForKey:name];
+        if (klass) {
+            return klass;
+        }
+
+        // A class stored under its own name is found without a scan.
+        Class namedClass = NSClassFromString(name);
+        if (namedClass && [self isStorableClass:namedClass] && [[self storedNameOfClass:namedClass] isEqualToString:name]) {
+            [_foundClasses setObject:namedClass forKey:name];
+            [self rebuildLookupTable];
+            return namedClass;
+        }
+
+        if (!_scannedClasses) {
+            _scannedClasses = [self scanRuntime];
+            [self rebuildLookupTable];
+            klass = [self.lookupTable objectForKey:name];
+            if (klass) {
+                return klass;
+            }
+        }
+
+        NSMutableSet *missingNames = [self.missingNames mutableCopy] ?: [NSMutableSet set];
+        if (missingNames.count >= CMObjectClassNameRegistryMissingNameLimit) {
+            [missingNames removeAllObjects];
+        }
+        [missingNames addObject:name];
+        self.missingNames = missingNames;
         return nil;
     }
 }
 
 - (void)refreshRegistry;
 {
-    [self.classNameMappings removeAllObjects];
-    [self discoverCMObjectSubclasses];
-    [self discoverCMCodingImplementors];
+    @synchronized(self) {
+        [self resolvePendingClasses];
+        [_foundClasses removeAllObjects];
+        _scannedClasses = [self scanRuntime];
+        self.missingNames = nil;
+        [self rebuildLookupTable];
+    }
 }
 
 #pragma mark - Private initializers
@@ -56,45 +111,110 @@
 - (instancetype)init;
 {
     if (self = [super init]) {
-        _classNameMappings = [[NSMutableDictionary alloc] init];
-        [self refreshRegistry];
+        _pendingClasses = [NSMutableArray array];
+        _registeredClasses = [NSMutableDictionary dictionary];
+        _foundClasses = [NSMutableDictionary dictionary];
+        self.lookupTable = [NSDictionary dictionary];
     }
     return self;
 }
 
 #pragma mark - Private workhorse methods
 
-- (void)discoverCMObjectSubclasses;
+- (void)addPendingClass:(Class)klass;
 {
-    NSArray *cmObjectSubclasses = [CMObject rt_subclasses];
-    for (Class klass in cmObjectSubclasses) {
-        [self.classNameMappings setObject:NSStringFromClass(klass) forKey:[klass className]];
+    @synchronized(self) {
+        [_pendingClasses addObject:klass];
+        self.missingNames = nil;
     }
 }
 
-- (void)discoverCMCodingImplementors;
+/**
+ * Moves registered classes into the table. Their names aren't asked for at registration, which may be at load time.
+ */
+- (void)resolvePendingClasses;
 {
-    int numClasses;
-    Class *classes = NULL;
-    
-    classes = NULL;
-    numClasses = objc_getClassList(NULL, 0);
-    
-    if (numClasses > 0 )
-    {
-        classes = (__unsafe_unretained Class *)malloc(sizeof(Class) * numClasses);
-        numClasses = objc_getClassList(classes, numClasses);
-        for (int i = 0; i < numClasses; i++) {
-            Class nextClass = classes[i];
-            if (class_conformsToProtocol(nextClass, @protocol(CMCoding))) {
-                NSString *className = NSStringFromClass(nextClass);
-                if ([nextClass respondsToSelector:@selector(className)]) {
-                    className = [nextClass className];
-                }
-                [self.classNameMappings setObject:NSStringFromClass(nextClass) forKey:className];
-            }
+    if (_pendingClasses.count == 0) {
+        return;
+    }
+    for (Class klass in _pendingClasses) {
+        [_registeredClasses setObject:klass forKey:[self storedNameOfClass:klass]];
+    }
+    [_pendingClasses removeAllObjects];
+    [self rebuildLookupTable];
+}
+
+- (void)rebuildLookupTable;
+{
+    NSMutableDictionary *lookupTable = [NSMutableDictionary dictionaryWithDictionary:_scannedClasses];
+    [lookupTable addEntriesFromDictionary:_foundClasses];
+    [lookupTable addEntriesFromDictionary:_registeredClasses];
+    self.lookupTable = lookupTable;
+}
+
+/**
+ * Whether a class is a subclass of <tt>CMObject</tt> or itself adopts <tt>CMCoding</tt>. Only the runtime is asked,
+ * so scanning a class doesn't initialize it.
+ */
+- (BOOL)isStorableClass:(Class)klass;
+{
+    if (class_conformsToProtocol(klass, @protocol(CMCoding))) {
+        return YES;
+    }
+    Class objectClass = [CMObject class];
+    for (Class superclass = class_getSuperclass(klass); superclass; superclass = class_getSuperclass(superclass)) {
+        if (superclass == objectClass) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (NSString *)storedNameOfClass:(Class)klass;
+{
+    return [klass respondsToSelector:@selector(className)] ? [klass className] : NSStringFromClass(klass);
+}
+
+/**
+ * Finds every storable class in the runtime, in a single pass over the class list.
+ */
+- (NSDictionary *)scanRuntime;
+{
+    NSMutableDictionary *classes = [NSMutableDictionary dictionary];
+    int numClasses = objc_getClassList(NULL, 0);
+    if (numClasses <= 0) {
+        return classes;
+    }
+
+    Class *classList = (__unsafe_unretained Class *)malloc(sizeof(Class) * numClasses);
+    numClasses = objc_getClassList(classList, numClasses);
+    for (int i = 0; i < numClasses; i++) {
+        Class nextClass = classList[i];
+        if ([self isStorableClass:nextClass]) {
+            [classes setObject:nextClass forKey:[self storedNameOfClass:nextClass]];
         }
-        free(classes);
+    }
+    free(classList);
+    return classes;
+}
+
+/**
+ * Every name the registry knows, mapped to the name of its class, scanning the runtime first if it hasn't yet.
+ */
+- (NSMutableDictionary *)classNameMappings;
+{
+    @synchronized(self) {
+        [self resolvePendingClasses];
+        if (!_scannedClasses) {
+            _scannedClasses = [self scanRuntime];
+            [self rebuildLookupTable];
+        }
+
+        NSMutableDictionary *mappings = [NSMutableDictionary dictionaryWithCapacity:self.lookupTable.count];
+        [self.lookupTable enumerateKeysAndObjectsUsingBlock:^(NSString *name, Class klass, BOOL *stop) {
+            [mappings setObject:NSStringFromClass(klass) forKey:name];
+        }];
+        return mappings;
     }
 }
 
@@ -0,0 +1,117 @@
+//
+//  CMMemoryCache.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * A thread-safe, cost-aware, least-recently-used in-memory cache with a dictionary-like interface. Whenever the cache
+ * holds more objects than <tt>countLimit</tt> or more than <tt>totalCostLimit</tt> worth of objects, the least
+ * recently used objects that may be evicted are removed until it fits again.
+ */
+@interface CMMemoryCache : NSObject
+
+/**
+ * The maximum number of objects the cache holds. <tt>0</tt> means no limit.
+ */
+@property (nonatomic, assign) NSUInteger countLimit;
+
+/**
+ * The maximum total cost of the objects the cache holds. <tt>0</tt> means no limit.
+ */
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+
+/**
+ * The fraction of the limits, between <tt>0</tt> and <tt>1</tt>, that <tt>trimToLowWaterMark</tt> trims the cache to.
+ * For a limit of <tt>0</tt>, the fraction of the current count or cost is used instead. Defaults to <tt>0.5</tt>.
+ */
+@property (nonatomic, assign) double lowWaterMark;
+
+/**
+ * Estimates the cost of an object when it is added. If <tt>nil</tt>, every object costs <tt>0</tt>.
+ */
+@property (nonatomic, copy) NSUInteger (^costEstimator)(id object);
+
+/**
+ * Decides whether an object may be evicted. If <tt>nil</tt>, every object may be.
+ */
+@property (nonatomic, copy) BOOL (^evictionFilter)(id object);
+
+/**
+ * Called, with the cache unlocked, for every object that is evicted.
+ */
+@property (nonatomic, copy) void (^evictionHandler)(id key, id object);
+
+/** The number of objects in the cache. */
+@property (nonatomic, readonly) NSUInteger count;
+
+/** The total estimated cost of the objects in the cache. */
+@property (nonatomic, readonly) NSUInteger totalCost;
+
+/**
+ * Returns the object for the given key and marks it as the most recently used.
+ *
+ * @param key The key of the object.
+ */
+- (id)objectForKey:(id)key;
+
+/**
+ * Adds an object, or replaces the one with the same key, as the most recently used, then evicts objects as needed.
+ *
+ * @param object The object to cache.
+ * @param key The key of the object.
+ */
+- (void)setObject:(id)object forKey:(id <NSCopying>)key;
+
+/**
+ * Adds an object, or replaces the one with the same key, as the most recently used, at a known cost instead of the
+ * one <tt>costEstimator</tt> would give it, then evicts objects as needed.
+ *
+ * @param object The object to cache.
+ * @param key The key of the object.
+ * @param cost The cost of the object.
+ */
+- (void)setObject:(id)object forKey:(id <NSCopying>)key cost:(NSUInteger)cost;
+
+/**
+ * Changes the cost of an object once it is known better, without affecting how recently it was used, then evicts
+ * objects as needed. Does nothing unless <tt>object</tt> is the one cached for <tt>key</tt>.
+ *
+ * @param cost The new cost of the object.
+ * @param object The object.
+ * @param key The key of the object.
+ */
+- (void)setCost:(NSUInteger)cost ofObject:(id)object forKey:(id)key;
+
+/**
+ * Removes the object for the given key. The eviction handler is not called.
+ *
+ * @param key The key of the object.
+ */
+- (void)removeObjectForKey:(id)key;
+
+/**
+ * Removes every object. The eviction handler is not called.
+ */
+- (void)removeAllObjects;
+
+/** A snapshot of every object in the cache. */
+- (NSArray *)allValues;
+
+/**
+ * Enumerates a snapshot of the cache without affecting how recently its objects were used.
+ *
+ * @param block The block to call for each key and object.
+ */
+- (void)enumerateKeysAndObjectsUsingBlock:(void (^)(id key, id object, BOOL *stop))block;
+
+/**
+ * Evicts the least recently used objects until the cache fits within <tt>lowWaterMark</tt> of its limits.
+ */
+- (void)trimToLowWaterMark;
+
+@end
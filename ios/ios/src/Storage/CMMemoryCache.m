@@ -0,0 +1,202 @@
+//
+//  CMMemoryCache.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMMemoryCache.h"
+
+@implementation CMMemoryCache {
+    NSMutableDictionary *_objects;
+    NSMutableDictionary *_costs;
+    // Keys ordered from least to most recently used.
+    NSMutableOrderedSet *_recency;
+    NSUInteger _totalCost;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _objects = [NSMutableDictionary dictionary];
+        _costs = [NSMutableDictionary dictionary];
+        _recency = [NSMutableOrderedSet orderedSet];
+        _lowWaterMark = 0.5;
+    }
+    return self;
+}
+
+#pragma mark - Limits
+
+- (void)setCountLimit:(NSUInteger)countLimit {
+    @synchronized(self) {
+        _countLimit = countLimit;
+    }
+    [self evictToLimits];
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit {
+    @synchronized(self) {
+        _totalCostLimit = totalCostLimit;
+    }
+    [self evictToLimits];
+}
+
+- (NSUInteger)count {
+    @synchronized(self) {
+        return _objects.count;
+    }
+}
+
+- (NSUInteger)totalCost {
+    @synchronized(self) {
+        return _totalCost;
+    }
+}
+
+#pragma mark - Access
+
+- (id)objectForKey:(id)key {
+    if (!key) {
+        return nil;
+    }
+
+    @synchronized(self) {
+        id object = [_objects objectForKey:key];
+        if (object) {
+            [_recency removeObject:key];
+            [_recency addObject:key];
+        }
+        return object;
+    }
+}
+
+- (void)setObject:(id)object forKey:(id <NSCopying>)key {
+    NSParameterAssert(object);
+    NSParameterAssert(key);
+
+    [self setObject:object forKey:key cost:(self.costEstimator ? self.costEstimator(object) : 0)];
+}
+
+- (void)setObject:(id)object forKey:(id <NSCopying>)key cost:(NSUInteger)cost {
+    NSParameterAssert(object);
+    NSParameterAssert(key);
+
+    @synchronized(self) {
+        _totalCost -= [[_costs objectForKey:key] unsignedIntegerValue];
+        [_objects setObject:object forKey:key];
+        [_costs setObject:@(cost) forKey:key];
+        _totalCost += cost;
+        [_recency removeObject:key];
+        [_recency addObject:key];
+    }
+    [self evictToLimits];
+}
+
+- (void)setCost:(NSUInteger)cost ofObject:(id)object forKey:(id)key {
+    if (!key) {
+        return;
+    }
+
+    @synchronized(self) {
+        if ([_objects objectForKey:key] != object) {
+            return;
+        }
+        _totalCost -= [[_costs objectForKey:key] unsignedIntegerValue];
+        [_costs setObject:@(cost) forKey:key];
+        _totalCost += cost;
+    }
+    [self evictToLimits];
+}
+
+- (void)removeObjectForKey:(id)key {
+    if (!key) {
+        return;
+    }
+
+    @synchronized(self) {
+        [self unlockedRemoveObjectForKey:key];
+    }
+}
+
+- (void)removeAllObjects {
+    @synchronized(self) {
+        [_objects removeAllObjects];
+        [_costs removeAllObjects];
+        [_recency removeAllObjects];
+        _totalCost = 0;
+    }
+}
+
+- (NSArray *)allValues {
+    @synchronized(self) {
+        return [_objects allValues];
+    }
+}
+
+- (void)enumerateKeysAndObjectsUsingBlock:(void (^)(id key, id object, BOOL *stop))block {
+    NSDictionary *snapshot = nil;
+    @synchronized(self) {
+        snapshot = [_objects copy];
+    }
+    [snapshot enumerateKeysAndObjectsUsingBlock:block];
+}
+
+#pragma mark - Eviction
+
+- (void)trimToLowWaterMark {
+    NSUInteger count, cost;
+    @synchronized(self) {
+        double fraction = MAX(0.0, MIN(1.0, _lowWaterMark));
+        count = (NSUInteger)((_countLimit > 0 ? _countLimit : _objects.count) * fraction);
+        cost = (NSUInteger)((_totalCostLimit > 0 ? _totalCostLimit : _totalCost) * fraction);
+    }
+    [self evictToCount:count cost:cost];
+}
+
+- (void)evictToLimits {
+    NSUInteger count, cost;
+    @synchronized(self) {
+        count = _countLimit > 0 ? _countLimit : NSUIntegerMax;
+        cost = _totalCostLimit > 0 ? _totalCostLimit : NSUIntegerMax;
+    }
+    [self evictToCount:count cost:cost];
+}
+
+/**
+ * Evicts least recently used objects until the cache holds at most <tt>count</tt> objects costing at most <tt>cost</tt>.
+ * Objects the eviction filter refuses are skipped, so the cache stays above the targets if too many are refused.
+ */
+- (void)evictToCount:(NSUInteger)count cost:(NSUInteger)cost {
+    NSMutableArray *evicted = [NSMutableArray array];
+
+    @synchronized(self) {
+        NSUInteger index = 0;
+        while (index < _recency.count && (_objects.count > count || _totalCost > cost)) {
+            id key = [_recency objectAtIndex:index];
+            id object = [_objects objectForKey:key];
+            if (_evictionFilter && !_evictionFilter(object)) {
+                index++;
+                continue;
+            }
+            [evicted addObject:@[key, object]];
+            [self unlockedRemoveObjectForKey:key];
+        }
+    }
+
+    void (^handler)(id, id) = self.evictionHandler;
+    if (handler) {
+        for (NSArray *pair in evicted) {
+            handler(pair[0], pair[1]);
+        }
+    }
+}
+
+- (void)unlockedRemoveObjectForKey:(id)key {
+    _totalCost -= [[_costs objectForKey:key] unsignedIntegerValue];
+    [_objects removeObjectForKey:key];
+    [_costs removeObjectForKey:key];
+    [_recency removeObject:key];
+}
+
+@end
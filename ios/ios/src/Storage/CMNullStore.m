@@ -76,6 +76,14 @@
     THROW_NULLSTORE_EXCEPTION
 }
 
+- (void)fileWithName:(NSString *)name toURL:(NSURL *)url additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback {
+    THROW_NULLSTORE_EXCEPTION
+}
+
+- (void)userFileWithName:(NSString *)name toURL:(NSURL *)url additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback {
+    THROW_NULLSTORE_EXCEPTION
+}
+
 - (void)saveAll:(CMStoreObjectUploadCallback)callback {
     THROW_NULLSTORE_EXCEPTION
 }
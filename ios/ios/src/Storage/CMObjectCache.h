@@ -0,0 +1,158 @@
+//
+//  CMObjectCache.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Which of the objects stored for a user a lookup or a complete fetch covers.
+ */
+typedef NS_ENUM(NSInteger, CMObjectCacheScope) {
+    /** The objects of the user and the objects other users shared with them. */
+    CMObjectCacheScopeAll = 0,
+    /** Only the objects of the user. App-level objects are always in this scope. */
+    CMObjectCacheScopeOwned,
+    /** Only the objects other users shared with the user. */
+    CMObjectCacheScopeShared
+};
+
+/**
+ * A persistent, SQLite-backed cache of object representations, as returned by the CloudMine API. Representations are
+ * keyed by object ID and owner, so app-level objects and the objects of each user are kept apart. Every representation
+ * remembers when it was stored, which lets callers ignore entries that are older than they are willing to accept.
+ *
+ * All methods are safe to call from any thread. Writes happen asynchronously on a private serial queue; reads wait
+ * for any writes that were issued before them.
+ */
+@interface CMObjectCache : NSObject
+
+/**
+ * The cache shared by every store of the given app. The database lives in the app's caches directory.
+ *
+ * @param appIdentifier The identifier of the CloudMine app whose objects are cached.
+ */
++ (CMObjectCache *)sharedCacheForAppIdentifier:(NSString *)appIdentifier;
+
+/**
+ * Opens, creating it if needed, the cache database at the given path.
+ *
+ * This is the designated initializer.
+ *
+ * @param path The file path of the SQLite database.
+ */
+- (instancetype)initWithPath:(NSString *)path;
+
+/** The file path of the SQLite database. */
+@property (nonatomic, readonly, copy) NSString *path;
+
+/**
+ * Stores object representations, replacing any previously stored under the same object IDs and owner. Objects that
+ * were already stored stay in the scope they were in; new ones are in <tt>CMObjectCacheScopeOwned</tt>.
+ *
+ * @param representations Object representations keyed by object ID, in the format used by the CloudMine API.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ */
+- (void)storeRepresentations:(NSDictionary *)representations ownerIdentifier:(NSString *)ownerIdentifier;
+
+/**
+ * Stores object representations like <tt>storeRepresentations:ownerIdentifier:</tt>, but puts the objects whose keys
+ * are in <tt>sharedKeys</tt> in <tt>CMObjectCacheScopeShared</tt> and the rest in <tt>CMObjectCacheScopeOwned</tt>.
+ *
+ * @param representations Object representations keyed by object ID, in the format used by the CloudMine API.
+ * @param sharedKeys The object IDs of the representations that other users shared with the owner.
+ * @param ownerIdentifier The object ID of the user the objects were fetched for, or <tt>nil</tt> for app-level objects.
+ */
+- (void)storeRepresentations:(NSDictionary *)representations sharedKeys:(NSSet *)sharedKeys ownerIdentifier:(NSString *)ownerIdentifier;
+
+/**
+ * Merges partial representations into the stored ones, replacing the top-level fields they contain and leaving the
+ * rest alone. Partial representations of objects that aren't stored are dropped, since they can't stand on their own.
+ *
+ * @param representations Partial object representations keyed by object ID.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ */
+- (void)mergeRepresentations:(NSDictionary *)representations ownerIdentifier:(NSString *)ownerIdentifier;
+
+/**
+ * Returns the stored representations with the given keys, keyed by object ID. Keys that aren't cached, or whose
+ * entries are older than <tt>maximumAge</tt>, are left out.
+ *
+ * @param keys The object IDs to look up, or <tt>nil</tt> for every object of the owner.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ * @param maximumAge The oldest entry, in seconds, to return. Pass <tt>0</tt> to ignore the age of entries.
+ */
+- (NSDictionary *)representationsWithKeys:(NSArray *)keys ownerIdentifier:(NSString *)ownerIdentifier maximumAge:(NSTimeInterval)maximumAge;
+
+/**
+ * Returns the stored representations of the given class, keyed by object ID.
+ *
+ * @param className The class name stored with the objects (the value returned by <tt>+[CMObject className]</tt>).
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ * @param maximumAge The oldest entry, in seconds, to return. Pass <tt>0</tt> to ignore the age of entries.
+ */
+- (NSDictionary *)representationsOfClassNamed:(NSString *)className ownerIdentifier:(NSString *)ownerIdentifier maximumAge:(NSTimeInterval)maximumAge;
+
+/**
+ * Returns the stored representations of the given class within a scope, keyed by object ID.
+ *
+ * @param className The class name stored with the objects, or <tt>nil</tt> for objects of every class.
+ * @param scope Which of the owner's objects to return.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ * @param maximumAge The oldest entry, in seconds, to return. Pass <tt>0</tt> to ignore the age of entries.
+ */
+- (NSDictionary *)representationsOfClassNamed:(NSString *)className scope:(CMObjectCacheScope)scope ownerIdentifier:(NSString *)ownerIdentifier maximumAge:(NSTimeInterval)maximumAge;
+
+/**
+ * Removes the representations with the given keys.
+ *
+ * @param keys The object IDs to remove.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ */
+- (void)removeRepresentationsWithKeys:(NSArray *)keys ownerIdentifier:(NSString *)ownerIdentifier;
+
+/**
+ * Records that the complete result of a query was just stored, so later lookups can tell how fresh it is.
+ *
+ * @param query An identifier for the query, such as a class name.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ */
+- (void)recordFetchOfQuery:(NSString *)query ownerIdentifier:(NSString *)ownerIdentifier;
+
+/**
+ * Records that the complete result of a query was just stored, like <tt>recordFetchOfQuery:ownerIdentifier:</tt>, and
+ * removes the objects of its class and scope that aren't part of that result, since they were deleted or are no
+ * longer shared with the owner.
+ *
+ * @param query An identifier for the query, which should tell apart queries of different scopes.
+ * @param className The class name the query is limited to, or <tt>nil</tt> if it returns objects of every class.
+ * @param scope Which of the owner's objects the query returns.
+ * @param keys The object IDs of the complete result.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ */
+- (void)recordCompleteFetchOfQuery:(NSString *)query className:(NSString *)className scope:(CMObjectCacheScope)scope keys:(NSArray *)keys ownerIdentifier:(NSString *)ownerIdentifier;
+
+/**
+ * When the complete result of a query was last stored, or <tt>nil</tt> if it never was.
+ *
+ * @param query An identifier for the query, such as a class name.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ */
+- (NSDate *)lastFetchOfQuery:(NSString *)query ownerIdentifier:(NSString *)ownerIdentifier;
+
+/**
+ * Removes the objects and query records of one owner, for instance once that user logged out.
+ *
+ * @param ownerIdentifier The object ID of the user, or <tt>nil</tt> for app-level objects.
+ */
+- (void)removeAllRepresentationsOfOwner:(NSString *)ownerIdentifier;
+
+/**
+ * Removes everything from the cache.
+ */
+- (void)removeAllRepresentations;
+
+@end
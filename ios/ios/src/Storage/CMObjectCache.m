@@ -0,0 +1,495 @@
+//
+//  CMObjectCache.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <sqlite3.h>
+
+#import "CMObjectCache.h"
+#import "CMObjectSerialization.h"
+
+/** App-level objects are stored under this owner, since SQLite primary keys can't hold <tt>NULL</tt>. */
+static NSString * const CMObjectCacheAppOwner = @"";
+
+/** Bumped whenever the tables change. Entries are only a cache, so older tables are dropped rather than migrated. */
+static int const CMObjectCacheSchemaVersion = 2;
+
+static NSString *CMObjectCacheScopeCondition(CMObjectCacheScope scope)
+{
+    switch (scope) {
+        case CMObjectCacheScopeOwned:
+            return @" AND shared = 0";
+        case CMObjectCacheScopeShared:
+            return @" AND shared = 1";
+        default:
+            return @"";
+    }
+}
+
+@interface CMObjectCache () {
+    sqlite3 *_database;
+    dispatch_queue_t _queue;
+}
+@property (nonatomic, readwrite, copy) NSString *path;
+@end
+
+@implementation CMObjectCache
+
+#pragma mark - Shared caches
+
++ (CMObjectCache *)sharedCacheForAppIdentifier:(NSString *)appIdentifier;
+{
+    NSParameterAssert(appIdentifier);
+
+    static NSMutableDictionary *_sharedCaches = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _sharedCaches = [NSMutableDictionary dictionary];
+    });
+
+    @synchronized(_sharedCaches) {
+        CMObjectCache *cache = [_sharedCaches objectForKey:appIdentifier];
+        if (!cache) {
+            NSURL *cachesURL = [[NSFileManager defaultManager] URLForDirectory:NSCachesDirectory inDomain:NSUserDomainMask appropriateForURL:nil create:YES error:nil];
+            NSURL *directoryURL = [cachesURL URLByAppendingPathComponent:@"cmObjectCache"];
+            [[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+            NSString *path = [[directoryURL URLByAppendingPathComponent:[appIdentifier stringByAppendingPathExtension:@"sqlite"]] path];
+            cache = [[CMObjectCache alloc] initWithPath:path];
+            if (cache) {
+                [_sharedCaches setObject:cache forKey:appIdentifier];
+            }
+        }
+        return cache;
+    }
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithPath:(NSString *)path;
+{
+    NSParameterAssert(path);
+
+    if ((self = [super init])) {
+        self.path = path;
+        _queue = dispatch_queue_create("com.cloudmine.objectcache", DISPATCH_QUEUE_SERIAL);
+
+        if (sqlite3_open_v2([path fileSystemRepresentation], &_database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK) {
+            NSLog(@"CloudMine *** Unable to open the object cache at %@: %s", path, sqlite3_errmsg(_database));
+            sqlite3_close(_database);
+            _database = NULL;
+            return nil;
+        }
+
+        sqlite3_busy_timeout(_database, 1000);
+        [self _execute:@"PRAGMA journal_mode = WAL"];
+        if ([self _schemaVersion] < CMObjectCacheSchemaVersion) {
+            [self _execute:@"DROP TABLE IF EXISTS objects"];
+            [self _execute:@"DROP TABLE IF EXISTS queries"];
+            [self _execute:[NSString stringWithFormat:@"PRAGMA user_version = %d", CMObjectCacheSchemaVersion]];
+        }
+        [self _execute:@"CREATE TABLE IF NOT EXISTS objects (object_id TEXT NOT NULL, owner TEXT NOT NULL, class_name TEXT, body BLOB NOT NULL, stored_at REAL NOT NULL, shared INTEGER NOT NULL DEFAULT 0, PRIMARY KEY (object_id, owner))"];
+        [self _execute:@"CREATE INDEX IF NOT EXISTS objects_class ON objects (owner, class_name)"];
+        [self _execute:@"CREATE TABLE IF NOT EXISTS queries (query TEXT NOT NULL, owner TEXT NOT NULL, fetched_at REAL NOT NULL, PRIMARY KEY (query, owner))"];
+    }
+    return self;
+}
+
+- (void)dealloc;
+{
+    if (_database) {
+        sqlite3_close(_database);
+    }
+}
+
+#pragma mark - Writing
+
+- (void)storeRepresentations:(NSDictionary *)representations ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    [self _storeRepresentations:representations sharedKeys:nil ownerIdentifier:ownerIdentifier];
+}
+
+- (void)storeRepresentations:(NSDictionary *)representations sharedKeys:(NSSet *)sharedKeys ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    [self _storeRepresentations:representations sharedKeys:(sharedKeys ?: [NSSet set]) ownerIdentifier:ownerIdentifier];
+}
+
+/**
+ * Without <tt>sharedKeys</tt>, objects that are already stored keep their scope.
+ */
+- (void)_storeRepresentations:(NSDictionary *)representations sharedKeys:(NSSet *)sharedKeys ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    if ([representations count] == 0) {
+        return;
+    }
+
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    representations = [representations copy];
+
+    dispatch_async(_queue, ^{
+        sqlite3_stmt *statement = [self _prepare:@"INSERT OR REPLACE INTO objects (object_id, owner, class_name, body, stored_at, shared) "
+                                                  "VALUES (?1, ?2, ?3, ?4, ?5, COALESCE(?6, (SELECT shared FROM objects WHERE object_id = ?1 AND owner = ?2), 0))"];
+        if (!statement) {
+            return;
+        }
+
+        [self _execute:@"BEGIN TRANSACTION"];
+        [representations enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSDictionary *representation, BOOL *stop) {
+            if (![representation isKindOfClass:[NSDictionary class]] || ![NSJSONSerialization isValidJSONObject:representation]) {
+                return;
+            }
+
+            NSData *body = [NSJSONSerialization dataWithJSONObject:representation options:0 error:nil];
+            NSString *className = [representation objectForKey:CMInternalClassStorageKey];
+            sqlite3_bind_text(statement, 1, [key UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 2, [owner UTF8String], -1, SQLITE_TRANSIENT);
+            if ([className isKindOfClass:[NSString class]]) {
+                sqlite3_bind_text(statement, 3, [className UTF8String], -1, SQLITE_TRANSIENT);
+            } else {
+                sqlite3_bind_null(statement, 3);
+            }
+            sqlite3_bind_blob(statement, 4, [body bytes], (int)[body length], SQLITE_TRANSIENT);
+            sqlite3_bind_double(statement, 5, now);
+            if (sharedKeys) {
+                sqlite3_bind_int(statement, 6, [sharedKeys containsObject:key] ? 1 : 0);
+            } else {
+                sqlite3_bind_null(statement, 6);
+            }
+            [self _step:statement];
+        }];
+        [self _execute:@"COMMIT TRANSACTION"];
+        sqlite3_finalize(statement);
+    });
+}
+
+- (void)mergeRepresentations:(NSDictionary *)representations ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    if ([representations count] == 0) {
+        return;
+    }
+
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    representations = [representations copy];
+
+    dispatch_async(_queue, ^{
+        sqlite3_stmt *select = [self _prepare:@"SELECT object_id, body FROM objects WHERE object_id = ? AND owner = ?"];
+        sqlite3_stmt *update = [self _prepare:@"UPDATE objects SET body = ?, stored_at = ? WHERE object_id = ? AND owner = ?"];
+        if (!select || !update) {
+            sqlite3_finalize(select);
+            sqlite3_finalize(update);
+            return;
+        }
+
+        [self _execute:@"BEGIN TRANSACTION"];
+        [representations enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSDictionary *partial, BOOL *stop) {
+            if (![partial isKindOfClass:[NSDictionary class]]) {
+                return;
+            }
+
+            NSMutableDictionary *stored = [NSMutableDictionary dictionary];
+            sqlite3_bind_text(select, 1, [key UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(select, 2, [owner UTF8String], -1, SQLITE_TRANSIENT);
+            [self _collectRepresentationsFromStatement:select into:stored];
+
+            NSMutableDictionary *merged = [[stored objectForKey:key] mutableCopy];
+            if (![merged isKindOfClass:[NSMutableDictionary class]]) {
+                return;
+            }
+            [merged addEntriesFromDictionary:partial];
+            if (![NSJSONSerialization isValidJSONObject:merged]) {
+                return;
+            }
+
+            NSData *body = [NSJSONSerialization dataWithJSONObject:merged options:0 error:nil];
+            sqlite3_bind_blob(update, 1, [body bytes], (int)[body length], SQLITE_TRANSIENT);
+            sqlite3_bind_double(update, 2, now);
+            sqlite3_bind_text(update, 3, [key UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(update, 4, [owner UTF8String], -1, SQLITE_TRANSIENT);
+            [self _step:update];
+        }];
+        [self _execute:@"COMMIT TRANSACTION"];
+        sqlite3_finalize(select);
+        sqlite3_finalize(update);
+    });
+}
+
+- (void)removeRepresentationsWithKeys:(NSArray *)keys ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    if ([keys count] == 0) {
+        return;
+    }
+
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    keys = [keys copy];
+
+    dispatch_async(_queue, ^{
+        sqlite3_stmt *statement = [self _prepare:@"DELETE FROM objects WHERE object_id = ? AND owner = ?"];
+        if (!statement) {
+            return;
+        }
+
+        [self _execute:@"BEGIN TRANSACTION"];
+        for (NSString *key in keys) {
+            sqlite3_bind_text(statement, 1, [key UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 2, [owner UTF8String], -1, SQLITE_TRANSIENT);
+            [self _step:statement];
+        }
+        [self _execute:@"COMMIT TRANSACTION"];
+        sqlite3_finalize(statement);
+    });
+}
+
+- (void)recordFetchOfQuery:(NSString *)query ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    NSParameterAssert(query);
+
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+
+    dispatch_async(_queue, ^{
+        sqlite3_stmt *statement = [self _prepare:@"INSERT OR REPLACE INTO queries (query, owner, fetched_at) VALUES (?, ?, ?)"];
+        if (!statement) {
+            return;
+        }
+
+        sqlite3_bind_text(statement, 1, [query UTF8String], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 2, [owner UTF8String], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(statement, 3, now);
+        [self _step:statement];
+        sqlite3_finalize(statement);
+    });
+}
+
+- (void)recordCompleteFetchOfQuery:(NSString *)query className:(NSString *)className scope:(CMObjectCacheScope)scope keys:(NSArray *)keys ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    NSParameterAssert(query);
+
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    NSSet *fetchedKeys = [NSSet setWithArray:keys ?: @[]];
+
+    dispatch_async(_queue, ^{
+        NSString *sql = [@"SELECT object_id FROM objects WHERE owner = ?" stringByAppendingString:CMObjectCacheScopeCondition(scope)];
+        if (className) {
+            sql = [sql stringByAppendingString:@" AND class_name = ?"];
+        }
+        sqlite3_stmt *select = [self _prepare:sql];
+        sqlite3_stmt *removal = [self _prepare:@"DELETE FROM objects WHERE object_id = ? AND owner = ?"];
+        if (!select || !removal) {
+            sqlite3_finalize(select);
+            sqlite3_finalize(removal);
+            return;
+        }
+
+        NSMutableArray *missingKeys = [NSMutableArray array];
+        sqlite3_bind_text(select, 1, [owner UTF8String], -1, SQLITE_TRANSIENT);
+        if (className) {
+            sqlite3_bind_text(select, 2, [className UTF8String], -1, SQLITE_TRANSIENT);
+        }
+        while (sqlite3_step(select) == SQLITE_ROW) {
+            const char *objectId = (const char *)sqlite3_column_text(select, 0);
+            NSString *key = objectId ? [NSString stringWithUTF8String:objectId] : nil;
+            if (key && ![fetchedKeys containsObject:key]) {
+                [missingKeys addObject:key];
+            }
+        }
+        sqlite3_finalize(select);
+
+        [self _execute:@"BEGIN TRANSACTION"];
+        for (NSString *key in missingKeys) {
+            sqlite3_bind_text(removal, 1, [key UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(removal, 2, [owner UTF8String], -1, SQLITE_TRANSIENT);
+            [self _step:removal];
+        }
+        [self _execute:@"COMMIT TRANSACTION"];
+        sqlite3_finalize(removal);
+    });
+
+    [self recordFetchOfQuery:query ownerIdentifier:ownerIdentifier];
+}
+
+- (void)removeAllRepresentationsOfOwner:(NSString *)ownerIdentifier;
+{
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+
+    dispatch_async(_queue, ^{
+        for (NSString *sql in @[@"DELETE FROM objects WHERE owner = ?", @"DELETE FROM queries WHERE owner = ?"]) {
+            sqlite3_stmt *statement = [self _prepare:sql];
+            if (statement) {
+                sqlite3_bind_text(statement, 1, [owner UTF8String], -1, SQLITE_TRANSIENT);
+                [self _step:statement];
+                sqlite3_finalize(statement);
+            }
+        }
+    });
+}
+
+- (void)removeAllRepresentations;
+{
+    dispatch_async(_queue, ^{
+        [self _execute:@"DELETE FROM objects"];
+        [self _execute:@"DELETE FROM queries"];
+    });
+}
+
+#pragma mark - Reading
+
+- (NSDictionary *)representationsWithKeys:(NSArray *)keys ownerIdentifier:(NSString *)ownerIdentifier maximumAge:(NSTimeInterval)maximumAge;
+{
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    NSTimeInterval oldest = maximumAge > 0 ? [[NSDate date] timeIntervalSince1970] - maximumAge : 0;
+    NSMutableDictionary *representations = [NSMutableDictionary dictionary];
+
+    dispatch_sync(_queue, ^{
+        if (!keys) {
+            sqlite3_stmt *statement = [self _prepare:@"SELECT object_id, body FROM objects WHERE owner = ? AND stored_at >= ?"];
+            if (!statement) {
+                return;
+            }
+            sqlite3_bind_text(statement, 1, [owner UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_double(statement, 2, oldest);
+            [self _collectRepresentationsFromStatement:statement into:representations];
+            sqlite3_finalize(statement);
+            return;
+        }
+
+        sqlite3_stmt *statement = [self _prepare:@"SELECT object_id, body FROM objects WHERE object_id = ? AND owner = ? AND stored_at >= ?"];
+        if (!statement) {
+            return;
+        }
+        for (NSString *key in keys) {
+            sqlite3_bind_text(statement, 1, [key UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 2, [owner UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_double(statement, 3, oldest);
+            [self _collectRepresentationsFromStatement:statement into:representations];
+        }
+        sqlite3_finalize(statement);
+    });
+
+    return representations;
+}
+
+- (NSDictionary *)representationsOfClassNamed:(NSString *)className ownerIdentifier:(NSString *)ownerIdentifier maximumAge:(NSTimeInterval)maximumAge;
+{
+    NSParameterAssert(className);
+    return [self representationsOfClassNamed:className scope:CMObjectCacheScopeAll ownerIdentifier:ownerIdentifier maximumAge:maximumAge];
+}
+
+- (NSDictionary *)representationsOfClassNamed:(NSString *)className scope:(CMObjectCacheScope)scope ownerIdentifier:(NSString *)ownerIdentifier maximumAge:(NSTimeInterval)maximumAge;
+{
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    NSTimeInterval oldest = maximumAge > 0 ? [[NSDate date] timeIntervalSince1970] - maximumAge : 0;
+    NSMutableDictionary *representations = [NSMutableDictionary dictionary];
+
+    NSString *sql = [@"SELECT object_id, body FROM objects WHERE owner = ? AND stored_at >= ?" stringByAppendingString:CMObjectCacheScopeCondition(scope)];
+    if (className) {
+        sql = [sql stringByAppendingString:@" AND class_name = ?"];
+    }
+
+    dispatch_sync(_queue, ^{
+        sqlite3_stmt *statement = [self _prepare:sql];
+        if (!statement) {
+            return;
+        }
+        sqlite3_bind_text(statement, 1, [owner UTF8String], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(statement, 2, oldest);
+        if (className) {
+            sqlite3_bind_text(statement, 3, [className UTF8String], -1, SQLITE_TRANSIENT);
+        }
+        [self _collectRepresentationsFromStatement:statement into:representations];
+        sqlite3_finalize(statement);
+    });
+
+    return representations;
+}
+
+- (NSDate *)lastFetchOfQuery:(NSString *)query ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    NSParameterAssert(query);
+
+    NSString *owner = ownerIdentifier ?: CMObjectCacheAppOwner;
+    __block NSDate *fetchDate = nil;
+
+    dispatch_sync(_queue, ^{
+        sqlite3_stmt *statement = [self _prepare:@"SELECT fetched_at FROM queries WHERE query = ? AND owner = ?"];
+        if (!statement) {
+            return;
+        }
+        sqlite3_bind_text(statement, 1, [query UTF8String], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 2, [owner UTF8String], -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(statement) == SQLITE_ROW) {
+            fetchDate = [NSDate dateWithTimeIntervalSince1970:sqlite3_column_double(statement, 0)];
+        }
+        sqlite3_finalize(statement);
+    });
+
+    return fetchDate;
+}
+
+#pragma mark - SQLite helpers
+
+- (void)_collectRepresentationsFromStatement:(sqlite3_stmt *)statement into:(NSMutableDictionary *)representations;
+{
+    while (sqlite3_step(statement) == SQLITE_ROW) {
+        const char *objectId = (const char *)sqlite3_column_text(statement, 0);
+        NSData *body = [NSData dataWithBytes:sqlite3_column_blob(statement, 1) length:(NSUInteger)sqlite3_column_bytes(statement, 1)];
+        id representation = [NSJSONSerialization JSONObjectWithData:body options:0 error:nil];
+        if (objectId && representation) {
+            [representations setObject:representation forKey:[NSString stringWithUTF8String:objectId]];
+        }
+    }
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+}
+
+- (int)_schemaVersion;
+{
+    int version = 0;
+    sqlite3_stmt *statement = [self _prepare:@"PRAGMA user_version"];
+    if (statement && sqlite3_step(statement) == SQLITE_ROW) {
+        version = sqlite3_column_int(statement, 0);
+    }
+    sqlite3_finalize(statement);
+    return version;
+}
+
+- (sqlite3_stmt *)_prepare:(NSString *)sql;
+{
+    if (!_database) {
+        return NULL;
+    }
+
+    sqlite3_stmt *statement = NULL;
+    if (sqlite3_prepare_v2(_database, [sql UTF8String], -1, &statement, NULL) != SQLITE_OK) {
+        NSLog(@"CloudMine *** Object cache statement failed (%@): %s", sql, sqlite3_errmsg(_database));
+        return NULL;
+    }
+    return statement;
+}
+
+- (void)_step:(sqlite3_stmt *)statement;
+{
+    if (sqlite3_step(statement) != SQLITE_DONE) {
+        NSLog(@"CloudMine *** Object cache write failed: %s", sqlite3_errmsg(_database));
+    }
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+}
+
+- (void)_execute:(NSString *)sql;
+{
+    if (!_database) {
+        return;
+    }
+
+    char *message = NULL;
+    if (sqlite3_exec(_database, [sql UTF8String], NULL, NULL, &message) != SQLITE_OK) {
+        NSLog(@"CloudMine *** Object cache statement failed (%@): %s", sql, message);
+        sqlite3_free(message);
+    }
+}
+
+@end
@@ -0,0 +1,173 @@
+//
+//  CMOutbox.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <Foundation/Foundation.h>
+
+@class CMOutbox;
+
+/**
+ * The kinds of writes an outbox holds.
+ */
+typedef NS_ENUM(NSInteger, CMOutboxOperationType) {
+    /** Creates or updates an object, like <tt>CMStore#saveObject:callback:</tt>. */
+    CMOutboxOperationSave = 0,
+    /** Creates or replaces an object as a whole, like <tt>CMStore#replaceObject:callback:</tt>. */
+    CMOutboxOperationReplace,
+    /** Deletes an object, like <tt>CMStore#deleteObject:additionalOptions:callback:</tt>. */
+    CMOutboxOperationDelete
+};
+
+/**
+ * Name of the notification posted, on the main thread, whenever an operation leaves the outbox, either because it
+ * reached CloudMine or because CloudMine refused it. The <tt>object</tt> is the outbox and the <tt>userInfo</tt>
+ * holds the operation under <tt>CMOutboxOperationKey</tt> and, if it failed, the error under
+ * <tt>CMOutboxErrorKey</tt>. This is the only way to learn about operations replayed after a relaunch.
+ */
+extern NSString * const CMOutboxDidFinishOperationNotification;
+extern NSString * const CMOutboxOperationKey;
+extern NSString * const CMOutboxErrorKey;
+
+/**
+ * Called once an operation has left the outbox. <tt>error</tt> is <tt>nil</tt> if it reached CloudMine.
+ */
+typedef void (^CMOutboxCompletion)(NSError *error);
+
+/**
+ * A pending write of one object. Operations are immutable; merging a write into one that is already queued replaces
+ * it with a new operation.
+ */
+@interface CMOutboxOperation : NSObject
+
+/**
+ * @param type What the write does.
+ * @param objectId The ID of the object written.
+ * @param ownerIdentifier The object ID of the user owning the object, or <tt>nil</tt> for an app-level object.
+ * @param representation The object in the format used by the CloudMine API, or <tt>nil</tt> for a delete.
+ * @param partial Whether <tt>representation</tt> only holds the changed fields of a save.
+ */
+- (instancetype)initWithType:(CMOutboxOperationType)type
+                    objectId:(NSString *)objectId
+             ownerIdentifier:(NSString *)ownerIdentifier
+              representation:(NSDictionary *)representation
+                     partial:(BOOL)partial;
+
+@property (nonatomic, readonly) CMOutboxOperationType type;
+@property (nonatomic, readonly, copy) NSString *objectId;
+@property (nonatomic, readonly, copy) NSString *ownerIdentifier;
+@property (nonatomic, readonly, copy) NSDictionary *representation;
+@property (nonatomic, readonly, getter=isPartial) BOOL partial;
+
+@end
+
+/**
+ * Sends the operations of an outbox. <tt>CMStore</tt> implements this for the outbox it is given.
+ */
+@protocol CMOutboxDelegate <NSObject>
+
+/**
+ * Whether the operations of an owner can be sent right now, typically whether that user is logged in.
+ *
+ * @param ownerIdentifier The object ID of a user, or <tt>nil</tt> for app-level operations.
+ */
+- (BOOL)outbox:(CMOutbox *)outbox canSendOperationsOfOwner:(NSString *)ownerIdentifier;
+
+/**
+ * Sends a batch of operations, which all have the same type and owner, in a single request.
+ *
+ * @param operations The operations to send. Each object appears at most once.
+ * @param completion Must be called exactly once, from any thread. <tt>errors</tt> maps the object IDs of the
+ * operations CloudMine refused to the reason, and <tt>error</tt> is set if the request as a whole failed.
+ */
+- (void)outbox:(CMOutbox *)outbox sendOperations:(NSArray *)operations completion:(void (^)(NSDictionary *errors, NSError *error))completion;
+
+@end
+
+/**
+ * A durable queue of writes that couldn't reach CloudMine. Every operation is appended to a journal on disk, one per
+ * owner, before it is acknowledged, so queued writes survive the app being killed and are replayed at the next launch.
+ *
+ * Writing an object that already has an operation waiting merges the two, so only the outcome of successive writes
+ * is sent: a save followed by a save sends the fields of both, anything followed by a delete sends the delete, and a
+ * delete followed by a save or a replace sends a replace. A write is only merged into the last operation queued for its
+ * object, and not if that one is already being sent, so writes of an object always reach CloudMine in order.
+ *
+ * Operations are sent in batches, in the order they were first queued, as soon as the network is reachable. A batch
+ * that fails with <tt>CMErrorServerConnectionFailed</tt>, <tt>CMErrorServerError</tt> or another 5xx status, or
+ * <tt>CMErrorUnauthorized</tt>, such as when the session token has expired, stays queued and is retried with
+ * exponential backoff, and right away whenever the network becomes reachable again. An operation that failed with a
+ * server error is sent on its own from then on, and is removed from the outbox with that error once CloudMine has
+ * failed it five times, counting earlier launches, so a write CloudMine can't handle doesn't hold up the ones behind
+ * it forever. Any other error for the batch, and any error CloudMine reports for one of its objects, removes the
+ * operations concerned from the outbox and is reported to their completions.
+ *
+ * Operations don't carry a server-side function or extra parameters, so none are sent with them, in the same launch
+ * or when replayed from the journal.
+ *
+ * All methods are safe to call from any thread.
+ */
+@interface CMOutbox : NSObject
+
+/**
+ * An outbox whose journals live in the app's Application Support directory, under the given app identifier.
+ * Only one outbox should use a directory at a time.
+ *
+ * @param appIdentifier The identifier of the CloudMine app whose writes are queued.
+ */
++ (CMOutbox *)outboxForAppIdentifier:(NSString *)appIdentifier;
+
+/**
+ * Opens, creating it if needed, an outbox that keeps its journals in the given directory. Operations left there by a
+ * previous launch are loaded right away and sent once a delegate is set.
+ *
+ * This is the designated initializer.
+ *
+ * @param directoryURL The directory of the journals.
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL;
+
+/** The directory of the journals. */
+@property (nonatomic, readonly, copy) NSURL *directoryURL;
+
+/** Sends the queued operations. Nothing is sent without one. */
+@property (nonatomic, weak) id<CMOutboxDelegate> delegate;
+
+/**
+ * The backoff before the first retry of a batch that couldn't connect. It doubles with each failed attempt, up to
+ * five minutes. Defaults to 2 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval retryInterval;
+
+/**
+ * Queues an operation, merging it into any operation for the same object that isn't being sent yet. The operation is
+ * in the journal by the time this returns.
+ *
+ * @param operation The write to queue.
+ * @param completion Called, on an arbitrary queue, once the operation, or the operation it was merged into, leaves
+ * the outbox. Completions don't survive a relaunch.
+ */
+- (void)enqueueOperation:(CMOutboxOperation *)operation completion:(CMOutboxCompletion)completion;
+
+/**
+ * Whether any of the given objects has an operation waiting. Writes of such objects should be queued as well rather
+ * than sent, so they don't overtake the queued ones.
+ *
+ * @param objectIds The IDs of the objects.
+ * @param ownerIdentifier The object ID of the user owning the objects, or <tt>nil</tt> for app-level objects.
+ */
+- (BOOL)hasOperationsForObjectIds:(NSArray *)objectIds ownerIdentifier:(NSString *)ownerIdentifier;
+
+/** The operations waiting, in the order they will be sent. */
+- (NSArray *)pendingOperations;
+
+/**
+ * Sends the queued operations now, without waiting for the network to change or for a backoff to end. Does nothing
+ * while a batch is being sent.
+ */
+- (void)flush;
+
+@end
@@ -0,0 +1,611 @@
+//
+//  CMOutbox.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <AFNetworking/AFNetworking.h>
+
+#import "CMOutbox.h"
+#import "CMStore.h"
+
+NSString * const CMOutboxDidFinishOperationNotification = @"CMOutboxDidFinishOperationNotification";
+NSString * const CMOutboxOperationKey = @"CMOutboxOperationKey";
+NSString * const CMOutboxErrorKey = @"CMOutboxErrorKey";
+
+/** The most operations sent in one request. */
+static NSUInteger const CMOutboxBatchSize = 50;
+static NSTimeInterval const CMOutboxMaximumRetryInterval = 300.0;
+/** How many times CloudMine may fail an operation with a server error before it is dropped. */
+static NSUInteger const CMOutboxMaximumServerErrors = 5;
+
+/** The journal of app-level operations. Owner IDs are percent-escaped, so none of theirs can start with an underscore. */
+static NSString * const CMOutboxAppJournalName = @"_app";
+static NSString * const CMOutboxJournalExtension = @"journal";
+
+#pragma mark - Operations
+
+@interface CMOutboxOperation ()
+/** Where the operation is in the journal; a merged operation gets a new one. */
+@property (nonatomic, assign) unsigned long long sequence;
+/** The sequence of the first operation merged into this one, which decides when it is sent. */
+@property (nonatomic, assign) unsigned long long order;
+@property (nonatomic, assign, getter=isSending) BOOL sending;
+/** How many times sending the operation failed with a server error. */
+@property (nonatomic, assign) NSUInteger serverErrors;
+@property (nonatomic, strong) NSMutableArray *completions;
+@end
+
+@implementation CMOutboxOperation
+
+- (instancetype)initWithType:(CMOutboxOperationType)type
+                    objectId:(NSString *)objectId
+             ownerIdentifier:(NSString *)ownerIdentifier
+              representation:(NSDictionary *)representation
+                     partial:(BOOL)partial;
+{
+    NSParameterAssert(objectId);
+    NSParameterAssert(type == CMOutboxOperationDelete || representation);
+
+    if (self = [super init]) {
+        _type = type;
+        _objectId = [objectId copy];
+        _ownerIdentifier = [ownerIdentifier copy];
+        _representation = type == CMOutboxOperationDelete ? nil : [representation copy];
+        _partial = type == CMOutboxOperationSave && partial;
+        _completions = [NSMutableArray array];
+    }
+    return self;
+}
+
+/**
+ * The single operation with the effect of the receiver followed by <tt>operation</tt>.
+ */
+- (CMOutboxOperation *)operationByMergingOperation:(CMOutboxOperation *)operation;
+{
+    CMOutboxOperationType type = operation.type;
+    NSDictionary *representation = operation.representation;
+    BOOL partial = operation.isPartial;
+
+    if (type == CMOutboxOperationSave) {
+        if (self.type == CMOutboxOperationDelete) {
+            // The object is gone, so whatever the save holds is all of it.
+            type = CMOutboxOperationReplace;
+        } else if (partial) {
+            NSMutableDictionary *merged = [self.representation mutableCopy];
+            [merged addEntriesFromDictionary:representation];
+            type = self.type;
+            representation = merged;
+            partial = self.isPartial;
+        } else if (self.type == CMOutboxOperationReplace) {
+            type = CMOutboxOperationReplace;
+        }
+    }
+
+    CMOutboxOperation *merged = [[CMOutboxOperation alloc] initWithType:type
+                                                               objectId:self.objectId
+                                                        ownerIdentifier:self.ownerIdentifier
+                                                         representation:representation
+                                                                partial:partial];
+    merged.order = self.order;
+    merged.serverErrors = self.serverErrors;
+    [merged.completions addObjectsFromArray:self.completions];
+    [merged.completions addObjectsFromArray:operation.completions];
+    return merged;
+}
+
+- (NSString *)description;
+{
+    NSArray *types = @[@"save", @"replace", @"delete"];
+    return [NSString stringWithFormat:@"<%@: %p; %@ %@%@>", [self class], self, types[self.type], self.objectId, self.isPartial ? @" (partial)" : @""];
+}
+
+@end
+
+#pragma mark - Outbox
+
+@interface CMOutbox ()
+@property (nonatomic, readwrite, copy) NSURL *directoryURL;
+@end
+
+@implementation CMOutbox {
+    // Everything below is only touched on _queue.
+    dispatch_queue_t _queue;
+    NSMutableArray *_operations;
+    NSMutableDictionary *_journals;
+    unsigned long long _nextSequence;
+
+    BOOL _sending;
+    NSUInteger _failedAttempts;
+    BOOL _retryScheduled;
+    NSUInteger _retryGeneration;
+
+    AFNetworkReachabilityManager *_reachabilityManager;
+}
+
++ (CMOutbox *)outboxForAppIdentifier:(NSString *)appIdentifier;
+{
+    NSParameterAssert(appIdentifier);
+
+    NSURL *supportURL = [[NSFileManager defaultManager] URLForDirectory:NSApplicationSupportDirectory inDomain:NSUserDomainMask appropriateForURL:nil create:YES error:nil];
+    NSURL *directoryURL = [[supportURL URLByAppendingPathComponent:@"cmOutbox"] URLByAppendingPathComponent:appIdentifier];
+    return [[CMOutbox alloc] initWithDirectoryURL:directoryURL];
+}
+
+#pragma mark - Initializers
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL;
+{
+    NSParameterAssert(directoryURL);
+
+    if (self = [super init]) {
+        self.directoryURL = directoryURL;
+        _retryInterval = 2.0;
+        _queue = dispatch_queue_create("com.cloudmine.outbox", DISPATCH_QUEUE_SERIAL);
+        _operations = [NSMutableArray array];
+        _journals = [NSMutableDictionary dictionary];
+        _nextSequence = 1;
+
+        NSError *error = nil;
+        if (![[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:&error]) {
+            NSLog(@"CloudMine *** Unable to create the outbox at %@: %@", directoryURL, error);
+            return nil;
+        }
+        [self _loadJournals];
+
+        __weak CMOutbox *weakSelf = self;
+        _reachabilityManager = [AFNetworkReachabilityManager manager];
+        [_reachabilityManager setReachabilityStatusChangeBlock:^(AFNetworkReachabilityStatus status) {
+            if (status == AFNetworkReachabilityStatusReachableViaWWAN || status == AFNetworkReachabilityStatusReachableViaWiFi) {
+                [weakSelf flush];
+            }
+        }];
+        [_reachabilityManager startMonitoring];
+    }
+    return self;
+}
+
+- (void)dealloc;
+{
+    [_reachabilityManager stopMonitoring];
+    for (NSFileHandle *journal in [_journals allValues]) {
+        [journal closeFile];
+    }
+}
+
+#pragma mark - Public interface
+
+- (void)setDelegate:(id<CMOutboxDelegate>)delegate;
+{
+    _delegate = delegate;
+    [self flush];
+}
+
+- (void)enqueueOperation:(CMOutboxOperation *)operation completion:(CMOutboxCompletion)completion;
+{
+    NSParameterAssert(operation);
+
+    if (operation.representation && ![NSJSONSerialization isValidJSONObject:operation.representation]) {
+        NSError *error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:@{NSLocalizedDescriptionKey: @"The object can't be written to the outbox."}];
+        if (completion) {
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{ completion(error); });
+        }
+        return;
+    }
+
+    // Each enqueued operation is a fresh instance, so its private state can be set up here.
+    operation = [[CMOutboxOperation alloc] initWithType:operation.type
+                                               objectId:operation.objectId
+                                        ownerIdentifier:operation.ownerIdentifier
+                                         representation:operation.representation
+                                                partial:operation.isPartial];
+    if (completion) {
+        [operation.completions addObject:[completion copy]];
+    }
+
+    dispatch_sync(_queue, ^{
+        NSUInteger index = [self _indexOfWaitingOperationForObjectId:operation.objectId ownerIdentifier:operation.ownerIdentifier];
+        CMOutboxOperation *queued = operation;
+        NSDictionary *record = nil;
+        if (index == NSNotFound) {
+            queued.sequence = _nextSequence++;
+            queued.order = queued.sequence;
+            [_operations addObject:queued];
+            record = [self _recordOfOperation:queued replacing:0];
+        } else {
+            CMOutboxOperation *existing = [_operations objectAtIndex:index];
+            queued = [existing operationByMergingOperation:operation];
+            queued.sequence = _nextSequence++;
+            [_operations replaceObjectAtIndex:index withObject:queued];
+            record = [self _recordOfOperation:queued replacing:existing.sequence];
+        }
+        [self _appendRecord:record ownerIdentifier:queued.ownerIdentifier];
+    });
+
+    // Unlike -flush, this waits out any backoff, since the write most likely just failed to connect.
+    dispatch_async(_queue, ^{
+        [self _sendNextBatch];
+    });
+}
+
+- (BOOL)hasOperationsForObjectIds:(NSArray *)objectIds ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    NSSet *ids = [NSSet setWithArray:objectIds];
+    __block BOOL found = NO;
+    dispatch_sync(_queue, ^{
+        for (CMOutboxOperation *operation in _operations) {
+            if ([self _operation:operation isOwnedBy:ownerIdentifier] && [ids containsObject:operation.objectId]) {
+                found = YES;
+                break;
+            }
+        }
+    });
+    return found;
+}
+
+- (NSArray *)pendingOperations;
+{
+    __block NSArray *operations = nil;
+    dispatch_sync(_queue, ^{
+        operations = [_operations copy];
+    });
+    return operations;
+}
+
+- (void)flush;
+{
+    dispatch_async(_queue, ^{
+        // Whatever backoff was running is void; a retry already scheduled finds its generation out of date.
+        _failedAttempts = 0;
+        _retryScheduled = NO;
+        _retryGeneration++;
+        [self _sendNextBatch];
+    });
+}
+
+#pragma mark - Sending
+
+- (void)_sendNextBatch;
+{
+    id<CMOutboxDelegate> delegate = self.delegate;
+    if (_sending || _retryScheduled || !delegate || _operations.count == 0) {
+        return;
+    }
+    if (_reachabilityManager.networkReachabilityStatus == AFNetworkReachabilityStatusNotReachable) {
+        return;
+    }
+
+    NSMutableArray *batch = [NSMutableArray array];
+    NSMutableSet *claimedIds = [NSMutableSet set];
+    NSMutableSet *blockedOwners = [NSMutableSet set];
+    CMOutboxOperation *first = nil;
+    for (CMOutboxOperation *operation in _operations) {
+        if (!first) {
+            id ownerKey = operation.ownerIdentifier ?: [NSNull null];
+            if ([blockedOwners containsObject:ownerKey]) {
+                continue;
+            }
+            if (![delegate outbox:self canSendOperationsOfOwner:operation.ownerIdentifier]) {
+                [blockedOwners addObject:ownerKey];
+                continue;
+            }
+            first = operation;
+        } else if (![self _operation:operation isOwnedBy:first.ownerIdentifier]) {
+            continue;
+        } else if (operation.type != first.type || operation.serverErrors > 0 || [claimedIds containsObject:operation.objectId]) {
+            // Later writes of the same object wait for this one, so they can't overtake it.
+            [claimedIds addObject:operation.objectId];
+            continue;
+        }
+
+        [batch addObject:operation];
+        [claimedIds addObject:operation.objectId];
+        // An operation that made CloudMine fail goes out on its own, so it can't take others down with it.
+        if (batch.count == CMOutboxBatchSize || first.serverErrors > 0) {
+            break;
+        }
+    }
+    if (batch.count == 0) {
+        return;
+    }
+
+    _sending = YES;
+    for (CMOutboxOperation *operation in batch) {
+        operation.sending = YES;
+    }
+
+    [delegate outbox:self sendOperations:[batch copy] completion:^(NSDictionary *errors, NSError *error) {
+        dispatch_async(_queue, ^{
+            [self _didSendBatch:batch errors:errors error:error];
+        });
+    }];
+}
+
+- (void)_didSendBatch:(NSArray *)batch errors:(NSDictionary *)errors error:(NSError *)error;
+{
+    _sending = NO;
+    for (CMOutboxOperation *operation in batch) {
+        operation.sending = NO;
+    }
+
+    if ([self _shouldRetryAfterError:error]) {
+        if ([self _isServerError:error]) {
+            for (CMOutboxOperation *operation in batch) {
+                operation.serverErrors++;
+                if (operation.serverErrors >= CMOutboxMaximumServerErrors) {
+                    NSLog(@"CloudMine *** Dropping queued write of %@ after %lu server errors", operation.objectId, (unsigned long)operation.serverErrors);
+                    [self _finishOperation:operation error:error];
+                } else {
+                    [self _appendRecord:@{@"failed": @(operation.sequence)} ownerIdentifier:operation.ownerIdentifier];
+                }
+            }
+        }
+
+        _failedAttempts++;
+        NSTimeInterval delay = MIN(self.retryInterval * pow(2.0, _failedAttempts - 1), CMOutboxMaximumRetryInterval);
+        NSLog(@"CloudMine *** Unable to send %lu queued writes, retrying in %.0f seconds", (unsigned long)batch.count, delay);
+
+        _retryScheduled = YES;
+        NSUInteger generation = _retryGeneration;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _queue, ^{
+            if (generation == _retryGeneration) {
+                _retryScheduled = NO;
+                [self _sendNextBatch];
+            }
+        });
+        return;
+    }
+
+    _failedAttempts = 0;
+    for (CMOutboxOperation *operation in batch) {
+        [self _finishOperation:operation error:error ?: [errors objectForKey:operation.objectId]];
+    }
+    [self _sendNextBatch];
+}
+
+/**
+ * Whether a batch failed in a way that sending it again later could fix: CloudMine couldn't be reached, had a server
+ * error, or refused the session token, which logging in again renews. Errors of single objects are never retried.
+ */
+- (BOOL)_shouldRetryAfterError:(NSError *)error;
+{
+    if (![error.domain isEqualToString:CMErrorDomain]) {
+        return NO;
+    }
+    switch (error.code) {
+        case CMErrorServerConnectionFailed:
+        case CMErrorServerError:
+        case CMErrorUnauthorized:
+            return YES;
+        default:
+            return [[error.userInfo objectForKey:@"httpCode"] integerValue] >= 500;
+    }
+}
+
+/**
+ * Whether CloudMine got the batch and failed on it, which the operations themselves may be causing.
+ */
+- (BOOL)_isServerError:(NSError *)error;
+{
+    return [error.domain isEqualToString:CMErrorDomain] && (error.code == CMErrorServerError || [[error.userInfo objectForKey:@"httpCode"] integerValue] >= 500);
+}
+
+- (void)_finishOperation:(CMOutboxOperation *)operation error:(NSError *)error;
+{
+    [_operations removeObjectIdenticalTo:operation];
+
+    BOOL ownerHasMore = NO;
+    for (CMOutboxOperation *other in _operations) {
+        if ([self _operation:other isOwnedBy:operation.ownerIdentifier]) {
+            ownerHasMore = YES;
+            break;
+        }
+    }
+    if (ownerHasMore) {
+        [self _appendRecord:@{@"done": @(operation.sequence)} ownerIdentifier:operation.ownerIdentifier];
+    } else {
+        [self _truncateJournalOfOwner:operation.ownerIdentifier];
+    }
+
+    NSArray *completions = [operation.completions copy];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (CMOutboxCompletion completion in completions) {
+            completion(error);
+        }
+    });
+
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:operation forKey:CMOutboxOperationKey];
+    if (error) {
+        [userInfo setObject:error forKey:CMOutboxErrorKey];
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [[NSNotificationCenter defaultCenter] postNotificationName:CMOutboxDidFinishOperationNotification object:self userInfo:userInfo];
+    });
+}
+
+/**
+ * The index of the last operation queued for the object, if it isn't being sent. Merging into any earlier one would
+ * move the write ahead of those queued after it.
+ */
+- (NSUInteger)_indexOfWaitingOperationForObjectId:(NSString *)objectId ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    NSUInteger index = [_operations indexOfObjectWithOptions:NSEnumerationReverse passingTest:^BOOL(CMOutboxOperation *operation, NSUInteger idx, BOOL *stop) {
+        return [operation.objectId isEqualToString:objectId] && [self _operation:operation isOwnedBy:ownerIdentifier];
+    }];
+    if (index != NSNotFound && [[_operations objectAtIndex:index] isSending]) {
+        return NSNotFound;
+    }
+    return index;
+}
+
+- (BOOL)_operation:(CMOutboxOperation *)operation isOwnedBy:(NSString *)ownerIdentifier;
+{
+    return operation.ownerIdentifier == ownerIdentifier || [operation.ownerIdentifier isEqualToString:ownerIdentifier];
+}
+
+#pragma mark - Journals
+
+/**
+ * Each line of a journal is a JSON record: an operation, possibly replacing an earlier one it was merged into, the
+ * sequence of an operation that failed with a server error, or the sequence of an operation that is done. Records are only ever appended, so a crash can at worst tear the last
+ * line, which is skipped when the journal is read back.
+ */
+- (NSDictionary *)_recordOfOperation:(CMOutboxOperation *)operation replacing:(unsigned long long)replacedSequence;
+{
+    NSMutableDictionary *record = [NSMutableDictionary dictionary];
+    [record setObject:@(operation.sequence) forKey:@"seq"];
+    [record setObject:@(operation.order) forKey:@"order"];
+    [record setObject:@(operation.type) forKey:@"type"];
+    [record setObject:operation.objectId forKey:@"id"];
+    if (operation.representation) {
+        [record setObject:operation.representation forKey:@"body"];
+    }
+    if (operation.isPartial) {
+        [record setObject:@YES forKey:@"partial"];
+    }
+    if (operation.serverErrors > 0) {
+        [record setObject:@(operation.serverErrors) forKey:@"serverErrors"];
+    }
+    if (replacedSequence) {
+        [record setObject:@(replacedSequence) forKey:@"replaces"];
+    }
+    return record;
+}
+
+- (NSURL *)_journalURLOfOwner:(NSString *)ownerIdentifier;
+{
+    NSString *name = ownerIdentifier ? [ownerIdentifier stringByAddingPercentEncodingWithAllowedCharacters:[NSCharacterSet alphanumericCharacterSet]] : CMOutboxAppJournalName;
+    return [self.directoryURL URLByAppendingPathComponent:[name stringByAppendingPathExtension:CMOutboxJournalExtension]];
+}
+
+- (NSFileHandle *)_journalOfOwner:(NSString *)ownerIdentifier;
+{
+    id key = ownerIdentifier ?: [NSNull null];
+    NSFileHandle *journal = [_journals objectForKey:key];
+    if (!journal) {
+        NSURL *url = [self _journalURLOfOwner:ownerIdentifier];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:url.path]) {
+            [[NSFileManager defaultManager] createFileAtPath:url.path contents:nil attributes:nil];
+        }
+        journal = [NSFileHandle fileHandleForWritingToURL:url error:nil];
+        if (journal) {
+            [_journals setObject:journal forKey:key];
+        }
+    }
+    return journal;
+}
+
+- (void)_appendRecord:(NSDictionary *)record ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    NSMutableData *line = [[NSJSONSerialization dataWithJSONObject:record options:0 error:nil] mutableCopy];
+    [line appendBytes:"\n" length:1];
+
+    NSFileHandle *journal = [self _journalOfOwner:ownerIdentifier];
+    @try {
+        [journal seekToEndOfFile];
+        [journal writeData:line];
+        [journal synchronizeFile];
+    } @catch (NSException *exception) {
+        NSLog(@"CloudMine *** Unable to write to the outbox journal at %@: %@", [self _journalURLOfOwner:ownerIdentifier], exception);
+    }
+}
+
+- (void)_truncateJournalOfOwner:(NSString *)ownerIdentifier;
+{
+    NSFileHandle *journal = [self _journalOfOwner:ownerIdentifier];
+    @try {
+        [journal truncateFileAtOffset:0];
+        [journal synchronizeFile];
+    } @catch (NSException *exception) {
+        NSLog(@"CloudMine *** Unable to write to the outbox journal at %@: %@", [self _journalURLOfOwner:ownerIdentifier], exception);
+    }
+}
+
+/**
+ * Reads back every journal in the directory and rewrites each with only the operations still waiting.
+ */
+- (void)_loadJournals;
+{
+    NSArray *urls = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:self.directoryURL includingPropertiesForKeys:nil options:0 error:nil];
+    for (NSURL *url in urls) {
+        if (![url.pathExtension isEqualToString:CMOutboxJournalExtension]) {
+            continue;
+        }
+        NSString *name = [url.lastPathComponent stringByDeletingPathExtension];
+        NSString *ownerIdentifier = [name isEqualToString:CMOutboxAppJournalName] ? nil : [name stringByRemovingPercentEncoding];
+
+        NSArray *operations = [self _operationsInJournalAtURL:url ownerIdentifier:ownerIdentifier];
+        [_operations addObjectsFromArray:operations];
+
+        NSMutableData *compacted = [NSMutableData data];
+        for (CMOutboxOperation *operation in operations) {
+            [compacted appendData:[NSJSONSerialization dataWithJSONObject:[self _recordOfOperation:operation replacing:0] options:0 error:nil]];
+            [compacted appendBytes:"\n" length:1];
+            _nextSequence = MAX(_nextSequence, operation.sequence + 1);
+        }
+        [compacted writeToURL:url options:NSDataWritingAtomic error:nil];
+    }
+
+    [_operations sortUsingComparator:^NSComparisonResult(CMOutboxOperation *a, CMOutboxOperation *b) {
+        return a.order < b.order ? NSOrderedAscending : (a.order > b.order ? NSOrderedDescending : NSOrderedSame);
+    }];
+}
+
+- (NSArray *)_operationsInJournalAtURL:(NSURL *)url ownerIdentifier:(NSString *)ownerIdentifier;
+{
+    NSData *data = [NSData dataWithContentsOfURL:url];
+    NSMutableDictionary *operations = [NSMutableDictionary dictionary];
+
+    const char *bytes = data.bytes;
+    NSUInteger start = 0;
+    for (NSUInteger i = 0; i < data.length; i++) {
+        if (bytes[i] != '\n') {
+            continue;
+        }
+        NSDictionary *record = [NSJSONSerialization JSONObjectWithData:[data subdataWithRange:NSMakeRange(start, i - start)] options:0 error:nil];
+        start = i + 1;
+        if (![record isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+
+        NSNumber *done = [record objectForKey:@"done"];
+        if (done) {
+            [operations removeObjectForKey:done];
+            continue;
+        }
+
+        NSNumber *failed = [record objectForKey:@"failed"];
+        if (failed) {
+            CMOutboxOperation *operation = [operations objectForKey:failed];
+            operation.serverErrors++;
+            continue;
+        }
+
+        NSNumber *replaces = [record objectForKey:@"replaces"];
+        if (replaces) {
+            [operations removeObjectForKey:replaces];
+        }
+
+        NSString *objectId = [record objectForKey:@"id"];
+        CMOutboxOperationType type = [[record objectForKey:@"type"] integerValue];
+        NSDictionary *representation = [record objectForKey:@"body"];
+        if (![objectId isKindOfClass:[NSString class]] || type < CMOutboxOperationSave || type > CMOutboxOperationDelete || (type != CMOutboxOperationDelete && ![representation isKindOfClass:[NSDictionary class]])) {
+            continue;
+        }
+
+        CMOutboxOperation *operation = [[CMOutboxOperation alloc] initWithType:type
+                                                                      objectId:objectId
+                                                               ownerIdentifier:ownerIdentifier
+                                                                representation:representation
+                                                                       partial:[[record objectForKey:@"partial"] boolValue]];
+        operation.sequence = [[record objectForKey:@"seq"] unsignedLongLongValue];
+        operation.order = [[record objectForKey:@"order"] unsignedLongLongValue];
+        operation.serverErrors = [[record objectForKey:@"serverErrors"] unsignedIntegerValue];
+        [operations setObject:operation forKey:@(operation.sequence)];
+    }
+    return [operations allValues];
+}
+
+@end
@@ -27,9 +27,14 @@
 @class CMWebService;
 @class CMObject;
 @class CMACL;
+@class CMObjectCache;
+@class CMOutbox;
 
 extern NSString * const CMErrorDomain;
 
+/** The <tt>NSURLErrorDomain</tt> error behind a <tt>CMErrorDomain</tt> error, in its <tt>userInfo</tt>. */
+extern NSString * const NSURLErrorKey;
+
 typedef NS_ENUM(NSInteger, CMErrorCode) {
     CMErrorUnknown,
     CMErrorServerConnectionFailed,
@@ -40,6 +45,22 @@ typedef NS_ENUM(NSInteger, CMErrorCode) {
     CMErrorUnauthorized
 };
 
+/**
+ * The in-memory caches a store keeps of the objects it manages.
+ *
+ * @see CMStore#setCountLimit:totalCostLimit:forMemoryCache:
+ */
+typedef NS_ENUM(NSInteger, CMStoreMemoryCache) {
+    /** App-level objects. */
+    CMStoreMemoryCacheAppObjects,
+    /** User-level objects. */
+    CMStoreMemoryCacheUserObjects,
+    /** ACLs of the user. */
+    CMStoreMemoryCacheACLs,
+    /** App-level and user-level files. */
+    CMStoreMemoryCacheFiles
+};
+
 /**
  * Name of the notification that is sent out when an object is deleted.
  */
@@ -84,6 +105,67 @@ extern NSString * const CMStoreObjectDeletedNotification;
 /** The last error that occured during a store-based operation. */
 @property (readonly, strong) NSError *lastError;
 
+/**
+ * The queue on which fetched objects are decoded, cached and matched up with their ACL metadata before the
+ * finished <tt>CMObjectFetchResponse</tt> is handed back. Large result sets are additionally split up and decoded
+ * concurrently. Defaults to a private concurrent queue, so none of this work happens on the UI thread.
+ */
+@property (nonatomic, strong) dispatch_queue_t decodeQueue;
+
+/**
+ * The queue on which the callbacks of requests made through this store are called. Defaults to the main queue.
+ * Callbacks that are already running on the main thread when the main queue is the completion queue are called
+ * right away; everything else is dispatched asynchronously.
+ *
+ * To keep a background job off the main thread entirely, also set the <tt>completionQueue</tt> of
+ * <tt>webService</tt>, which is where the responses reach the store.
+ */
+@property (nonatomic, strong) dispatch_queue_t completionQueue;
+
+/**
+ * The persistent cache that fetched and saved objects are written to, and that fetches read from according to the
+ * <tt>cachePolicy</tt> of their <tt>CMStoreOptions</tt>. Defaults to <tt>nil</tt>, so objects are only kept in
+ * memory; set it to <tt>[CMObjectCache sharedCacheForAppIdentifier:]</tt> to keep them on disk across launches.
+ *
+ * What was cached for a user is removed when the store switches to another user and when that user logs out. A fetch
+ * of every object (of a class) that returns the complete result, that is without paging options and with fewer
+ * objects than the server's default page, or with an unlimited first page, also removes the objects it no longer
+ * returns.
+ */
+@property (nonatomic, strong) CMObjectCache *objectCache;
+
+/**
+ * Where saves, replaces and deletes of objects go when they fail with <tt>CMErrorServerConnectionFailed</tt>, other
+ * than by being cancelled, to be sent again once CloudMine can be reached. Their callbacks are then only called once the queued writes have been
+ * sent, or refused by CloudMine, which may be much later. Writes of objects that still have a queued write are queued
+ * behind it rather than sent. <tt>nil</tt> by default, so failed writes fail as usual.
+ *
+ * The store becomes the outbox's delegate and sends app-level writes, and the user-level writes of its
+ * <tt>user</tt> while that user is logged in. Call <tt>CMOutbox#flush</tt> after logging a user in to send theirs
+ * right away. Server-side functions and extra parameters of the original writes aren't queued.
+ *
+ * @see CMOutbox#outboxForAppIdentifier:
+ */
+@property (nonatomic, strong) CMOutbox *outbox;
+
+/**
+ * How long single-object saves are held back so saves made in quick succession go out together. Every
+ * <tt>saveObject:</tt> and <tt>saveUserObject:</tt> call in that window, including those made through
+ * <tt>CMObject#save:</tt>, joins one request per ownership level and set of options, and each callback is handed a
+ * <tt>CMObjectUploadResponse</tt> with the status of its own object only. Saves that run a server-side function are
+ * always sent on their own. Defaults to <tt>0</tt>, which sends every save right away.
+ *
+ * @see flushPendingSaves
+ */
+@property (nonatomic, assign) NSTimeInterval saveCoalescingInterval;
+
+/**
+ * How many ACLs <tt>saveACLs:callback:</tt> saves at once. CloudMine takes one ACL per request, so the requests for
+ * a list of ACLs overlap up to this many at a time instead of waiting for each other. Set it to <tt>1</tt> to save
+ * them one after another. Defaults to 4.
+ */
+@property (nonatomic, assign) NSUInteger maxConcurrentACLSaves;
+
 /**
  * The default store for this app.
  *
@@ -297,6 +379,41 @@ extern NSString * const CMStoreObjectDeletedNotification;
  */
 - (void)allUserObjectsWithOptions:(CMStoreOptions *)options callback:(CMStoreObjectFetchCallback)callback;
 
+/**
+ * Downloads all app-level objects like <tt>allObjectsWithOptions:callback:</tt>, but hands each object to
+ * <tt>objectHandler</tt> as soon as it has been read from the response, so result sets too large to hold in memory
+ * at once can be processed. Only about one object of the response is in memory at a time, besides those kept by
+ * <tt>objectHandler</tt>. The objects aren't added to the store's memory cache, so they don't evict the objects already
+ * in it, but they still belong to the store and can be saved like any other object.
+ *
+ * <tt>objectHandler</tt> is called on a background queue, in the order of the response. The callback is called
+ * afterwards with a response that has no objects, but carries the errors, snippet result, metadata and count.
+ * Objects handed out this way don't have <tt>ownerId</tt> or <tt>sharedACL</tt> set, since the metadata they come from
+ * may follow them in the response, and they are not stored in the object cache. The cache policy of <tt>options</tt> is ignored.
+ *
+ * @param options Additional options, such as paging and server-side post-processing functions, to apply. This can be <tt>nil</tt>.
+ * @param objectHandler The block to be called with each object.
+ * @param callback The callback to be triggered once every object has been handed to <tt>objectHandler</tt>.
+ *
+ * @see CMStoreOptions
+ */
+- (void)allObjectsWithOptions:(CMStoreOptions *)options objectHandler:(CMStoreObjectHandler)objectHandler callback:(CMStoreObjectFetchCallback)callback;
+
+/**
+ * Downloads all user-level objects, handing each to <tt>objectHandler</tt> as it is read, like
+ * <tt>allObjectsWithOptions:objectHandler:callback:</tt>. The store must be configured with a user or else calling
+ * this method will throw an exception.
+ *
+ * @param options Additional options, such as paging and server-side post-processing functions, to apply. This can be <tt>nil</tt>.
+ * @param objectHandler The block to be called with each object.
+ * @param callback The callback to be triggered once every object has been handed to <tt>objectHandler</tt>.
+ *
+ * @throws NSException An exception will be raised if this method is called when a user is not configured for this store.
+ *
+ * @see CMStoreOptions
+ */
+- (void)allUserObjectsWithOptions:(CMStoreOptions *)options objectHandler:(CMStoreObjectHandler)objectHandler callback:(CMStoreObjectFetchCallback)callback;
+
 /**
  * Downloads all ACLs associated with the store's user
  *
@@ -429,6 +546,36 @@ extern NSString * const CMStoreObjectDeletedNotification;
  */
 - (void)userFileWithName:(NSString *)name additionalOptions:(CMStoreOptions *)options callback:(CMStoreFileFetchCallback)callback;
 
+/**
+ * Downloads an app-level binary file from your app's CloudMine data store straight to disk. The file is streamed to
+ * <tt>url</tt> as it arrives, so memory use stays bounded however large it is, and the <tt>CMFile</tt> handed to the
+ * callback is backed by <tt>url</tt> instead of holding the data. Any file already at <tt>url</tt> is replaced.
+ *
+ * @param name The unique name of the file to download.
+ * @param url The file URL to write the file to.
+ * @param options Additional options, such as server-side post-processing functions, to apply. This can be <tt>nil</tt>.
+ * @param progress The block to be called as the file is downloaded. This can be <tt>nil</tt>.
+ * @param callback The callback to be triggered when the file is finished downloading.
+ *
+ * @see CMFile#fileURL
+ */
+- (void)fileWithName:(NSString *)name toURL:(NSURL *)url additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback;
+
+/**
+ * Downloads a user-level binary file from your app's CloudMine data store straight to disk, like
+ * <tt>fileWithName:toURL:additionalOptions:progress:callback:</tt>. The store must be configured with a user or else
+ * calling this method will throw an exception.
+ *
+ * @param name The unique name of the file to download.
+ * @param url The file URL to write the file to.
+ * @param options Additional options, such as server-side post-processing functions, to apply. This can be <tt>nil</tt>.
+ * @param progress The block to be called as the file is downloaded. This can be <tt>nil</tt>.
+ * @param callback The callback to be triggered when the file is finished downloading.
+ *
+ * @throws NSException An exception will be raised if this method is called when a user is not configured for this store.
+ */
+- (void)userFileWithName:(NSString *)name toURL:(NSURL *)url additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback;
+
 /**
  * Saves all the objects (user- and app-level) in the store with your app's CloudMine data store. User-level objects
  * will only be sync'd if there is a user associated with this store.
@@ -520,6 +667,12 @@ extern NSString * const CMStoreObjectDeletedNotification;
  */
 - (void)saveObject:(CMObject *)theObject additionalOptions:(CMStoreOptions *)options callback:(CMStoreObjectUploadCallback)callback;
 
+/**
+ * Sends the saves held back by <tt>saveCoalescingInterval</tt> now instead of at the end of the window. This is
+ * also done before the store's <tt>user</tt> changes.
+ */
+- (void)flushPendingSaves;
+
 /**
  * Saves an individual object to your app's CloudMine data store at the user-level. The store must be configured
  * with a user or else calling this method will throw an exception. If this object doesn't
@@ -652,12 +805,16 @@ extern NSString * const CMStoreObjectDeletedNotification;
  * automatically be added as well. This has the additional effect of increasing
  * the ACLs' retain counts by 1 as well as setting their <tt>store</tt> property to this store.
  *
+ * Only ACLs with unsaved changes are sent, <tt>maxConcurrentACLSaves</tt> at a time. The upload statuses hold an entry
+ * for every ACL, with the reason for each one that couldn't be saved.
+ *
  * @param acls The ACLs to save.
  * @param callback The callback to be triggered when all the ACLs are finished uploading.
  *
  * @throws NSException An exception will be raised if this method is called when a user is not configured for this store.
  *
  * @see CMACL
+ * @see maxConcurrentACLSaves
  */
 - (void)saveACLs:(NSArray *)acls callback:(CMStoreObjectUploadCallback)callback;
 
@@ -1011,4 +1168,30 @@ extern NSString * const CMStoreObjectDeletedNotification;
  */
 - (CMObjectOwnershipLevel)objectOwnershipLevel:(id)theObject;
 
+/**
+ * Bounds one of the store's in-memory caches. When a cache grows past either limit, the least recently used objects
+ * are dropped from it until it fits again. The cost of an object is the size of the JSON it was fetched as or, once
+ * saved with an object cache, encoded to. Objects the store has no JSON for, such as those added with
+ * <tt>addObject:</tt>, cost an estimate of 256 bytes plus 64 per property their class declares. The cost of a file
+ * is the size of its in-memory data. Objects with unsaved changes are never dropped, and dropped objects keep their
+ * <tt>store</tt>, so saving one again works as before. When the app receives a memory warning, every cache is
+ * trimmed to half of its limits.
+ *
+ * By default object and ACL caches hold up to 10,000 entries or 16 MB, and the file cache up to 100 files or 32 MB.
+ *
+ * @param countLimit The maximum number of entries, or <tt>0</tt> for no limit.
+ * @param totalCostLimit The maximum total size in bytes, or <tt>0</tt> for no limit.
+ * @param cache The cache to bound.
+ */
+- (void)setCountLimit:(NSUInteger)countLimit totalCostLimit:(NSUInteger)totalCostLimit forMemoryCache:(CMStoreMemoryCache)cache;
+
+/**
+ * Cancels every queued or in-flight request this store has started. The callbacks of cancelled operations are called
+ * with a <tt>CMErrorServerConnectionFailed</tt> error. Stores each own a separate <tt>CMWebService</tt>, so this
+ * leaves other stores alone unless you have given them the same <tt>webService</tt>.
+ *
+ * @see CMWebService#cancelAllRequests
+ */
+- (void)cancelAllRequests;
+
 @end
@@ -25,6 +25,11 @@
 #import "CMFileUploadResponse.h"
 #import "CMDeleteResponse.h"
 #import "CMAppDelegateBase.h"
+#import "CMObjectCache.h"
+#import "CMMemoryCache.h"
+#import "CMClassMetadata.h"
+#import "CMOutbox.h"
+#import "CMBackgroundTransferService.h"
 
 #define _CMAssertAPICredentialsInitialized NSAssert([[CMAPICredentials sharedInstance] appSecret] != nil && [[[CMAPICredentials sharedInstance] appSecret] length] > 0 && [[CMAPICredentials sharedInstance] appIdentifier] != nil && [[[CMAPICredentials sharedInstance] appIdentifier] length] > 0, @"The CMAPICredentials singleton must be initialized before using a CloudMine Store")
 #define _CMAssertUserConfigured NSAssert(user, @"You must set the user of this store to a CMUser before querying for user-level objects.")
@@ -34,41 +39,97 @@
 
 #define CM_TOKENEXPIRATION_HEADER @"X-CloudMine-TE"
 
+/** Default bounds of the in-memory caches. */
+static NSUInteger const CMStoreDefaultObjectCountLimit = 10000;
+static NSUInteger const CMStoreDefaultObjectCostLimit = 16 * 1024 * 1024;
+static NSUInteger const CMStoreDefaultFileCountLimit = 100;
+static NSUInteger const CMStoreDefaultFileCostLimit = 32 * 1024 * 1024;
+static NSUInteger const CMStoreEstimatedObjectCost = 256;
+static NSUInteger const CMStoreEstimatedPropertyCost = 64;
+
+/** Default number of ACLs saved at once by saveACLs:callback:. */
+static NSUInteger const CMStoreDefaultMaxConcurrentACLSaves = 4;
+
 #pragma mark - Notification strings
 
 NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotification";
 
 #pragma mark -
 
-@interface CMStore ()
+/**
+ * Single-object saves waiting to be sent together. Every save in a batch has the same ownership level and options.
+ */
+@interface CMStoreSaveBatch : NSObject
+@property (nonatomic, assign) BOOL userLevel;
+@property (nonatomic, strong) CMStoreOptions *options;
+@property (nonatomic, strong) NSMutableArray *objects;
+@property (nonatomic, strong) NSMutableArray *callbacks;
+@end
+
+@implementation CMStoreSaveBatch
+@end
+
+@interface CMStore () <CMOutboxDelegate>
 
 - (void)_allObjects:(CMStoreObjectFetchCallback)callback userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options;
 - (void)_allObjects:(CMStoreObjectFetchCallback)callback ofClass:(Class)klass userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options;
 - (void)_objectsWithKeys:(NSArray *)keys callback:(CMStoreObjectFetchCallback)callback userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options;
 - (void)_searchObjects:(CMStoreObjectFetchCallback)callback query:(NSString *)query userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options;
++ (NSString *)_backgroundDownloadsDirectory;
 - (void)_fileWithName:(NSString *)name userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options callback:(CMStoreFileFetchCallback)callback;
+- (void)_fileWithName:(NSString *)name toURL:(NSURL *)url userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback;
+- (void)_didFetchFile:(CMFile *)file userLevel:(BOOL)userLevel headers:(NSDictionary *)headers callback:(CMStoreFileFetchCallback)callback;
+- (void)_didFailToFetchFileWithName:(NSString *)name userLevel:(BOOL)userLevel error:(NSError *)error callback:(CMStoreFileFetchCallback)callback;
 - (void)_saveObjects:(NSArray *)objects userLevel:(BOOL)userLevel callback:(CMStoreObjectUploadCallback)callback additionalOptions:(CMStoreOptions *)options;
+- (BOOL)_coalesceSaveOfObject:(CMObject *)object userLevel:(BOOL)userLevel options:(CMStoreOptions *)options callback:(CMStoreObjectUploadCallback)callback;
+- (void)_sendSaveBatch:(CMStoreSaveBatch *)batch;
 - (void)_saveFileAtURL:(NSURL *)url named:(NSString *)name userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options callback:(CMStoreFileUploadCallback)callback;
 - (void)_saveFileWithData:(NSData *)data named:(NSString *)name userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options callback:(CMStoreFileUploadCallback)callback;
 - (NSString *)_mimeTypeForFileAtURL:(NSURL *)url withCustomName:(NSString *)name;
 - (void)cacheObjectsInMemory:(NSArray *)objects atUserLevel:(BOOL)userLevel;
+- (void)_cacheObjectsInMemory:(NSArray *)objects atUserLevel:(BOOL)userLevel representations:(NSDictionary *)representations;
+- (void)_costCachedObjects:(NSArray *)objects atUserLevel:(BOOL)userLevel representations:(NSDictionary *)representations;
+- (CMMemoryCache *)_memoryCacheWithCountLimit:(NSUInteger)countLimit costLimit:(NSUInteger)costLimit level:(CMObjectOwnershipLevel)level;
+- (void)_didReceiveMemoryWarning:(NSNotification *)notification;
+- (void)_userDidLogOut:(NSNotification *)notification;
+- (NSDictionary *)_changedCoderKeysOfObjects:(NSArray *)objects;
+- (BOOL)_isCompleteFetchResponse:(CMObjectFetchResponse *)response options:(CMStoreOptions *)options;
+- (void)_performCallback:(void (^)(void))block;
+- (BOOL)_shouldQueueWriteAfterError:(NSError *)error;
+- (void)_enqueueOperations:(NSArray *)operations completion:(void (^)(NSDictionary *errors))completion;
+- (void)_fetchWithCachePolicyFromOptions:(CMStoreOptions *)options keys:(NSArray *)keys className:(NSString *)className userLevel:(BOOL)userLevel callback:(CMStoreObjectFetchCallback)callback network:(void (^)(CMStoreObjectFetchCallback callback))network;
+- (void)_streamObjectsWithKeys:(NSArray *)keys objectHandler:(CMStoreObjectHandler)objectHandler callback:(CMStoreObjectFetchCallback)callback userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options;
+- (void)_finishFetchWithResults:(NSDictionary *)results errors:(NSDictionary *)errors meta:(NSDictionary *)meta snippetResult:(NSDictionary *)snippetResult count:(NSNumber *)count headers:(NSDictionary *)headers userLevel:(BOOL)userLevel callback:(CMStoreObjectFetchCallback)callback;
 
 @property (strong, nonatomic) NSDateFormatter *dateFormatter;
 
 @end
 
 @implementation CMStore {
-    NSMutableDictionary *_cachedAppObjects;
-    NSMutableDictionary *_cachedUserObjects;
-    NSMutableDictionary *_cachedACLs;
-    NSMutableDictionary *_cachedAppFiles;
-    NSMutableDictionary *_cachedUserFiles;
+    CMMemoryCache *_cachedAppObjects;
+    CMMemoryCache *_cachedUserObjects;
+    CMMemoryCache *_cachedACLs;
+    CMMemoryCache *_cachedAppFiles;
+    CMMemoryCache *_cachedUserFiles;
+
+    // Ownership levels of objects and files evicted from the caches above, or streamed without ever being added to
+    // them, so they can still be saved to the right level. Keyed weakly by instance; entries go away with the objects.
+    NSMapTable *_evictedOwnershipLevels;
+
+    // Saves held back by saveCoalescingInterval, keyed by ownership level and options. Guarded by itself.
+    NSMutableDictionary *_pendingSaveBatches;
 }
 
 @synthesize webService;
 @synthesize user;
 @synthesize lastError;
 @synthesize dateFormatter;
+@synthesize decodeQueue;
+@synthesize completionQueue;
+@synthesize objectCache;
+@synthesize outbox;
+@synthesize saveCoalescingInterval;
+@synthesize maxConcurrentACLSaves;
 
 #pragma mark - Shared store
 
@@ -134,55 +195,99 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
         rfc1123.dateFormat = @"EEE',' dd MMM yyyy HH':'mm':'ss z";
         
         self.dateFormatter = rfc1123;
+        self.decodeQueue = dispatch_queue_create("com.cloudmine.store.decode", DISPATCH_QUEUE_CONCURRENT);
+        self.completionQueue = dispatch_get_main_queue();
         
         lastError = nil;
-        _cachedAppObjects = [[NSMutableDictionary alloc] init];
-        _cachedACLs = theUser ? [[NSMutableDictionary alloc] init] : nil;
-        _cachedUserObjects = theUser ? [[NSMutableDictionary alloc] init] : nil;
-        _cachedAppFiles = [[NSMutableDictionary alloc] init];
-        _cachedUserFiles = theUser ? [[NSMutableDictionary alloc] init] : nil;
+        _pendingSaveBatches = [NSMutableDictionary dictionary];
+        self.maxConcurrentACLSaves = CMStoreDefaultMaxConcurrentACLSaves;
+        _evictedOwnershipLevels = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                         valueOptions:NSPointerFunctionsStrongMemory];
+        _cachedAppObjects = [self _memoryCacheWithCountLimit:CMStoreDefaultObjectCountLimit costLimit:CMStoreDefaultObjectCostLimit level:CMObjectOwnershipAppLevel];
+        _cachedACLs = [self _memoryCacheWithCountLimit:CMStoreDefaultObjectCountLimit costLimit:CMStoreDefaultObjectCostLimit level:CMObjectOwnershipUserLevel];
+        _cachedUserObjects = [self _memoryCacheWithCountLimit:CMStoreDefaultObjectCountLimit costLimit:CMStoreDefaultObjectCostLimit level:CMObjectOwnershipUserLevel];
+        _cachedAppFiles = [self _memoryCacheWithCountLimit:CMStoreDefaultFileCountLimit costLimit:CMStoreDefaultFileCostLimit level:CMObjectOwnershipAppLevel];
+        _cachedUserFiles = [self _memoryCacheWithCountLimit:CMStoreDefaultFileCountLimit costLimit:CMStoreDefaultFileCostLimit level:CMObjectOwnershipUserLevel];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(_didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(_userDidLogOut:)
+                                                     name:CMUserDidLogOutNotification
+                                                   object:nil];
     }
     return self;
 }
 
+- (void)dealloc;
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 - (void)setUser:(CMUser *)theUser;
 {
     @synchronized(self) {
         if (user != theUser) {
-            if (_cachedUserObjects) {
-                [_cachedUserObjects enumerateKeysAndObjectsUsingBlock:^(id key, CMObject *obj, BOOL *stop) {
-                    obj.store = nil;
-                }];
-                [_cachedUserObjects removeAllObjects];
-            } else {
-                _cachedUserObjects = [[NSMutableDictionary alloc] init];
+            // Saves held back for the current user have to go out as that user.
+            [self flushPendingSaves];
+
+            // The next user must not be served what was cached for this one.
+            if (user.objectId && ![user.objectId isEqualToString:theUser.objectId]) {
+                [self.objectCache removeAllRepresentationsOfOwner:user.objectId];
             }
+
+            [_cachedUserObjects enumerateKeysAndObjectsUsingBlock:^(id key, CMObject *obj, BOOL *stop) {
+                obj.store = nil;
+            }];
+            [_cachedUserObjects removeAllObjects];
             
-            if (_cachedACLs) {
-                [_cachedACLs enumerateKeysAndObjectsUsingBlock:^(id key, CMACL *obj, BOOL *stop) {
-                    obj.store = nil;
-                }];
-                [_cachedACLs removeAllObjects];
-            } else {
-                _cachedACLs = [[NSMutableDictionary alloc] init];
-            }
+            [_cachedACLs enumerateKeysAndObjectsUsingBlock:^(id key, CMACL *obj, BOOL *stop) {
+                obj.store = nil;
+            }];
+            [_cachedACLs removeAllObjects];
             
-            if (_cachedUserFiles) {
-                [_cachedUserFiles enumerateKeysAndObjectsUsingBlock:^(id key, CMObject *obj, BOOL *stop) {
-                    obj.store = nil;
-                }];
-                [_cachedUserFiles removeAllObjects];
-            } else {
-                _cachedUserFiles = [[NSMutableDictionary alloc] init];
+            [_cachedUserFiles enumerateKeysAndObjectsUsingBlock:^(id key, CMObject *obj, BOOL *stop) {
+                obj.store = nil;
+            }];
+            [_cachedUserFiles removeAllObjects];
+            for (id evicted in [[_evictedOwnershipLevels keyEnumerator] allObjects]) {
+                if ([[_evictedOwnershipLevels objectForKey:evicted] integerValue] == CMObjectOwnershipUserLevel) {
+                    [_evictedOwnershipLevels removeObjectForKey:evicted];
+                }
             }
             user = theUser;
             [user setValue:self.webService forKey:@"webService"];
+            [outbox flush];
         }
     }
 }
 
+- (void)setOutbox:(CMOutbox *)theOutbox;
+{
+    if (outbox.delegate == self) {
+        outbox.delegate = nil;
+    }
+    outbox = theOutbox;
+    outbox.delegate = self;
+}
+
+- (void)_userDidLogOut:(NSNotification *)notification;
+{
+    CMUser *loggedOutUser = notification.object;
+    if (loggedOutUser.objectId) {
+        [self.objectCache removeAllRepresentationsOfOwner:loggedOutUser.objectId];
+    }
+}
+
 #pragma mark - Store state
 
+- (void)cancelAllRequests;
+{
+    [self.webService cancelAllRequests];
+}
+
 - (CMObjectOwnershipLevel)objectOwnershipLevel:(id)theObject;
 {
     if ([theObject isKindOfClass:[CMFile class]]) {
@@ -201,7 +306,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     } else if ([_cachedUserObjects objectForKey:[theObject objectId]] != nil) {
         return CMObjectOwnershipUserLevel;
     } else {
-        return CMObjectOwnershipUndefinedLevel;
+        return [self _evictedOwnershipLevel:theObject];
     }
 }
 
@@ -210,7 +315,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     if ([_cachedACLs objectForKey:acl.objectId] != nil) {
         return CMObjectOwnershipUserLevel;
     } else {
-        return CMObjectOwnershipUndefinedLevel;
+        return [self _evictedOwnershipLevel:acl];
     }
 }
 
@@ -221,7 +326,104 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     } else if ([_cachedUserFiles objectForKey:[theFile uuid]] != nil) {
         return CMObjectOwnershipUserLevel;
     } else {
-        return CMObjectOwnershipUndefinedLevel;
+        return [self _evictedOwnershipLevel:theFile];
+    }
+}
+
+- (CMObjectOwnershipLevel)_evictedOwnershipLevel:(id)theObject;
+{
+    @synchronized(self) {
+        NSNumber *level = [_evictedOwnershipLevels objectForKey:theObject];
+        return level ? [level integerValue] : CMObjectOwnershipUndefinedLevel;
+    }
+}
+
+#pragma mark - Memory caches
+
+/**
+ * The size of the JSON a representation encodes to, give or take, counted from the representation itself so nothing
+ * is encoded again.
+ */
+static NSUInteger CMStoreRepresentationCost(id representation)
+{
+    if ([representation isKindOfClass:[NSDictionary class]]) {
+        NSUInteger cost = 2;
+        for (id key in representation) {
+            cost += CMStoreRepresentationCost(key) + CMStoreRepresentationCost([representation objectForKey:key]) + 2;
+        }
+        return cost;
+    } else if ([representation isKindOfClass:[NSArray class]]) {
+        NSUInteger cost = 2;
+        for (id element in representation) {
+            cost += CMStoreRepresentationCost(element) + 1;
+        }
+        return cost;
+    } else if ([representation isKindOfClass:[NSString class]]) {
+        return [representation length] + 2;
+    }
+    return 8;
+}
+
+- (CMMemoryCache *)_memoryCacheWithCountLimit:(NSUInteger)countLimit costLimit:(NSUInteger)costLimit level:(CMObjectOwnershipLevel)level;
+{
+    CMMemoryCache *cache = [[CMMemoryCache alloc] init];
+    cache.countLimit = countLimit;
+    cache.totalCostLimit = costLimit;
+    cache.costEstimator = ^NSUInteger(id object) {
+        if ([object isKindOfClass:[CMFile class]]) {
+            // Files backed by a URL keep their contents on disk, so only in-memory data counts.
+            return [(CMFile *)object fileURL] ? 0 : [[(CMFile *)object fileData] length];
+        }
+
+        // Only objects cached without the representation they came from get here; encoding them would double the
+        // cost of caching, so the size is guessed from their shape.
+        NSUInteger propertyCount = [[[CMClassMetadata metadataForClass:[object class]] userDefinedPropertyNames] count];
+        return CMStoreEstimatedObjectCost + propertyCount * CMStoreEstimatedPropertyCost;
+    };
+    cache.evictionFilter = ^BOOL(id object) {
+        return !([object isKindOfClass:[CMObject class]] && [(CMObject *)object isDirty]);
+    };
+
+    __weak CMStore *weakSelf = self;
+    cache.evictionHandler = ^(id key, id object) {
+        CMStore *strongSelf = weakSelf;
+        if (strongSelf) {
+            @synchronized(strongSelf) {
+                [strongSelf->_evictedOwnershipLevels setObject:@(level) forKey:object];
+            }
+        }
+    };
+    return cache;
+}
+
+- (void)setCountLimit:(NSUInteger)countLimit totalCostLimit:(NSUInteger)totalCostLimit forMemoryCache:(CMStoreMemoryCache)cache;
+{
+    NSArray *caches = nil;
+    switch (cache) {
+        case CMStoreMemoryCacheAppObjects:
+            caches = @[_cachedAppObjects];
+            break;
+        case CMStoreMemoryCacheUserObjects:
+            caches = @[_cachedUserObjects];
+            break;
+        case CMStoreMemoryCacheACLs:
+            caches = @[_cachedACLs];
+            break;
+        case CMStoreMemoryCacheFiles:
+            caches = @[_cachedAppFiles, _cachedUserFiles];
+            break;
+    }
+
+    for (CMMemoryCache *memoryCache in caches) {
+        memoryCache.countLimit = countLimit;
+        memoryCache.totalCostLimit = totalCostLimit;
+    }
+}
+
+- (void)_didReceiveMemoryWarning:(NSNotification *)notification;
+{
+    for (CMMemoryCache *cache in @[_cachedAppObjects, _cachedUserObjects, _cachedACLs, _cachedAppFiles, _cachedUserFiles]) {
+        [cache trimToLowWaterMark];
     }
 }
 
@@ -315,6 +517,83 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     [self _objectsWithKeys:nil callback:callback userLevel:userLevel additionalOptions:options];
 }
 
+- (void)allObjectsWithOptions:(CMStoreOptions *)options objectHandler:(CMStoreObjectHandler)objectHandler callback:(CMStoreObjectFetchCallback)callback;
+{
+    [self _streamObjectsWithKeys:nil objectHandler:objectHandler callback:callback userLevel:NO additionalOptions:options];
+}
+
+- (void)allUserObjectsWithOptions:(CMStoreOptions *)options objectHandler:(CMStoreObjectHandler)objectHandler callback:(CMStoreObjectFetchCallback)callback;
+{
+    _CMAssertUserConfigured;
+    
+    if (!user.isLoggedIn) {
+        if (callback) {
+            callback([[CMObjectFetchResponse alloc] initWithError:Error401]);
+        }
+        return;
+    }
+    
+    [self _streamObjectsWithKeys:nil objectHandler:objectHandler callback:callback userLevel:YES additionalOptions:options];
+}
+
+- (void)_streamObjectsWithKeys:(NSArray *)keys objectHandler:(CMStoreObjectHandler)objectHandler callback:(CMStoreObjectFetchCallback)callback userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options;
+{
+    _CMAssertAPICredentialsInitialized;
+    NSParameterAssert(objectHandler);
+
+    // Only touched on the web service's processing queue, until the success handler reads it afterwards.
+    __block NSInteger objectCount = 0;
+
+    [webService getValuesForKeys:keys
+              serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                   pagingOptions:_CMTryMethod(options, pagingDescriptor)
+                  sortingOptions:_CMTryMethod(options, sortDescriptor)
+                            user:_CMUserOrNil
+                 extraParameters:_CMTryMethod(options, buildExtraParameters)
+                    entryHandler:^(NSString *key, NSDictionary *representation) {
+                        id object = [[CMObjectDecoder decodeObjects:[NSDictionary dictionaryWithObject:representation forKey:key]] firstObject];
+                        if (!object) {
+                            return;
+                        }
+                        // Caching every object would evict the app's own objects to make room for them. The store only
+                        // remembers their ownership level, as for evicted objects, so they can still be saved.
+                        if ([object isKindOfClass:[CMObject class]]) {
+                            @synchronized(self) {
+                                [_evictedOwnershipLevels setObject:@(userLevel ? CMObjectOwnershipUserLevel : CMObjectOwnershipAppLevel) forKey:object];
+                            }
+                            [object setStoreWithoutCaching:self];
+                        }
+                        objectCount++;
+                        objectHandler(object);
+                    }
+                  successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
+                      CMResponseMetadata *metadata = [[CMResponseMetadata alloc] initWithMetadata:meta];
+                      CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
+                      CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithObjects:[NSArray array] errors:errors snippetResult:result responseMetadata:metadata];
+                      response.count = count ? [count integerValue] : objectCount;
+
+                      NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
+                      CMUser *fetchingUser = self.user;
+                      [self _performCallback:^{
+                          if (expirationDate && userLevel) {
+                              fetchingUser.tokenExpiration = expirationDate;
+                          }
+
+                          if (callback) {
+                              callback(response);
+                          }
+                      }];
+                  } errorHandler:^(NSError *error) {
+                      NSLog(@"CloudMine *** Error occurred during streamed object request for keys: %@ for user: %@ with message: %@", keys, _CMUserOrNil, [error description]);
+                      CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithError:error];
+                      lastError = error;
+                      if (callback) {
+                          [self _performCallback:^{ callback(response); }];
+                      }
+                  }
+     ];
+}
+
 - (void)allACLs:(CMStoreACLFetchCallback)callback;
 {
     _CMAssertUserConfigured;
@@ -340,14 +619,14 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
         
         CMACLFetchResponse *response = [[CMACLFetchResponse alloc] initWithACLs:acls errors:errors];
         if (callback) {
-            callback(response);
+            [self _performCallback:^{ callback(response); }];
         }
     } errorHandler:^(NSError *error) {
         NSLog(@"CloudMine *** Error occurred retrieving ACLS for user: %@ with message: %@", user, [error description]);
         CMACLFetchResponse *response = [[CMACLFetchResponse alloc] initWithError:error];
         lastError = error;
         if (callback) {
-            callback(response);
+            [self _performCallback:^{ callback(response); }];
         }
     }];
 }
@@ -375,49 +654,269 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     _CMAssertAPICredentialsInitialized;
 
-    [webService getValuesForKeys:keys
-              serverSideFunction:_CMTryMethod(options, serverSideFunction)
-                   pagingOptions:_CMTryMethod(options, pagingDescriptor)
-                  sortingOptions:_CMTryMethod(options, sortDescriptor)
-                            user:_CMUserOrNil
-                 extraParameters:_CMTryMethod(options, buildExtraParameters)
-                  successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
-
-                      NSArray *objects = [CMObjectDecoder decodeObjects:results];
-                      [self cacheObjectsInMemory:objects atUserLevel:userLevel];
-                      CMResponseMetadata *metadata = [[CMResponseMetadata alloc] initWithMetadata:meta];
-                      CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
-                      CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithObjects:objects errors:errors snippetResult:result responseMetadata:metadata];
-                      response.count = count ? [count integerValue] : [objects count];
-
-                      [objects enumerateObjectsUsingBlock:^(CMObject *obj, NSUInteger idx, BOOL *stop) {
-                          obj.ownerId = [metadata metadataForObject:obj ofType:@"owner"];
-                          NSArray *permissions = [metadata metadataForObject:obj ofType:@"permissions"];
-                          if (![obj.ownerId isEqualToString:self.user.objectId] && permissions) {
-                              CMACL *acl = [[CMACL alloc] init];
-                              acl.permissions = [NSSet setWithArray:permissions];
-                              acl.members = [NSSet setWithObject:user.objectId];
-                              obj.sharedACL = acl;
+    [self _fetchWithCachePolicyFromOptions:options keys:keys className:nil userLevel:userLevel callback:callback network:^(CMStoreObjectFetchCallback fetchCallback) {
+        [webService getValuesForKeys:keys
+                  serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                       pagingOptions:_CMTryMethod(options, pagingDescriptor)
+                      sortingOptions:_CMTryMethod(options, sortDescriptor)
+                                user:_CMUserOrNil
+                     extraParameters:_CMTryMethod(options, buildExtraParameters)
+                      successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
+                          [self _finishFetchWithResults:results errors:errors meta:meta snippetResult:snippetResult count:count headers:headers userLevel:userLevel callback:fetchCallback];
+                      } errorHandler:^(NSError *error) {
+                          NSLog(@"CloudMine *** Error occurred during object request for keys: %@ for user: %@ with message: %@", keys, _CMUserOrNil, [error description]);
+                          CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithError:error];
+                          lastError = error;
+                          if (fetchCallback) {
+                              [self _performCallback:^{ fetchCallback(response); }];
                           }
-                      }];
-
-                      NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
-                      if (expirationDate && userLevel) {
-                          user.tokenExpiration = expirationDate;
                       }
+         ];
+    }];
+}
 
-                      if (callback) {
-                          callback(response);
-                      }
-                  } errorHandler:^(NSError *error) {
-                      NSLog(@"CloudMine *** Error occurred during object request for keys: %@ for user: %@ with message: %@", keys, _CMUserOrNil, [error description]);
-                      CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithError:error];
-                      lastError = error;
-                      if (callback) {
-                          callback(response);
-                      }
-                  }
-     ];
+- (void)_finishFetchWithResults:(NSDictionary *)results
+                         errors:(NSDictionary *)errors
+                           meta:(NSDictionary *)meta
+                  snippetResult:(NSDictionary *)snippetResult
+                          count:(NSNumber *)count
+                        headers:(NSDictionary *)headers
+                      userLevel:(BOOL)userLevel
+                       callback:(CMStoreObjectFetchCallback)callback;
+{
+    // Inflating a large page is expensive, so only the finished response ever reaches the completion queue.
+    dispatch_async(self.decodeQueue, ^{
+        NSArray *objects = [CMObjectDecoder decodeObjects:results];
+        [self _cacheObjectsInMemory:objects atUserLevel:userLevel representations:results];
+        CMResponseMetadata *metadata = [[CMResponseMetadata alloc] initWithMetadata:meta];
+        CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
+        CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithObjects:objects errors:errors snippetResult:result responseMetadata:metadata];
+        response.count = count ? [count integerValue] : [objects count];
+
+        CMUser *fetchingUser = self.user;
+        NSMutableSet *sharedKeys = [NSMutableSet set];
+        [objects enumerateObjectsUsingBlock:^(CMObject *obj, NSUInteger idx, BOOL *stop) {
+            obj.ownerId = [metadata metadataForObject:obj ofType:@"owner"];
+            NSArray *permissions = [metadata metadataForObject:obj ofType:@"permissions"];
+            if (![obj.ownerId isEqualToString:fetchingUser.objectId] && permissions) {
+                CMACL *acl = [[CMACL alloc] init];
+                acl.permissions = [NSSet setWithArray:permissions];
+                acl.members = [NSSet setWithObject:fetchingUser.objectId];
+                obj.sharedACL = acl;
+                [sharedKeys addObject:obj.objectId];
+            }
+        }];
+        [self.objectCache storeRepresentations:results sharedKeys:sharedKeys ownerIdentifier:userLevel ? fetchingUser.objectId : nil];
+
+        NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
+
+        [self _performCallback:^{
+            if (expirationDate && userLevel) {
+                fetchingUser.tokenExpiration = expirationDate;
+            }
+
+            if (callback) {
+                callback(response);
+            }
+        }];
+    });
+}
+
+- (void)_fetchWithCachePolicyFromOptions:(CMStoreOptions *)options
+                                    keys:(NSArray *)keys
+                               className:(NSString *)className
+                               userLevel:(BOOL)userLevel
+                                callback:(CMStoreObjectFetchCallback)callback
+                                 network:(void (^)(CMStoreObjectFetchCallback callback))network;
+{
+    CMObjectCache *cache = self.objectCache;
+    CMStoreCachePolicy policy = options ? options.cachePolicy : CMStoreCachePolicyNetworkOnly;
+    NSString *ownerIdentifier = userLevel ? user.objectId : nil;
+    if (policy == CMStoreCachePolicyNetworkOnly || !cache || options.serverSideFunction || (userLevel && !(ownerIdentifier && user.isLoggedIn))) {
+        network(callback);
+        return;
+    }
+
+    // Shared objects are only part of a user-level result when asked for, so each combination is its own query.
+    CMObjectCacheScope scope = CMObjectCacheScopeOwned;
+    NSString *scopeSuffix = @"";
+    if (userLevel && options.sharedOnly) {
+        scope = CMObjectCacheScopeShared;
+        scopeSuffix = @"?sharedOnly";
+    } else if (userLevel && options.shared) {
+        scope = CMObjectCacheScopeAll;
+        scopeSuffix = @"?shared";
+    }
+
+    // A fetch of every object (of a class) is only as fresh as the last time that whole result was stored.
+    NSString *query = keys ? nil : [(className ?: @"*") stringByAppendingString:scopeSuffix];
+    CMStoreObjectFetchCallback networkCallback = callback;
+    if (query) {
+        networkCallback = ^(CMObjectFetchResponse *response) {
+            if (!response.error && [self _isCompleteFetchResponse:response options:options]) {
+                [cache recordCompleteFetchOfQuery:query className:className scope:scope keys:[response.objects valueForKey:@"objectId"] ownerIdentifier:ownerIdentifier];
+            }
+            if (callback) {
+                callback(response);
+            }
+        };
+    }
+
+    dispatch_async(self.decodeQueue, ^{
+        NSTimeInterval maximumAge = policy == CMStoreCachePolicyCacheIfFresh ? options.cacheMaximumAge : 0;
+        if (policy == CMStoreCachePolicyCacheIfFresh && query) {
+            NSDate *lastFetch = [cache lastFetchOfQuery:query ownerIdentifier:ownerIdentifier];
+            if (!lastFetch || -[lastFetch timeIntervalSinceNow] > maximumAge) {
+                network(networkCallback);
+                return;
+            }
+        }
+
+        NSDictionary *representations = keys ? [cache representationsWithKeys:keys ownerIdentifier:ownerIdentifier maximumAge:maximumAge]
+                                              : [cache representationsOfClassNamed:className scope:scope ownerIdentifier:ownerIdentifier maximumAge:maximumAge];
+        if (policy == CMStoreCachePolicyCacheIfFresh && keys && representations.count < [[NSSet setWithArray:keys] count]) {
+            network(networkCallback);
+            return;
+        }
+
+        if (representations.count > 0 || policy != CMStoreCachePolicyCacheThenNetwork) {
+            NSArray *objects = [CMObjectDecoder decodeObjects:representations];
+            [self _cacheObjectsInMemory:objects atUserLevel:userLevel representations:representations];
+            CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithObjects:objects errors:[NSDictionary dictionary]];
+            response.count = objects.count;
+            response.cached = YES;
+            if (callback) {
+                [self _performCallback:^{ callback(response); }];
+            }
+        }
+
+        if (policy == CMStoreCachePolicyCacheThenNetwork) {
+            network(networkCallback);
+        }
+    });
+}
+
+/**
+ * Whether a fetch returned every object its query matches. Without paging options, the server returns its default
+ * page, so a full page may have been cut short.
+ */
+- (BOOL)_isCompleteFetchResponse:(CMObjectFetchResponse *)response options:(CMStoreOptions *)options;
+{
+    CMPagingDescriptor *paging = options.pagingDescriptor;
+    if (paging) {
+        return paging.skip == 0 && paging.limit < 0;
+    }
+    return response.objects.count < (NSUInteger)[[CMPagingDescriptor defaultPagingDescriptor] limit];
+}
+
+- (void)_performCallback:(void (^)(void))block;
+{
+    dispatch_queue_t queue = self.completionQueue ?: dispatch_get_main_queue();
+    if (queue == dispatch_get_main_queue() && [NSThread isMainThread]) {
+        block();
+    } else {
+        dispatch_async(queue, block);
+    }
+}
+
+#pragma mark - Offline writes
+
+/**
+ * Whether a write that failed with this error goes to the outbox instead of failing.
+ */
+- (BOOL)_shouldQueueWriteAfterError:(NSError *)error;
+{
+    if (!self.outbox || ![error.domain isEqualToString:CMErrorDomain] || error.code != CMErrorServerConnectionFailed) {
+        return NO;
+    }
+
+    // Cancelled requests fail the same way, but they were meant not to be sent.
+    NSError *underlyingError = [error.userInfo objectForKey:NSURLErrorKey] ?: [error.userInfo objectForKey:NSUnderlyingErrorKey];
+    return !([underlyingError.domain isEqualToString:NSURLErrorDomain] && underlyingError.code == NSURLErrorCancelled);
+}
+
+/**
+ * Queues operations in the outbox and calls back once every one of them has left it, with the errors of those that
+ * failed keyed by object ID.
+ */
+- (void)_enqueueOperations:(NSArray *)operations completion:(void (^)(NSDictionary *errors))completion;
+{
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableDictionary *errors = [NSMutableDictionary dictionary];
+    for (CMOutboxOperation *operation in operations) {
+        dispatch_group_enter(group);
+        [self.outbox enqueueOperation:operation completion:^(NSError *error) {
+            if (error) {
+                @synchronized(errors) {
+                    [errors setObject:error forKey:operation.objectId];
+                }
+            }
+            dispatch_group_leave(group);
+        }];
+    }
+    dispatch_group_notify(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        completion(errors);
+    });
+}
+
+- (BOOL)outbox:(CMOutbox *)theOutbox canSendOperationsOfOwner:(NSString *)ownerIdentifier;
+{
+    CMUser *currentUser = user;
+    return !ownerIdentifier || (currentUser.isLoggedIn && [currentUser.objectId isEqualToString:ownerIdentifier]);
+}
+
+- (void)outbox:(CMOutbox *)theOutbox sendOperations:(NSArray *)operations completion:(void (^)(NSDictionary *errors, NSError *error))completion;
+{
+    CMOutboxOperation *firstOperation = [operations firstObject];
+    NSString *ownerIdentifier = firstOperation.ownerIdentifier;
+    BOOL userLevel = ownerIdentifier != nil;
+
+    NSMutableDictionary *representations = [NSMutableDictionary dictionaryWithCapacity:operations.count];
+    for (CMOutboxOperation *operation in operations) {
+        if (operation.representation) {
+            [representations setObject:operation.representation forKey:operation.objectId];
+        }
+    }
+
+    CMWebServiceObjectFetchSuccessCallback successHandler = ^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+        NSMutableDictionary *operationErrors = [NSMutableDictionary dictionary];
+        NSMutableDictionary *savedRepresentations = [NSMutableDictionary dictionary];
+        NSMutableDictionary *savedChanges = [NSMutableDictionary dictionary];
+        NSMutableArray *deletedKeys = [NSMutableArray array];
+        for (CMOutboxOperation *operation in operations) {
+            id reason = [errors objectForKey:operation.objectId];
+            if (reason) {
+                NSString *description = [reason isKindOfClass:[NSString class]] ? reason : [reason description];
+                [operationErrors setObject:[NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:@{NSLocalizedDescriptionKey: description}]
+                                    forKey:operation.objectId];
+            } else if (operation.type == CMOutboxOperationDelete) {
+                [deletedKeys addObject:operation.objectId];
+            } else {
+                NSMutableDictionary *destination = operation.isPartial ? savedChanges : savedRepresentations;
+                [destination setObject:operation.representation forKey:operation.objectId];
+            }
+        }
+        [self.objectCache storeRepresentations:savedRepresentations ownerIdentifier:ownerIdentifier];
+        [self.objectCache mergeRepresentations:savedChanges ownerIdentifier:ownerIdentifier];
+        [self.objectCache removeRepresentationsWithKeys:deletedKeys ownerIdentifier:ownerIdentifier];
+
+        completion(operationErrors, nil);
+    };
+    CMWebServiceFetchFailureCallback errorHandler = ^(NSError *error) {
+        completion(nil, error);
+    };
+
+    switch (firstOperation.type) {
+        case CMOutboxOperationSave:
+            [webService updateValuesFromDictionary:representations serverSideFunction:nil user:_CMUserOrNil extraParameters:nil successHandler:successHandler errorHandler:errorHandler];
+            break;
+        case CMOutboxOperationReplace:
+            [webService setValuesFromDictionary:representations serverSideFunction:nil user:_CMUserOrNil extraParameters:nil successHandler:successHandler errorHandler:errorHandler];
+            break;
+        case CMOutboxOperationDelete:
+            [webService deleteValuesForKeys:[operations valueForKey:@"objectId"] serverSideFunction:nil user:_CMUserOrNil extraParameters:nil successHandler:successHandler errorHandler:errorHandler];
+            break;
+    }
 }
 
 #pragma mark Object querying by type
@@ -445,10 +944,12 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     NSAssert([klass respondsToSelector:@selector(className)], @"You must pass a class (%@) that extends CMObject and responds to +className.", klass);
     _CMAssertAPICredentialsInitialized;
 
-    [self _searchObjects:callback
-                   query:[NSString stringWithFormat:@"[%@ = \"%@\"]", CMInternalClassStorageKey, [klass className]]
-               userLevel:userLevel
-       additionalOptions:options];
+    [self _fetchWithCachePolicyFromOptions:options keys:nil className:[klass className] userLevel:userLevel callback:callback network:^(CMStoreObjectFetchCallback fetchCallback) {
+        [self _searchObjects:fetchCallback
+                       query:[NSString stringWithFormat:@"[%@ = \"%@\"]", CMInternalClassStorageKey, [klass className]]
+                   userLevel:userLevel
+           additionalOptions:options];
+    }];
 }
 
 #pragma mark General object querying
@@ -486,38 +987,13 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
                            user:_CMUserOrNil
                 extraParameters:_CMTryMethod(options, buildExtraParameters)
                  successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
-                     NSArray *objects = [CMObjectDecoder decodeObjects:results];
-                     CMResponseMetadata *metadata = [[CMResponseMetadata alloc] initWithMetadata:meta];
-                     CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
-                     [self cacheObjectsInMemory:objects atUserLevel:userLevel];
-                     CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithObjects:objects errors:errors snippetResult:result responseMetadata:metadata];
-                     response.count = count ? [count intValue] : [objects count];
-
-                     [objects enumerateObjectsUsingBlock:^(CMObject *obj, NSUInteger idx, BOOL *stop) {
-                         obj.ownerId = [metadata metadataForObject:obj ofType:@"owner"];
-                         NSArray *permissions = [metadata metadataForObject:obj ofType:@"permissions"];
-                         if (![obj.ownerId isEqualToString:self.user.objectId] && permissions) {
-                             CMACL *acl = [[CMACL alloc] init];
-                             acl.permissions = [NSSet setWithArray:permissions];
-                             acl.members = [NSSet setWithObject:user.objectId];
-                             obj.sharedACL = acl;
-                         }
-                     }];
-
-                     NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
-                     if (expirationDate && userLevel) {
-                         user.tokenExpiration = expirationDate;
-                     }
-
-                     if (callback) {
-                         callback(response);
-                     }
+                     [self _finishFetchWithResults:results errors:errors meta:meta snippetResult:snippetResult count:count headers:headers userLevel:userLevel callback:callback];
                  } errorHandler:^(NSError *error) {
                      NSLog(@"CloudMine *** Error occurred during object search with query: %@ for user: %@ with message: %@", query, _CMUserOrNil, [error description]);
                      CMObjectFetchResponse *response = [[CMObjectFetchResponse alloc] initWithError:error];
                      lastError = error;
                      if (callback) {
-                         callback(response);
+                         [self _performCallback:^{ callback(response); }];
                      }
                  }
      ];
@@ -547,14 +1023,14 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
         
         CMACLFetchResponse *response = [[CMACLFetchResponse alloc] initWithACLs:acls errors:errors];
         if (callback) {
-            callback(response);
+            [self _performCallback:^{ callback(response); }];
         }
     } errorHandler:^(NSError *error) {
         NSLog(@"CloudMine *** Error occurred retrieving ACLS for user: %@ with message: %@", user, [error description]);
         CMACLFetchResponse *response = [[CMACLFetchResponse alloc] initWithError:error];
         lastError = error;
         if (callback) {
-            callback(response);
+            [self _performCallback:^{ callback(response); }];
         }
     }];
 }
@@ -636,6 +1112,10 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
         NSLog(@"CloudMine *** Attempted to save a nil object from %s", __PRETTY_FUNCTION__);
         return;
     }
+
+    if ([self _coalesceSaveOfObject:theObject userLevel:YES options:options callback:callback]) {
+        return;
+    }
     
     [self _saveObjects:@[theObject] userLevel:YES callback:callback additionalOptions:options];
 }
@@ -662,9 +1142,111 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
         return;
     }
 
+    if ([self _coalesceSaveOfObject:theObject userLevel:NO options:options callback:callback]) {
+        return;
+    }
+
     [self _saveObjects:@[theObject] userLevel:NO callback:callback additionalOptions:options];
 }
 
+#pragma mark Save coalescing
+
+- (void)flushPendingSaves;
+{
+    NSArray *batches = nil;
+    @synchronized(_pendingSaveBatches) {
+        batches = [_pendingSaveBatches allValues];
+        [_pendingSaveBatches removeAllObjects];
+    }
+    for (CMStoreSaveBatch *batch in batches) {
+        [self _sendSaveBatch:batch];
+    }
+}
+
+/**
+ * Adds a single-object save to the batch of saves like it, starting a batch if there is none.
+ *
+ * @return <tt>NO</tt> if the save has to be sent on its own, because coalescing is off or it runs a server-side function.
+ */
+- (BOOL)_coalesceSaveOfObject:(CMObject *)object userLevel:(BOOL)userLevel options:(CMStoreOptions *)options callback:(CMStoreObjectUploadCallback)callback;
+{
+    NSTimeInterval interval = self.saveCoalescingInterval;
+    if (interval <= 0 || options.serverSideFunction) {
+        return NO;
+    }
+
+    NSArray *key = @[@(userLevel), @(options.saveChangedFieldsOnly), [options buildExtraParameters] ?: @{}];
+    CMStoreSaveBatch *batch = nil;
+    BOOL isNewBatch = NO;
+    @synchronized(_pendingSaveBatches) {
+        batch = [_pendingSaveBatches objectForKey:key];
+        if (!batch) {
+            batch = [[CMStoreSaveBatch alloc] init];
+            batch.userLevel = userLevel;
+            batch.options = options;
+            batch.objects = [NSMutableArray array];
+            batch.callbacks = [NSMutableArray array];
+            [_pendingSaveBatches setObject:batch forKey:key];
+            isNewBatch = YES;
+        }
+        if ([batch.objects indexOfObjectIdenticalTo:object] == NSNotFound) {
+            [batch.objects addObject:object];
+        }
+        [batch.callbacks addObject:@[object, callback ? [callback copy] : [NSNull null]]];
+    }
+
+    if (isNewBatch) {
+        __weak CMStore *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            CMStore *store = weakSelf;
+            if (!store) {
+                return;
+            }
+
+            BOOL isPending = NO;
+            @synchronized(store->_pendingSaveBatches) {
+                // The batch may already have gone out with a flush.
+                isPending = [store->_pendingSaveBatches objectForKey:key] == batch;
+                if (isPending) {
+                    [store->_pendingSaveBatches removeObjectForKey:key];
+                }
+            }
+            if (isPending) {
+                [store _sendSaveBatch:batch];
+            }
+        });
+    }
+    return YES;
+}
+
+/**
+ * Saves the objects of a batch in one request and hands each caller a response with the status of its own object.
+ */
+- (void)_sendSaveBatch:(CMStoreSaveBatch *)batch;
+{
+    NSArray *callbacks = [batch.callbacks copy];
+    [self _saveObjects:[batch.objects copy] userLevel:batch.userLevel callback:^(CMObjectUploadResponse *response) {
+        for (NSArray *entry in callbacks) {
+            CMObject *object = [entry objectAtIndex:0];
+            CMStoreObjectUploadCallback callback = [entry objectAtIndex:1];
+            if ((id)callback == [NSNull null]) {
+                continue;
+            }
+
+            CMObjectUploadResponse *objectResponse = nil;
+            if (response.error) {
+                objectResponse = [[CMObjectUploadResponse alloc] initWithError:response.error];
+            } else {
+                id status = [response.uploadStatuses objectForKey:object.objectId];
+                objectResponse = [[CMObjectUploadResponse alloc] initWithUploadStatuses:status ? @{object.objectId: status} : @{}
+                                                                         snippetResult:response.snippetResult
+                                                                      responseMetadata:response.metadata];
+            }
+            callback(objectResponse);
+        }
+    } additionalOptions:batch.options];
+}
+
 - (void)_saveObjects:(NSArray *)objects userLevel:(BOOL)userLevel callback:(CMStoreObjectUploadCallback)callback additionalOptions:(CMStoreOptions *)options;
 {
     NSParameterAssert(objects);
@@ -677,49 +1259,143 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
         obj.dirty ? [dirtyObjects addObject:obj] : [cleanObjects addObject:obj];
     }];
 
-    // Only send the dirty objects to the servers
-    [webService updateValuesFromDictionary:[CMObjectEncoder encodeObjects:dirtyObjects]
-                        serverSideFunction:_CMTryMethod(options, serverSideFunction)
-                                      user:_CMUserOrNil
-                           extraParameters:_CMTryMethod(options, buildExtraParameters)
-                            successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
-                                // Add clean objects that were omitted from the request into the response as pseudo-updated
-                                NSMutableDictionary *mutResults = [results mutableCopy];
-                                [mutResults addEntriesFromDictionary:errors];
-                                [cleanObjects enumerateObjectsUsingBlock:^(CMObject *obj, NSUInteger idx, BOOL *stop) {
-                                    [mutResults setObject:@"updated" forKey:obj.objectId];
-                                }];
-                                results = [mutResults copy];
-
-                                CMResponseMetadata *metadata = [[CMResponseMetadata alloc] initWithMetadata:meta];
-                                CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
-                                CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithUploadStatuses:results snippetResult:result responseMetadata:metadata];
-
-                                NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
-                                if (expirationDate && userLevel) {
-                                    user.tokenExpiration = expirationDate;
-                                }
-
-                                // If the dirty objects were successfully uploaded, mark them as clean
-                                [dirtyObjects enumerateObjectsUsingBlock:^(CMObject *object, NSUInteger idx, BOOL *stop) {
-                                    NSString *status = [response.uploadStatuses objectForKey:object.objectId];
-                                    if ([status isEqualToString:@"updated"] || [status isEqualToString:@"created"]) {
-                                        object.dirty = NO;
-                                    }
-                                }];
-
-                                if (callback) {
-                                    callback(response);
-                                }
-                            } errorHandler:^(NSError *error) {
-                                NSLog(@"CloudMine *** Error occurred during object save with message: %@", [error description]);
-                                CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithError:error];
-                                lastError = error;
-                                if (callback) {
-                                    callback(response);
-                                }
-                            }
-     ];
+    // Only send the dirty objects to the servers, and of those that are already stored only the changed fields if asked to
+    NSDictionary *changedKeys = options.saveChangedFieldsOnly ? [self _changedCoderKeysOfObjects:dirtyObjects] : nil;
+    CMWebServiceObjectFetchSuccessCallback successHandler = ^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+        // Add clean objects that were omitted from the request into the response as pseudo-updated
+        NSMutableDictionary *mutResults = [results mutableCopy];
+        [mutResults addEntriesFromDictionary:errors];
+        [cleanObjects enumerateObjectsUsingBlock:^(CMObject *obj, NSUInteger idx, BOOL *stop) {
+            [mutResults setObject:@"updated" forKey:obj.objectId];
+        }];
+        results = [mutResults copy];
+
+        CMResponseMetadata *metadata = [[CMResponseMetadata alloc] initWithMetadata:meta];
+        CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
+        CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithUploadStatuses:results snippetResult:result responseMetadata:metadata];
+
+        NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
+        if (expirationDate && userLevel) {
+            user.tokenExpiration = expirationDate;
+        }
+
+        // If the dirty objects were successfully uploaded, mark them as clean
+        NSMutableArray *savedObjects = [NSMutableArray arrayWithCapacity:dirtyObjects.count];
+        [dirtyObjects enumerateObjectsUsingBlock:^(CMObject *object, NSUInteger idx, BOOL *stop) {
+            NSString *status = [response.uploadStatuses objectForKey:object.objectId];
+            if ([status isEqualToString:@"updated"] || [status isEqualToString:@"created"]) {
+                object.dirty = NO;
+                [savedObjects addObject:object];
+            }
+        }];
+
+        // The request body was streamed, so the saved objects are encoded again for the object cache, and only if
+        // there is one.
+        if (self.objectCache && savedObjects.count > 0) {
+            NSMutableDictionary *savedRepresentations = [NSMutableDictionary dictionaryWithCapacity:savedObjects.count];
+            NSMutableDictionary *savedChanges = [NSMutableDictionary dictionary];
+            [[CMObjectEncoder encodeObjects:savedObjects keys:changedKeys] enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSDictionary *representation, BOOL *stop) {
+                NSMutableDictionary *destination = [changedKeys objectForKey:key] ? savedChanges : savedRepresentations;
+                [destination setObject:representation forKey:key];
+            }];
+            [self.objectCache storeRepresentations:savedRepresentations ownerIdentifier:userLevel ? user.objectId : nil];
+            [self.objectCache mergeRepresentations:savedChanges ownerIdentifier:userLevel ? user.objectId : nil];
+            [self _costCachedObjects:savedObjects atUserLevel:userLevel representations:savedRepresentations];
+        }
+
+        if (callback) {
+            [self _performCallback:^{ callback(response); }];
+        }
+    };
+    void (^queueObjects)(void) = ^{
+        NSString *ownerIdentifier = userLevel ? user.objectId : nil;
+        NSDictionary *representations = [CMObjectEncoder encodeObjects:dirtyObjects keys:changedKeys];
+        NSMutableArray *operations = [NSMutableArray arrayWithCapacity:representations.count];
+        [representations enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSDictionary *representation, BOOL *stop) {
+            [operations addObject:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave
+                                                                  objectId:key
+                                                           ownerIdentifier:ownerIdentifier
+                                                            representation:representation
+                                                                   partial:[changedKeys objectForKey:key] != nil]];
+        }];
+
+        [self _enqueueOperations:operations completion:^(NSDictionary *errors) {
+            NSMutableDictionary *uploadStatuses = [NSMutableDictionary dictionaryWithCapacity:objects.count];
+            [cleanObjects enumerateObjectsUsingBlock:^(CMObject *object, NSUInteger idx, BOOL *stop) {
+                [uploadStatuses setObject:@"updated" forKey:object.objectId];
+            }];
+            [dirtyObjects enumerateObjectsUsingBlock:^(CMObject *object, NSUInteger idx, BOOL *stop) {
+                NSError *error = [errors objectForKey:object.objectId];
+                if (!error) {
+                    object.dirty = NO;
+                }
+                [uploadStatuses setObject:error ? [error localizedDescription] : @"updated" forKey:object.objectId];
+            }];
+
+            CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithUploadStatuses:uploadStatuses];
+            if (callback) {
+                [self _performCallback:^{ callback(response); }];
+            }
+        }];
+    };
+    CMWebServiceFetchFailureCallback errorHandler = ^(NSError *error) {
+        if ([self _shouldQueueWriteAfterError:error]) {
+            queueObjects();
+            return;
+        }
+
+        NSLog(@"CloudMine *** Error occurred during object save with message: %@", [error description]);
+        CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithError:error];
+        lastError = error;
+        if (callback) {
+            [self _performCallback:^{ callback(response); }];
+        }
+    };
+
+    if ([self.outbox hasOperationsForObjectIds:[dirtyObjects valueForKey:@"objectId"] ownerIdentifier:userLevel ? user.objectId : nil]) {
+        queueObjects();
+    } else {
+        [webService updateValuesFromObjects:dirtyObjects
+                                       keys:changedKeys
+                         serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                                       user:_CMUserOrNil
+                            extraParameters:_CMTryMethod(options, buildExtraParameters)
+                             successHandler:successHandler
+                               errorHandler:errorHandler];
+    }
+}
+
+/**
+ * The coder keys of the changed fields of every object that can be saved partially, keyed by object ID. Objects that
+ * have never been saved, or that are dirty without recorded changes, are left out and so get sent in full.
+ *
+ * Changes are recorded by property name, so each object is encoded once with just those keys to check that it writes
+ * every one of them. An object that stores a changed property under some other coder key, or not at all, is left out
+ * too, since sending only the keys it did write would drop the change while the server still reports the object saved.
+ */
+- (NSDictionary *)_changedCoderKeysOfObjects:(NSArray *)objects;
+{
+    NSMutableDictionary *changedKeys = [NSMutableDictionary dictionary];
+    for (CMObject *object in objects) {
+        NSSet *keys = object.changedKeys;
+        if (!object.isPersisted || keys.count == 0) {
+            continue;
+        }
+
+        if ([keys containsObject:@"aclIds"]) {
+            NSMutableSet *coderKeys = [keys mutableCopy];
+            [coderKeys removeObject:@"aclIds"];
+            [coderKeys addObject:CMInternalObjectACLsKey];
+            keys = coderKeys;
+        }
+
+        NSDictionary *encoded = [[CMObjectEncoder encodeObjects:@[object] keys:@{object.objectId: keys}] objectForKey:object.objectId];
+        if (![keys isSubsetOfSet:[NSSet setWithArray:[encoded allKeys]]]) {
+            continue;
+        }
+        [changedKeys setObject:keys forKey:object.objectId];
+    }
+    return changedKeys;
 }
 
 - (void)saveACLsOnObject:(CMObject *)object callback:(CMStoreObjectUploadCallback)callback;
@@ -755,50 +1431,95 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     [acls enumerateObjectsUsingBlock:^(CMACL *acl, NSUInteger idx, BOOL *stop) {
         [self addACL:acl];
     }];
-    
-    __block NSUInteger index = 0;
-    NSMutableDictionary *uploadStatuses = [NSMutableDictionary dictionary];
-    
-    __block CMWebServiceObjectFetchSuccessCallback successHandler;
-    
-    CMWebServiceFetchFailureCallback errorHandler = ^(NSError *error) {
-        successHandler(nil, [NSDictionary dictionaryWithObject:[error localizedDescription] forKey:[[acls objectAtIndex:index] objectId]], nil, nil, nil, nil);
-    };
-    
-    successHandler = ^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
-        CMACL *acl = [[CMObjectDecoder decodeObjects:results] lastObject];
-        if (acl) {
-            [self addACL:acl];
-            acl.dirty = NO;
-            [uploadStatuses setObject:@"updated" forKey:acl.objectId];
+
+    // ACLs are saved one per request, so only the dirty ones are sent, a few at a time, each encoded once.
+    NSMutableDictionary *uploadStatuses = [NSMutableDictionary dictionaryWithCapacity:acls.count];
+    NSMutableArray *dirtyACLs = [NSMutableArray arrayWithCapacity:acls.count];
+    for (CMACL *acl in acls) {
+        if (acl.dirty) {
+            [dirtyACLs addObject:acl];
         } else {
-            [uploadStatuses addEntriesFromDictionary:errors];
+            [uploadStatuses setObject:@"updated" forKey:acl.objectId];
         }
-        
-        index++;
-        if (index < acls.count) {
-            acl = [acls objectAtIndex:index];
-            NSDictionary *aclDict = [[CMObjectEncoder encodeObjects:[NSSet setWithObject:acl]] objectForKey:acl.objectId];
-            if (acl.dirty)
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Warc-retain-cycles"
-                [webService updateACL:aclDict user:user successHandler:successHandler errorHandler:errorHandler];
-#pragma clang diagnostic pop
-            else
-                successHandler([NSDictionary dictionaryWithObject:aclDict forKey:acl.objectId], nil, nil, nil, [NSNumber numberWithUnsignedInt:1], nil);
-        } else {
-            CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithUploadStatuses:uploadStatuses];
-            if (callback)
-                callback(response);
+    }
+    NSDictionary *encodedACLs = [CMObjectEncoder encodeObjects:dirtyACLs];
+
+    __block NSUInteger nextIndex = 0;
+    __block NSUInteger remaining = dirtyACLs.count;
+    // Refers to itself through finish, so it is cleared once the last ACL is saved. Only touched under the lock, since
+    // responses may finish on several threads at once.
+    __block void (^saveNextACL)(void) = nil;
+
+    void (^finish)(NSDictionary *) = ^(NSDictionary *statuses) {
+        void (^next)(void) = nil;
+        CMObjectUploadResponse *response = nil;
+        @synchronized(uploadStatuses) {
+            [uploadStatuses addEntriesFromDictionary:statuses];
+            if (--remaining > 0) {
+                next = saveNextACL;
+            } else {
+                saveNextACL = nil;
+                response = [[CMObjectUploadResponse alloc] initWithUploadStatuses:[uploadStatuses copy]];
+            }
+        }
+        if (next) {
+            next();
+            return;
+        }
+
+        if (callback) {
+            [self _performCallback:^{ callback(response); }];
         }
     };
-    
-    CMACL *acl = [acls objectAtIndex:index];
-    NSDictionary *aclDict = [[CMObjectEncoder encodeObjects:[NSSet setWithObject:acl]] objectForKey:acl.objectId];
-    if (acl.dirty)
-        [webService updateACL:aclDict user:user successHandler:successHandler errorHandler:errorHandler];
-    else
-        successHandler([NSDictionary dictionaryWithObject:aclDict forKey:acl.objectId], nil, nil, nil, [NSNumber numberWithUnsignedInt:1], nil);
+
+    void (^start)(void) = ^{
+        CMACL *acl = nil;
+        @synchronized(uploadStatuses) {
+            if (nextIndex < dirtyACLs.count) {
+                acl = [dirtyACLs objectAtIndex:nextIndex++];
+            }
+        }
+        if (!acl) {
+            return;
+        }
+
+        [webService updateACL:[encodedACLs objectForKey:acl.objectId]
+                         user:user
+               successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+                   CMACL *savedACL = [[CMObjectDecoder decodeObjects:results] lastObject];
+                   if (savedACL) {
+                       [self addACL:savedACL];
+                       savedACL.dirty = NO;
+                       finish(@{savedACL.objectId: @"updated"});
+                   } else if ([errors objectForKey:acl.objectId]) {
+                       finish(errors);
+                   } else {
+                       // Nothing usable came back for this ACL, so it still needs a status of its own.
+                       NSMutableDictionary *statuses = [NSMutableDictionary dictionaryWithDictionary:errors];
+                       [statuses setObject:@"The server response could not be decoded into an ACL." forKey:acl.objectId];
+                       finish(statuses);
+                   }
+               } errorHandler:^(NSError *error) {
+                   finish(@{acl.objectId: [error localizedDescription]});
+               }];
+    };
+
+    if (dirtyACLs.count == 0) {
+        CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithUploadStatuses:uploadStatuses];
+        if (callback) {
+            [self _performCallback:^{ callback(response); }];
+        }
+        return;
+    }
+
+    @synchronized(uploadStatuses) {
+        saveNextACL = start;
+    }
+
+    NSUInteger concurrency = MIN(MAX(self.maxConcurrentACLSaves, (NSUInteger)1), dirtyACLs.count);
+    for (NSUInteger i = 0; i < concurrency; i++) {
+        start();
+    }
 }
 
 #pragma mark - Replace Objects
@@ -849,13 +1570,46 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
   [self cacheObjectsInMemory:objects atUserLevel:userLevel];
 
     __weak typeof(self) weakSelf = self;
+
+  void (^queueObjects)(void) = ^{
+    NSString *ownerIdentifier = userLevel ? user.objectId : nil;
+    NSMutableArray *operations = [NSMutableArray arrayWithCapacity:objects.count];
+    [[CMObjectEncoder encodeObjects:objects] enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSDictionary *representation, BOOL *stop) {
+      [operations addObject:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationReplace
+                                                            objectId:key
+                                                     ownerIdentifier:ownerIdentifier
+                                                      representation:representation
+                                                             partial:NO]];
+    }];
+
+    [self _enqueueOperations:operations completion:^(NSDictionary *errors) {
+      NSMutableDictionary *uploadStatuses = [NSMutableDictionary dictionaryWithCapacity:objects.count];
+      [objects enumerateObjectsUsingBlock:^(CMObject *object, NSUInteger idx, BOOL *stop) {
+        NSError *error = [errors objectForKey:object.objectId];
+        if (!error) {
+          object.dirty = NO;
+        }
+        [uploadStatuses setObject:error ? [error localizedDescription] : @"updated" forKey:object.objectId];
+      }];
+
+      CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithUploadStatuses:uploadStatuses];
+      if (callback) {
+        [self _performCallback:^{ callback(response); }];
+      }
+    }];
+  };
+
+  if ([self.outbox hasOperationsForObjectIds:[objects valueForKey:@"objectId"] ownerIdentifier:userLevel ? user.objectId : nil]) {
+    queueObjects();
+    return;
+  }
   
   // Only send the dirty objects to the servers
-  [webService setValuesFromDictionary:[CMObjectEncoder encodeObjects:objects] //send them all
-                      serverSideFunction:_CMTryMethod(options, serverSideFunction)
-                                    user:_CMUserOrNil
-                         extraParameters:_CMTryMethod(options, buildExtraParameters)
-                          successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
+  [webService setValuesFromObjects:objects //send them all
+                serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                              user:_CMUserOrNil
+                   extraParameters:_CMTryMethod(options, buildExtraParameters)
+                    successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
 
                             CMResponseMetadata *metadata = [[CMResponseMetadata alloc] initWithMetadata:meta];
                             CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
@@ -875,14 +1629,19 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
                             }];
                             
                             if (callback) {
-                              callback(response);
+                              [self _performCallback:^{ callback(response); }];
                             }
                           } errorHandler:^(NSError *error) {
+                            if ([self _shouldQueueWriteAfterError:error]) {
+                              queueObjects();
+                              return;
+                            }
+
                             NSLog(@"CloudMine *** Error occurred during object save with message: %@", [error description]);
                             CMObjectUploadResponse *response = [[CMObjectUploadResponse alloc] initWithError:error];
                             lastError = error;
                             if (callback) {
-                              callback(response);
+                              [self _performCallback:^{ callback(response); }];
                             }
                           }
    ];
@@ -935,33 +1694,63 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     NSParameterAssert(url);
     _CMAssertAPICredentialsInitialized;
 
+    CMWebServiceFileUploadSuccessCallback successHandler = ^(CMFileUploadResult result, NSString *fileKey, id snippetResult, NSDictionary *headers) {
+        CMSnippetResult *sResult = [[CMSnippetResult alloc] initWithData:snippetResult];
+        CMFileUploadResponse *response = [[CMFileUploadResponse alloc] initWithResult:result key:fileKey snippetResult:sResult];
+
+        NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
+        if (expirationDate && userLevel) {
+            user.tokenExpiration = expirationDate;
+        }
+
+        if (callback) {
+            [self _performCallback:^{ callback(response); }];
+        }
+    };
+    CMWebServiceFetchFailureCallback errorHandler = ^(NSError *error) {
+        NSLog(@"CloudMine *** Error occurred uploading streamed file with URL: %@ name: %@ for user: %@ with message: %@", [url absoluteString], name, _CMUserOrNil, [error description]);
+        CMFileUploadResponse *response = [[CMFileUploadResponse alloc] initWithError:error];
+        lastError = error;
+        if (callback) {
+            [self _performCallback:^{ callback(response); }];
+        }
+    };
+
+    if (options.transferInBackground) {
+        [webService uploadFileInBackgroundAtPath:[url path]
+                              serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                                           named:name
+                                      ofMimeType:[self _mimeTypeForFileAtURL:url withCustomName:name]
+                                            user:_CMUserOrNil
+                                 extraParameters:_CMTryMethod(options, buildExtraParameters)
+                                  successHandler:successHandler
+                                    errorHandler:errorHandler];
+        return;
+    }
+
+    NSUInteger chunkSize = options ? options.uploadChunkSize : 0;
+    if (chunkSize > 0) {
+        [webService uploadFileAtPath:[url path]
+                  serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                               named:name
+                          ofMimeType:[self _mimeTypeForFileAtURL:url withCustomName:name]
+                                user:_CMUserOrNil
+                     extraParameters:_CMTryMethod(options, buildExtraParameters)
+                           chunkSize:chunkSize
+                     progressHandler:nil
+                      successHandler:successHandler
+                        errorHandler:errorHandler];
+        return;
+    }
+
     [webService uploadFileAtPath:[url path]
               serverSideFunction:_CMTryMethod(options, serverSideFunction)
                            named:name
                       ofMimeType:[self _mimeTypeForFileAtURL:url withCustomName:name]
                             user:_CMUserOrNil
                  extraParameters:_CMTryMethod(options, buildExtraParameters)
-                  successHandler:^(CMFileUploadResult result, NSString *fileKey, id snippetResult, NSDictionary *headers) {
-                      CMSnippetResult *sResult = [[CMSnippetResult alloc] initWithData:snippetResult];
-                      CMFileUploadResponse *response = [[CMFileUploadResponse alloc] initWithResult:result key:fileKey snippetResult:sResult];
-
-                      NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
-                      if (expirationDate && userLevel) {
-                          user.tokenExpiration = expirationDate;
-                      }
-
-                      if (callback) {
-                          callback(response);
-                      }
-                  } errorHandler:^(NSError *error) {
-                      NSLog(@"CloudMine *** Error occurred uploading streamed file with URL: %@ name: %@ for user: %@ with message: %@", [url absoluteString], name, _CMUserOrNil, [error description]);
-                      CMFileUploadResponse *response = [[CMFileUploadResponse alloc] initWithError:error];
-                      lastError = error;
-                      if (callback) {
-                          callback(response);
-                      }
-                  }
-     ];
+                  successHandler:successHandler
+                    errorHandler:errorHandler];
 }
 
 - (void)saveFileWithData:(NSData *)data additionalOptions:(CMStoreOptions *)options callback:(CMStoreFileUploadCallback)callback;
@@ -1023,14 +1812,14 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
                       }
 
                       if (callback) {
-                          callback(response);
+                          [self _performCallback:^{ callback(response); }];
                       }
                   } errorHandler:^(NSError *error) {
                       NSLog(@"CloudMine *** Error occurred uploading data as file with name: %@ for user: %@ with message: %@", name, _CMUserOrNil, [error description]);
                       CMFileUploadResponse *response = [[CMFileUploadResponse alloc] initWithError:error];
                       lastError = error;
                       if (callback) {
-                          callback(response);
+                          [self _performCallback:^{ callback(response); }];
                       }
                   }
      ];
@@ -1138,14 +1927,14 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
                          }
 
                          if (callback) {
-                             callback(response);
+                             [self _performCallback:^{ callback(response); }];
                          }
                      } errorHandler:^(NSError *error) {
                          NSLog(@"CloudMine *** Error occurred deleting file with name: %@ for user: %@ with message: %@", name, _CMUserOrNil, [error description]);
                          CMDeleteResponse *response = [[CMDeleteResponse alloc] initWithError:error];
                          lastError = error;
                          if (callback) {
-                             callback(response);
+                             [self _performCallback:^{ callback(response); }];
                          }
                      }
      ];
@@ -1169,6 +1958,45 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     }];
 
     NSArray *keys = [deletedObjects allKeys];
+    void (^queueDeletes)(void) = ^{
+        NSString *ownerIdentifier = userLevel ? user.objectId : nil;
+        NSMutableArray *operations = [NSMutableArray arrayWithCapacity:keys.count];
+        for (NSString *key in keys) {
+            [operations addObject:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete
+                                                                  objectId:key
+                                                           ownerIdentifier:ownerIdentifier
+                                                            representation:nil
+                                                                   partial:NO]];
+        }
+
+        [self _enqueueOperations:operations completion:^(NSDictionary *errors) {
+            NSMutableDictionary *success = [NSMutableDictionary dictionaryWithCapacity:keys.count];
+            NSMutableDictionary *failures = [NSMutableDictionary dictionary];
+            for (NSString *key in keys) {
+                NSError *error = [errors objectForKey:key];
+                if (error) {
+                    [failures setObject:[error localizedDescription] forKey:key];
+                } else {
+                    [success setObject:@"deleted" forKey:key];
+                }
+            }
+
+            CMDeleteResponse *response = [[CMDeleteResponse alloc] initWithSuccess:success errors:failures];
+            if (callback) {
+                [self _performCallback:^{ callback(response); }];
+            }
+        }];
+    };
+
+    [[NSNotificationCenter defaultCenter] postNotificationName:CMStoreObjectDeletedNotification
+                                                        object:self
+                                                      userInfo:deletedObjects];
+
+    if ([self.outbox hasOperationsForObjectIds:keys ownerIdentifier:userLevel ? user.objectId : nil]) {
+        queueDeletes();
+        return;
+    }
+
     [webService deleteValuesForKeys:keys
                  serverSideFunction:_CMTryMethod(options, serverSideFunction)
                                user:_CMUserOrNil
@@ -1176,6 +2004,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
                      successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, NSDictionary *snippetResult, NSNumber *count, NSDictionary *headers) {
                          CMSnippetResult *result = [[CMSnippetResult alloc] initWithData:snippetResult];
                          CMDeleteResponse *response = [[CMDeleteResponse alloc] initWithSuccess:results errors:errors snippetResult:result];
+                         [self.objectCache removeRepresentationsWithKeys:[results allKeys] ownerIdentifier:userLevel ? user.objectId : nil];
 
                          NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
                          if (expirationDate && userLevel) {
@@ -1183,21 +2012,22 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
                          }
 
                          if (callback) {
-                             callback(response);
+                             [self _performCallback:^{ callback(response); }];
                          }
                      } errorHandler:^(NSError *error) {
+                         if ([self _shouldQueueWriteAfterError:error]) {
+                             queueDeletes();
+                             return;
+                         }
+
                          NSLog(@"CloudMine *** Error occurred deleting objects %@ for user: %@ with message: %@", objects, _CMUserOrNil, [error description]);
                          CMDeleteResponse *response = [[CMDeleteResponse alloc] initWithError:error];
                          lastError = error;
                          if (callback) {
-                             callback(response);
+                             [self _performCallback:^{ callback(response); }];
                          }
                      }
      ];
-
-    [[NSNotificationCenter defaultCenter] postNotificationName:CMStoreObjectDeletedNotification
-                                                        object:self
-                                                      userInfo:deletedObjects];
 }
 
 - (void)deleteACLs:(NSArray *)acls callback:(CMStoreDeleteCallback)callback;
@@ -1256,7 +2086,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
         } else {
             CMDeleteResponse *response = [[CMDeleteResponse alloc] initWithSuccess:allSuccess errors:allErrors];
             if (callback)
-                callback(response);
+                [self _performCallback:^{ callback(response); }];
         }
     };
     
@@ -1283,9 +2113,66 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     [self _fileWithName:name userLevel:YES additionalOptions:options callback:callback];
 }
 
+- (void)fileWithName:(NSString *)name toURL:(NSURL *)url additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback;
+{
+    [self _fileWithName:name toURL:url userLevel:NO additionalOptions:options progress:progress callback:callback];
+}
+
+- (void)userFileWithName:(NSString *)name toURL:(NSURL *)url additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback;
+{
+    _CMAssertUserConfigured;
+    if (!user.isLoggedIn) {
+        if (callback) {
+            callback([[CMFileFetchResponse alloc] initWithError:Error401]);
+        }
+        return;
+    }
+    [self _fileWithName:name toURL:url userLevel:YES additionalOptions:options progress:progress callback:callback];
+}
+
+/**
+ * Where files fetched by name in the background are downloaded to. The first time it is used in a launch, the files
+ * handed out in earlier launches are removed from it, keeping those of transfers still pending.
+ */
++ (NSString *)_backgroundDownloadsDirectory;
+{
+    static NSString *_directory = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+        _directory = [caches stringByAppendingPathComponent:@"CMBackgroundDownloads"];
+
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        NSMutableSet *pendingPaths = [NSMutableSet set];
+        for (NSDictionary *transfer in [[CMBackgroundTransferService sharedService] pendingTransfers]) {
+            NSString *path = [[[transfer objectForKey:CMBackgroundTransferLocationKey] URLByStandardizingPath] path];
+            if (path) {
+                [pendingPaths addObject:path];
+            }
+        }
+        for (NSString *name in [fileManager contentsOfDirectoryAtPath:_directory error:nil]) {
+            NSString *path = [[_directory stringByAppendingPathComponent:name] stringByStandardizingPath];
+            if (![pendingPaths containsObject:path]) {
+                [fileManager removeItemAtPath:path error:nil];
+            }
+        }
+        [fileManager createDirectoryAtPath:_directory withIntermediateDirectories:YES attributes:nil error:nil];
+    });
+    return _directory;
+}
+
 - (void)_fileWithName:(NSString *)name userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options callback:(CMStoreFileFetchCallback)callback;
 {
     NSParameterAssert(name);
+
+    if (options.transferInBackground) {
+        // Background sessions can only download to disk, so the file ends up backed by one in the caches directory.
+        NSString *directory = [[self class] _backgroundDownloadsDirectory];
+        NSURL *url = [NSURL fileURLWithPath:[directory stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        [self _fileWithName:name toURL:url userLevel:userLevel additionalOptions:options progress:nil callback:callback];
+        return;
+    }
+
     [webService getBinaryDataNamed:name
                 serverSideFunction:_CMTryMethod(options, serverSideFunction)
                               user:_CMUserOrNil
@@ -1294,42 +2181,119 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
                         CMFile *file = [[CMFile alloc] initWithData:data
                                                               named:name
                                                            mimeType:mimeType];
-                        if (userLevel) {
-                            [self addUserFile:file];
-                        } else {
-                            [self addFile:file];
-                        }
-                        
-                        CMFileFetchResponse *response = [[CMFileFetchResponse alloc] initWithFile:file];
-
-                        NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
-                        if (expirationDate && userLevel) {
-                            user.tokenExpiration = expirationDate;
-                        }
-
-                        if (callback) {
-                            callback(response);
-                        }
+                        [self _didFetchFile:file userLevel:userLevel headers:headers callback:callback];
                     } errorHandler:^(NSError *error) {
-                        NSLog(@"CloudMine *** Error occurred downloading file with name: %@ for user: %@ with message: %@", name, _CMUserOrNil, [error description]);
-                        CMFileFetchResponse *response = [[CMFileFetchResponse alloc] initWithError:error];
-                        lastError = error;
-                        if (callback) {
-                            callback(response);
-                        }
+                        [self _didFailToFetchFileWithName:name userLevel:userLevel error:error callback:callback];
                     }
      ];
 }
 
+- (void)_fileWithName:(NSString *)name toURL:(NSURL *)url userLevel:(BOOL)userLevel additionalOptions:(CMStoreOptions *)options progress:(CMStoreProgressCallback)progress callback:(CMStoreFileFetchCallback)callback;
+{
+    NSParameterAssert(name);
+    NSParameterAssert([url isFileURL]);
+
+    if (options.transferInBackground) {
+        // Background sessions don't report progress to the app while it is suspended, so none is reported at all.
+        [webService downloadBinaryDataInBackgroundNamed:name
+                                     serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                                                   user:_CMUserOrNil
+                                        extraParameters:_CMTryMethod(options, buildExtraParameters)
+                                                  toURL:url
+                                         successHandler:^(NSURL *location, NSString *mimeType, NSDictionary *headers) {
+                                             CMFile *file = [[CMFile alloc] initWithContentsOfURL:location
+                                                                                            named:name
+                                                                                         mimeType:mimeType];
+                                             [self _didFetchFile:file userLevel:userLevel headers:headers callback:callback];
+                                         } errorHandler:^(NSError *error) {
+                                             [self _didFailToFetchFileWithName:name userLevel:userLevel error:error callback:callback];
+                                         }
+         ];
+        return;
+    }
+
+    CMWebServiceProgressCallback progressHandler = nil;
+    if (progress) {
+        progressHandler = ^(long long totalBytesTransferred, long long totalBytesExpected) {
+            [self _performCallback:^{ progress(totalBytesTransferred, totalBytesExpected); }];
+        };
+    }
+
+    [webService downloadBinaryDataNamed:name
+                     serverSideFunction:_CMTryMethod(options, serverSideFunction)
+                                   user:_CMUserOrNil
+                        extraParameters:_CMTryMethod(options, buildExtraParameters)
+                                  toURL:url
+                        progressHandler:progressHandler
+                         successHandler:^(NSURL *location, NSString *mimeType, NSDictionary *headers) {
+                             CMFile *file = [[CMFile alloc] initWithContentsOfURL:location
+                                                                            named:name
+                                                                         mimeType:mimeType];
+                             [self _didFetchFile:file userLevel:userLevel headers:headers callback:callback];
+                         } errorHandler:^(NSError *error) {
+                             [self _didFailToFetchFileWithName:name userLevel:userLevel error:error callback:callback];
+                         }
+     ];
+}
+
+- (void)_didFetchFile:(CMFile *)file userLevel:(BOOL)userLevel headers:(NSDictionary *)headers callback:(CMStoreFileFetchCallback)callback;
+{
+    if (userLevel) {
+        [self addUserFile:file];
+    } else {
+        [self addFile:file];
+    }
+
+    CMFileFetchResponse *response = [[CMFileFetchResponse alloc] initWithFile:file];
+
+    NSDate *expirationDate = [self.dateFormatter dateFromString:[headers objectForKey:CM_TOKENEXPIRATION_HEADER]];
+    if (expirationDate && userLevel) {
+        user.tokenExpiration = expirationDate;
+    }
+
+    if (callback) {
+        [self _performCallback:^{ callback(response); }];
+    }
+}
+
+- (void)_didFailToFetchFileWithName:(NSString *)name userLevel:(BOOL)userLevel error:(NSError *)error callback:(CMStoreFileFetchCallback)callback;
+{
+    NSLog(@"CloudMine *** Error occurred downloading file with name: %@ for user: %@ with message: %@", name, _CMUserOrNil, [error description]);
+    CMFileFetchResponse *response = [[CMFileFetchResponse alloc] initWithError:error];
+    lastError = error;
+    if (callback) {
+        [self _performCallback:^{ callback(response); }];
+    }
+}
+
 #pragma mark - In-memory caching
 
 - (void)cacheObjectsInMemory:(NSArray *)objects atUserLevel:(BOOL)userLevel;
+{
+    [self _cacheObjectsInMemory:objects atUserLevel:userLevel representations:nil];
+}
+
+/**
+ * Caches objects in memory at the size of the representations, keyed by object ID, they were decoded from. Objects
+ * without one are costed by estimate.
+ */
+- (void)_cacheObjectsInMemory:(NSArray *)objects atUserLevel:(BOOL)userLevel representations:(NSDictionary *)representations;
 {
     NSAssert(userLevel ? (user != nil) : true, @"Failed trying to cache remote objects in-memory for user when user is not configured (%@)", self);
 
     @synchronized(self) {
         SEL addMethod = userLevel ? @selector(addUserObject:) : @selector(addObject:);
+        CMMemoryCache *cache = userLevel ? _cachedUserObjects : _cachedAppObjects;
         for (CMObject *obj in objects) {
+            NSDictionary *representation = [representations objectForKey:obj.objectId];
+            if (representation && ![obj isKindOfClass:[CMACL class]]) {
+                [_evictedOwnershipLevels removeObjectForKey:obj];
+                [cache setObject:obj forKey:obj.objectId cost:CMStoreRepresentationCost(representation)];
+                if (obj.store != self) {
+                    obj.store = self;
+                }
+                continue;
+            }
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-performSelector-leaks"
             [self performSelector:addMethod withObject:obj];
@@ -1338,11 +2302,27 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     }
 }
 
+/**
+ * Sets the cost of objects already cached in memory to the size of the representations, keyed by object ID, they
+ * were just encoded to.
+ */
+- (void)_costCachedObjects:(NSArray *)objects atUserLevel:(BOOL)userLevel representations:(NSDictionary *)representations;
+{
+    CMMemoryCache *cache = userLevel ? _cachedUserObjects : _cachedAppObjects;
+    for (CMObject *object in objects) {
+        NSDictionary *representation = [representations objectForKey:object.objectId];
+        if (representation) {
+            [cache setCost:CMStoreRepresentationCost(representation) ofObject:object forKey:object.objectId];
+        }
+    }
+}
+
 - (void)addACL:(CMACL *)acl;
 {
     NSAssert(user != nil, @"Attempted to add ACL (%@) to store (%@) belonging to user when user is not set.", acl, self);
     NSAssert([acl isKindOfClass:[CMACL class]], @"Attempted to add object (%@) to store (%@) as an ACL.", acl, self);
     @synchronized(self) {
+        [_evictedOwnershipLevels removeObjectForKey:acl];
         [_cachedACLs setObject:acl forKey:acl.objectId];
     }
 
@@ -1356,6 +2336,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     NSAssert(user != nil, @"Attempted to add object (%@) to store (%@) belonging to user when user is not set.", theObject, self);
     NSAssert((![theObject isKindOfClass:[CMACL class]] && [theObject isKindOfClass:[CMObject class]]), @"Attempted to add ACL (%@) to store (%@) as a user-level object.", theObject, self);
     @synchronized(self) {
+        [_evictedOwnershipLevels removeObjectForKey:theObject];
         [_cachedUserObjects setObject:theObject forKey:theObject.objectId];
     }
 
@@ -1368,6 +2349,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     NSAssert((![theObject isKindOfClass:[CMACL class]] && [theObject isKindOfClass:[CMObject class]]), @"Attempted to add ACL (%@) to store (%@) as an app-level object.", theObject, self);
     @synchronized(self) {
+        [_evictedOwnershipLevels removeObjectForKey:theObject];
         [_cachedAppObjects setObject:theObject forKey:theObject.objectId];
     }
 
@@ -1380,6 +2362,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     @synchronized(self) {
         [_cachedAppObjects removeObjectForKey:theObject.objectId];
+        [_evictedOwnershipLevels removeObjectForKey:theObject];
     }
 
     if (theObject.store) {
@@ -1391,6 +2374,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     @synchronized(self) {
         [_cachedUserObjects removeObjectForKey:theObject.objectId];
+        [_evictedOwnershipLevels removeObjectForKey:theObject];
     }
 
     if (theObject.store) {
@@ -1402,6 +2386,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     @synchronized(self) {
         [_cachedACLs removeObjectForKey:acl.objectId];
+        [_evictedOwnershipLevels removeObjectForKey:acl];
     }
 
     if (acl.store) {
@@ -1414,6 +2399,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
     NSAssert(user != nil, @"Attempted to add File (%@) to store (%@) belonging to user when user is not set.", theFile, self);
     NSAssert([theFile isKindOfClass:[CMFile class]], @"Attempted to add object (%@) to store (%@) as a file.", theFile, self);
     @synchronized(self) {
+        [_evictedOwnershipLevels removeObjectForKey:theFile];
         [_cachedUserFiles setObject:theFile forKey:theFile.uuid];
     }
 
@@ -1426,6 +2412,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     NSAssert([theFile isKindOfClass:[CMFile class]], @"Attempted to add object (%@) to store (%@) as a file.", theFile, self);
     @synchronized(self) {
+        [_evictedOwnershipLevels removeObjectForKey:theFile];
         [_cachedAppFiles setObject:theFile forKey:theFile.uuid];
     }
 
@@ -1438,6 +2425,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     @synchronized(self) {
         [_cachedAppFiles removeObjectForKey:theFile.uuid];
+        [_evictedOwnershipLevels removeObjectForKey:theFile];
     }
 
     if (theFile.store) {
@@ -1449,6 +2437,7 @@ NSString * const CMStoreObjectDeletedNotification = @"CMStoreObjectDeletedNotifi
 {
     @synchronized(self) {
         [_cachedUserFiles removeObjectForKey:theFile.uuid];
+        [_evictedOwnershipLevels removeObjectForKey:theFile];
     }
 
     if (theFile.store) {
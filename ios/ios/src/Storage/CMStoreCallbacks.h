@@ -31,6 +31,12 @@ typedef void (^CMStoreACLFetchCallback)(CMACLFetchResponse *response);
  */
 typedef void (^CMStoreObjectFetchCallback)(CMObjectFetchResponse *response);
 
+/**
+ * Callback block signature for operations on <tt>CMStore</tt> that hand fetched objects out one at a time, as the
+ * response is read, instead of all at once in a <tt>CMObjectFetchResponse</tt>.
+ */
+typedef void (^CMStoreObjectHandler)(id object);
+
 /**
  * Callback block signature for all operations on <tt>CMStore</tt> that upload objects
  * to the CloudMine servers.
@@ -55,6 +61,13 @@ typedef void (^CMStoreFileFetchCallback)(CMFileFetchResponse *response);
  */
 typedef void (^CMStoreFileUploadCallback)(CMFileUploadResponse *response);
 
+/**
+ * Callback block signature for operations on <tt>CMStore</tt> that report the progress of a transfer. The block takes
+ * the number of bytes transferred so far and the number expected in total, which is <tt>NSURLResponseUnknownLength</tt>
+ * when unknown.
+ */
+typedef void (^CMStoreProgressCallback)(long long totalBytesTransferred, long long totalBytesExpected);
+
 /**
  * Callback block signature for all operations on <tt>CMStore</tt> that delete objects or binary files.
  *
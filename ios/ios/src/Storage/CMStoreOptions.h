@@ -12,6 +12,22 @@
 @class CMServerFunction;
 @class CMSortDescriptor;
 
+/**
+ * Where <tt>CMStore</tt> looks for the objects of a fetch. Only fetches by key and fetches of every object (or every
+ * object of a class) use the persistent object cache; searches and fetches with a server-side function always go to
+ * the network. Paging and sorting options don't apply to objects read from the cache.
+ */
+typedef NS_ENUM(NSInteger, CMStoreCachePolicy) {
+    /** Always fetch from the network. This is the default. */
+    CMStoreCachePolicyNetworkOnly = 0,
+    /** Call back with the cached objects right away, if there are any, and then again with the network response. */
+    CMStoreCachePolicyCacheThenNetwork,
+    /** Only read from the cache, never from the network. Objects that aren't cached are simply missing. */
+    CMStoreCachePolicyCacheOnly,
+    /** Answer from the cache if all of the requested objects were stored within <tt>cacheMaximumAge</tt>, otherwise fetch from the network. */
+    CMStoreCachePolicyCacheIfFresh
+};
+
 /**
  * This object describes additional configuration you can pass to a <tt>CMStore</tt> to customize how it
  * runs. See each property in this class for information on what is customizable.
@@ -52,6 +68,52 @@
  */
 @property (nonatomic) BOOL sharedOnly;
 
+/**
+ * Whether the fetch is answered from the store's persistent object cache, the network, or both.
+ * Defaults to <tt>CMStoreCachePolicyNetworkOnly</tt>.
+ *
+ * @see CMStoreCachePolicy
+ */
+@property (nonatomic) CMStoreCachePolicy cachePolicy;
+
+/**
+ * How old, in seconds, cached objects may be for <tt>CMStoreCachePolicyCacheIfFresh</tt> to use them.
+ */
+@property (nonatomic) NSTimeInterval cacheMaximumAge;
+
+/**
+ * If this is set to <tt>YES</tt>, saving an object that has been fetched or saved before sends only the top-level
+ * fields that changed since then, plus its ID and class, instead of the whole object. The server merges them into the
+ * stored object. Changes are tracked by property name, so an object that encodes a changed property under a different
+ * coder key is sent in full instead, as are objects that haven't been saved yet or whose changes weren't tracked.
+ * Defaults to <tt>NO</tt>.
+ *
+ * @see CMObject#changedKeys
+ */
+@property (nonatomic) BOOL saveChangedFieldsOnly;
+
+/**
+ * If this is greater than 0, files saved from a URL are uploaded in chunks of at most this many bytes instead of in a
+ * single request. Failed chunks are retried on their own, and saving the same unchanged file under the same name again,
+ * even after the app was relaunched, resumes from the last chunk the server acknowledged. Defaults to 0.
+ *
+ * @see CMStore#saveFileAtURL:named:additionalOptions:callback:
+ */
+@property (nonatomic) NSUInteger uploadChunkSize;
+
+/**
+ * If this is set to <tt>YES</tt>, files saved from a URL and files fetched by name are transferred on the app's
+ * background <tt>NSURLSession</tt>, so they carry on while the app is suspended or after the system terminated it.
+ * The callback is only called if the transfer finishes during the same launch; transfers that finish later are reported
+ * through <tt>CMBackgroundTransferDidFinishNotification</tt>. Files fetched by name this way are backed by a file in
+ * the caches directory rather than held in memory. That file is removed the next time the app is launched and fetches
+ * a file in the background, so move or copy it to keep it longer. Takes precedence over <tt>uploadChunkSize</tt>.
+ * Defaults to <tt>NO</tt>.
+ *
+ * @see CMBackgroundTransferService
+ */
+@property (nonatomic) BOOL transferInBackground;
+
 @property (nonatomic) BOOL includeDistance;
 @property (nonatomic, strong) NSString *distanceUnits;
 
@@ -18,6 +18,11 @@
 @synthesize sortDescriptor;
 @synthesize shared;
 @synthesize sharedOnly;
+@synthesize cachePolicy;
+@synthesize cacheMaximumAge;
+@synthesize saveChangedFieldsOnly;
+@synthesize uploadChunkSize;
+@synthesize transferInBackground;
 
 #define _CMAddIfNotNil(array, obj) if(obj) [array addObject:[obj stringRepresentation]];
 
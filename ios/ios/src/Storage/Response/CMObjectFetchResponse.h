@@ -28,6 +28,13 @@
  */
 @property (nonatomic) NSInteger count;
 
+/**
+ * <tt>YES</tt> if the objects were read from the store's persistent object cache rather than fetched from the network.
+ *
+ * @see CMStoreCachePolicy
+ */
+@property (nonatomic, getter=isCached) BOOL cached;
+
 - (instancetype)initWithObjects:(NSArray *)objects errors:(NSDictionary *)errors;
 - (instancetype)initWithObjects:(NSArray *)objects errors:(NSDictionary *)errors snippetResult:(CMSnippetResult *)snippetResult;
 - (instancetype)initWithObjects:(NSArray *)objects errors:(NSDictionary *)errors snippetResult:(CMSnippetResult *)snippetResult responseMetadata:(CMResponseMetadata *)metadata;
@@ -13,6 +13,7 @@
 @synthesize objects;
 @synthesize objectErrors;
 @synthesize count;
+@synthesize cached;
 
 - (instancetype)initWithObjects:(NSArray *)theObjects errors:(NSDictionary *)theErrors {
     return [self initWithObjects:theObjects errors:theErrors snippetResult:nil responseMetadata:nil];
@@ -12,17 +12,55 @@
 
 @interface UIImageView (CloudMine)
 
+/**
+ * The most memory, in bytes of decoded pixels, the images fetched by this category may take up before the least
+ * recently used are evicted. The cache is trimmed to half of this on a memory warning. Defaults to 50 MB.
+ */
++ (NSUInteger)imageCacheByteLimit;
++ (void)setImageCacheByteLimit:(NSUInteger)byteLimit;
 
 /**
- 
+ * Sets the image to an app-level file, fetched from CloudMine unless it is in memory already.
+ *
+ * @param fileKey The name of the file.
+ * @see UIImageView#setImageWithFileKey:placeholderImage:user:downsample:
  */
 - (void)setImageWithFileKey:(NSString *)fileKey;
 
 /**
- 
+ * Sets the image to an app-level file, showing <tt>placeholderImage</tt> until it is fetched.
+ *
+ * @param fileKey The name of the file.
+ * @param placeholderImage The image shown meanwhile, or <tt>nil</tt> to keep the current one.
+ * @see UIImageView#setImageWithFileKey:placeholderImage:user:downsample:
  */
 - (void)setImageWithFileKey:(NSString *)fileKey placeholderImage:(UIImage *)placeholderImage;
 
+/**
+ * Sets the image to a file at full size, showing <tt>placeholderImage</tt> until it is fetched.
+ *
+ * @param fileKey The name of the file.
+ * @param placeholderImage The image shown meanwhile, or <tt>nil</tt> to keep the current one.
+ * @param user If not <tt>nil</tt>, the file is one of the files of the user of <tt>[CMStore defaultStore]</tt>.
+ * @see UIImageView#setImageWithFileKey:placeholderImage:user:downsample:
+ */
 - (void)setImageWithFileKey:(NSString *)fileKey placeholderImage:(UIImage *)placeholderImage user:(CMUser *)user;
 
+/**
+ * Sets the image to a file, showing <tt>placeholderImage</tt> until it is fetched.
+ *
+ * The file is decoded off the main thread, and the decoded image is kept in memory under the file, the user and the
+ * size it was decoded at, so setting it again doesn't fetch it again. If another image is set on the view before the
+ * file arrives, the file is not shown.
+ *
+ * @param fileKey The name of the file.
+ * @param placeholderImage The image shown meanwhile, or <tt>nil</tt> to keep the current one.
+ * @param user If not <tt>nil</tt>, the file is one of the files of the user of <tt>[CMStore defaultStore]</tt>.
+ * @param downsample If <tt>YES</tt> and the content mode scales the image, an image larger than needed to fill the
+ * current bounds of the view, in pixels, is decoded at just that size instead of its full size. Lay the view out
+ * before calling this, and call it again if the view grows. Large photos in small views, like the cells of a table,
+ * then take a fraction of the memory and time to decode.
+ */
+- (void)setImageWithFileKey:(NSString *)fileKey placeholderImage:(UIImage *)placeholderImage user:(CMUser *)user downsample:(BOOL)downsample;
+
 @end
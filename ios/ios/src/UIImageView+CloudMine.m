@@ -6,16 +6,91 @@
 //  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
 //
 
+#import <ImageIO/ImageIO.h>
+#import <objc/runtime.h>
 #import "UIImageView+CloudMine.h"
 #import "CMStore.h"
+#import "CMUser.h"
+#import "CMMemoryCache.h"
 
-@interface CMImageCache : NSCache
+static NSUInteger const CMImageCacheDefaultByteLimit = 50 * 1024 * 1024;
 
-- (UIImage *)cachedImageForFileKey:(NSString *)fileKey;
-- (void)cacheImage:(UIImage *)image forFileKey:(NSString *)fileKey;
+// The cache key of the image an image view is waiting for, so a late fetch doesn't overwrite a newer request.
+static char CMImageViewCacheKeyAssociationKey;
+
+@interface CMImageCache : CMMemoryCache
+
+- (UIImage *)cachedImageForKey:(NSString *)key;
+- (void)cacheImage:(UIImage *)image forKey:(NSString *)key;
 
 @end
 
+static UIImageOrientation CMImageOrientationFromProperty(NSInteger orientation)
+{
+    switch (orientation) {
+        case 2: return UIImageOrientationUpMirrored;
+        case 3: return UIImageOrientationDown;
+        case 4: return UIImageOrientationDownMirrored;
+        case 5: return UIImageOrientationLeftMirrored;
+        case 6: return UIImageOrientationRight;
+        case 7: return UIImageOrientationRightMirrored;
+        case 8: return UIImageOrientationLeft;
+        default: return UIImageOrientationUp;
+    }
+}
+
+/**
+ * Decodes the first image of a source into memory, so drawing it later doesn't decode it on the main thread.
+ *
+ * If <tt>pixelSize</tt> is not zero and the image is larger than needed to fill it, a thumbnail just large enough to
+ * fill it is decoded instead, already rotated upright and with the given scale. Otherwise the image keeps its full
+ * size and a scale of 1, as <tt>+[UIImage imageWithData:]</tt> would give it.
+ */
+static UIImage *CMDecodedImage(CGImageSourceRef source, CGSize pixelSize, CGFloat scale)
+{
+    if (!source || CGImageSourceGetCount(source) == 0) {
+        return nil;
+    }
+
+    NSDictionary *properties = CFBridgingRelease(CGImageSourceCopyPropertiesAtIndex(source, 0, NULL));
+    CGFloat width = [[properties objectForKey:(__bridge NSString *)kCGImagePropertyPixelWidth] doubleValue];
+    CGFloat height = [[properties objectForKey:(__bridge NSString *)kCGImagePropertyPixelHeight] doubleValue];
+    NSInteger orientation = [[properties objectForKey:(__bridge NSString *)kCGImagePropertyOrientation] integerValue];
+    if (orientation >= 5) {
+        // Rotated a quarter turn, so the image is displayed with its sides swapped.
+        CGFloat swap = width;
+        width = height;
+        height = swap;
+    }
+
+    CGFloat factor = 1.0;
+    if (width > 0 && height > 0 && pixelSize.width > 0 && pixelSize.height > 0) {
+        factor = MAX(pixelSize.width / width, pixelSize.height / height);
+    }
+
+    if (factor < 1.0) {
+        NSDictionary *options = @{(__bridge NSString *)kCGImageSourceCreateThumbnailFromImageAlways: @YES,
+                                  (__bridge NSString *)kCGImageSourceCreateThumbnailWithTransform: @YES,
+                                  (__bridge NSString *)kCGImageSourceShouldCacheImmediately: @YES,
+                                  (__bridge NSString *)kCGImageSourceThumbnailMaxPixelSize: @(ceil(MAX(width, height) * factor))};
+        CGImageRef thumbnail = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)options);
+        if (thumbnail) {
+            UIImage *image = [UIImage imageWithCGImage:thumbnail scale:scale orientation:UIImageOrientationUp];
+            CGImageRelease(thumbnail);
+            return image;
+        }
+    }
+
+    NSDictionary *options = @{(__bridge NSString *)kCGImageSourceShouldCacheImmediately: @YES};
+    CGImageRef decoded = CGImageSourceCreateImageAtIndex(source, 0, (__bridge CFDictionaryRef)options);
+    if (!decoded) {
+        return nil;
+    }
+    UIImage *image = [UIImage imageWithCGImage:decoded scale:1.0 orientation:CMImageOrientationFromProperty(orientation)];
+    CGImageRelease(decoded);
+    return image;
+}
+
 @implementation UIImageView (CloudMine)
 
 + (CMImageCache *)cm_sharedImageCache;
@@ -25,10 +100,47 @@
     dispatch_once(&oncePredicate, ^{
         _cm_imageCache = [[CMImageCache alloc] init];
     });
-    
+
     return _cm_imageCache;
 }
 
++ (NSUInteger)imageCacheByteLimit;
+{
+    return [[self cm_sharedImageCache] totalCostLimit];
+}
+
++ (void)setImageCacheByteLimit:(NSUInteger)byteLimit;
+{
+    [[self cm_sharedImageCache] setTotalCostLimit:byteLimit];
+}
+
++ (NSString *)cm_cacheKeyForFileKey:(NSString *)fileKey user:(CMUser *)user pixelSize:(CGSize)pixelSize;
+{
+    if (!fileKey) {
+        return nil;
+    }
+    return [NSString stringWithFormat:@"%@/%@@%.0fx%.0f", user.objectId ?: @"", fileKey, pixelSize.width, pixelSize.height];
+}
+
+/**
+ * The size in pixels the image is drawn at, or zero if the content mode doesn't scale the image or the view isn't laid
+ * out yet.
+ */
+- (CGSize)cm_targetPixelSize;
+{
+    switch (self.contentMode) {
+        case UIViewContentModeScaleToFill:
+        case UIViewContentModeScaleAspectFit:
+        case UIViewContentModeScaleAspectFill:
+            break;
+        default:
+            return CGSizeZero;
+    }
+
+    CGFloat scale = self.window ? self.window.screen.scale : [[UIScreen mainScreen] scale];
+    return CGSizeMake(ceil(CGRectGetWidth(self.bounds) * scale), ceil(CGRectGetHeight(self.bounds) * scale));
+}
+
 - (void)setImageWithFileKey:(NSString *)fileKey;
 {
     [self setImageWithFileKey:fileKey placeholderImage:nil];
@@ -41,20 +153,53 @@
 
 - (void)setImageWithFileKey:(NSString *)fileKey placeholderImage:(UIImage *)placeholderImage user:(CMUser *)user;
 {
-    UIImage *cachedImage = [[[self class] cm_sharedImageCache] cachedImageForFileKey:fileKey];
+    [self setImageWithFileKey:fileKey placeholderImage:placeholderImage user:user downsample:NO];
+}
+
+- (void)setImageWithFileKey:(NSString *)fileKey placeholderImage:(UIImage *)placeholderImage user:(CMUser *)user downsample:(BOOL)downsample;
+{
+    CGSize pixelSize = downsample ? [self cm_targetPixelSize] : CGSizeZero;
+    CGFloat scale = self.window ? self.window.screen.scale : [[UIScreen mainScreen] scale];
+    NSString *cacheKey = [[self class] cm_cacheKeyForFileKey:fileKey user:user pixelSize:pixelSize];
+    objc_setAssociatedObject(self, &CMImageViewCacheKeyAssociationKey, cacheKey, OBJC_ASSOCIATION_COPY_NONATOMIC);
+
+    UIImage *cachedImage = [[[self class] cm_sharedImageCache] cachedImageForKey:cacheKey];
     if (cachedImage) {
         self.image = cachedImage;
     } else {
         if (placeholderImage) {
             self.image = placeholderImage;
         }
-        
+
+        __weak UIImageView *weakSelf = self;
         void (^callback)(CMFileFetchResponse *response) = ^(CMFileFetchResponse *response){
-            UIImage *image = [UIImage imageWithData:response.file.fileData];
-            self.image = image;
-            [[[self class] cm_sharedImageCache] cacheImage:image forFileKey:fileKey];
+            CMFile *file = response.file;
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                UIImage *image = nil;
+                @autoreleasepool {
+                    CGImageSourceRef source = NULL;
+                    if (file.fileURL) {
+                        source = CGImageSourceCreateWithURL((__bridge CFURLRef)file.fileURL, NULL);
+                    } else if (file.fileData.length > 0) {
+                        source = CGImageSourceCreateWithData((__bridge CFDataRef)file.fileData, NULL);
+                    }
+                    image = CMDecodedImage(source, pixelSize, scale);
+                    if (source) {
+                        CFRelease(source);
+                    }
+                }
+                [[UIImageView cm_sharedImageCache] cacheImage:image forKey:cacheKey];
+
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    UIImageView *imageView = weakSelf;
+                    NSString *awaitedKey = objc_getAssociatedObject(imageView, &CMImageViewCacheKeyAssociationKey);
+                    if (imageView && (awaitedKey == cacheKey || [awaitedKey isEqualToString:cacheKey])) {
+                        imageView.image = image;
+                    }
+                });
+            });
         };
-        
+
         if (user) {
             [[CMStore defaultStore] userFileWithName:fileKey additionalOptions:nil callback:callback];
         } else {
@@ -70,15 +215,44 @@
 
 @implementation CMImageCache
 
-- (UIImage *)cachedImageForFileKey:(NSString *)fileKey;
+- (instancetype)init;
 {
-	return [self objectForKey:fileKey];
+    if (self = [super init]) {
+        self.totalCostLimit = CMImageCacheDefaultByteLimit;
+        self.costEstimator = ^NSUInteger(UIImage *image) {
+            CGImageRef imageRef = image.CGImage;
+            return imageRef ? CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) : 0;
+        };
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc;
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification;
+{
+    [self trimToLowWaterMark];
+}
+
+- (UIImage *)cachedImageForKey:(NSString *)key;
+{
+    if (!key) {
+        return nil;
+    }
+	return [self objectForKey:key];
 }
 
-- (void)cacheImage:(UIImage *)image forFileKey:(NSString *)fileKey;
+- (void)cacheImage:(UIImage *)image forKey:(NSString *)key;
 {
-    if (image && fileKey) {
-        [self setObject:image forKey:fileKey];
+    if (image && key) {
+        [self setObject:image forKey:key];
     }
 }
 
@@ -9,6 +9,7 @@
 #import "CMACL.h"
 #import "CMNullStore.h"
 #import "CMObjectSerialization.h"
+#import "CMObjectClassNameRegistry.h"
 
 NSString * const CMACLReadPermission = @"r";
 NSString * const CMACLUpdatePermission = @"u";
@@ -139,3 +140,6 @@ NSString * const CMACLSegmentLoggedIn = @"logged_in";
 }
 
 @end
+
+// Every ACL fetch decodes into this class, so it is registered up front rather than found by a scan.
+CM_REGISTER_CLASS(CMACL)
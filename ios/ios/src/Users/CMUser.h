@@ -67,6 +67,12 @@ extern NSString * const CMSocialNetworkGoogle;
 
 FOUNDATION_EXPORT NSString * const CMUserDefaultsLocalSaveKey;
 
+/**
+ * Posted once a user has logged out successfully. The <tt>object</tt> is the user. Stores drop whatever they cached
+ * on disk for that user when they receive it.
+ */
+FOUNDATION_EXPORT NSString * const CMUserDidLogOutNotification;
+
 /**
  * The block callback for all user account and session operations that take place on an instance of <tt>CMUser</tt>.
  * The block returns <tt>void</tt> and takes a <tt>CMUserAccountResult</tt> code representing the reuslt of the operation,
@@ -143,6 +149,11 @@ typedef void (^CMUserFetchWithMetaCallback)(CMObjectFetchResponse *response);
  */
 @property (readonly) BOOL isDirty;
 
+/**
+ * The names of the profile fields that have changed locally since the user was created, fetched or last saved.
+ */
+@property (nonatomic, readonly) NSSet *changedKeys;
+
 /**
  * <tt>YES</tt> if the user is logged in and <tt>NO</tt> otherwise. Being logged in
  * is defined by having a session token set and having a token expiration date in the future.
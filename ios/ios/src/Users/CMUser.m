@@ -15,13 +15,13 @@
 #import "NSDictionary+CMJSON.h"
 #import "CMUserResponse.h"
 
-#import "MARTNSObject.h"
-#import "RTProperty.h"
+#import "CMClassMetadata.h"
+#import "CMChangeJournal.h"
 
 #import <Accounts/Accounts.h>
 #import <Social/Social.h>
 
-@interface CMUser ()
+@interface CMUser () <CMChangeJournaling>
 
 @property (nonatomic, strong) CMWebService *webService;
 
@@ -44,6 +44,7 @@ NSString * const CMSocialNetworkWordpress = @"wordpress";
 NSString * const CMSocialNetworkYammer = @"yammer";
 NSString * const CMSocialNetworkSingly = @"singly";
 NSString * const CMSocialNetworkGoogle = @"google";
+NSString * const CMUserDidLogOutNotification = @"CMUserDidLogOutNotification";
 
 ///
 /// Private Constants
@@ -58,7 +59,9 @@ NSString * const CMUserJSONTokenKey = @"token";
 NSString * const CMUserJSONSecretKey = @"secret";
 NSString * const CMUserDefaultsLocalSaveKey = @"me.cloudmine.CMUserDefaultsLocalSaveKey";
 
-@implementation CMUser
+@implementation CMUser {
+    CMChangeJournal *_changeJournal;
+}
 
 @synthesize userId = _userId; // Delete in Version 2.0
 @synthesize email = _email;
@@ -127,7 +130,7 @@ static id _private_user = nil;
             _webService = [[CMWebService alloc] init];
         }
         isDirty = NO;
-        [self registerAllPropertiesForKVO];
+        [self startTrackingChanges];
     }
     return self;
 }
@@ -148,52 +151,58 @@ static id _private_user = nil;
             _webService = [[CMWebService alloc] init];
         }
         isDirty = NO;
-        [self registerAllPropertiesForKVO];
+        [self startTrackingChanges];
     }
     return self;
 }
 
 - (void)dealloc {
-    [self deregisterAllPropertiesForKVO];
+    [self stopTrackingChanges];
 }
 
 #pragma mark - Dirty tracking
 
-- (void)executeBlockForAllUserDefinedProperties:(void (^)(RTProperty *property))block {
-    NSArray *properties = [[self class] rt_properties];
-    NSArray *ignoredProperties = [CMUser rt_properties]; // none of these are user profile fields, so ignore them
-    for (RTProperty *property in properties) {
-        if (![ignoredProperties containsObject:property]) {
-            block(property);
-        }
+- (void)startTrackingChanges {
+    [CMChangeJournal prepareClass:[self class]];
+    _changeJournal = [[CMChangeJournal alloc] init];
+    for (NSString *key in [CMChangeJournal observedKeysOfClass:[self class]]) {
+        [self addObserver:self forKeyPath:key options:NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld context:NULL];
     }
 }
 
-- (void)registerAllPropertiesForKVO {
-    [self executeBlockForAllUserDefinedProperties:^(RTProperty *property) {
-        [self addObserver:self forKeyPath:[property name] options:NSKeyValueObservingOptionNew|NSKeyValueObservingOptionOld context:NULL];
-    }];
+- (void)stopTrackingChanges {
+    for (NSString *key in [CMChangeJournal observedKeysOfClass:[self class]]) {
+        [self removeObserver:self forKeyPath:key];
+    }
+    _changeJournal = nil;
 }
 
-- (void)deregisterAllPropertiesForKVO {
-    [self executeBlockForAllUserDefinedProperties:^(RTProperty *property) {
-        [self removeObserver:self forKeyPath:[property name]];
-    }];
+- (CMChangeJournal *)changeJournal {
+    return _changeJournal;
 }
 
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context {
+- (NSSet *)changedKeys {
+    return _changeJournal.changedKeys ?: [NSSet set];
+}
+
+- (void)didRecordChangeOfKey:(NSString *)key {
     if (self.isCreatedRemotely) {
         // Only change the state to dirty if the object has been at least saved remotely once. Doesn't matter otherwise and
         // just confuses matters.
-        id oldValue = [change objectForKey:NSKeyValueChangeOldKey];
-        id newValue = [change objectForKey:NSKeyValueChangeNewKey];
-        if (![oldValue isEqual:newValue]) {
-            // Only apply the change if a change was actually made.
-            #ifdef DEBUG
-                NSLog(@"Detected change for property %@. Old value was \"%@\", new value is \"%@\"", keyPath, oldValue, newValue);
-            #endif
-            isDirty = YES;
-        }
+        #ifdef DEBUG
+            NSLog(@"Detected change for property %@. Original value was \"%@\"", key, _changeJournal.originalValues[key]);
+        #endif
+        isDirty = YES;
+    }
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context {
+    id oldValue = [change objectForKey:NSKeyValueChangeOldKey];
+    id newValue = [change objectForKey:NSKeyValueChangeNewKey];
+    if (![oldValue isEqual:newValue]) {
+        // Only apply the change if a change was actually made.
+        [_changeJournal recordChangeOfKey:keyPath fromValue:(oldValue == [NSNull null] ? nil : oldValue)];
+        [self didRecordChangeOfKey:keyPath];
     }
 }
 
@@ -291,6 +300,7 @@ static id _private_user = nil;
     }
     
     isDirty = NO;
+    [_changeJournal reset];
 }
 
 - (void)setUserProperties:(NSDictionary *)attributes;
@@ -353,6 +363,7 @@ static id _private_user = nil;
             self.token = nil;
             self.tokenExpiration = nil;
             [CMUser removeLocalObjectWithKey:CMUserDefaultsLocalSaveKey];
+            [[NSNotificationCenter defaultCenter] postNotificationName:CMUserDidLogOutNotification object:self];
         } else {
             messages = [responseBody allValues];
         }
@@ -372,6 +383,7 @@ static id _private_user = nil;
         } else {
             objectId = [responseBody objectForKey:CMInternalObjectIdKey];
             isDirty = NO;
+            [_changeJournal reset];
         }
 
         if (callback) {
@@ -881,11 +893,11 @@ static id _private_user = nil;
 {
     NSString *string = [[NSString alloc] init];
     
-    NSArray *properties = [[self class] rt_properties];
+    NSArray *names = [CMClassMetadata metadataForClass:[self class]].propertyNames;
     
-    for (RTProperty *prop in properties) {
-        if (!([prop.name isEqualToString:@"description"] || [prop.name isEqualToString:@"debugDescription"] )) {
-            string = [string stringByAppendingFormat:@"\n%@: %@", prop.name, [self valueForKey:prop.name]];
+    for (NSString *name in names) {
+        if (!([name isEqualToString:@"description"] || [name isEqualToString:@"debugDescription"] )) {
+            string = [string stringByAppendingFormat:@"\n%@: %@", name, [self valueForKey:name]];
         }
     }
     
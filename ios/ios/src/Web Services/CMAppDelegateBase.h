@@ -26,4 +26,10 @@
  */
 - (void)application:(UIApplication *)app didRegisterForRemoteNotificationsWithDeviceToken:(NSData *)devToken;
 
+/**
+ * Reconnects to the background session of <tt>CMBackgroundTransferService</tt> when the app is relaunched for it. If you
+ * implement this method in your Application Delegate to handle sessions of your own, call super for any other identifier.
+ */
+- (void)application:(UIApplication *)application handleEventsForBackgroundURLSession:(NSString *)identifier completionHandler:(void (^)(void))completionHandler;
+
 @end
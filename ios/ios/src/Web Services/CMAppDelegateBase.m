@@ -8,6 +8,7 @@
 
 #import "CMAppDelegateBase.h"
 #import "CMWebService.h"
+#import "CMBackgroundTransferService.h"
 
 @implementation CMAppDelegateBase
 
@@ -31,4 +32,11 @@
     NSLog(@"CloudMine *** Error in token registration with Apple. To Handle this error override application:didFailToRegisterForRemoteNotificationsWithError: in your own App Delegate. Error: %@", err);
 }
 
+- (void)application:(UIApplication *)application handleEventsForBackgroundURLSession:(NSString *)identifier completionHandler:(void (^)(void))completionHandler {
+    if (![[CMBackgroundTransferService sharedService] handleEventsForBackgroundURLSession:identifier completionHandler:completionHandler]) {
+        NSLog(@"CloudMine *** Events for unknown background session %@. To handle them override application:handleEventsForBackgroundURLSession:completionHandler: in your own App Delegate.", identifier);
+        completionHandler();
+    }
+}
+
 @end
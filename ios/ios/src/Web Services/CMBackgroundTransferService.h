@@ -0,0 +1,123 @@
+//
+//  CMBackgroundTransferService.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+/** @file */
+
+#import <Foundation/Foundation.h>
+#import "CMWebService.h"
+
+/**
+ * Posted on the main queue whenever a background transfer finishes, whether or not the app was relaunched in between.
+ * The <tt>userInfo</tt> dictionary holds the keys below.
+ */
+extern NSString * const CMBackgroundTransferDidFinishNotification;
+
+/** An <tt>NSNumber</tt> holding <tt>YES</tt> for uploads and <tt>NO</tt> for downloads. */
+extern NSString * const CMBackgroundTransferIsUploadKey;
+
+/** The name of the file the transfer was started with. Missing for uploads that let the server name the file. */
+extern NSString * const CMBackgroundTransferFileNameKey;
+
+/** An <tt>NSNumber</tt> holding <tt>YES</tt> if the file is user-level. */
+extern NSString * const CMBackgroundTransferUserLevelKey;
+
+/** The <tt>NSURL</tt> of the local file that was uploaded or downloaded to. */
+extern NSString * const CMBackgroundTransferLocationKey;
+
+/** The name the server stored an uploaded file under. Only set for successful uploads. */
+extern NSString * const CMBackgroundTransferUploadedKeyKey;
+
+/** An <tt>NSNumber</tt> holding the <tt>CMFileUploadResult</tt> of a successful upload. */
+extern NSString * const CMBackgroundTransferUploadResultKey;
+
+/** The <tt>NSError</tt> the transfer failed with. Only set for failed transfers. */
+extern NSString * const CMBackgroundTransferErrorKey;
+
+/**
+ * Runs file uploads and downloads on a background <tt>NSURLSession</tt>, so they carry on while the app is suspended or
+ * even after it was terminated by the system. Every transfer is recorded in a registry on disk along with what it was
+ * for. Transfers that finish during the same launch call the handlers they were started with. Those that finish after a
+ * relaunch, when the handlers are gone, are reported through <tt>CMBackgroundTransferDidFinishNotification</tt>, which
+ * is posted for every transfer either way.
+ *
+ * Call <tt>+sharedService</tt> early in <tt>application:didFinishLaunchingWithOptions:</tt> to reconnect to transfers that
+ * finished while the app wasn't running, and forward <tt>application:handleEventsForBackgroundURLSession:completionHandler:</tt>
+ * to <tt>-handleEventsForBackgroundURLSession:completionHandler:</tt>. <tt>CMAppDelegateBase</tt> does the latter.
+ */
+@interface CMBackgroundTransferService : NSObject
+
+/**
+ * The service for the app's background session.
+ */
++ (instancetype)sharedService;
+
+/**
+ * Creates a service for the background session with the given identifier, keeping its registry at the given path.
+ * Only one service may exist per identifier in a process.
+ *
+ * This is the designated initializer.
+ *
+ * @param identifier The identifier of the background session.
+ * @param registryPath The file the registry of pending transfers is kept in.
+ */
+- (instancetype)initWithSessionIdentifier:(NSString *)identifier registryPath:(NSString *)registryPath NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/** The identifier of the background session. */
+@property (nonatomic, readonly) NSString *sessionIdentifier;
+
+/** The <tt>userInfo</tt> of every transfer that hasn't finished yet, as it will be posted once it does. */
+@property (nonatomic, readonly) NSArray *pendingTransfers;
+
+/**
+ * Uploads a file in the background.
+ *
+ * @param fileURL The file to upload. It must stay where it is until the upload finishes.
+ * @param request The request to upload it with.
+ * @param name The name the file is uploaded as, or <tt>nil</tt> if the server names it.
+ * @param userLevel Whether the file is user-level.
+ * @param successHandler The block to be called if the upload finishes during this launch.
+ * @param errorHandler The block to be called if the upload fails during this launch.
+ */
+- (void)uploadFileAtURL:(NSURL *)fileURL
+            withRequest:(NSURLRequest *)request
+                  named:(NSString *)name
+              userLevel:(BOOL)userLevel
+         successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
+           errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
+/**
+ * Downloads a file in the background, replacing any file already at <tt>url</tt> once it is complete. The transfer
+ * fails if the finished file can't be moved to <tt>url</tt>.
+ *
+ * @param request The request to download the file with.
+ * @param url The file URL to write the file to.
+ * @param name The name of the file.
+ * @param userLevel Whether the file is user-level.
+ * @param successHandler The block to be called if the download finishes during this launch.
+ * @param errorHandler The block to be called if the download fails during this launch.
+ */
+- (void)downloadWithRequest:(NSURLRequest *)request
+                      toURL:(NSURL *)url
+                      named:(NSString *)name
+                  userLevel:(BOOL)userLevel
+             successHandler:(CMWebServiceFileDownloadSuccessCallback)successHandler
+               errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
+/**
+ * Takes the completion handler the system passes to <tt>application:handleEventsForBackgroundURLSession:completionHandler:</tt>
+ * and calls it once every event of the session has been handled.
+ *
+ * @param identifier The identifier of the session with pending events.
+ * @param completionHandler The block to call once they have been handled.
+ * @return <tt>NO</tt> if the session isn't this service's, in which case <tt>completionHandler</tt> isn't kept.
+ */
+- (BOOL)handleEventsForBackgroundURLSession:(NSString *)identifier completionHandler:(void (^)(void))completionHandler;
+
+@end
@@ -0,0 +1,349 @@
+//
+//  CMBackgroundTransferService.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <AFNetworking/AFNetworking.h>
+
+#import "CMBackgroundTransferService.h"
+#import "CMStore.h"
+
+NSString * const CMBackgroundTransferDidFinishNotification = @"CMBackgroundTransferDidFinishNotification";
+NSString * const CMBackgroundTransferIsUploadKey = @"CMBackgroundTransferIsUploadKey";
+NSString * const CMBackgroundTransferFileNameKey = @"CMBackgroundTransferFileNameKey";
+NSString * const CMBackgroundTransferUserLevelKey = @"CMBackgroundTransferUserLevelKey";
+NSString * const CMBackgroundTransferLocationKey = @"CMBackgroundTransferLocationKey";
+NSString * const CMBackgroundTransferUploadedKeyKey = @"CMBackgroundTransferUploadedKeyKey";
+NSString * const CMBackgroundTransferUploadResultKey = @"CMBackgroundTransferUploadResultKey";
+NSString * const CMBackgroundTransferErrorKey = @"CMBackgroundTransferErrorKey";
+
+/** Registry entries keep the local file's path relative to the home directory, which moves when the app is updated. */
+static NSString * const CMBackgroundTransferPathKey = @"path";
+
+@interface CMBackgroundTransferService () {
+    AFURLSessionManager *_manager;
+    NSString *_registryPath;
+    NSMutableDictionary *_registry;
+    NSMutableDictionary *_handlers;
+    NSMutableDictionary *_responseBodies;
+    NSMutableDictionary *_moveErrors;
+    void (^_eventsCompletionHandler)(void);
+}
+@end
+
+@implementation CMBackgroundTransferService
+
+#pragma mark - Initializers
+
++ (instancetype)sharedService;
+{
+    static CMBackgroundTransferService *_sharedService = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *identifier = [NSString stringWithFormat:@"io.cloudmine.transfers.%@", [[NSBundle mainBundle] bundleIdentifier] ?: @"default"];
+        NSString *directory = [NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES) firstObject];
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+        _sharedService = [[self alloc] initWithSessionIdentifier:identifier registryPath:[directory stringByAppendingPathComponent:@"CMBackgroundTransfers.plist"]];
+    });
+    return _sharedService;
+}
+
+- (instancetype)initWithSessionIdentifier:(NSString *)identifier registryPath:(NSString *)registryPath;
+{
+    NSParameterAssert(identifier);
+    NSParameterAssert(registryPath);
+
+    if (self = [super init]) {
+        _sessionIdentifier = [identifier copy];
+        _registryPath = [registryPath copy];
+        _registry = [NSMutableDictionary dictionaryWithContentsOfFile:_registryPath] ?: [NSMutableDictionary dictionary];
+        _handlers = [NSMutableDictionary dictionary];
+        _responseBodies = [NSMutableDictionary dictionary];
+        _moveErrors = [NSMutableDictionary dictionary];
+
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration backgroundSessionConfigurationWithIdentifier:identifier];
+        _manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:configuration];
+        _manager.attemptsToRecreateUploadTasksForBackgroundSessions = YES;
+
+        // Completions are handled through the session-wide blocks, so tasks left over from an earlier launch, which have
+        // no completion handlers of their own, are handled the same way as new ones.
+        __weak CMBackgroundTransferService *weakSelf = self;
+        [_manager setDataTaskDidReceiveDataBlock:^(NSURLSession *session, NSURLSessionDataTask *dataTask, NSData *data) {
+            [weakSelf _task:dataTask didReceiveData:data];
+        }];
+        // The file is moved here rather than by AFNetworking, which only posts a notification if the move fails and then
+        // lets the task complete as if it had succeeded.
+        [_manager setDownloadTaskDidFinishDownloadingBlock:^NSURL *(NSURLSession *session, NSURLSessionDownloadTask *downloadTask, NSURL *location) {
+            [weakSelf _downloadTask:downloadTask didFinishDownloadingToURL:location];
+            return nil;
+        }];
+        [_manager setTaskDidCompleteBlock:^(NSURLSession *session, NSURLSessionTask *task, NSError *error) {
+            [weakSelf _task:task didCompleteWithError:error];
+        }];
+        [_manager setDidFinishEventsForBackgroundURLSessionBlock:^(NSURLSession *session) {
+            [weakSelf _didFinishEvents];
+        }];
+    }
+    return self;
+}
+
+#pragma mark - Starting transfers
+
+- (void)uploadFileAtURL:(NSURL *)fileURL
+            withRequest:(NSURLRequest *)request
+                  named:(NSString *)name
+              userLevel:(BOOL)userLevel
+         successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
+           errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+{
+    NSParameterAssert([fileURL isFileURL]);
+    NSURLSessionUploadTask *task = [_manager uploadTaskWithRequest:request fromFile:fileURL progress:nil completionHandler:nil];
+    [self _registerTask:task upload:YES named:name userLevel:userLevel location:fileURL successHandler:successHandler errorHandler:errorHandler];
+}
+
+- (void)downloadWithRequest:(NSURLRequest *)request
+                      toURL:(NSURL *)url
+                      named:(NSString *)name
+                  userLevel:(BOOL)userLevel
+             successHandler:(CMWebServiceFileDownloadSuccessCallback)successHandler
+               errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+{
+    NSParameterAssert([url isFileURL]);
+    NSURLSessionDownloadTask *task = [_manager downloadTaskWithRequest:request progress:nil destination:nil completionHandler:nil];
+    [self _registerTask:task upload:NO named:name userLevel:userLevel location:url successHandler:successHandler errorHandler:errorHandler];
+}
+
+- (void)_registerTask:(NSURLSessionTask *)task
+               upload:(BOOL)upload
+                named:(NSString *)name
+            userLevel:(BOOL)userLevel
+             location:(NSURL *)location
+       successHandler:(id)successHandler
+         errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+{
+    if (!task) {
+        NSLog(@"CloudMine *** Could not start a background transfer of the file at %@", location);
+        if (errorHandler) {
+            errorHandler([NSError errorWithDomain:CMErrorDomain code:CMErrorUnknown userInfo:@{NSLocalizedDescriptionKey: @"The background transfer could not be started."}]);
+        }
+        return;
+    }
+
+    NSMutableDictionary *entry = [NSMutableDictionary dictionary];
+    [entry setObject:@(upload) forKey:CMBackgroundTransferIsUploadKey];
+    [entry setObject:@(userLevel) forKey:CMBackgroundTransferUserLevelKey];
+    [entry setObject:[self _storablePathOfURL:location] forKey:CMBackgroundTransferPathKey];
+    if (name) {
+        [entry setObject:name forKey:CMBackgroundTransferFileNameKey];
+    }
+
+    NSString *taskKey = [@(task.taskIdentifier) stringValue];
+    @synchronized(self) {
+        [_registry setObject:entry forKey:taskKey];
+        [_registry writeToFile:_registryPath atomically:YES];
+        [_handlers setObject:@[successHandler ?: [NSNull null], errorHandler ?: [NSNull null]] forKey:taskKey];
+    }
+
+    [task resume];
+}
+
+#pragma mark - Registry
+
+- (NSArray *)pendingTransfers;
+{
+    NSMutableArray *transfers = [NSMutableArray array];
+    @synchronized(self) {
+        for (NSDictionary *entry in [_registry allValues]) {
+            [transfers addObject:[self _userInfoForEntry:entry]];
+        }
+    }
+    return transfers;
+}
+
+- (NSString *)_storablePathOfURL:(NSURL *)url;
+{
+    NSString *path = [[url URLByStandardizingPath] path];
+    NSString *home = [NSHomeDirectory() stringByStandardizingPath];
+    if ([path hasPrefix:[home stringByAppendingString:@"/"]]) {
+        return [@"~" stringByAppendingString:[path substringFromIndex:home.length]];
+    }
+    return path;
+}
+
+- (NSMutableDictionary *)_userInfoForEntry:(NSDictionary *)entry;
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:entry];
+    [userInfo removeObjectForKey:CMBackgroundTransferPathKey];
+    NSString *path = [[entry objectForKey:CMBackgroundTransferPathKey] stringByExpandingTildeInPath];
+    if (path) {
+        [userInfo setObject:[NSURL fileURLWithPath:path] forKey:CMBackgroundTransferLocationKey];
+    }
+    return userInfo;
+}
+
+#pragma mark - Session events
+
+- (void)_task:(NSURLSessionTask *)task didReceiveData:(NSData *)data;
+{
+    NSString *taskKey = [@(task.taskIdentifier) stringValue];
+    @synchronized(self) {
+        NSMutableData *body = [_responseBodies objectForKey:taskKey];
+        if (!body) {
+            body = [NSMutableData data];
+            [_responseBodies setObject:body forKey:taskKey];
+        }
+        [body appendData:data];
+    }
+}
+
+- (void)_downloadTask:(NSURLSessionDownloadTask *)task didFinishDownloadingToURL:(NSURL *)location;
+{
+    NSString *taskKey = [@(task.taskIdentifier) stringValue];
+    NSDictionary *entry = nil;
+    @synchronized(self) {
+        entry = [_registry objectForKey:taskKey];
+    }
+
+    // Error bodies are left where the session put them, which it cleans up, rather than replacing the destination.
+    if (!entry || [(NSHTTPURLResponse *)task.response statusCode] >= 400) {
+        return;
+    }
+
+    NSURL *destination = [[self _userInfoForEntry:entry] objectForKey:CMBackgroundTransferLocationKey];
+    NSError *error = nil;
+    [[NSFileManager defaultManager] removeItemAtURL:destination error:nil];
+    if (![[NSFileManager defaultManager] moveItemAtURL:location toURL:destination error:&error]) {
+        @synchronized(self) {
+            [_moveErrors setObject:error ?: [NSNull null] forKey:taskKey];
+        }
+    }
+}
+
+- (void)_task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error;
+{
+    NSString *taskKey = [@(task.taskIdentifier) stringValue];
+    NSDictionary *entry = nil;
+    NSArray *handlers = nil;
+    NSData *body = nil;
+    id moveError = nil;
+    @synchronized(self) {
+        entry = [_registry objectForKey:taskKey];
+        handlers = [_handlers objectForKey:taskKey];
+        body = [_responseBodies objectForKey:taskKey];
+        moveError = [_moveErrors objectForKey:taskKey];
+        [_registry removeObjectForKey:taskKey];
+        [_registry writeToFile:_registryPath atomically:YES];
+        [_handlers removeObjectForKey:taskKey];
+        [_responseBodies removeObjectForKey:taskKey];
+        [_moveErrors removeObjectForKey:taskKey];
+    }
+
+    if (!entry) {
+        return;
+    }
+
+    NSMutableDictionary *userInfo = [self _userInfoForEntry:entry];
+    NSHTTPURLResponse *response = (NSHTTPURLResponse *)task.response;
+    NSDictionary *headers = [response allHeaderFields];
+    BOOL isUpload = [[entry objectForKey:CMBackgroundTransferIsUploadKey] boolValue];
+    error = [self _errorForResponse:response error:error];
+    if (!error && moveError) {
+        NSMutableDictionary *errorInfo = [NSMutableDictionary dictionaryWithObject:@"The downloaded file could not be moved into place." forKey:NSLocalizedDescriptionKey];
+        if (moveError != [NSNull null]) {
+            [errorInfo setObject:moveError forKey:NSUnderlyingErrorKey];
+        }
+        error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnknown userInfo:errorInfo];
+    }
+
+    CMFileUploadResult result = ([response statusCode] == 201 ? CMFileCreated : CMFileUpdated);
+    NSString *uploadedKey = nil;
+    id snippetResult = nil;
+    if (!error && isUpload) {
+        NSDictionary *results = body.length > 0 ? [NSJSONSerialization JSONObjectWithData:body options:0 error:NULL] : nil;
+        if (![results isKindOfClass:[NSDictionary class]]) {
+            results = nil;
+        }
+        uploadedKey = [results objectForKey:@"key"] ?: [entry objectForKey:CMBackgroundTransferFileNameKey];
+        snippetResult = [results objectForKey:@"result"] ?: [NSDictionary dictionary];
+        if (uploadedKey) {
+            [userInfo setObject:uploadedKey forKey:CMBackgroundTransferUploadedKeyKey];
+        }
+        [userInfo setObject:@(result) forKey:CMBackgroundTransferUploadResultKey];
+    }
+
+    if (error) {
+        NSLog(@"CloudMine *** Background transfer of the file at %@ failed. (%@)", [userInfo objectForKey:CMBackgroundTransferLocationKey], [error localizedDescription]);
+        [userInfo setObject:error forKey:CMBackgroundTransferErrorKey];
+        id errorHandler = [handlers lastObject];
+        if (errorHandler && errorHandler != [NSNull null]) {
+            ((CMWebServiceFetchFailureCallback)errorHandler)(error);
+        }
+    } else {
+        id successHandler = [handlers firstObject];
+        if (successHandler && successHandler != [NSNull null]) {
+            if (isUpload) {
+                ((CMWebServiceFileUploadSuccessCallback)successHandler)(result, uploadedKey, snippetResult, headers);
+            } else {
+                ((CMWebServiceFileDownloadSuccessCallback)successHandler)([userInfo objectForKey:CMBackgroundTransferLocationKey], [headers objectForKey:@"Content-Type"], headers);
+            }
+        }
+    }
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [[NSNotificationCenter defaultCenter] postNotificationName:CMBackgroundTransferDidFinishNotification object:self userInfo:userInfo];
+    });
+}
+
+- (NSError *)_errorForResponse:(NSHTTPURLResponse *)response error:(NSError *)error;
+{
+    if (error) {
+        return [NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:@{NSLocalizedDescriptionKey: @"A connection to the server was not able to be established.", NSUnderlyingErrorKey: error}];
+    }
+
+    switch ([response statusCode]) {
+        case 404:
+            return [NSError errorWithDomain:CMErrorDomain code:CMErrorNotFound userInfo:@{NSLocalizedDescriptionKey: @"Either the file was not found or the application itself was not found."}];
+        case 401:
+            return [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:@{NSLocalizedDescriptionKey: @"The request was unauthorized. Is your API key correct?"}];
+        case 400:
+            return [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:@{NSLocalizedDescriptionKey: @"The request was malformed."}];
+        default:
+            if ([response statusCode] >= 400) {
+                return [NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:@{NSLocalizedDescriptionKey: @"The server experienced an error"}];
+            }
+            return nil;
+    }
+}
+
+#pragma mark - Relaunching for events
+
+- (BOOL)handleEventsForBackgroundURLSession:(NSString *)identifier completionHandler:(void (^)(void))completionHandler;
+{
+    if (![identifier isEqualToString:_sessionIdentifier]) {
+        return NO;
+    }
+
+    @synchronized(self) {
+        _eventsCompletionHandler = [completionHandler copy];
+    }
+    return YES;
+}
+
+- (void)_didFinishEvents;
+{
+    void (^completionHandler)(void) = nil;
+    @synchronized(self) {
+        completionHandler = _eventsCompletionHandler;
+        _eventsCompletionHandler = nil;
+    }
+
+    if (completionHandler) {
+        // The system takes a new snapshot of the UI when this is called, so it has to happen on the main thread.
+        dispatch_async(dispatch_get_main_queue(), completionHandler);
+    }
+}
+
+@end
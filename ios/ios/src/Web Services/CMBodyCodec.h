@@ -0,0 +1,78 @@
+//
+//  CMBodyCodec.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+/** @file */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * A wire format for the bodies of object fetches and saves. <tt>CMWebService</tt> encodes request bodies and decodes
+ * response bodies with the codec set as its <tt>bodyCodec</tt>, and asks the server to answer in the same format.
+ *
+ * Codecs must be safe to use from any thread.
+ */
+@protocol CMBodyCodec <NSObject>
+
+/** The MIME type of the format, sent as <tt>Content-Type</tt> and <tt>Accept</tt>. */
+@property (nonatomic, readonly, copy) NSString *contentType;
+
+/**
+ * Encodes a tree of dictionaries, arrays, strings, numbers and <tt>NSNull</tt>.
+ *
+ * @param object The root of the tree.
+ * @param error Set if the tree can't be encoded.
+ * @return The encoded bytes, or <tt>nil</tt> on error.
+ */
+- (NSData *)dataWithObject:(id)object error:(NSError **)error;
+
+/**
+ * Encodes objects to be saved, keyed by object ID, going straight from the objects to bytes.
+ *
+ * @param objects The objects, which must conform to <tt>CMSerializable</tt>.
+ * @param keysByObjectId The coder keys to keep of each object, as <tt>CMObjectEncoder</tt> takes them, or <tt>nil</tt>
+ * to encode every object in full.
+ * @return The encoded bytes.
+ */
+- (NSData *)dataWithObjects:(NSArray *)objects keys:(NSDictionary *)keysByObjectId;
+
+/**
+ * Decodes a body into dictionaries, arrays, strings, numbers and <tt>NSNull</tt>.
+ *
+ * @param data The body.
+ * @param error Set, in <tt>NSCocoaErrorDomain</tt>, if the body is malformed.
+ * @return The decoded object, or <tt>nil</tt> on error.
+ */
+- (id)objectWithData:(NSData *)data error:(NSError **)error;
+
+@end
+
+/**
+ * JSON through <tt>NSJSONSerialization</tt>. This is the default. Objects are written with
+ * <tt>CMJSONObjectEncoder</tt>, without building dictionaries of them first.
+ */
+@interface CMJSONBodyCodec : NSObject <CMBodyCodec>
+
++ (instancetype)codec;
+
+@end
+
+/**
+ * MessagePack, which is smaller than JSON and cheaper to write and read. Objects are written with
+ * <tt>CMMessagePackObjectEncoder</tt>, without building dictionaries of them first.
+ */
+@interface CMMessagePackBodyCodec : NSObject <CMBodyCodec>
+
++ (instancetype)codec;
+
+@end
+
+/**
+ * Returns the built-in codec for a response's MIME type: MessagePack for <tt>application/msgpack</tt> and
+ * <tt>application/x-msgpack</tt>, JSON for anything else.
+ */
+extern id<CMBodyCodec> CMBodyCodecForContentType(NSString *contentType);
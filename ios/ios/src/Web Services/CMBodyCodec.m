@@ -0,0 +1,95 @@
+//
+//  CMBodyCodec.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMBodyCodec.h"
+#import "CMJSONObjectEncoder.h"
+#import "CMMessagePackObjectEncoder.h"
+#import "CMMessagePackSerialization.h"
+
+@implementation CMJSONBodyCodec
+
++ (instancetype)codec;
+{
+    static CMJSONBodyCodec *_codec = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _codec = [[self alloc] init];
+    });
+    return _codec;
+}
+
+- (NSString *)contentType;
+{
+    return @"application/json";
+}
+
+- (NSData *)dataWithObject:(id)object error:(NSError **)error;
+{
+    if (![NSJSONSerialization isValidJSONObject:object]) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListWriteInvalidError userInfo:[NSDictionary dictionaryWithObject:@"The object can't be written as JSON." forKey:NSLocalizedDescriptionKey]];
+        }
+        return nil;
+    }
+    return [NSJSONSerialization dataWithJSONObject:object options:0 error:error];
+}
+
+- (NSData *)dataWithObjects:(NSArray *)objects keys:(NSDictionary *)keysByObjectId;
+{
+    return [CMJSONObjectEncoder dataWithObjects:objects keys:keysByObjectId];
+}
+
+- (id)objectWithData:(NSData *)data error:(NSError **)error;
+{
+    return [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+}
+
+@end
+
+@implementation CMMessagePackBodyCodec
+
++ (instancetype)codec;
+{
+    static CMMessagePackBodyCodec *_codec = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _codec = [[self alloc] init];
+    });
+    return _codec;
+}
+
+- (NSString *)contentType;
+{
+    return @"application/msgpack";
+}
+
+- (NSData *)dataWithObject:(id)object error:(NSError **)error;
+{
+    return [CMMessagePackSerialization dataWithObject:object error:error];
+}
+
+- (NSData *)dataWithObjects:(NSArray *)objects keys:(NSDictionary *)keysByObjectId;
+{
+    return [CMMessagePackObjectEncoder dataWithObjects:objects keys:keysByObjectId];
+}
+
+- (id)objectWithData:(NSData *)data error:(NSError **)error;
+{
+    return [CMMessagePackSerialization objectWithData:data error:error];
+}
+
+@end
+
+id<CMBodyCodec> CMBodyCodecForContentType(NSString *contentType) {
+    NSString *mimeType = [[[contentType componentsSeparatedByString:@";"] firstObject] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    if ([mimeType caseInsensitiveCompare:@"application/msgpack"] == NSOrderedSame ||
+        [mimeType caseInsensitiveCompare:@"application/x-msgpack"] == NSOrderedSame) {
+        return [CMMessagePackBodyCodec codec];
+    }
+    return [CMJSONBodyCodec codec];
+}
@@ -0,0 +1,60 @@
+//
+//  CMJSONEntryParser.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Called by <tt>CMJSONEntryParser</tt> with one entry of the streamed member at a time.
+ */
+typedef void (^CMJSONEntryHandler)(NSString *key, id value);
+
+/**
+ * Parses a JSON object incrementally, handing out the entries of one of its members as soon as each is complete
+ * instead of building that member as a whole. This is meant for CloudMine responses, where the
+ * <tt>success</tt> member can hold thousands of objects: only the bytes of the entry being read are kept, and each
+ * entry is parsed with <tt>NSJSONSerialization</tt> and released before the next.
+ *
+ * Bytes can be fed in chunks of any size, split anywhere. Every other member of the object is parsed as usual and
+ * returned by <tt>finishWithError:</tt>.
+ */
+@interface CMJSONEntryParser : NSObject
+
+/**
+ * @param entriesKey The member of the top-level object whose entries are handed out. If it is not an object, it is
+ * returned with the other members instead.
+ * @param entryHandler Called with each entry of that member, in the order they appear, on the thread doing the parsing.
+ */
+- (instancetype)initWithEntriesKey:(NSString *)entriesKey entryHandler:(CMJSONEntryHandler)entryHandler;
+
+/**
+ * Parses the next chunk of the body.
+ *
+ * @param error Set, in <tt>NSCocoaErrorDomain</tt>, if the bytes so far are not the beginning of a JSON object.
+ * @return <tt>NO</tt> on error, after which the parser can't be used anymore.
+ */
+- (BOOL)parseBytes:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError **)error;
+
+/**
+ * Ends the body.
+ *
+ * @param error Set if the body was malformed or incomplete.
+ * @return The members of the top-level object other than the streamed one, or <tt>nil</tt> on error.
+ */
+- (NSDictionary *)finishWithError:(NSError **)error;
+
+/**
+ * Parses a whole body held in memory, a chunk at a time, and ends it.
+ */
+- (NSDictionary *)parseData:(NSData *)data error:(NSError **)error;
+
+/**
+ * Reads a whole body from a stream, which is opened and closed here, and ends it.
+ */
+- (NSDictionary *)parseStream:(NSInputStream *)stream error:(NSError **)error;
+
+@end
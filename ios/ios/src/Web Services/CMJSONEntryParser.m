@@ -0,0 +1,340 @@
+//
+//  CMJSONEntryParser.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMJSONEntryParser.h"
+
+static NSUInteger const CMJSONEntryParserChunkSize = 64 * 1024;
+
+@implementation CMJSONEntryParser {
+    NSString *_entriesKey;
+    CMJSONEntryHandler _entryHandler;
+
+    // The bytes not handed out yet. Every offset below is into this buffer, or -1 if unset.
+    NSMutableData *_buffer;
+    NSUInteger _scanned;
+
+    // Only the structure is followed here: nesting, strings, and the keys and values of the two levels that matter.
+    NSUInteger _depth;
+    BOOL _inString;
+    BOOL _escaped;
+    BOOL _started;
+    BOOL _finished;
+    BOOL _expectingKey;
+    NSInteger _keyStart;
+
+    // Set after the key of the streamed member, until the first byte of its value shows whether it is an object.
+    BOOL _awaitingEntries;
+    BOOL _inEntries;
+
+    NSString *_memberKey;
+    NSInteger _memberValueStart;
+    NSString *_entryKey;
+    NSInteger _entryValueStart;
+
+    NSMutableDictionary *_members;
+    NSError *_error;
+}
+
+- (instancetype)initWithEntriesKey:(NSString *)entriesKey entryHandler:(CMJSONEntryHandler)entryHandler;
+{
+    NSParameterAssert(entriesKey);
+    if (self = [super init]) {
+        _entriesKey = [entriesKey copy];
+        _entryHandler = [entryHandler copy];
+        _buffer = [NSMutableData dataWithCapacity:CMJSONEntryParserChunkSize];
+        _keyStart = -1;
+        _memberValueStart = -1;
+        _entryValueStart = -1;
+        _members = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+#pragma mark - Parsing
+
+- (BOOL)parseBytes:(const uint8_t *)bytes length:(NSUInteger)length error:(NSError **)error;
+{
+    if (!_error) {
+        [_buffer appendBytes:bytes length:length];
+        [self scan];
+        [self discardHandledBytes];
+    }
+    if (_error && error) {
+        *error = _error;
+    }
+    return _error == nil;
+}
+
+- (NSDictionary *)finishWithError:(NSError **)error;
+{
+    if (!_error && !_finished) {
+        [self failWithDescription:@"The body ended before the JSON object did." underlyingError:nil];
+    }
+    if (_error) {
+        if (error) {
+            *error = _error;
+        }
+        return nil;
+    }
+    return [_members copy];
+}
+
+- (NSDictionary *)parseData:(NSData *)data error:(NSError **)error;
+{
+    const uint8_t *bytes = data.bytes;
+    for (NSUInteger offset = 0; offset < data.length; offset += CMJSONEntryParserChunkSize) {
+        if (![self parseBytes:bytes + offset length:MIN(CMJSONEntryParserChunkSize, data.length - offset) error:error]) {
+            return nil;
+        }
+    }
+    return [self finishWithError:error];
+}
+
+- (NSDictionary *)parseStream:(NSInputStream *)stream error:(NSError **)error;
+{
+    uint8_t *chunk = malloc(CMJSONEntryParserChunkSize);
+    NSInteger length = 0;
+    BOOL parsed = YES;
+
+    [stream open];
+    while (parsed && (length = [stream read:chunk maxLength:CMJSONEntryParserChunkSize]) > 0) {
+        parsed = [self parseBytes:chunk length:length error:error];
+    }
+    if (parsed && length < 0) {
+        [self failWithDescription:@"The body could not be read." underlyingError:stream.streamError];
+    }
+    [stream close];
+    free(chunk);
+
+    return [self finishWithError:error];
+}
+
+#pragma mark - Private methods
+
+- (void)scan;
+{
+    for (NSUInteger i = _scanned; i < _buffer.length && !_error; i++) {
+        uint8_t c = ((const uint8_t *)_buffer.bytes)[i];
+        _scanned = i + 1;
+
+        if (_inString) {
+            if (_escaped) {
+                _escaped = NO;
+            } else if (c == '\\') {
+                _escaped = YES;
+            } else if (c == '"') {
+                _inString = NO;
+                if (_keyStart >= 0) {
+                    [self readKeyEndingAt:i];
+                }
+            }
+            continue;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            continue;
+        }
+
+        if (!_started) {
+            if (c != '{') {
+                [self failWithDescription:@"The body is not a JSON object." underlyingError:nil];
+                return;
+            }
+            _started = YES;
+            _depth = 1;
+            _expectingKey = YES;
+            continue;
+        }
+
+        if (_finished) {
+            [self failWithDescription:@"There is more to the body than one JSON object." underlyingError:nil];
+            return;
+        }
+
+        if (_awaitingEntries) {
+            _awaitingEntries = NO;
+            if (c == '{') {
+                _inEntries = YES;
+                _memberValueStart = -1;
+                _depth = 2;
+                _expectingKey = YES;
+                continue;
+            }
+        }
+
+        NSUInteger memberDepth = _inEntries ? 2 : 1;
+        switch (c) {
+            case '"':
+                _inString = YES;
+                _keyStart = (_depth == memberDepth && _expectingKey) ? (NSInteger)i : -1;
+                break;
+
+            case ':':
+                if (_depth == memberDepth) {
+                    if (!_expectingKey || !(_inEntries ? _entryKey : _memberKey)) {
+                        [self failWithDescription:@"A value in the body has no key." underlyingError:nil];
+                        return;
+                    }
+                    _expectingKey = NO;
+                    if (_inEntries) {
+                        _entryValueStart = i + 1;
+                    } else {
+                        _memberValueStart = i + 1;
+                        _awaitingEntries = [_memberKey isEqualToString:_entriesKey];
+                    }
+                }
+                break;
+
+            case ',':
+                if (_depth == memberDepth) {
+                    [self finishValueEndingAt:i];
+                    _expectingKey = YES;
+                }
+                break;
+
+            case '{':
+            case '[':
+                _depth++;
+                break;
+
+            case '}':
+            case ']':
+                if (_depth > memberDepth) {
+                    _depth--;
+                    break;
+                }
+                if (c != '}') {
+                    [self failWithDescription:@"The brackets in the body don't match." underlyingError:nil];
+                    return;
+                }
+                [self finishValueEndingAt:i];
+                if (_inEntries) {
+                    // The streamed member is over; what follows is a comma or the end of the top-level object.
+                    _inEntries = NO;
+                    _depth = 1;
+                    _expectingKey = NO;
+                } else {
+                    _depth = 0;
+                    _finished = YES;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+- (void)readKeyEndingAt:(NSUInteger)end;
+{
+    const uint8_t *bytes = (const uint8_t *)_buffer.bytes + _keyStart;
+    NSUInteger length = end + 1 - _keyStart;
+    NSString *key = nil;
+
+    // Keys with escapes in them are rare, so only those go through NSJSONSerialization.
+    if (!memchr(bytes, '\\', length)) {
+        key = [[NSString alloc] initWithBytes:bytes + 1 length:length - 2 encoding:NSUTF8StringEncoding];
+    } else {
+        key = [self valueInRange:NSMakeRange(_keyStart, length)];
+    }
+    _keyStart = -1;
+
+    if (![key isKindOfClass:[NSString class]]) {
+        [self failWithDescription:@"A key in the body is malformed." underlyingError:_error];
+        return;
+    }
+    if (_inEntries) {
+        _entryKey = key;
+    } else {
+        _memberKey = key;
+    }
+}
+
+- (void)finishValueEndingAt:(NSUInteger)end;
+{
+    NSInteger start = _inEntries ? _entryValueStart : _memberValueStart;
+    if (start < 0) {
+        return;
+    }
+
+    @autoreleasepool {
+        id value = [self valueInRange:NSMakeRange(start, end - start)];
+        if (!value) {
+            return;
+        }
+
+        if (_inEntries) {
+            if (_entryHandler) {
+                _entryHandler(_entryKey, value);
+            }
+            _entryKey = nil;
+            _entryValueStart = -1;
+        } else {
+            [_members setObject:value forKey:_memberKey];
+            _memberKey = nil;
+            _memberValueStart = -1;
+        }
+    }
+}
+
+- (id)valueInRange:(NSRange)range;
+{
+    NSData *data = [NSData dataWithBytesNoCopy:(uint8_t *)_buffer.mutableBytes + range.location length:range.length freeWhenDone:NO];
+    NSError *parseError = nil;
+    id value = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingAllowFragments error:&parseError];
+    if (!value) {
+        [self failWithDescription:@"A value in the body is malformed." underlyingError:parseError];
+    }
+    return value;
+}
+
+/**
+ * Drops the bytes before the earliest key or value still being read, and moves every offset back to match.
+ */
+- (void)discardHandledBytes;
+{
+    NSInteger handled = _scanned;
+    if (_keyStart >= 0) {
+        handled = MIN(handled, _keyStart);
+    }
+    if (_memberValueStart >= 0) {
+        handled = MIN(handled, _memberValueStart);
+    }
+    if (_entryValueStart >= 0) {
+        handled = MIN(handled, _entryValueStart);
+    }
+    if (handled == 0) {
+        return;
+    }
+
+    [_buffer replaceBytesInRange:NSMakeRange(0, handled) withBytes:NULL length:0];
+    _scanned -= handled;
+    if (_keyStart >= 0) {
+        _keyStart -= handled;
+    }
+    if (_memberValueStart >= 0) {
+        _memberValueStart -= handled;
+    }
+    if (_entryValueStart >= 0) {
+        _entryValueStart -= handled;
+    }
+}
+
+- (void)failWithDescription:(NSString *)description underlyingError:(NSError *)underlyingError;
+{
+    if (_error) {
+        return;
+    }
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey];
+    if (underlyingError) {
+        [userInfo setObject:underlyingError forKey:NSUnderlyingErrorKey];
+    }
+    _error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:userInfo];
+}
+
+@end
@@ -0,0 +1,72 @@
+//
+//  CMMessagePackSerialization.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+/** @file */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Converts between MessagePack and Foundation objects, the way <tt>NSJSONSerialization</tt> does for JSON. The same
+ * types are supported, plus <tt>NSData</tt>, which is written as MessagePack binary. Dictionary keys must be strings.
+ */
+@interface CMMessagePackSerialization : NSObject
+
+/**
+ * Returns the MessagePack form of a tree of dictionaries, arrays, strings, numbers, data and <tt>NSNull</tt>.
+ *
+ * @param object The root of the tree.
+ * @param error Set if the tree holds anything else.
+ * @return The encoded bytes, or <tt>nil</tt> on error.
+ */
++ (NSData *)dataWithObject:(id)object error:(NSError **)error;
+
+/**
+ * Returns the Foundation form of a MessagePack value. Maps become dictionaries, and extension types are rejected.
+ *
+ * @param data The encoded bytes.
+ * @param error Set if the bytes are not a single, complete MessagePack value.
+ * @return The decoded object, or <tt>nil</tt> on error.
+ */
++ (id)objectWithData:(NSData *)data error:(NSError **)error;
+
+@end
+
+/**
+ * Writes MessagePack values one at a time into a growing buffer, so that encoders can write their output as they go
+ * instead of building an object tree first.
+ *
+ * Maps don't need to know their size up front: every key written between <tt>beginMap</tt> and <tt>endMap</tt> is
+ * counted and the count is filled in when the map ends. Arrays do, since their size is always known.
+ */
+@interface CMMessagePackWriter : NSObject
+
+/** The bytes written so far. Only a complete value once every map has ended. */
+@property (nonatomic, readonly) NSData *data;
+
+- (void)beginMap;
+- (void)writeKey:(NSString *)key;
+- (void)endMap;
+
+- (void)beginArrayWithCount:(NSUInteger)count;
+
+- (void)writeNil;
+- (void)writeBool:(BOOL)value;
+- (void)writeInteger:(int64_t)value;
+- (void)writeDouble:(double)value;
+- (void)writeNumber:(NSNumber *)number;
+- (void)writeString:(NSString *)string;
+- (void)writeData:(NSData *)data;
+
+/**
+ * Writes a tree of Foundation objects as <tt>CMMessagePackSerialization</tt> does.
+ *
+ * @return <tt>NO</tt> if the tree holds an unsupported object, in which case the output is incomplete.
+ */
+- (BOOL)writeObject:(id)object;
+
+@end
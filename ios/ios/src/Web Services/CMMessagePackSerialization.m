@@ -0,0 +1,435 @@
+//
+//  CMMessagePackSerialization.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMMessagePackSerialization.h"
+
+/** Values nested deeper than this are rejected rather than risking the stack on malformed input. */
+static const NSUInteger CMMessagePackMaximumDepth = 512;
+
+static NSError *CMMessagePackError(NSInteger code, NSString *description) {
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:code userInfo:[NSDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey]];
+}
+
+#pragma mark - Reading
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger position;
+} CMMessagePackReader;
+
+static id CMMessagePackReadValue(CMMessagePackReader *reader, NSUInteger depth, NSError **error);
+
+static id CMMessagePackFail(NSError **error, NSString *description) {
+    if (error && !*error) {
+        *error = CMMessagePackError(NSPropertyListReadCorruptError, description);
+    }
+    return nil;
+}
+
+static BOOL CMMessagePackReadBigEndian(CMMessagePackReader *reader, NSUInteger size, uint64_t *value) {
+    if (reader->length - reader->position < size) {
+        return NO;
+    }
+    uint64_t result = 0;
+    for (NSUInteger i = 0; i < size; i++) {
+        result = (result << 8) | reader->bytes[reader->position + i];
+    }
+    reader->position += size;
+    *value = result;
+    return YES;
+}
+
+static id CMMessagePackReadString(CMMessagePackReader *reader, uint64_t length, NSError **error) {
+    if (reader->length - reader->position < length) {
+        return CMMessagePackFail(error, @"The MessagePack data ends in the middle of a string.");
+    }
+    NSString *string = [[NSString alloc] initWithBytes:reader->bytes + reader->position length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+    if (!string) {
+        return CMMessagePackFail(error, @"The MessagePack data holds a string that isn't valid UTF-8.");
+    }
+    reader->position += length;
+    return string;
+}
+
+static id CMMessagePackReadBinary(CMMessagePackReader *reader, uint64_t length, NSError **error) {
+    if (reader->length - reader->position < length) {
+        return CMMessagePackFail(error, @"The MessagePack data ends in the middle of binary data.");
+    }
+    NSData *data = [NSData dataWithBytes:reader->bytes + reader->position length:(NSUInteger)length];
+    reader->position += length;
+    return data;
+}
+
+static id CMMessagePackReadArray(CMMessagePackReader *reader, uint64_t count, NSUInteger depth, NSError **error) {
+    // Every element takes at least a byte, so a larger count can only come from malformed data.
+    if (reader->length - reader->position < count) {
+        return CMMessagePackFail(error, @"The MessagePack data ends in the middle of an array.");
+    }
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        id element = CMMessagePackReadValue(reader, depth + 1, error);
+        if (!element) {
+            return nil;
+        }
+        [array addObject:element];
+    }
+    return array;
+}
+
+static id CMMessagePackReadMap(CMMessagePackReader *reader, uint64_t count, NSUInteger depth, NSError **error) {
+    if ((reader->length - reader->position) / 2 < count) {
+        return CMMessagePackFail(error, @"The MessagePack data ends in the middle of a map.");
+    }
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        id key = CMMessagePackReadValue(reader, depth + 1, error);
+        if (key && ![key isKindOfClass:[NSString class]]) {
+            return CMMessagePackFail(error, @"The MessagePack data holds a map with a key that isn't a string.");
+        }
+        id value = key ? CMMessagePackReadValue(reader, depth + 1, error) : nil;
+        if (!value) {
+            return nil;
+        }
+        [dictionary setObject:value forKey:key];
+    }
+    return dictionary;
+}
+
+static id CMMessagePackReadValue(CMMessagePackReader *reader, NSUInteger depth, NSError **error) {
+    if (depth > CMMessagePackMaximumDepth) {
+        return CMMessagePackFail(error, @"The MessagePack data is nested too deeply.");
+    }
+
+    uint64_t type = 0;
+    if (!CMMessagePackReadBigEndian(reader, 1, &type)) {
+        return CMMessagePackFail(error, @"The MessagePack data ends before a value.");
+    }
+
+    if (type <= 0x7f) {
+        return [NSNumber numberWithLongLong:(long long)type];
+    } else if (type >= 0xe0) {
+        return [NSNumber numberWithLongLong:(int8_t)type];
+    } else if ((type & 0xe0) == 0xa0) {
+        return CMMessagePackReadString(reader, type & 0x1f, error);
+    } else if ((type & 0xf0) == 0x90) {
+        return CMMessagePackReadArray(reader, type & 0x0f, depth, error);
+    } else if ((type & 0xf0) == 0x80) {
+        return CMMessagePackReadMap(reader, type & 0x0f, depth, error);
+    }
+
+    uint64_t value = 0;
+    switch (type) {
+        case 0xc0:
+            return [NSNull null];
+        case 0xc2:
+            return [NSNumber numberWithBool:NO];
+        case 0xc3:
+            return [NSNumber numberWithBool:YES];
+        case 0xcc: case 0xcd: case 0xce: case 0xcf:
+            if (!CMMessagePackReadBigEndian(reader, 1 << (type - 0xcc), &value)) {
+                break;
+            }
+            return value > INT64_MAX ? [NSNumber numberWithUnsignedLongLong:value] : [NSNumber numberWithLongLong:(long long)value];
+        case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+            NSUInteger size = 1 << (type - 0xd0);
+            if (!CMMessagePackReadBigEndian(reader, size, &value)) {
+                break;
+            }
+            // Sign-extend from the encoded width.
+            NSUInteger shift = 64 - 8 * size;
+            return [NSNumber numberWithLongLong:((int64_t)(value << shift)) >> shift];
+        }
+        case 0xca: {
+            if (!CMMessagePackReadBigEndian(reader, 4, &value)) {
+                break;
+            }
+            uint32_t bits = (uint32_t)value;
+            float single;
+            memcpy(&single, &bits, sizeof(single));
+            return [NSNumber numberWithFloat:single];
+        }
+        case 0xcb: {
+            if (!CMMessagePackReadBigEndian(reader, 8, &value)) {
+                break;
+            }
+            double real;
+            memcpy(&real, &value, sizeof(real));
+            return [NSNumber numberWithDouble:real];
+        }
+        case 0xd9: case 0xda: case 0xdb:
+            if (!CMMessagePackReadBigEndian(reader, 1 << (type - 0xd9), &value)) {
+                break;
+            }
+            return CMMessagePackReadString(reader, value, error);
+        case 0xc4: case 0xc5: case 0xc6:
+            if (!CMMessagePackReadBigEndian(reader, 1 << (type - 0xc4), &value)) {
+                break;
+            }
+            return CMMessagePackReadBinary(reader, value, error);
+        case 0xdc: case 0xdd:
+            if (!CMMessagePackReadBigEndian(reader, type == 0xdc ? 2 : 4, &value)) {
+                break;
+            }
+            return CMMessagePackReadArray(reader, value, depth, error);
+        case 0xde: case 0xdf:
+            if (!CMMessagePackReadBigEndian(reader, type == 0xde ? 2 : 4, &value)) {
+                break;
+            }
+            return CMMessagePackReadMap(reader, value, depth, error);
+        default:
+            return CMMessagePackFail(error, [NSString stringWithFormat:@"The MessagePack data holds an unsupported type (0x%02llx).", type]);
+    }
+    return CMMessagePackFail(error, @"The MessagePack data ends in the middle of a value.");
+}
+
+@implementation CMMessagePackSerialization
+
++ (NSData *)dataWithObject:(id)object error:(NSError **)error;
+{
+    CMMessagePackWriter *writer = [[CMMessagePackWriter alloc] init];
+    if (![writer writeObject:object]) {
+        if (error) {
+            *error = CMMessagePackError(NSPropertyListWriteInvalidError, @"Only dictionaries, arrays, strings, numbers, data and NSNull can be written as MessagePack.");
+        }
+        return nil;
+    }
+    return writer.data;
+}
+
++ (id)objectWithData:(NSData *)data error:(NSError **)error;
+{
+    CMMessagePackReader reader = { data.bytes, data.length, 0 };
+    id object = CMMessagePackReadValue(&reader, 0, error);
+    if (object && reader.position != reader.length) {
+        return CMMessagePackFail(error, @"The MessagePack data has bytes left over after its value.");
+    }
+    return object;
+}
+
+@end
+
+#pragma mark - Writing
+
+typedef struct {
+    NSUInteger headerOffset;
+    uint32_t count;
+} CMMessagePackOpenMap;
+
+@implementation CMMessagePackWriter {
+    NSMutableData *_buffer;
+    CMMessagePackOpenMap *_openMaps;
+    NSUInteger _openMapCount;
+    NSUInteger _openMapCapacity;
+}
+
+- (instancetype)init;
+{
+    if (self = [super init]) {
+        _buffer = [NSMutableData dataWithCapacity:1024];
+    }
+    return self;
+}
+
+- (void)dealloc;
+{
+    free(_openMaps);
+}
+
+- (NSData *)data;
+{
+    return _buffer;
+}
+
+- (void)writeType:(uint8_t)type bigEndianValue:(uint64_t)value size:(NSUInteger)size;
+{
+    uint8_t bytes[9];
+    bytes[0] = type;
+    for (NSUInteger i = 0; i < size; i++) {
+        bytes[1 + i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+    }
+    [_buffer appendBytes:bytes length:1 + size];
+}
+
+#pragma mark - Containers
+
+- (void)beginMap;
+{
+    if (_openMapCount == _openMapCapacity) {
+        _openMapCapacity = MAX(16, _openMapCapacity * 2);
+        _openMaps = realloc(_openMaps, _openMapCapacity * sizeof(CMMessagePackOpenMap));
+    }
+    _openMaps[_openMapCount++] = (CMMessagePackOpenMap){ _buffer.length, 0 };
+
+    // Always the 32-bit form, so the count can be filled in at the end without moving what follows.
+    [self writeType:0xdf bigEndianValue:0 size:4];
+}
+
+- (void)writeKey:(NSString *)key;
+{
+    NSAssert(_openMapCount > 0, @"Keys can only be written inside a map.");
+    _openMaps[_openMapCount - 1].count++;
+    [self writeString:key];
+}
+
+- (void)endMap;
+{
+    NSAssert(_openMapCount > 0, @"There is no map to end.");
+    CMMessagePackOpenMap map = _openMaps[--_openMapCount];
+    uint8_t *header = (uint8_t *)_buffer.mutableBytes + map.headerOffset;
+    for (NSUInteger i = 0; i < 4; i++) {
+        header[1 + i] = (uint8_t)(map.count >> (8 * (3 - i)));
+    }
+}
+
+- (void)beginArrayWithCount:(NSUInteger)count;
+{
+    if (count < 16) {
+        [self writeType:(uint8_t)(0x90 | count) bigEndianValue:0 size:0];
+    } else if (count <= UINT16_MAX) {
+        [self writeType:0xdc bigEndianValue:count size:2];
+    } else {
+        [self writeType:0xdd bigEndianValue:count size:4];
+    }
+}
+
+#pragma mark - Scalars
+
+- (void)writeNil;
+{
+    [self writeType:0xc0 bigEndianValue:0 size:0];
+}
+
+- (void)writeBool:(BOOL)value;
+{
+    [self writeType:(value ? 0xc3 : 0xc2) bigEndianValue:0 size:0];
+}
+
+- (void)writeInteger:(int64_t)value;
+{
+    if (value >= 0) {
+        if (value < 128) {
+            [self writeType:(uint8_t)value bigEndianValue:0 size:0];
+        } else if (value <= UINT8_MAX) {
+            [self writeType:0xcc bigEndianValue:(uint64_t)value size:1];
+        } else if (value <= UINT16_MAX) {
+            [self writeType:0xcd bigEndianValue:(uint64_t)value size:2];
+        } else if (value <= UINT32_MAX) {
+            [self writeType:0xce bigEndianValue:(uint64_t)value size:4];
+        } else {
+            [self writeType:0xcf bigEndianValue:(uint64_t)value size:8];
+        }
+    } else {
+        if (value >= -32) {
+            [self writeType:(uint8_t)value bigEndianValue:0 size:0];
+        } else if (value >= INT8_MIN) {
+            [self writeType:0xd0 bigEndianValue:(uint64_t)value size:1];
+        } else if (value >= INT16_MIN) {
+            [self writeType:0xd1 bigEndianValue:(uint64_t)value size:2];
+        } else if (value >= INT32_MIN) {
+            [self writeType:0xd2 bigEndianValue:(uint64_t)value size:4];
+        } else {
+            [self writeType:0xd3 bigEndianValue:(uint64_t)value size:8];
+        }
+    }
+}
+
+- (void)writeDouble:(double)value;
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    [self writeType:0xcb bigEndianValue:bits size:8];
+}
+
+- (void)writeNumber:(NSNumber *)number;
+{
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        [self writeBool:[number boolValue]];
+        return;
+    }
+
+    const char *type = [number objCType];
+    if (*type == 'f' || *type == 'd') {
+        [self writeDouble:[number doubleValue]];
+    } else if (*type == 'Q' && [number unsignedLongLongValue] > INT64_MAX) {
+        [self writeType:0xcf bigEndianValue:[number unsignedLongLongValue] size:8];
+    } else {
+        [self writeInteger:[number longLongValue]];
+    }
+}
+
+- (void)writeString:(NSString *)string;
+{
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    if (length < 32) {
+        [self writeType:(uint8_t)(0xa0 | length) bigEndianValue:0 size:0];
+    } else if (length <= UINT8_MAX) {
+        [self writeType:0xd9 bigEndianValue:length size:1];
+    } else if (length <= UINT16_MAX) {
+        [self writeType:0xda bigEndianValue:length size:2];
+    } else {
+        [self writeType:0xdb bigEndianValue:length size:4];
+    }
+
+    // Transcode straight into the buffer rather than through an intermediate NSData.
+    NSUInteger offset = _buffer.length;
+    [_buffer increaseLengthBy:length];
+    [string getBytes:(uint8_t *)_buffer.mutableBytes + offset maxLength:length usedLength:NULL encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, string.length) remainingRange:NULL];
+}
+
+- (void)writeData:(NSData *)data;
+{
+    NSUInteger length = data.length;
+    if (length <= UINT8_MAX) {
+        [self writeType:0xc4 bigEndianValue:length size:1];
+    } else if (length <= UINT16_MAX) {
+        [self writeType:0xc5 bigEndianValue:length size:2];
+    } else {
+        [self writeType:0xc6 bigEndianValue:length size:4];
+    }
+    [_buffer appendData:data];
+}
+
+#pragma mark - Object trees
+
+- (BOOL)writeObject:(id)object;
+{
+    if (!object || object == [NSNull null]) {
+        [self writeNil];
+    } else if ([object isKindOfClass:[NSString class]]) {
+        [self writeString:object];
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        [self writeNumber:object];
+    } else if ([object isKindOfClass:[NSData class]]) {
+        [self writeData:object];
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        [self beginArrayWithCount:[object count]];
+        for (id element in object) {
+            if (![self writeObject:element]) {
+                return NO;
+            }
+        }
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        [self beginMap];
+        for (id key in object) {
+            if (![key isKindOfClass:[NSString class]]) {
+                return NO;
+            }
+            [self writeKey:key];
+            if (![self writeObject:[object objectForKey:key]]) {
+                return NO;
+            }
+        }
+        [self endMap];
+    } else {
+        return NO;
+    }
+    return YES;
+}
+
+@end
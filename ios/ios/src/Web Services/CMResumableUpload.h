@@ -0,0 +1,89 @@
+//
+//  CMResumableUpload.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+/** @file */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * The state of a file upload sent in chunks, so that an interrupted upload continues from the last byte the server
+ * acknowledged instead of starting over. The state is written to disk as chunks are acknowledged. It is keyed by the
+ * file's path, size and modification date, the destination key and the owner, so uploading the same unchanged file
+ * again, even after the app was relaunched, picks up where the previous attempt left off.
+ *
+ * Each chunk is a <tt>PUT</tt> to the file's binary URL carrying the upload's identifier in
+ * <tt>X-CloudMine-Upload-Id</tt> and its position in <tt>Content-Range</tt>. The server answers <tt>308</tt> with a
+ * <tt>Range</tt> header for every chunk but the last, and with the usual upload response once it has the whole file.
+ * A chunk with no body and a <tt>Content-Range</tt> of <tt>bytes &#42;/total</tt> asks how much the server already has.
+ */
+@interface CMResumableUpload : NSObject
+
+/**
+ * Returns the saved state of an earlier upload of the same file, or the state of a new upload if there is none or the
+ * file changed since.
+ *
+ * @param path The path of the file to upload.
+ * @param key The name to upload the file as. If <tt>nil</tt>, a name is generated and kept with the state.
+ * @param ownerIdentifier The object ID of the user the file belongs to, or <tt>nil</tt> for an app-level file.
+ * @param chunkSize The largest number of bytes to send in one request. Saved uploads keep the size they started with.
+ * @return The upload's state, or <tt>nil</tt> if the file can't be read.
+ */
++ (instancetype)uploadForFileAtPath:(NSString *)path named:(NSString *)key ownerIdentifier:(NSString *)ownerIdentifier chunkSize:(NSUInteger)chunkSize;
+
+/**
+ * The file the saved states are kept in.
+ */
++ (NSString *)statePath;
+
+/** The identifier the server tracks the upload by. */
+@property (nonatomic, readonly) NSString *uploadIdentifier;
+
+/** The path of the file being uploaded. */
+@property (nonatomic, readonly) NSString *path;
+
+/** The name the file is uploaded as. */
+@property (nonatomic, readonly) NSString *key;
+
+/** The size of the file in bytes. */
+@property (nonatomic, readonly) unsigned long long fileSize;
+
+/** The largest number of bytes sent in one request. */
+@property (nonatomic, readonly) NSUInteger chunkSize;
+
+/** The number of bytes the server has acknowledged. Setting it saves the state. */
+@property (nonatomic) unsigned long long committedLength;
+
+/** Whether the server has acknowledged the whole file. */
+@property (nonatomic, readonly, getter = isComplete) BOOL complete;
+
+/**
+ * Reads the chunk that starts at <tt>committedLength</tt>.
+ *
+ * @param error Set if the file can't be read.
+ * @return Up to <tt>chunkSize</tt> bytes, or <tt>nil</tt> on error.
+ */
+- (NSData *)nextChunk:(NSError **)error;
+
+/**
+ * The <tt>Content-Range</tt> header value for a chunk of the given length starting at <tt>committedLength</tt>, or for
+ * a status query if <tt>length</tt> is 0.
+ */
+- (NSString *)contentRangeForChunkOfLength:(NSUInteger)length;
+
+/**
+ * Updates <tt>committedLength</tt> from the <tt>Range</tt> header of a <tt>308</tt> response. No header means the
+ * server has nothing yet.
+ */
+- (void)commitRange:(NSString *)rangeHeader;
+
+/**
+ * Forgets the saved state, once the upload has finished or the server no longer knows about it.
+ */
+- (void)remove;
+
+@end
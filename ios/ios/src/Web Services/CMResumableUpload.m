@@ -0,0 +1,184 @@
+//
+//  CMResumableUpload.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMResumableUpload.h"
+
+static NSString * const CMResumableUploadIdentifierKey = @"id";
+static NSString * const CMResumableUploadKeyKey = @"key";
+static NSString * const CMResumableUploadChunkSizeKey = @"chunkSize";
+static NSString * const CMResumableUploadCommittedLengthKey = @"committed";
+static NSString * const CMResumableUploadUpdatedKey = @"updated";
+
+/** Saved states untouched for this long are dropped; servers don't keep partial uploads forever either. */
+static NSTimeInterval const CMResumableUploadMaximumAge = 7.0 * 24.0 * 60.0 * 60.0;
+
+@interface CMResumableUpload ()
+@property (nonatomic, copy) NSString *stateKey;
+@end
+
+@implementation CMResumableUpload {
+    unsigned long long _committedLength;
+}
+
+#pragma mark - Saved state
+
++ (NSString *)statePath;
+{
+    NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    return [caches stringByAppendingPathComponent:@"CMResumableUploads.plist"];
+}
+
++ (NSMutableDictionary *)_loadStates;
+{
+    NSMutableDictionary *states = [NSMutableDictionary dictionaryWithContentsOfFile:[self statePath]] ?: [NSMutableDictionary dictionary];
+    for (NSString *stateKey in [states allKeys]) {
+        NSDate *updated = [[states objectForKey:stateKey] objectForKey:CMResumableUploadUpdatedKey];
+        if (!updated || -[updated timeIntervalSinceNow] > CMResumableUploadMaximumAge) {
+            [states removeObjectForKey:stateKey];
+        }
+    }
+    return states;
+}
+
++ (void)_updateStates:(void (^)(NSMutableDictionary *states))block;
+{
+    @synchronized(self) {
+        NSMutableDictionary *states = [self _loadStates];
+        block(states);
+        [states writeToFile:[self statePath] atomically:YES];
+    }
+}
+
+#pragma mark - Creating uploads
+
++ (instancetype)uploadForFileAtPath:(NSString *)path named:(NSString *)key ownerIdentifier:(NSString *)ownerIdentifier chunkSize:(NSUInteger)chunkSize;
+{
+    NSParameterAssert(path);
+    NSParameterAssert(chunkSize > 0);
+
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL];
+    if (!attributes) {
+        return nil;
+    }
+
+    CMResumableUpload *upload = [[self alloc] init];
+    upload->_path = [path copy];
+    upload->_fileSize = [attributes fileSize];
+    // A file that changed since the last attempt gets a state of its own, so stale bytes are never resumed.
+    upload.stateKey = [NSString stringWithFormat:@"%@|%@|%@|%llu|%f", ownerIdentifier ?: @"", key ?: @"", path,
+                       upload->_fileSize, [[attributes fileModificationDate] timeIntervalSinceReferenceDate]];
+
+    @synchronized(self) {
+        NSDictionary *state = [[self _loadStates] objectForKey:upload.stateKey];
+        if (state) {
+            upload->_uploadIdentifier = [state objectForKey:CMResumableUploadIdentifierKey];
+            upload->_key = [state objectForKey:CMResumableUploadKeyKey];
+            upload->_chunkSize = [[state objectForKey:CMResumableUploadChunkSizeKey] unsignedIntegerValue];
+            upload->_committedLength = [[state objectForKey:CMResumableUploadCommittedLengthKey] unsignedLongLongValue];
+        } else {
+            upload->_uploadIdentifier = [[NSUUID UUID] UUIDString];
+            upload->_key = key ? [key copy] : [[NSUUID UUID] UUIDString];
+            upload->_chunkSize = chunkSize;
+            [upload _save];
+        }
+    }
+
+    return upload;
+}
+
+#pragma mark - Progress
+
+- (unsigned long long)committedLength;
+{
+    @synchronized(self) {
+        return _committedLength;
+    }
+}
+
+- (void)setCommittedLength:(unsigned long long)committedLength;
+{
+    @synchronized(self) {
+        _committedLength = MIN(committedLength, _fileSize);
+    }
+    [self _save];
+}
+
+- (BOOL)isComplete;
+{
+    return self.committedLength >= _fileSize;
+}
+
+- (void)commitRange:(NSString *)rangeHeader;
+{
+    // The header looks like "bytes=0-1048575", naming the last byte received. A 308 without one means no bytes were.
+    if (rangeHeader.length == 0) {
+        self.committedLength = 0;
+        return;
+    }
+    NSRange dash = [rangeHeader rangeOfString:@"-" options:NSBackwardsSearch];
+    NSString *lastByte = dash.location == NSNotFound ? nil : [rangeHeader substringFromIndex:NSMaxRange(dash)];
+    if (lastByte.length == 0) {
+        self.committedLength = 0;
+        return;
+    }
+    self.committedLength = strtoull([lastByte UTF8String], NULL, 10) + 1;
+}
+
+- (NSString *)contentRangeForChunkOfLength:(NSUInteger)length;
+{
+    if (length == 0) {
+        return [NSString stringWithFormat:@"bytes */%llu", _fileSize];
+    }
+    unsigned long long start = self.committedLength;
+    return [NSString stringWithFormat:@"bytes %llu-%llu/%llu", start, start + length - 1, _fileSize];
+}
+
+- (NSData *)nextChunk:(NSError **)error;
+{
+    NSFileHandle *handle = [NSFileHandle fileHandleForReadingFromURL:[NSURL fileURLWithPath:_path] error:error];
+    if (!handle) {
+        return nil;
+    }
+
+    NSData *chunk = nil;
+    @try {
+        [handle seekToFileOffset:self.committedLength];
+        chunk = [handle readDataOfLength:_chunkSize];
+    } @catch (NSException *exception) {
+        // NSFileHandle reports I/O errors by raising.
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSLocalizedDescriptionKey: [exception reason] ?: @"The file could not be read."}];
+        }
+    } @finally {
+        [handle closeFile];
+    }
+    return chunk;
+}
+
+#pragma mark - Persistence
+
+- (void)_save;
+{
+    NSDictionary *state = @{CMResumableUploadIdentifierKey: _uploadIdentifier,
+                            CMResumableUploadKeyKey: _key,
+                            CMResumableUploadChunkSizeKey: @(_chunkSize),
+                            CMResumableUploadCommittedLengthKey: @(self.committedLength),
+                            CMResumableUploadUpdatedKey: [NSDate date]};
+    [[self class] _updateStates:^(NSMutableDictionary *states) {
+        [states setObject:state forKey:self.stateKey];
+    }];
+}
+
+- (void)remove;
+{
+    [[self class] _updateStates:^(NSMutableDictionary *states) {
+        [states removeObjectForKey:self.stateKey];
+    }];
+}
+
+@end
@@ -0,0 +1,83 @@
+//
+//  CMRevalidationCache.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+/** @file */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Keeps the last response to each GET that came with an <tt>ETag</tt> or <tt>Last-Modified</tt> header, so that the
+ * next identical GET can be sent with <tt>If-None-Match</tt> and <tt>If-Modified-Since</tt> and a <tt>304 Not
+ * Modified</tt> answered from here, without transferring the body again. Responses are keyed by URL and session token,
+ * so users never see each other's. Bodies are kept on disk, up to <tt>byteLimit</tt>; the parsed form of object bodies
+ * is also kept in memory for as long as the system allows, so a revalidated response usually isn't parsed again either.
+ *
+ * All methods are safe to call from any thread.
+ */
+@interface CMRevalidationCache : NSObject
+
+/**
+ * The cache <tt>CMWebService</tt> uses by default, kept in the app's caches directory.
+ */
++ (instancetype)sharedCache;
+
+/**
+ * Creates a cache keeping its responses in the given directory, which is created if needed.
+ *
+ * This is the designated initializer.
+ *
+ * @param directory The directory to keep responses in.
+ */
+- (instancetype)initWithDirectory:(NSString *)directory NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/** The directory responses are kept in. */
+@property (nonatomic, readonly, copy) NSString *directory;
+
+/**
+ * The most bytes of bodies kept on disk. Once a new response takes the total over it, the responses used least recently
+ * are forgotten until it fits again, and a body larger than it isn't kept at all. Defaults to 10 MB.
+ */
+@property (nonatomic, assign) unsigned long long byteLimit;
+
+/**
+ * Returns <tt>request</tt> with conditional headers for the response kept for it, or <tt>request</tt> itself if none
+ * is kept or it isn't a GET.
+ */
+- (NSURLRequest *)conditionalRequestForRequest:(NSURLRequest *)request;
+
+/**
+ * Keeps a successful response for the given request if it carries a validator, and forgets any kept before otherwise.
+ *
+ * @param data The body of the response.
+ * @param parsedObject The parsed body for JSON or MessagePack responses, or <tt>nil</tt>.
+ * @param response The response.
+ * @param request The request as it was made, without conditional headers.
+ */
+- (void)storeData:(NSData *)data parsedObject:(id)parsedObject forResponse:(NSHTTPURLResponse *)response request:(NSURLRequest *)request;
+
+/**
+ * Returns the body kept for a request the server answered with <tt>304 Not Modified</tt>. The headers of the
+ * <tt>304</tt> replace those kept with the response, as they are newer.
+ *
+ * @param response The <tt>304</tt> response.
+ * @param request The request as it was made, without conditional headers.
+ * @param parsed Whether to return the parsed body rather than its bytes. It is only parsed if it isn't in memory, in the
+ * format its <tt>Content-Type</tt> names.
+ * @param headers Set to the headers of the kept response.
+ * @return The kept body, or <tt>nil</tt> if there is none.
+ */
+- (id)bodyForNotModifiedResponse:(NSHTTPURLResponse *)response request:(NSURLRequest *)request parsed:(BOOL)parsed headers:(NSDictionary **)headers;
+
+/**
+ * Forgets every response.
+ */
+- (void)removeAllResponses;
+
+@end
@@ -0,0 +1,282 @@
+//
+//  CMRevalidationCache.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import <CommonCrypto/CommonDigest.h>
+
+#import "CMRevalidationCache.h"
+#import "CMBodyCodec.h"
+
+static NSString * const CMRevalidationCacheKeyKey = @"key";
+static NSString * const CMRevalidationCacheETagKey = @"etag";
+static NSString * const CMRevalidationCacheLastModifiedKey = @"lastModified";
+static NSString * const CMRevalidationCacheHeadersKey = @"headers";
+
+static unsigned long long const CMRevalidationCacheDefaultByteLimit = 10 * 1024 * 1024;
+
+@implementation CMRevalidationCache {
+    NSCache *_parsedObjects;
+    // The bytes of bodies on disk, counted from the directory the first time it's needed and kept up to date after.
+    unsigned long long _totalBytes;
+    BOOL _totalBytesCounted;
+}
+
++ (instancetype)sharedCache;
+{
+    static CMRevalidationCache *_sharedCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+        _sharedCache = [[self alloc] initWithDirectory:[caches stringByAppendingPathComponent:@"CMRevalidationCache"]];
+    });
+    return _sharedCache;
+}
+
+- (instancetype)initWithDirectory:(NSString *)directory;
+{
+    NSParameterAssert(directory);
+
+    if (self = [super init]) {
+        _directory = [directory copy];
+        _parsedObjects = [[NSCache alloc] init];
+        _byteLimit = CMRevalidationCacheDefaultByteLimit;
+        [[NSFileManager defaultManager] createDirectoryAtPath:_directory withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+    return self;
+}
+
+#pragma mark - Keys
+
+- (NSString *)_keyForRequest:(NSURLRequest *)request;
+{
+    return [NSString stringWithFormat:@"%@ %@", [[request URL] absoluteString], [request valueForHTTPHeaderField:@"X-CloudMine-SessionToken"] ?: @""];
+}
+
+/** The path of an entry without its extension. Keys are hashed since URLs don't make valid file names. */
+- (NSString *)_basePathForKey:(NSString *)key;
+{
+    NSData *bytes = [key dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1(bytes.bytes, (CC_LONG)bytes.length, digest);
+
+    NSMutableString *name = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_SHA1_DIGEST_LENGTH; i++) {
+        [name appendFormat:@"%02x", digest[i]];
+    }
+    return [_directory stringByAppendingPathComponent:name];
+}
+
+- (NSDictionary *)_entryForKey:(NSString *)key;
+{
+    NSDictionary *entry = [NSDictionary dictionaryWithContentsOfFile:[[self _basePathForKey:key] stringByAppendingPathExtension:@"plist"]];
+    return [[entry objectForKey:CMRevalidationCacheKeyKey] isEqualToString:key] ? entry : nil;
+}
+
+#pragma mark - Revalidating
+
+- (NSURLRequest *)conditionalRequestForRequest:(NSURLRequest *)request;
+{
+    if (![[request HTTPMethod] isEqualToString:@"GET"]) {
+        return request;
+    }
+
+    NSDictionary *entry = nil;
+    @synchronized(self) {
+        entry = [self _entryForKey:[self _keyForRequest:request]];
+    }
+    if (!entry) {
+        return request;
+    }
+
+    NSMutableURLRequest *conditionalRequest = [request mutableCopy];
+    // The system's own cache would otherwise answer or revalidate on its own and hide the 304.
+    conditionalRequest.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    NSString *etag = [entry objectForKey:CMRevalidationCacheETagKey];
+    if (etag) {
+        [conditionalRequest setValue:etag forHTTPHeaderField:@"If-None-Match"];
+    }
+    NSString *lastModified = [entry objectForKey:CMRevalidationCacheLastModifiedKey];
+    if (lastModified) {
+        [conditionalRequest setValue:lastModified forHTTPHeaderField:@"If-Modified-Since"];
+    }
+    return conditionalRequest;
+}
+
+- (void)storeData:(NSData *)data parsedObject:(id)parsedObject forResponse:(NSHTTPURLResponse *)response request:(NSURLRequest *)request;
+{
+    if (![[request HTTPMethod] isEqualToString:@"GET"]) {
+        return;
+    }
+
+    NSString *key = [self _keyForRequest:request];
+    NSString *basePath = [self _basePathForKey:key];
+    NSDictionary *headers = [response allHeaderFields];
+    NSString *etag = [headers objectForKey:@"ETag"];
+    NSString *lastModified = [headers objectForKey:@"Last-Modified"];
+
+    @synchronized(self) {
+        if (!data || (!etag && !lastModified) || data.length > self.byteLimit) {
+            [self _removeEntryForKey:key];
+            return;
+        }
+
+        NSMutableDictionary *entry = [NSMutableDictionary dictionaryWithObjectsAndKeys:key, CMRevalidationCacheKeyKey, headers, CMRevalidationCacheHeadersKey, nil];
+        if (etag) {
+            [entry setObject:etag forKey:CMRevalidationCacheETagKey];
+        }
+        if (lastModified) {
+            [entry setObject:lastModified forKey:CMRevalidationCacheLastModifiedKey];
+        }
+
+        [self _countTotalBytesIfNeeded];
+        _totalBytes -= MIN(_totalBytes, [self _bodyBytesAtBasePath:basePath]);
+
+        // The body goes first so an entry is never without one.
+        if (![data writeToFile:[basePath stringByAppendingPathExtension:@"body"] atomically:YES] ||
+            ![entry writeToFile:[basePath stringByAppendingPathExtension:@"plist"] atomically:YES]) {
+            NSLog(@"CloudMine *** Could not keep the response to %@ for revalidation", [request URL]);
+            // Whichever body is left is counted again, so removing it keeps the total right.
+            _totalBytes += [self _bodyBytesAtBasePath:basePath];
+            [self _removeEntryForKey:key];
+            return;
+        }
+        _totalBytes += data.length;
+
+        if (parsedObject) {
+            [_parsedObjects setObject:parsedObject forKey:key cost:data.length];
+        } else {
+            [_parsedObjects removeObjectForKey:key];
+        }
+        if (_totalBytes > self.byteLimit) {
+            [self _trimToByteLimit];
+        }
+    }
+}
+
+/** Must be called while synchronized on the receiver. */
+- (void)_removeEntryForKey:(NSString *)key;
+{
+    NSString *basePath = [self _basePathForKey:key];
+    [_parsedObjects removeObjectForKey:key];
+    if (_totalBytesCounted) {
+        _totalBytes -= MIN(_totalBytes, [self _bodyBytesAtBasePath:basePath]);
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:[basePath stringByAppendingPathExtension:@"plist"] error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:[basePath stringByAppendingPathExtension:@"body"] error:nil];
+}
+
+/** Must be called while synchronized on the receiver. */
+- (unsigned long long)_bodyBytesAtBasePath:(NSString *)basePath;
+{
+    return [[[NSFileManager defaultManager] attributesOfItemAtPath:[basePath stringByAppendingPathExtension:@"body"] error:nil] fileSize];
+}
+
+/** Must be called while synchronized on the receiver. */
+- (void)_countTotalBytesIfNeeded;
+{
+    if (_totalBytesCounted) {
+        return;
+    }
+    _totalBytes = 0;
+    for (NSString *name in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_directory error:nil]) {
+        if ([[name pathExtension] isEqualToString:@"body"]) {
+            _totalBytes += [self _bodyBytesAtBasePath:[_directory stringByAppendingPathComponent:[name stringByDeletingPathExtension]]];
+        }
+    }
+    _totalBytesCounted = YES;
+}
+
+/**
+ * Forgets the responses used least recently until the bodies kept fit in <tt>byteLimit</tt>. An entry is rewritten
+ * each time it answers a <tt>304</tt>, so its modification date is when it was last used. Only called once the
+ * running total is over the limit, since it looks at every entry. Must be called while synchronized on the receiver.
+ */
+- (void)_trimToByteLimit;
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSMutableArray *entries = [NSMutableArray array];
+    unsigned long long totalBytes = 0;
+    for (NSString *name in [fileManager contentsOfDirectoryAtPath:_directory error:nil]) {
+        if (![[name pathExtension] isEqualToString:@"plist"]) {
+            continue;
+        }
+        NSString *basePath = [_directory stringByAppendingPathComponent:[name stringByDeletingPathExtension]];
+        NSDate *lastUsed = [[fileManager attributesOfItemAtPath:[basePath stringByAppendingPathExtension:@"plist"] error:nil] fileModificationDate];
+        unsigned long long bytes = [[fileManager attributesOfItemAtPath:[basePath stringByAppendingPathExtension:@"body"] error:nil] fileSize];
+        [entries addObject:@{@"path": basePath, @"lastUsed": lastUsed ?: [NSDate distantPast], @"bytes": @(bytes)}];
+        totalBytes += bytes;
+    }
+    if (totalBytes <= self.byteLimit) {
+        return;
+    }
+
+    [entries sortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"lastUsed" ascending:YES]]];
+    for (NSDictionary *entry in entries) {
+        if (totalBytes <= self.byteLimit) {
+            break;
+        }
+        NSString *basePath = [entry objectForKey:@"path"];
+        NSString *key = [[NSDictionary dictionaryWithContentsOfFile:[basePath stringByAppendingPathExtension:@"plist"]] objectForKey:CMRevalidationCacheKeyKey];
+        if (key) {
+            [_parsedObjects removeObjectForKey:key];
+        }
+        [fileManager removeItemAtPath:[basePath stringByAppendingPathExtension:@"plist"] error:nil];
+        [fileManager removeItemAtPath:[basePath stringByAppendingPathExtension:@"body"] error:nil];
+        totalBytes -= [[entry objectForKey:@"bytes"] unsignedLongLongValue];
+    }
+    _totalBytes = totalBytes;
+}
+
+- (id)bodyForNotModifiedResponse:(NSHTTPURLResponse *)response request:(NSURLRequest *)request parsed:(BOOL)parsed headers:(NSDictionary **)headers;
+{
+    NSString *key = [self _keyForRequest:request];
+    NSString *basePath = [self _basePathForKey:key];
+
+    @synchronized(self) {
+        NSMutableDictionary *entry = [[self _entryForKey:key] mutableCopy];
+        if (!entry) {
+            return nil;
+        }
+
+        NSMutableDictionary *mergedHeaders = [NSMutableDictionary dictionaryWithDictionary:[entry objectForKey:CMRevalidationCacheHeadersKey]];
+        [mergedHeaders addEntriesFromDictionary:[response allHeaderFields]];
+        if (headers) {
+            *headers = mergedHeaders;
+        }
+
+        id body = parsed ? [_parsedObjects objectForKey:key] : nil;
+        if (!body) {
+            NSData *data = [NSData dataWithContentsOfFile:[basePath stringByAppendingPathExtension:@"body"] options:NSDataReadingMappedIfSafe error:NULL];
+            id<CMBodyCodec> codec = CMBodyCodecForContentType([mergedHeaders objectForKey:@"Content-Type"]);
+            body = (parsed && data) ? [codec objectWithData:data error:NULL] : data;
+            if (parsed && body) {
+                [_parsedObjects setObject:body forKey:key cost:data.length];
+            }
+        }
+
+        [entry setObject:mergedHeaders forKey:CMRevalidationCacheHeadersKey];
+        NSString *etag = [[response allHeaderFields] objectForKey:@"ETag"];
+        if (etag) {
+            [entry setObject:etag forKey:CMRevalidationCacheETagKey];
+        }
+        [entry writeToFile:[basePath stringByAppendingPathExtension:@"plist"] atomically:YES];
+        return body;
+    }
+}
+
+- (void)removeAllResponses;
+{
+    @synchronized(self) {
+        [_parsedObjects removeAllObjects];
+        _totalBytes = 0;
+        _totalBytesCounted = YES;
+        [[NSFileManager defaultManager] removeItemAtPath:_directory error:nil];
+        [[NSFileManager defaultManager] createDirectoryAtPath:_directory withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+}
+
+@end
@@ -0,0 +1,45 @@
+//
+//  CMSessionRequestOperation.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+/** @file */
+
+#import <AFNetworking/AFNetworking.h>
+
+/**
+ * An <tt>AFHTTPRequestOperation</tt> that runs its request as a data task on a shared <tt>NSURLSession</tt> instead of
+ * opening its own <tt>NSURLConnection</tt>. Every operation created for the same session shares its connection pool, so
+ * requests to the same host are multiplexed over a single HTTP/2 connection whenever the server negotiates it.
+ *
+ * The operation still lives on <tt>CMWebService</tt>'s <tt>operationQueue</tt>, so queue priorities, concurrency limits
+ * and cancellation behave exactly as they do for connection-based operations. The response body is always held in memory;
+ * <tt>outputStream</tt> is ignored.
+ */
+@interface CMSessionRequestOperation : AFHTTPRequestOperation
+
+/**
+ * The session manager whose session runs the request.
+ */
+@property (readonly, nonatomic, strong) AFURLSessionManager *sessionManager;
+
+/**
+ * The data task running the request, or <tt>nil</tt> if the operation hasn't started yet.
+ */
+@property (readonly, nonatomic, strong) NSURLSessionDataTask *dataTask;
+
+/**
+ * Initializes an operation that will run the given request on the session of the given manager. The manager's response
+ * serializer must hand back the raw response data; the operation's own <tt>responseSerializer</tt> is applied afterwards.
+ *
+ * This is the designated initializer.
+ *
+ * @param urlRequest The request to run.
+ * @param sessionManager The session manager whose session runs the request.
+ */
+- (instancetype)initWithRequest:(NSURLRequest *)urlRequest sessionManager:(AFURLSessionManager *)sessionManager;
+
+@end
@@ -0,0 +1,156 @@
+//
+//  CMSessionRequestOperation.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMSessionRequestOperation.h"
+
+typedef NS_ENUM(NSInteger, CMSessionRequestOperationState) {
+    CMSessionRequestOperationStateReady = 0,
+    CMSessionRequestOperationStateExecuting,
+    CMSessionRequestOperationStateFinished
+};
+
+@interface CMSessionRequestOperation ()
+@property (readwrite, nonatomic, strong) AFURLSessionManager *sessionManager;
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *dataTask;
+@property (nonatomic, assign) CMSessionRequestOperationState sessionState;
+@property (nonatomic, assign) BOOL sessionCancelled;
+@property (nonatomic, strong) NSHTTPURLResponse *sessionResponse;
+@property (nonatomic, strong) NSData *sessionResponseData;
+@property (nonatomic, strong) NSError *sessionError;
+@end
+
+@implementation CMSessionRequestOperation
+
+- (instancetype)initWithRequest:(NSURLRequest *)urlRequest sessionManager:(AFURLSessionManager *)sessionManager {
+    NSParameterAssert(sessionManager);
+
+    if ((self = [super initWithRequest:urlRequest])) {
+        self.sessionManager = sessionManager;
+        self.sessionState = CMSessionRequestOperationStateReady;
+    }
+    return self;
+}
+
+#pragma mark - Operation state
+
+- (void)setSessionState:(CMSessionRequestOperationState)sessionState {
+    [self willChangeValueForKey:@"isExecuting"];
+    [self willChangeValueForKey:@"isFinished"];
+    _sessionState = sessionState;
+    [self didChangeValueForKey:@"isFinished"];
+    [self didChangeValueForKey:@"isExecuting"];
+}
+
+- (BOOL)isExecuting {
+    @synchronized(self) {
+        return self.sessionState == CMSessionRequestOperationStateExecuting;
+    }
+}
+
+- (BOOL)isFinished {
+    @synchronized(self) {
+        return self.sessionState == CMSessionRequestOperationStateFinished;
+    }
+}
+
+- (BOOL)isCancelled {
+    @synchronized(self) {
+        return self.sessionCancelled;
+    }
+}
+
+- (BOOL)isPaused {
+    return NO;
+}
+
+#pragma mark - Running the request
+
+- (void)start {
+    @synchronized(self) {
+        if (self.sessionState != CMSessionRequestOperationStateReady) {
+            return;
+        }
+
+        if (self.sessionCancelled) {
+            NSDictionary *userInfo = self.request.URL ? [NSDictionary dictionaryWithObject:self.request.URL forKey:NSURLErrorFailingURLErrorKey] : nil;
+            self.sessionError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:userInfo];
+            self.sessionState = CMSessionRequestOperationStateFinished;
+            return;
+        }
+
+        self.dataTask = [self.sessionManager dataTaskWithRequest:self.request completionHandler:^(NSURLResponse *response, id responseObject, NSError *error) {
+            [self finishWithResponse:response data:responseObject error:error];
+        }];
+
+        // With HTTP/2 the task priority becomes the stream priority, so keep it in line with the queue priority.
+        if (self.queuePriority < NSOperationQueuePriorityNormal) {
+            self.dataTask.priority = NSURLSessionTaskPriorityLow;
+        } else if (self.queuePriority > NSOperationQueuePriorityNormal) {
+            self.dataTask.priority = NSURLSessionTaskPriorityHigh;
+        }
+
+        self.sessionState = CMSessionRequestOperationStateExecuting;
+        [self.dataTask resume];
+    }
+}
+
+- (void)finishWithResponse:(NSURLResponse *)response data:(NSData *)data error:(NSError *)error {
+    @synchronized(self) {
+        self.sessionResponse = [response isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse *)response : nil;
+        self.sessionResponseData = [data isKindOfClass:[NSData class]] ? data : nil;
+        self.sessionError = error;
+        self.sessionState = CMSessionRequestOperationStateFinished;
+    }
+}
+
+- (void)cancel {
+    @synchronized(self) {
+        if (self.sessionState == CMSessionRequestOperationStateFinished || self.sessionCancelled) {
+            return;
+        }
+
+        [self willChangeValueForKey:@"isCancelled"];
+        self.sessionCancelled = YES;
+        [self didChangeValueForKey:@"isCancelled"];
+
+        // A running task reports the cancellation through its completion handler; one that never started fails in -start.
+        [self.dataTask cancel];
+    }
+}
+
+- (void)pause {
+    // Session tasks are suspended by the session itself; pausing an individual operation isn't supported.
+}
+
+- (void)resume {
+}
+
+#pragma mark - Response
+
+- (NSHTTPURLResponse *)response {
+    @synchronized(self) {
+        return self.sessionResponse;
+    }
+}
+
+- (NSData *)responseData {
+    @synchronized(self) {
+        return self.sessionResponseData;
+    }
+}
+
+- (NSError *)error {
+    NSError *transportError = nil;
+    @synchronized(self) {
+        transportError = self.sessionError;
+    }
+    // Falls back to the response serialization error, if any.
+    return transportError ?: [super error];
+}
+
+@end
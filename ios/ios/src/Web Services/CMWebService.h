@@ -18,6 +18,8 @@
 #import <AFNetworking/AFNetworking.h>
 
 @class CMUser;
+@class CMRevalidationCache;
+@protocol CMBodyCodec;
 @class CMServerFunction;
 @class CMPagingDescriptor;
 @class CMSortDescriptor;
@@ -35,6 +37,13 @@ typedef void (^CMWebServiceErorCallack)(id responseBody, NSUInteger httpCode, NS
  */
 typedef void (^CMWebServiceObjectFetchSuccessCallback)(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers);
 
+/**
+ * Callback block signature for object fetches on <tt>CMWebService</tt> whose results are streamed. The block is called
+ * with the key and dictionary representation of each object as soon as it has been read from the response, on a
+ * background queue.
+ */
+typedef void (^CMWebServiceObjectEntryCallback)(NSString *key, NSDictionary *representation);
+
 /**
  * Callback block signature for <b>all</b> operations on <tt>CMWebService</tt> that can fail. These are general
  * errors that cause the entire call to fail, not key-specific errors (which are reported instead in
@@ -66,6 +75,20 @@ typedef CMWebServiceFetchFailureCallback CMWebServiceSnippetRunFailureCallback;
  */
 typedef void (^CMWebServiceFileFetchSuccessCallback)(NSData *data, NSString *contentType, NSDictionary *headers);
 
+/**
+ * Callback block signature for operations on <tt>CMWebService</tt> that download binary files from the CloudMine
+ * servers straight to disk. These blocks return <tt>void</tt> and take the URL the file was written to, the content type
+ * of the file returned from the server and all the headers of the response.
+ */
+typedef void (^CMWebServiceFileDownloadSuccessCallback)(NSURL *location, NSString *contentType, NSDictionary *headers);
+
+/**
+ * Callback block signature for reporting the progress of transfers to and from the CloudMine servers. These blocks
+ * return <tt>void</tt> and take the number of bytes transferred so far and the number expected in total, which is
+ * <tt>NSURLResponseUnknownLength</tt> when the server didn't say.
+ */
+typedef void (^CMWebServiceProgressCallback)(long long totalBytesTransferred, long long totalBytesExpected);
+
 /**
  * Callback block signature for all operations on <tt>CMWebService</tt> and <tt>CMUser</tt> that involve the management
  * of user accounts and user sessions. These blocks return <tt>void</tt> and take a <tt>CMUserAccountResult</tt> code
@@ -88,6 +111,67 @@ typedef void (^CMWebServicesSocialQuerySuccessCallback)(NSString *results, NSDic
 
 typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSUInteger httpCode);
 
+/**
+ * Controls how <tt>CMWebService</tt> turns JSON response bodies into Foundation objects. Regardless of the mode,
+ * every response is parsed exactly once and the result is shared by all of the request execution paths.
+ */
+typedef NS_ENUM(NSInteger, CMWebServiceResponseSerialization) {
+    /** The body is parsed by the response serializer on AFNetworking's processing queue. This is the default. */
+    CMWebServiceResponseSerializationParsedOnce = 0,
+    /** The raw bytes are kept and parsed only when the response is handled. */
+    CMWebServiceResponseSerializationRawData,
+    /**
+     * The body is spooled to a temporary file as it arrives instead of accumulating in memory while it downloads, then
+     * parsed from that file. <tt>NSJSONSerialization</tt> still reads the whole body into memory to parse it, so this
+     * bounds the memory held by responses in flight rather than the peak of parsing one.
+     */
+    CMWebServiceResponseSerializationStreamed
+};
+
+/**
+ * The kind of CloudMine traffic a request belongs to. Every request started by <tt>CMWebService</tt> is tagged
+ * from the endpoint it calls, and each tag has its own queue priority and quality of service.
+ */
+typedef NS_ENUM(NSInteger, CMWebServiceRequestTag) {
+    /** Requests that don't fall into any other category, such as push notification registration. */
+    CMWebServiceRequestTagDefault = 0,
+    /** Object and ACL fetches, searches, saves and deletes. */
+    CMWebServiceRequestTagObject,
+    /** User account and profile requests. */
+    CMWebServiceRequestTagUser,
+    /** Binary file uploads and downloads. */
+    CMWebServiceRequestTagFile,
+    /** Direct server-side code snippet execution. */
+    CMWebServiceRequestTagSnippet
+};
+
+/**
+ * The networking engine <tt>CMWebService</tt> runs its requests on.
+ */
+typedef NS_ENUM(NSInteger, CMWebServiceTransport) {
+    /** Each request opens its own <tt>NSURLConnection</tt>. This is the default. */
+    CMWebServiceTransportConnection = 0,
+    /**
+     * Requests run as data tasks on a single shared <tt>NSURLSession</tt>. Connections are pooled and reused, and
+     * requests to the same host are multiplexed over one HTTP/2 connection when the server negotiates it (iOS 9 and
+     * later, over TLS). Response bodies are always held in memory, so
+     * <tt>CMWebServiceResponseSerializationStreamed</tt> behaves like <tt>CMWebServiceResponseSerializationRawData</tt>.
+     */
+    CMWebServiceTransportSession
+};
+
+/**
+ * How large JSON request bodies are compressed before they are sent.
+ */
+typedef NS_ENUM(NSInteger, CMWebServiceRequestCompression) {
+    /** Bodies are sent as they are. This is the default. */
+    CMWebServiceRequestCompressionNone = 0,
+    /** Bodies are sent with <tt>Content-Encoding: gzip</tt>. */
+    CMWebServiceRequestCompressionGzip,
+    /** Bodies are sent with <tt>Content-Encoding: deflate</tt>, in the zlib format. */
+    CMWebServiceRequestCompressionDeflate
+};
+
 /**
  * Base class for all classes concerned with the communication between the client device and the CloudMine
  * web services.
@@ -99,6 +183,83 @@ typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSU
 
 + (CMWebService *)sharedWebService;
 
+/**
+ * How JSON response bodies are read and parsed. Defaults to <tt>CMWebServiceResponseSerializationParsedOnce</tt>.
+ * Changing this replaces the <tt>responseSerializer</tt> used for requests started afterwards.
+ *
+ * @see CMWebServiceResponseSerialization
+ */
+@property (nonatomic, assign) CMWebServiceResponseSerialization responseSerialization;
+
+/**
+ * The maximum number of requests that may be in flight at once. Requests beyond this limit wait in
+ * <tt>operationQueue</tt>, ordered by the priority of their tag. Defaults to 4.
+ *
+ * With <tt>CMWebServiceTransportSession</tt> this is also the session's connection limit per host. Changing it starts a
+ * new session for later requests; requests already queued finish on the old one.
+ */
+@property (nonatomic, assign) NSInteger maxConcurrentRequests;
+
+/**
+ * The engine requests started afterwards run on. Defaults to <tt>CMWebServiceTransportConnection</tt>. Queueing,
+ * priorities and cancellation work the same way on either engine.
+ *
+ * @see CMWebServiceTransport
+ */
+@property (nonatomic, assign) CMWebServiceTransport transport;
+
+/**
+ * The queue on which the callbacks of every request are called, asynchronously. If <tt>NULL</tt> (the default), the
+ * main queue is used. Responses are always read and parsed on a private serial queue, so pointing this at a
+ * background queue keeps requests off the main thread entirely.
+ */
+@property (nonatomic, strong) dispatch_queue_t completionQueue;
+
+/**
+ * If <tt>YES</tt> (the default), a GET for objects or a file that is identical to one still in flight, down to the
+ * URL and the user it is made for, isn't sent again. It waits for the response of the first one instead, which is
+ * read and parsed once and handed to every caller.
+ */
+@property (nonatomic, assign) BOOL coalescesIdenticalRequests;
+
+/**
+ * Where responses to object, user profile and binary data GETs are kept for revalidation. When a kept response
+ * carries an <tt>ETag</tt> or <tt>Last-Modified</tt> header, the next identical GET is sent with the matching
+ * conditional headers, and a <tt>304 Not Modified</tt> is answered from the kept response without the body being
+ * transferred again. Binary data larger than the cache's <tt>byteLimit</tt> is never kept, and neither are downloads
+ * to a file. Every kept response is forgotten when a user logs out.
+ *
+ * <tt>nil</tt> by default, so the full response is always fetched. Set it to <tt>+[CMRevalidationCache sharedCache]</tt>
+ * to revalidate.
+ */
+@property (nonatomic, strong) CMRevalidationCache *revalidationCache;
+
+/**
+ * How the bodies of object updates and replacements (<tt>updateValuesFromDictionary:</tt>,
+ * <tt>setValuesFromDictionary:</tt> and their object-based forms) larger than <tt>requestCompressionThreshold</tt> are
+ * compressed. Defaults to <tt>CMWebServiceRequestCompressionNone</tt>. Responses are always negotiated with
+ * <tt>Accept-Encoding: gzip, deflate</tt> and decompressed transparently, except for files downloaded straight to disk,
+ * which are fetched uncompressed so their progress matches their size.
+ *
+ * @see CMWebServiceRequestCompression
+ */
+@property (nonatomic, assign) CMWebServiceRequestCompression requestCompression;
+
+/**
+ * The size in bytes above which request bodies are compressed, if <tt>requestCompression</tt> is set. Smaller bodies
+ * gain little and are sent as they are. Defaults to 16 KB.
+ */
+@property (nonatomic, assign) NSUInteger requestCompressionThreshold;
+
+/**
+ * The wire format of object fetches and saves: their request bodies are encoded with it, and the server is asked to
+ * answer in it. Responses are decoded according to the <tt>Content-Type</tt> they actually come with, so a server
+ * that only speaks JSON still works. Every other request, such as for users, ACLs or snippets, stays JSON.
+ * Defaults to <tt>+[CMJSONBodyCodec codec]</tt>; set <tt>+[CMMessagePackBodyCodec codec]</tt> for MessagePack.
+ *
+ * @see CMBodyCodec
+ */
+@property (nonatomic, strong) id<CMBodyCodec> bodyCodec;
 
 /**
  * Default initializer for the web service connector. You <strong>must</strong> have already configured the
@@ -169,6 +330,33 @@ typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSU
           successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
             errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
 
+/**
+ * Asynchronously retrieve objects like <tt>getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:</tt>,
+ * but hand each one to <tt>entryHandler</tt> as the response is read instead of collecting them. A JSON response is
+ * spooled and parsed one object at a time, so however many objects it holds, only about one of them is in memory at
+ * once. The <tt>successHandler</tt> is called afterwards with an empty dictionary of results.
+ *
+ * Streamed fetches are never coalesced with identical requests or revalidated, since neither keeps up with a response
+ * that isn't kept whole.
+ *
+ * @param keys The keys to fetch.
+ * @param function The server-side code snippet and related options to execute with this request, or nil if none.
+ * @param user The user whose data to fetch. If nil, fetches app-level objects.
+ * @param entryHandler The block to be called with each object, in the order of the response.
+ * @param successHandler The block to be called once every object has been handed to <tt>entryHandler</tt>.
+ * @param errorHandler The block to be called if the entire request failed, including when the response is malformed
+ * part of the way through.
+ */
+- (void)getValuesForKeys:(NSArray *)keys
+      serverSideFunction:(CMServerFunction *)function
+           pagingOptions:(CMPagingDescriptor *)paging
+          sortingOptions:(CMSortDescriptor *)sorting
+                    user:(CMUser *)user
+         extraParameters:(NSDictionary *)params
+            entryHandler:(CMWebServiceObjectEntryCallback)entryHandler
+          successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
+            errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
 - (void)searchValuesFor:(NSString *)searchQuery
      serverSideFunction:(CMServerFunction *)function
           pagingOptions:(CMPagingDescriptor *)paging
@@ -208,6 +396,28 @@ typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSU
             successHandler:(CMWebServiceFileFetchSuccessCallback)successHandler
               errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
 
+/**
+ * Asynchronously download a binary file for the named key straight to disk. The body is written to a temporary file
+ * as it arrives, so memory use stays bounded however large the file is, and moved to <tt>url</tt> once complete,
+ * replacing any file already there. On completion, the <tt>successHandler</tt> block will be called with <tt>url</tt>.
+ *
+ * @param key The key of the binary file to fetch.
+ * @param function The server-side code snippet and related options to execute with this request, or nil if none.
+ * @param user The user whose data to fetch. If nil, fetches app-level objects.
+ * @param url The file URL to write the file to.
+ * @param progressHandler The block to be called as the file is downloaded, or nil.
+ * @param successHandler The block to be called when the file has been fully downloaded.
+ * @param errorHandler The block to be called if the request failed. Nothing is left at <tt>url</tt> in that case.
+ */
+- (void)downloadBinaryDataNamed:(NSString *)key
+             serverSideFunction:(CMServerFunction *)function
+                           user:(CMUser *)user
+                extraParameters:(NSDictionary *)params
+                          toURL:(NSURL *)url
+                progressHandler:(CMWebServiceProgressCallback)progressHandler
+                 successHandler:(CMWebServiceFileDownloadSuccessCallback)successHandler
+                   errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
 /**
  * Asynchronously update one or more objects for the user-level keys included in <tt>data</tt>. On completion, the <tt>successHandler</tt>
  * block will be called with a dictionary of the keys of the objects that were created and updated as well as a dictionary of the
@@ -226,6 +436,28 @@ typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSU
                     successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
                       errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
 
+/**
+ * Asynchronously update one or more objects like <tt>updateValuesFromDictionary:</tt>, encoding them straight into the
+ * format of <tt>bodyCodec</tt> instead of into dictionaries first.
+ *
+ * @param objects The objects to update, which must conform to <tt>CMSerializable</tt>.
+ * @param keysByObjectId The coder keys to send of each object, as an <tt>NSSet</tt> for each object ID, or <tt>nil</tt>.
+ * Objects whose IDs are missing are sent in full.
+ * @param function The server-side code snippet and related options to execute with this request, or nil if none.
+ * @param user The user whose data to write. If nil, writes as app-level objects.
+ * @param successHandler The block to be called when the objects have been populated.
+ * @param errorHandler The block to be called if the entire request failed (i.e. if there is no network connectivity).
+ *
+ * @see updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:
+ */
+- (void)updateValuesFromObjects:(NSArray *)objects
+                           keys:(NSDictionary *)keysByObjectId
+             serverSideFunction:(CMServerFunction *)function
+                           user:(CMUser *)user
+                extraParameters:(NSDictionary *)params
+                 successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
+                   errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
 /**
  * Asynchronously update the specified ACL. On completion, the <tt>successHandler</tt> block will be called with a dictionary containing
  * the object updated.
@@ -286,6 +518,84 @@ typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSU
           successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
             errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
 
+/**
+ * Asynchronously upload the file stored at <tt>path</tt> in chunks of at most <tt>chunkSize</tt> bytes. Only one chunk
+ * is in memory at a time. A chunk that fails because of the connection or a server error is retried on its own, a few
+ * times, before the upload gives up. The progress of the upload is saved to disk, so uploading the same unchanged file
+ * under the same name again, even after the app was relaunched, resumes from the last chunk the server acknowledged.
+ *
+ * The server-side function, if any, runs once, with the last chunk. On completion, the <tt>successHandler</tt> block will
+ * be called just as for <tt>uploadFileAtPath:serverSideFunction:named:ofMimeType:user:extraParameters:successHandler:errorHandler:</tt>.
+ *
+ * @param path The path to the file to upload.
+ * @param key The unique name of this file. If <tt>nil</tt>, a name is generated.
+ * @param mimeType The MIME type of this file. If <tt>nil</tt>, defaults to <tt>application/octet-stream</tt>.
+ * @param user The user whose data to write. If nil, writes as app-level objects.
+ * @param chunkSize The largest number of bytes to send in one request.
+ * @param progressHandler The block to be called as the file is uploaded, or nil.
+ * @param successHandler The block to be called when the whole file has been uploaded.
+ * @param errorHandler The block to be called if the upload failed. Calling this method again resumes it.
+ *
+ * @see CMResumableUpload
+ */
+- (void)uploadFileAtPath:(NSString *)path
+      serverSideFunction:(CMServerFunction *)function
+                   named:(NSString *)key
+              ofMimeType:(NSString *)mimeType
+                    user:(CMUser *)user
+         extraParameters:(NSDictionary *)params
+               chunkSize:(NSUInteger)chunkSize
+         progressHandler:(CMWebServiceProgressCallback)progressHandler
+          successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
+            errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
+/**
+ * Upload the file stored at <tt>path</tt> on the app's background session, so the upload carries on while the app is
+ * suspended or after the system terminated it. The file must stay at <tt>path</tt> until the upload finishes.
+ *
+ * The handlers are only called if the upload finishes before the app is terminated. Either way, and after a relaunch,
+ * <tt>CMBackgroundTransferDidFinishNotification</tt> is posted once it does.
+ *
+ * @param path The path to the file to upload.
+ * @param key The unique name of this file. If <tt>nil</tt>, a key will be generated on the server.
+ * @param mimeType The MIME type of this file. If <tt>nil</tt>, defaults to <tt>application/octet-stream</tt>.
+ * @param user The user whose data to write. If nil, writes as app-level objects.
+ * @param successHandler The block to be called when the file has finished uploading.
+ * @param errorHandler The block to be called if the upload failed.
+ *
+ * @see CMBackgroundTransferService
+ */
+- (void)uploadFileInBackgroundAtPath:(NSString *)path
+                  serverSideFunction:(CMServerFunction *)function
+                               named:(NSString *)key
+                          ofMimeType:(NSString *)mimeType
+                                user:(CMUser *)user
+                     extraParameters:(NSDictionary *)params
+                      successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
+                        errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
+/**
+ * Download a binary file to <tt>url</tt> on the app's background session, replacing any file already there once it is
+ * complete. Like <tt>uploadFileInBackgroundAtPath:serverSideFunction:named:ofMimeType:user:extraParameters:successHandler:errorHandler:</tt>,
+ * the handlers are only called during the same launch, and <tt>CMBackgroundTransferDidFinishNotification</tt> is always posted.
+ *
+ * @param key The key of the binary file to fetch.
+ * @param function The server-side code snippet and related options to execute with this request, or nil if none.
+ * @param user The user whose data to fetch. If nil, fetches app-level objects.
+ * @param url The file URL to write the file to.
+ * @param successHandler The block to be called when the file has been fully downloaded.
+ * @param errorHandler The block to be called if the request failed.
+ *
+ * @see CMBackgroundTransferService
+ */
+- (void)downloadBinaryDataInBackgroundNamed:(NSString *)key
+                         serverSideFunction:(CMServerFunction *)function
+                                       user:(CMUser *)user
+                            extraParameters:(NSDictionary *)params
+                                      toURL:(NSURL *)url
+                             successHandler:(CMWebServiceFileDownloadSuccessCallback)successHandler
+                               errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
 /**
  * Asynchronously create or replace one or more objects for the values of the user-level keys included in <tt>data</tt>. On completion, the <tt>successHandler</tt>
  * block will be called with a dictionary of the keys of the objects that were created and replaced as well as a dictionary of the
@@ -308,6 +618,25 @@ typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSU
                  successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
                    errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
 
+/**
+ * Asynchronously create or replace one or more objects like <tt>setValuesFromDictionary:</tt>, encoding them straight
+ * into the format of <tt>bodyCodec</tt> instead of into dictionaries first.
+ *
+ * @param objects The objects to create or replace, which must conform to <tt>CMSerializable</tt>.
+ * @param function The server-side code snippet and related options to execute with this request, or nil if none.
+ * @param user The user whose data to write. If nil, writes as app-level objects.
+ * @param successHandler The block to be called when the objects have been populated.
+ * @param errorHandler The block to be called if the entire request failed (i.e. if there is no network connectivity).
+ *
+ * @see setValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:
+ */
+- (void)setValuesFromObjects:(NSArray *)objects
+          serverSideFunction:(CMServerFunction *)function
+                        user:(CMUser *)user
+             extraParameters:(NSDictionary *)params
+              successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
+                errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+
 /**
  * Asynchronously delete objects for the named user-level keys. On completion, the <tt>successHandler</tt> block
  * will be called.
@@ -723,5 +1052,35 @@ typedef void (^CMWebServiceResultCallback)(id responseBody, NSError *errors, NSU
  */
 - (void)enqueueHTTPRequestOperation:(AFHTTPRequestOperation *)operation;
 
+/**
+ * Configures how requests with the given tag are scheduled. By default file transfers run at a low priority with
+ * utility quality of service, so they never hold up object, user or snippet requests.
+ *
+ * @param priority The queue priority given to requests with this tag.
+ * @param qualityOfService The quality of service given to requests with this tag.
+ * @param tag The kind of request to configure.
+ */
+- (void)setQueuePriority:(NSOperationQueuePriority)priority qualityOfService:(NSQualityOfService)qualityOfService forRequestTag:(CMWebServiceRequestTag)tag;
+
+/**
+ * Cancels every queued or in-flight request with the given tag. The error handlers of cancelled requests are called
+ * with a <tt>CMErrorServerConnectionFailed</tt> error.
+ *
+ * @param tag The kind of request to cancel.
+ */
+- (void)cancelRequestsWithTag:(CMWebServiceRequestTag)tag;
+
+/**
+ * Cancels every queued or in-flight request started by this web service.
+ */
+- (void)cancelAllRequests;
+
+/**
+ * The tag a request to the given URL is scheduled under.
+ *
+ * @param url The URL of a CloudMine API request.
+ */
+- (CMWebServiceRequestTag)requestTagForURL:(NSURL *)url;
+
 
 @end
@@ -16,6 +16,7 @@
 #import "CMActiveUser.h"
 #import "NSURL+QueryParameterAdditions.h"
 #import "NSDictionary+CMJSON.h"
+#import "NSData+CMCompression.h"
 #import "CMConstants.h"
 #import "CMObjectEncoder.h"
 #import "CMObjectDecoder.h"
@@ -23,6 +24,12 @@
 #import "CMSocialAccountChooser.h"
 #import "CMUserResponse.h"
 #import "CMLegacyCacheCleaner.h"
+#import "CMSessionRequestOperation.h"
+#import "CMResumableUpload.h"
+#import "CMBackgroundTransferService.h"
+#import "CMRevalidationCache.h"
+#import "CMBodyCodec.h"
+#import "CMJSONEntryParser.h"
 
 #import <Accounts/Accounts.h>
 #import <Social/Social.h>
@@ -40,14 +47,28 @@ NSString * const CMErrorDomain = @"CMErrorDomain";
 NSString * const NSURLErrorKey = @"NSURLErrorKey";
 NSString * const JSONErrorKey = @"JSONErrorKey";
 
+static NSString * const CMResponseSpoolPathKey = @"CMResponseSpoolPathKey";
+static NSTimeInterval const CMResponseSpoolMaximumAge = 60.0 * 60.0;
+static NSString * const CMRequestTagKey = @"CMRequestTagKey";
+static NSString * const CMRevalidatedHeadersKey = @"CMRevalidatedHeadersKey";
+static NSInteger const CMDefaultMaxConcurrentRequests = 4;
+static NSUInteger const CMUploadChunkRetryLimit = 4;
+static NSString * const CMUploadIdentifierHeader = @"X-CloudMine-Upload-Id";
+static NSUInteger const CMDefaultRequestCompressionThreshold = 16 * 1024;
+
 @interface CMWebService () {
     NSMutableDictionary *_responseTimes;
+    NSMutableDictionary *_tagPriorities;
+    NSMutableDictionary *_tagQualitiesOfService;
+    NSMutableDictionary *_inFlightRequests;
     __strong CMWebServiceUserAccountOperationCallback temporaryCallback;
 }
 
 @property (nonatomic, copy) NSString *apiUrl;
 @property (nonatomic, strong) ACAccountStore *accountStore;
 @property (nonatomic, strong) CMSocialAccountChooser *picker;
+@property (nonatomic, strong) AFURLSessionManager *sessionManager;
+@property (nonatomic, strong) dispatch_queue_t responseProcessingQueue;
 
 
 @end
@@ -113,7 +134,16 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     _appSecret = appSecret;
     _appIdentifier = appIdentifier;
     _responseTimes = [NSMutableDictionary dictionary];
-    self.responseSerializer = [AFJSONResponseSerializer serializer];
+    _tagPriorities = [NSMutableDictionary dictionary];
+    _tagQualitiesOfService = [NSMutableDictionary dictionary];
+    _inFlightRequests = [NSMutableDictionary dictionary];
+    _coalescesIdenticalRequests = YES;
+    _requestCompressionThreshold = CMDefaultRequestCompressionThreshold;
+    _bodyCodec = [CMJSONBodyCodec codec];
+    self.responseProcessingQueue = dispatch_queue_create("com.cloudmine.webservice.responses", DISPATCH_QUEUE_SERIAL);
+    self.maxConcurrentRequests = CMDefaultMaxConcurrentRequests;
+    [self setQueuePriority:NSOperationQueuePriorityLow qualityOfService:NSQualityOfServiceUtility forRequestTag:CMWebServiceRequestTagFile];
+    self.responseSerialization = CMWebServiceResponseSerializationParsedOnce;
     self.requestSerializer = [AFJSONRequestSerializer serializer];
     
     // Enable activity indicator in status bar
@@ -121,9 +151,23 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
 
     [CMLegacyCacheCleaner cleanLegacyCache];
 
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(userDidLogOut:) name:CMUserDidLogOutNotification object:nil];
+
     return self;
 }
 
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [_sessionManager invalidateSessionCancelingTasks:YES];
+}
+
+/**
+ * Forgets the responses kept for revalidation, since some of them belong to the user who logged out.
+ */
+- (void)userDidLogOut:(NSNotification *)notification {
+    [self.revalidationCache removeAllResponses];
+}
+
 - (void)setApiUrl:(NSString *)apiUrl;
 {
     if (![apiUrl hasSuffix:@"/"]) {
@@ -132,6 +176,45 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     _apiUrl = [apiUrl stringByAppendingString:CM_DEFAULT_API_VERSION];
 }
 
+- (void)setResponseSerialization:(CMWebServiceResponseSerialization)responseSerialization
+{
+    _responseSerialization = responseSerialization;
+    [self updateResponseSerializer];
+    
+    if (responseSerialization == CMWebServiceResponseSerializationStreamed) {
+        [[self class] purgeStaleResponseSpools];
+    }
+}
+
+- (void)setBodyCodec:(id<CMBodyCodec>)bodyCodec;
+{
+    _bodyCodec = bodyCodec ?: [CMJSONBodyCodec codec];
+    [self updateResponseSerializer];
+}
+
+- (void)updateResponseSerializer;
+{
+    if (_responseSerialization == CMWebServiceResponseSerializationParsedOnce && [_bodyCodec isKindOfClass:[CMJSONBodyCodec class]]) {
+        self.responseSerializer = [AFJSONResponseSerializer serializer];
+        return;
+    }
+    
+    // Other formats are always decoded later, since the serializer only knows JSON.
+    self.responseSerializer = [self rawResponseSerializer];
+}
+
+/**
+ * A serializer that validates responses the same way the JSON serializer would, but leaves the body alone so it is
+ * parsed later, once.
+ */
+- (AFHTTPResponseSerializer *)rawResponseSerializer;
+{
+    NSSet *jsonContentTypes = [AFJSONResponseSerializer serializer].acceptableContentTypes;
+    AFHTTPResponseSerializer *rawSerializer = [AFHTTPResponseSerializer serializer];
+    rawSerializer.acceptableContentTypes = [_bodyCodec isKindOfClass:[CMJSONBodyCodec class]] ? jsonContentTypes : [jsonContentTypes setByAddingObject:_bodyCodec.contentType];
+    return rawSerializer;
+}
+
 #pragma mark - GET requests for non-binary data
 
 - (void)getValuesForKeys:(NSArray *)keys
@@ -142,18 +225,39 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
          extraParameters:(NSDictionary *)params
           successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
             errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
-    NSURLRequest *request = [self constructHTTPRequestWithVerb:@"GET"
-                                                           URL:[self constructTextUrlAtUserLevel:(user != nil)
-                                                                                        withKeys:keys
-                                                                                           query:nil
-                                                                                   pagingOptions:paging
-                                                                                  sortingOptions:sorting
-                                                                          withServerSideFunction:function
-                                                                                 extraParameters:params]
-                                                     appSecret:_appSecret
-                                                    binaryData:NO
-                                                          user:user];
-    [self executeRequest:request successHandler:successHandler errorHandler:errorHandler];
+    [self getValuesForKeys:keys
+        serverSideFunction:function
+             pagingOptions:paging
+            sortingOptions:sorting
+                      user:user
+           extraParameters:params
+              entryHandler:nil
+            successHandler:successHandler
+              errorHandler:errorHandler];
+}
+
+- (void)getValuesForKeys:(NSArray *)keys
+      serverSideFunction:(CMServerFunction *)function
+           pagingOptions:(CMPagingDescriptor *)paging
+          sortingOptions:(CMSortDescriptor *)sorting
+                    user:(CMUser *)user
+         extraParameters:(NSDictionary *)params
+            entryHandler:(CMWebServiceObjectEntryCallback)entryHandler
+          successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
+            errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSMutableURLRequest *request = [self constructHTTPRequestWithVerb:@"GET"
+                                                                  URL:[self constructTextUrlAtUserLevel:(user != nil)
+                                                                                               withKeys:keys
+                                                                                                  query:nil
+                                                                                          pagingOptions:paging
+                                                                                         sortingOptions:sorting
+                                                                                 withServerSideFunction:function
+                                                                                        extraParameters:params]
+                                                            appSecret:_appSecret
+                                                           binaryData:NO
+                                                                 user:user];
+    [self useBodyCodecForRequest:request];
+    [self executeRequest:request entryHandler:entryHandler successHandler:successHandler errorHandler:errorHandler];
 }
 
 - (void)getACLsForUser:(CMUser *)user
@@ -177,17 +281,18 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         extraParameters:(NSDictionary *)params
          successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
            errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
-    NSURLRequest *request = [self constructHTTPRequestWithVerb:@"GET"
-                                                           URL:[self constructTextUrlAtUserLevel:(user != nil)
-                                                                                        withKeys:nil
-                                                                                           query:searchQuery
-                                                                                   pagingOptions:paging
-                                                                                  sortingOptions:sorting
-                                                                          withServerSideFunction:function
-                                                                                 extraParameters:params]
-                                                     appSecret:_appSecret
-                                                    binaryData:NO
-                                                          user:user];
+    NSMutableURLRequest *request = [self constructHTTPRequestWithVerb:@"GET"
+                                                                  URL:[self constructTextUrlAtUserLevel:(user != nil)
+                                                                                               withKeys:nil
+                                                                                                  query:searchQuery
+                                                                                          pagingOptions:paging
+                                                                                         sortingOptions:sorting
+                                                                                 withServerSideFunction:function
+                                                                                        extraParameters:params]
+                                                            appSecret:_appSecret
+                                                           binaryData:NO
+                                                                 user:user];
+    [self useBodyCodecForRequest:request];
     [self executeRequest:request successHandler:successHandler errorHandler:errorHandler];
 }
 
@@ -223,6 +328,26 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     [self executeBinaryDataFetchRequest:request successHandler:successHandler errorHandler:errorHandler];
 }
 
+- (void)downloadBinaryDataNamed:(NSString *)key
+             serverSideFunction:(CMServerFunction *)function
+                           user:(CMUser *)user
+                extraParameters:(NSDictionary *)params
+                          toURL:(NSURL *)url
+                progressHandler:(CMWebServiceProgressCallback)progressHandler
+                 successHandler:(CMWebServiceFileDownloadSuccessCallback)successHandler
+                   errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSParameterAssert([url isFileURL]);
+    NSURLRequest *request = [self constructHTTPRequestWithVerb:@"GET"
+                                                           URL:[self constructBinaryUrlAtUserLevel:(user != nil)
+                                                                                           withKey:key
+                                                                            withServerSideFunction:function
+                                                                                   extraParameters:params]
+                                                     appSecret:_appSecret
+                                                    binaryData:NO
+                                                          user:user];
+    [self executeBinaryDataDownloadRequest:request toURL:url progressHandler:progressHandler successHandler:successHandler errorHandler:errorHandler];
+}
+
 #pragma mark - POST (update) requests for non-binary data
 
 - (void)updateValuesFromDictionary:(NSDictionary *)data
@@ -231,18 +356,20 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                    extraParameters:(NSDictionary *)params
                     successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
                       errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
-    NSMutableURLRequest *request = [self constructHTTPRequestWithVerb:@"POST"
-                                                                  URL:[self constructTextUrlAtUserLevel:(user != nil)
-                                                                                               withKeys:nil
-                                                                                                  query:nil
-                                                                                          pagingOptions:nil
-                                                                                         sortingOptions:nil
-                                                                                 withServerSideFunction:function
-                                                                                        extraParameters:params]
-                                                            appSecret:_appSecret
-                                                           binaryData:NO
-                                                                 user:user];
-    [request setHTTPBody:[data jsonData]];
+    NSMutableURLRequest *request = [self objectSaveRequestWithVerb:@"POST" serverSideFunction:function user:user extraParameters:params];
+    [self setBody:[self.bodyCodec dataWithObject:data error:NULL] ofRequest:request];
+    [self executeRequest:request successHandler:successHandler errorHandler:errorHandler];
+}
+
+- (void)updateValuesFromObjects:(NSArray *)objects
+                           keys:(NSDictionary *)keysByObjectId
+             serverSideFunction:(CMServerFunction *)function
+                           user:(CMUser *)user
+                extraParameters:(NSDictionary *)params
+                 successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
+                   errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSMutableURLRequest *request = [self objectSaveRequestWithVerb:@"POST" serverSideFunction:function user:user extraParameters:params];
+    [self setBody:[self.bodyCodec dataWithObjects:objects keys:keysByObjectId] ofRequest:request];
     [self executeRequest:request successHandler:successHandler errorHandler:errorHandler];
 }
 
@@ -280,7 +407,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     if (mimeType.length > 0) {
         [request setValue:mimeType forHTTPHeaderField:@"Content-Type"];
     }
-    [request setHTTPBody:[data mutableCopy]];
+    [request setHTTPBody:data];
     [self executeBinaryDataUploadRequest:request successHandler:successHandler errorHandler:errorHandler];
 }
 
@@ -314,6 +441,103 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     [self executeBinaryDataUploadRequest:request successHandler:successHandler errorHandler:errorHandler];
 }
 
+- (void)uploadFileAtPath:(NSString *)path
+      serverSideFunction:(CMServerFunction *)function
+                   named:(NSString *)key
+              ofMimeType:(NSString *)mimeType
+                    user:(CMUser *)user
+         extraParameters:(NSDictionary *)params
+               chunkSize:(NSUInteger)chunkSize
+         progressHandler:(CMWebServiceProgressCallback)progressHandler
+          successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
+            errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSParameterAssert(chunkSize > 0);
+    
+    CMResumableUpload *upload = [CMResumableUpload uploadForFileAtPath:path named:key ownerIdentifier:user.objectId chunkSize:chunkSize];
+    if (upload.fileSize == 0) {
+        // Nothing to split, and an unreadable file fails the same way it would have on its own.
+        [self uploadFileAtPath:path serverSideFunction:function named:key ofMimeType:mimeType user:user extraParameters:params successHandler:successHandler errorHandler:errorHandler];
+        [upload remove];
+        return;
+    }
+    
+    NSURL *chunkURL = [self constructBinaryUrlAtUserLevel:(user != nil) withKey:upload.key withServerSideFunction:nil extraParameters:params];
+    NSURL *finalURL = [self constructBinaryUrlAtUserLevel:(user != nil) withKey:upload.key withServerSideFunction:function extraParameters:params];
+    
+    // An upload picked up from an earlier attempt first asks the server how much of it arrived.
+    [self sendChunkOfUpload:upload chunkURL:chunkURL finalURL:finalURL mimeType:mimeType user:user queryStatus:(upload.committedLength > 0) attempt:0
+            progressHandler:progressHandler successHandler:successHandler errorHandler:errorHandler];
+}
+
+#pragma mark - Background transfers of binary data
+
+- (void)uploadFileInBackgroundAtPath:(NSString *)path
+                  serverSideFunction:(CMServerFunction *)function
+                               named:(NSString *)key
+                          ofMimeType:(NSString *)mimeType
+                                user:(CMUser *)user
+                     extraParameters:(NSDictionary *)params
+                      successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
+                        errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSMutableURLRequest *request = [self constructHTTPRequestWithVerb:@"PUT"
+                                                                  URL:[self constructBinaryUrlAtUserLevel:(user != nil)
+                                                                                                  withKey:key
+                                                                                   withServerSideFunction:function
+                                                                                          extraParameters:params]
+                                                            appSecret:_appSecret
+                                                           binaryData:YES
+                                                                 user:user];
+    if (mimeType.length > 0) {
+        [request setValue:mimeType forHTTPHeaderField:@"Content-Type"];
+    }
+    
+    [[CMBackgroundTransferService sharedService] uploadFileAtURL:[NSURL fileURLWithPath:path]
+                                                     withRequest:request
+                                                           named:key
+                                                       userLevel:(user != nil)
+                                                  successHandler:^(CMFileUploadResult result, NSString *fileKey, id snippetResult, NSDictionary *headers) {
+                                                      if (successHandler) {
+                                                          [self deliverBlock:^{ successHandler(result, fileKey, snippetResult, headers); }];
+                                                      }
+                                                  } errorHandler:^(NSError *error) {
+                                                      if (errorHandler) {
+                                                          [self deliverBlock:^{ errorHandler(error); }];
+                                                      }
+                                                  }];
+}
+
+- (void)downloadBinaryDataInBackgroundNamed:(NSString *)key
+                         serverSideFunction:(CMServerFunction *)function
+                                       user:(CMUser *)user
+                            extraParameters:(NSDictionary *)params
+                                      toURL:(NSURL *)url
+                             successHandler:(CMWebServiceFileDownloadSuccessCallback)successHandler
+                               errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSParameterAssert([url isFileURL]);
+    NSURLRequest *request = [self constructHTTPRequestWithVerb:@"GET"
+                                                           URL:[self constructBinaryUrlAtUserLevel:(user != nil)
+                                                                                           withKey:key
+                                                                            withServerSideFunction:function
+                                                                                   extraParameters:params]
+                                                     appSecret:_appSecret
+                                                    binaryData:NO
+                                                          user:user];
+    
+    [[CMBackgroundTransferService sharedService] downloadWithRequest:request
+                                                               toURL:url
+                                                               named:key
+                                                           userLevel:(user != nil)
+                                                      successHandler:^(NSURL *location, NSString *contentType, NSDictionary *headers) {
+                                                          if (successHandler) {
+                                                              [self deliverBlock:^{ successHandler(location, contentType, headers); }];
+                                                          }
+                                                      } errorHandler:^(NSError *error) {
+                                                          if (errorHandler) {
+                                                              [self deliverBlock:^{ errorHandler(error); }];
+                                                          }
+                                                      }];
+}
+
 #pragma mark - PUT (replace) requests for non-binary data
 
 - (void)setValuesFromDictionary:(NSDictionary *)data
@@ -322,18 +546,19 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                 extraParameters:(NSDictionary *)params
                  successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
                    errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
-    NSMutableURLRequest *request = [self constructHTTPRequestWithVerb:@"PUT"
-                                                                  URL:[self constructTextUrlAtUserLevel:(user != nil)
-                                                                                               withKeys:nil
-                                                                                                  query:nil
-                                                                                          pagingOptions:nil
-                                                                                         sortingOptions:nil
-                                                                                 withServerSideFunction:function
-                                                                                        extraParameters:params]
-                                                            appSecret:_appSecret
-                                                           binaryData:NO
-                                                                 user:user];
-    [request setHTTPBody:[data jsonData]];
+    NSMutableURLRequest *request = [self objectSaveRequestWithVerb:@"PUT" serverSideFunction:function user:user extraParameters:params];
+    [self setBody:[self.bodyCodec dataWithObject:data error:NULL] ofRequest:request];
+    [self executeRequest:request successHandler:successHandler errorHandler:errorHandler];
+}
+
+- (void)setValuesFromObjects:(NSArray *)objects
+          serverSideFunction:(CMServerFunction *)function
+                        user:(CMUser *)user
+             extraParameters:(NSDictionary *)params
+              successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
+                errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSMutableURLRequest *request = [self objectSaveRequestWithVerb:@"PUT" serverSideFunction:function user:user extraParameters:params];
+    [self setBody:[self.bodyCodec dataWithObjects:objects keys:nil] ofRequest:request];
     [self executeRequest:request successHandler:successHandler errorHandler:errorHandler];
 }
 
@@ -1011,25 +1236,19 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
             [request setHTTPBody:[payload jsonData]];
             
             AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
-                NSString *responseString = [operation responseString];
-                
                 // Parse responsibly. If error is not handled, it will crash the application!
                 NSError *parseErr = nil;
                 NSDictionary *results = [NSDictionary dictionary];
-                if (responseString != nil) {
-                    NSDictionary *parsedResults = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                                  options:0
-                                                                                    error:&parseErr];
-                    if (!parseErr && parsedResults) {
-                        results = parsedResults;
-                    }
+                NSDictionary *parsedResults = [self parsedResponseObject:responseObject forOperation:operation error:&parseErr];
+                if (!parseErr && parsedResults) {
+                    results = parsedResults;
                 }
                 
                 // Handle any service errors, or report success
                 if ([[operation response] statusCode] == 200 && [(NSArray *)results[@"errors"] count] == 0) {
-                    callback(CMUserAccountProfileUpdateSucceeded, results);
+                    [self deliverBlock:^{ callback(CMUserAccountProfileUpdateSucceeded, results); }];
                 } else {
-                    callback(CMUserAccountProfileUpdateFailed, [results objectForKey:@"errors"]);
+                    [self deliverBlock:^{ callback(CMUserAccountProfileUpdateFailed, [results objectForKey:@"errors"]); }];
                 }
             } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
                 if ([[error domain] isEqualToString:NSURLErrorDomain]) {
@@ -1042,7 +1261,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                 NSLog(@"CloudMine *** User profile save operation failed (%@)", [error localizedDescription]);
                 
                 if (callback) {
-                    callback(CMUserAccountProfileUpdateFailed, nil);
+                    [self deliverBlock:^{ callback(CMUserAccountProfileUpdateFailed, nil); }];
                 }
             }];
             
@@ -1050,6 +1269,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                 
             }];
             
+            [self prepareOperationForResponseSerialization:requestOperation];
             [self enqueueHTTPRequestOperation:requestOperation];
         };
         
@@ -1292,15 +1512,13 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     
     NSDate *startDate = [NSDate date];
     
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+    AFHTTPRequestOperation *requestOperation = [self revalidatedHTTPRequestOperationWithRequest:request parsed:YES success:^(AFHTTPRequestOperation *operation, id responseObject) {
         NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
         if (requestId) {
             int milliseconds = (int)([[NSDate date] timeIntervalSinceDate:startDate] * 1000.0f);
             [_responseTimes setObject:[NSNumber numberWithInt:milliseconds] forKey:requestId];
         }
         
-        NSString *responseString = [operation responseString];
-        
         NSError *parseErr = nil;
         NSDictionary *responseBody = [NSDictionary dictionary];
         
@@ -1310,36 +1528,32 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         NSNumber *count = nil;
         id snippetResult = nil;
         
-        if (responseString != nil) {
-            NSDictionary *results = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                    options:0
-                                                                      error:&parseErr];
-            if (!parseErr && results) {
-                responseBody = results;
+        NSDictionary *results = [self parsedResponseObject:responseObject forOperation:operation error:&parseErr];
+        if (!parseErr && results) {
+            responseBody = results;
+        }
+        
+        if (responseBody) {
+            successes = responseBody[@"success"];
+            if (!successes) {
+                successes = @{};
             }
             
-            if (responseBody) {
-                successes = responseBody[@"success"];
-                if (!successes) {
-                    successes = @{};
-                }
-                
-                errors = responseBody[@"errors"];
-                if (!errors) {
-                    errors = @{};
-                }
-                
-                snippetResult = responseBody[@"result"];
-                if(!snippetResult) {
-                    snippetResult = @{};
-                }
-                
-                meta = responseBody[@"meta"];
-                if(!meta) {
-                    meta = @{};
-                }
-                count = [responseBody objectForKey:@"count"];
+            errors = responseBody[@"errors"];
+            if (!errors) {
+                errors = @{};
             }
+            
+            snippetResult = responseBody[@"result"];
+            if(!snippetResult) {
+                snippetResult = @{};
+            }
+            
+            meta = responseBody[@"meta"];
+            if(!meta) {
+                meta = @{};
+            }
+            count = [responseBody objectForKey:@"count"];
         }
         
         if (callback) {
@@ -1349,7 +1563,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                                           meta,
                                           count);
             };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         
@@ -1371,10 +1585,11 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         
         NSLog(@"CloudMine *** User profile fetch operation failed (%@)", [error localizedDescription]);
         if (callback) {
-            callback(nil, nil, nil, nil, nil);
+            [self deliverBlock:^{ callback(nil, nil, nil, nil, nil); }];
         }
     }];
     
+    [self prepareOperationForResponseSerialization:requestOperation];
     [self enqueueHTTPRequestOperation:requestOperation];
 }
 
@@ -1387,31 +1602,25 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     
     NSDate *startDate = [NSDate date];
     
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+    AFHTTPRequestOperation *requestOperation = [self revalidatedHTTPRequestOperationWithRequest:request parsed:YES success:^(AFHTTPRequestOperation *operation, id responseObject) {
         NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
         if (requestId) {
             int milliseconds = (int)([[NSDate date] timeIntervalSinceDate:startDate] * 1000.0f);
             [_responseTimes setObject:[NSNumber numberWithInt:milliseconds] forKey:requestId];
         }
         
-        NSString *responseString = [operation responseString];
-        
         NSError *parseErr = nil;
         NSDictionary *responseBody = [NSDictionary dictionary];
-        if (responseString != nil) {
-            NSDictionary *parsedResponseBody = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                               options:0
-                                                                                 error:&parseErr];
-            if (!parseErr && parsedResponseBody) {
-                responseBody = parsedResponseBody;
-            }
+        NSDictionary *parsedResponseBody = [self parsedResponseObject:responseObject forOperation:operation error:&parseErr];
+        if (!parseErr && parsedResponseBody) {
+            responseBody = parsedResponseBody;
         }
         
         if (callback != nil) {
             void (^block)() = ^{ callback(responseBody[@"success"],
                                           responseBody[@"errors"],
                                           @([(NSArray *)responseBody[@"success"] count])); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
@@ -1430,10 +1639,11 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         
         NSLog(@"CloudMine *** User profile fetch operation failed (%@)", [error localizedDescription]);
         if (callback) {
-            callback(nil, nil, nil);
+            [self deliverBlock:^{ callback(nil, nil, nil); }];
         }
     }];
     
+    [self prepareOperationForResponseSerialization:requestOperation];
     [self enqueueHTTPRequestOperation:requestOperation];
 }
 
@@ -1453,28 +1663,22 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
             [_responseTimes setObject:[NSNumber numberWithInt:milliseconds] forKey:requestId];
         }
         
-        NSString *responseString = [operation responseString];
-        
         CMUserAccountResult resultCode = codeMapper([operation.response statusCode], nil);
         
         NSError *parseErr = nil;
         NSDictionary *responseBody = [NSDictionary dictionary];
-        if (responseString != nil) {
-            NSDictionary *parsedResponseBody = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                               options:0
-                                                                                 error:&parseErr];
-            if (!parseErr && parsedResponseBody) {
-                responseBody = parsedResponseBody;
-            }
+        NSDictionary *parsedResponseBody = [self parsedResponseObject:responseObject forOperation:operation error:&parseErr];
+        if (!parseErr && parsedResponseBody) {
+            responseBody = parsedResponseBody;
         }
         
         if (resultCode == CMUserAccountUnknownResult) {
-            NSLog(@"CloudMine *** Unexpected response received from server during user account operation. (%@) (Code %ld) Body: %@", [parseErr localizedDescription], (long)[operation.response statusCode], responseString);
+            NSLog(@"CloudMine *** Unexpected response received from server during user account operation. (%@) (Code %ld) Body: %@", [parseErr localizedDescription], (long)[operation.response statusCode], responseBody);
         }
         
         if (callback != nil) {
             void (^block)() = ^{ callback(resultCode, responseBody); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         
@@ -1488,10 +1692,11 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         
         if (callback != nil) {
             void (^block)() = ^{ callback(resultCode, [NSDictionary dictionary]); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     }];
     
+    [self prepareOperationForResponseSerialization:requestOperation];
     [self enqueueHTTPRequestOperation:requestOperation];
 }
 
@@ -1512,7 +1717,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         
         if (successHandler != nil) {
             void (^block)() = ^{ successHandler( responseString, [operation.response allHeaderFields]); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
         
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
@@ -1564,7 +1769,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
         if (errorHandler != nil) {
             void (^block)() = ^{ errorHandler(error); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     }];
     
@@ -1588,9 +1793,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                 }
 
             NSError *parseError;
-            NSDictionary *results = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                    options:0
-                                                                      error:&parseError];
+            NSDictionary *results = [self parsedResponseObject:responseObject forOperation:operation error:&parseError];
             
             if ([[parseError domain] isEqualToString:NSCocoaErrorDomain]) {
                 NSError *error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidResponse userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The response received from the server was malformed and could not be parsed.", NSLocalizedDescriptionKey, parseError, JSONErrorKey, nil]];
@@ -1598,14 +1801,14 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                 if (errorHandler != nil) {
                     NSMutableDictionary *errorInfo = [NSMutableDictionary dictionaryWithObjectsAndKeys:
                                                       @(operation.response.statusCode), @"httpCode",
-                                                      operation.responseData, @"responseData",
-                                                      operation.responseString, @"responseString",
                                                       [operation.response allHeaderFields], @"responseHeaders",
                                                       error, NSURLErrorKey,
+                                                      operation.responseData, @"responseData", // nil when the response was spooled, so keep it last
+                                                      operation.responseString, @"responseString",
                                                       nil];
                     
                     void (^block)() = ^{ errorHandler(operation.responseData, operation.response.statusCode, operation.response.allHeaderFields, error, errorInfo); };
-                    [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+                    [self deliverBlock:block];
                 }
                 return;
             }
@@ -1613,17 +1816,17 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
             
             if (successHandler != nil) {
                 void (^block)() = ^{ successHandler(results, operation.response.statusCode, operation.response.allHeaderFields); };
-                [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+                [self deliverBlock:block];
             }
             
         } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
             
             NSMutableDictionary *errorInfo = [NSMutableDictionary dictionaryWithObjectsAndKeys:
                                               @(operation.response.statusCode), @"httpCode",
-                                              operation.responseData, @"responseData",
-                                              operation.responseString, @"responseString",
                                               [operation.response allHeaderFields], @"responseHeaders",
                                               error, NSURLErrorKey,
+                                              operation.responseData, @"responseData", // nil when the response was spooled, so keep it last
+                                              operation.responseString, @"responseString",
                                               nil];
             
             if ([[error domain] isEqualToString:NSURLErrorDomain]) {
@@ -1664,11 +1867,12 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
             
             if (errorHandler != nil) {
                 void (^block)() = ^{ errorHandler(operation.responseData, operation.response.statusCode, operation.response.allHeaderFields, error, errorInfo); };
-                [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+                [self deliverBlock:block];
             }
             
         }];
     
+    [self prepareOperationForResponseSerialization:operation];
     [self enqueueHTTPRequestOperation:operation];
 }
 
@@ -1676,10 +1880,36 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
 - (void)executeRequest:(NSURLRequest *)request
         successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
           errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    [self executeRequest:request entryHandler:nil successHandler:successHandler errorHandler:errorHandler];
+}
+
+/**
+ * Runs an object request. With an <tt>entryHandler</tt>, the objects under <tt>success</tt> are handed to it one at a
+ * time as the body is parsed, and <tt>successHandler</tt> gets an empty dictionary of results.
+ */
+- (void)executeRequest:(NSURLRequest *)request
+          entryHandler:(CMWebServiceObjectEntryCallback)entryHandler
+        successHandler:(CMWebServiceObjectFetchSuccessCallback)successHandler
+          errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    
+    NSString *inFlightKey = entryHandler ? nil : [self inFlightKeyForRequest:request];
+    if (inFlightKey) {
+        if (![self joinInFlightRequestWithKey:inFlightKey successHandler:successHandler errorHandler:errorHandler]) {
+            return;
+        }
+        successHandler = ^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+            for (NSArray *handlers in [self leaveInFlightRequestWithKey:inFlightKey]) {
+                if ([handlers firstObject] != [NSNull null]) {
+                    ((CMWebServiceObjectFetchSuccessCallback)[handlers firstObject])(results, errors, meta, snippetResult, count, headers);
+                }
+            }
+        };
+        errorHandler = [self errorHandlerForInFlightRequestWithKey:inFlightKey];
+    }
     
     NSDate *startDate = [NSDate date];
     
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+    void (^success)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
         NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
         if (requestId) {
@@ -1688,16 +1918,15 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         }
         
         NSError *parseError;
-        NSDictionary *results = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                options:0
-                                                                  error:&parseError];
+        NSDictionary *results = entryHandler ? [self parsedResponseObject:responseObject forOperation:operation entryHandler:entryHandler error:&parseError]
+                                             : [self parsedResponseObject:responseObject forOperation:operation error:&parseError];
         
         if ([[parseError domain] isEqualToString:NSCocoaErrorDomain]) {
             NSError *error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidResponse userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The response received from the server was malformed.", NSLocalizedDescriptionKey, parseError, JSONErrorKey, nil]];
             NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
             if (errorHandler != nil) {
                 void (^block)() = ^{ errorHandler(error); };
-                [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+                [self deliverBlock:block];
             }
             return;
         }
@@ -1733,11 +1962,13 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         }
         
         if (successHandler != nil) {
-            void (^block)() = ^{ successHandler(successes, errors, meta, snippetResult, count, [operation.response allHeaderFields]); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            void (^block)() = ^{ successHandler(successes, errors, meta, snippetResult, count, [self responseHeadersForOperation:operation]); };
+            [self deliverBlock:block];
         }
         
-    } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+    };
+    
+    void (^failure)(AFHTTPRequestOperation *, NSError *) = ^(AFHTTPRequestOperation *operation, NSError *error) {
         if ([[error domain] isEqualToString:NSURLErrorDomain]) {
             if ([error code] == NSURLErrorUserCancelledAuthentication) {
                 error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
@@ -1770,10 +2001,23 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
         if (errorHandler != nil) {
             void (^block)() = ^{ errorHandler(error); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
-    }];
+    };
+    
+    if (!entryHandler) {
+        AFHTTPRequestOperation *requestOperation = [self revalidatedHTTPRequestOperationWithRequest:request parsed:YES success:success failure:failure];
+        [self prepareOperationForResponseSerialization:requestOperation];
+        [self enqueueHTTPRequestOperation:requestOperation];
+        return;
+    }
     
+    // Streamed objects are parsed from the raw body, which a connection spools whatever the response serialization.
+    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:success failure:failure];
+    requestOperation.responseSerializer = [self rawResponseSerializer];
+    if (![requestOperation isKindOfClass:[CMSessionRequestOperation class]]) {
+        [self spoolResponseOfOperation:requestOperation];
+    }
     [self enqueueHTTPRequestOperation:requestOperation];
 }
 
@@ -1791,32 +2035,31 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         }
         
         NSError *parseError;
-        NSDictionary *results = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                options:0
-                                                                  error:&parseError];
+        NSDictionary *results = [self parsedResponseObject:responseObject forOperation:operation error:&parseError];
         
         if ([[parseError domain] isEqualToString:NSCocoaErrorDomain]) {
             NSError *error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidResponse userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The response received from the server was malformed.", NSLocalizedDescriptionKey, parseError, JSONErrorKey, nil]];
             NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
             if (handler != nil) {
                 void (^block)() = ^{ handler(results, error, operation.response.statusCode); };
-                [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+                [self deliverBlock:block];
             }
             return;
         }
         
         if (handler != nil) {
             void (^block)() = ^{ handler(results, nil, operation.response.statusCode); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
         
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         if (handler != nil) {
             void (^block)() = ^{ handler([operation responseString], error, operation.response.statusCode); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     }];
     
+    [self prepareOperationForResponseSerialization:requestOperation];
     [self enqueueHTTPRequestOperation:requestOperation];
     
     
@@ -1836,23 +2079,21 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         }
         
         NSError *parseError;
-        NSDictionary *results = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                options:0
-                                                                  error:&parseError];
+        NSDictionary *results = [self parsedResponseObject:responseObject forOperation:operation error:&parseError];
         
         if ([[parseError domain] isEqualToString:NSCocoaErrorDomain]) {
             NSError *error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidResponse userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The response received from the server was malformed.", NSLocalizedDescriptionKey, parseError, JSONErrorKey, nil]];
             NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
             if (errorHandler != nil) {
                 void (^block)() = ^{ errorHandler(error); };
-                [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+                [self deliverBlock:block];
             }
             return;
         }
         
         if (successHandler != nil) {
             void (^block)() = ^{ successHandler(results, nil, nil, nil, [NSNumber numberWithUnsignedInteger:results.count], [operation.response allHeaderFields]); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
@@ -1893,10 +2134,11 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
         if (errorHandler != nil) {
             void (^block)() = ^{ errorHandler(error); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     }];
     
+    [self prepareOperationForResponseSerialization:requestOperation];
     [self enqueueHTTPRequestOperation:requestOperation];
 }
 
@@ -1907,7 +2149,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
         if (successHandler != nil) {
             void (^block)() = ^{ successHandler([NSDictionary dictionaryWithObject:@"deleted" forKey:[[request URL] lastPathComponent]], nil, nil, nil, [NSNumber numberWithUnsignedInt:1], [operation.response allHeaderFields]); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         if ([[error domain] isEqualToString:NSURLErrorDomain]) {
@@ -1942,7 +2184,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
         if (errorHandler != nil) {
             void (^block)() = ^{ errorHandler(error); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     }];
     
@@ -1953,9 +2195,24 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
                        successHandler:(CMWebServiceFileFetchSuccessCallback)successHandler
                          errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
     
+    NSString *inFlightKey = [self inFlightKeyForRequest:request];
+    if (inFlightKey) {
+        if (![self joinInFlightRequestWithKey:inFlightKey successHandler:successHandler errorHandler:errorHandler]) {
+            return;
+        }
+        successHandler = ^(NSData *data, NSString *mimeType, NSDictionary *headers) {
+            for (NSArray *handlers in [self leaveInFlightRequestWithKey:inFlightKey]) {
+                if ([handlers firstObject] != [NSNull null]) {
+                    ((CMWebServiceFileFetchSuccessCallback)[handlers firstObject])(data, mimeType, headers);
+                }
+            }
+        };
+        errorHandler = [self errorHandlerForInFlightRequestWithKey:inFlightKey];
+    }
+    
     NSDate *startDate = [NSDate date];
     
-    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+    AFHTTPRequestOperation *requestOperation = [self revalidatedHTTPRequestOperationWithRequest:request parsed:NO success:^(AFHTTPRequestOperation *operation, id responseObject) {
         NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
         if (requestId) {
             int milliseconds = (int)([[NSDate date] timeIntervalSinceDate:startDate] * 1000.0f);
@@ -1963,8 +2220,9 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         }
         
         if (successHandler != nil) {
-            void (^block)() = ^{ successHandler([operation responseData], [[operation.response allHeaderFields] objectForKey:@"Content-Type"], [operation.response allHeaderFields]); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            NSDictionary *headers = [self responseHeadersForOperation:operation];
+            void (^block)() = ^{ successHandler(responseObject, [headers objectForKey:@"Content-Type"], headers); };
+            [self deliverBlock:block];
         }
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
         NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
@@ -1973,47 +2231,126 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
             [_responseTimes setObject:[NSNumber numberWithInt:milliseconds] forKey:requestId];
         }
         
-        if ([[error domain] isEqualToString:NSURLErrorDomain]) {
-            if ([error code] == NSURLErrorUserCancelledAuthentication) {
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
-            } else {
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"A connection to the server was not able to be established.", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
+        error = [self binaryDownloadError:error forOperation:operation];
+        
+        NSLog(@"CloudMine *** Unexpected error occurred during binary download request. (%@)", [error localizedDescription]);
+        if (errorHandler != nil) {
+            void (^block)() = ^{ errorHandler(error); };
+            [self deliverBlock:block];
+        }
+    }];
+    
+    requestOperation.responseSerializer = [AFHTTPResponseSerializer serializer];
+    
+    [self enqueueHTTPRequestOperation:requestOperation];
+}
+
+- (void)executeBinaryDataDownloadRequest:(NSURLRequest *)request
+                                   toURL:(NSURL *)url
+                         progressHandler:(CMWebServiceProgressCallback)progressHandler
+                          successHandler:(CMWebServiceFileDownloadSuccessCallback)successHandler
+                            errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    
+    // A compressed body would be decompressed on the fly, leaving the progress without a meaningful total.
+    NSMutableURLRequest *identityRequest = [request mutableCopy];
+    [identityRequest setValue:@"identity" forHTTPHeaderField:@"Accept-Encoding"];
+    request = identityRequest;
+    
+    NSDate *startDate = [NSDate date];
+    
+    // The body is written to the spool directory as it arrives, so a download that never completes is purged with the stale spools.
+    // Only connection operations write to an output stream, so this uses one even with the session transport.
+    NSString *directory = [[self class] responseSpoolDirectory];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    NSURL *temporaryURL = [NSURL fileURLWithPath:[directory stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    
+    AFHTTPRequestOperation *requestOperation = [self connectionRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
+        if (requestId) {
+            int milliseconds = (int)([[NSDate date] timeIntervalSinceDate:startDate] * 1000.0f);
+            [_responseTimes setObject:[NSNumber numberWithInt:milliseconds] forKey:requestId];
+        }
+        
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        NSError *moveError = nil;
+        [fileManager removeItemAtURL:url error:nil];
+        if (![fileManager moveItemAtURL:temporaryURL toURL:url error:&moveError]) {
+            [fileManager removeItemAtURL:temporaryURL error:nil];
+            NSError *error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnknown userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The downloaded file could not be moved to its destination.", NSLocalizedDescriptionKey, moveError, NSUnderlyingErrorKey, nil]];
+            NSLog(@"CloudMine *** Unexpected error occurred during binary download request. (%@)", [moveError localizedDescription]);
+            if (errorHandler != nil) {
+                void (^block)() = ^{ errorHandler(error); };
+                [self deliverBlock:block];
             }
+            return;
         }
         
-        switch ([operation.response statusCode]) {
-            case 404:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorNotFound userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"Either the file was not found or the application itself was not found.", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            case 401:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            case 400:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was malformed.", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            case 500:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The server experienced an error", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            default:
-                break;
+        if (successHandler != nil) {
+            void (^block)() = ^{ successHandler(url, [[operation.response allHeaderFields] objectForKey:@"Content-Type"], [operation.response allHeaderFields]); };
+            [self deliverBlock:block];
+        }
+    } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+        NSString *requestId = [[operation.response allHeaderFields] objectForKey:@"X-Request-Id"];
+        if (requestId) {
+            int milliseconds = (int)([[NSDate date] timeIntervalSinceDate:startDate] * 1000.0f);
+            [_responseTimes setObject:[NSNumber numberWithInt:milliseconds] forKey:requestId];
         }
         
+        [[NSFileManager defaultManager] removeItemAtURL:temporaryURL error:nil];
+        error = [self binaryDownloadError:error forOperation:operation];
+        
         NSLog(@"CloudMine *** Unexpected error occurred during binary download request. (%@)", [error localizedDescription]);
         if (errorHandler != nil) {
             void (^block)() = ^{ errorHandler(error); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
     }];
     
     requestOperation.responseSerializer = [AFHTTPResponseSerializer serializer];
+    requestOperation.outputStream = [NSOutputStream outputStreamWithURL:temporaryURL append:NO];
+    
+    if (progressHandler != nil) {
+        [requestOperation setDownloadProgressBlock:^(NSUInteger bytesRead, long long totalBytesRead, long long totalBytesExpectedToRead) {
+            [self deliverBlock:^{ progressHandler(totalBytesRead, totalBytesExpectedToRead); }];
+        }];
+    }
     
     [self enqueueHTTPRequestOperation:requestOperation];
 }
 
+- (NSError *)binaryDownloadError:(NSError *)error forOperation:(AFHTTPRequestOperation *)operation {
+    if ([[error domain] isEqualToString:NSURLErrorDomain]) {
+        if ([error code] == NSURLErrorUserCancelledAuthentication) {
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
+        } else {
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"A connection to the server was not able to be established.", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
+        }
+    }
+    
+    switch ([operation.response statusCode]) {
+        case 404:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorNotFound userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"Either the file was not found or the application itself was not found.", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        case 401:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        case 400:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was malformed.", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        case 500:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The server experienced an error", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        default:
+            break;
+    }
+    
+    return error;
+}
+
 - (void)executeBinaryDataUploadRequest:(NSURLRequest *)request
                         successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
                           errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
@@ -2028,16 +2365,14 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         }
         
         NSError *parseError;
-        NSDictionary *results = [NSJSONSerialization JSONObjectWithData:operation.responseData
-                                                                options:0
-                                                                  error:&parseError];
+        NSDictionary *results = [self parsedResponseObject:responseObject forOperation:operation error:&parseError];
         
         if ([[parseError domain] isEqualToString:NSCocoaErrorDomain]) {
             NSError *error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidResponse userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The response received from the server was malformed.", NSLocalizedDescriptionKey, parseError, JSONErrorKey, nil]];
             NSLog(@"CloudMine *** Unexpected error occurred during object request. (%@)", [error localizedDescription]);
             if (errorHandler != nil) {
                 void (^block)() = ^{ errorHandler(error); };
-                [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+                [self deliverBlock:block];
             }
             return;
         }
@@ -2053,7 +2388,7 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
         
         if (successHandler != nil) {
             void (^block)() = ^{ successHandler([operation.response statusCode] == 201 ? CMFileCreated : CMFileUpdated, key, snippetResult, [operation.response allHeaderFields]); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
         }
         
     } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
@@ -2063,52 +2398,602 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
             [_responseTimes setObject:[NSNumber numberWithInt:milliseconds] forKey:requestId];
         }
         
-        if ([[error domain] isEqualToString:NSURLErrorDomain]) {
-            if ([error code] == NSURLErrorUserCancelledAuthentication) {
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
-            } else {
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"A connection to the server was not able to be established.", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
-            }
-        }
+        error = [self binaryUploadError:error forOperation:operation];
         
-        switch ([operation.response statusCode]) {
-            case 404:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorNotFound userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The application was not found. Is your application identifier correct?", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            case 401:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            case 400:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was malformed.", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            case 500:
-                error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The server experienced an error", NSLocalizedDescriptionKey, nil]];
-                break;
-                
-            default:
-                break;
+        NSLog(@"CloudMine *** Unexpected error occurred during binary upload request. (%@)", [error localizedDescription]);
+        if (errorHandler != nil) {
+            void (^block)() = ^{ errorHandler(error); };
+            [self deliverBlock:block];
         }
-        
+    }];
+    
+    [self prepareOperationForResponseSerialization:requestOperation];
+    [self enqueueHTTPRequestOperation:requestOperation];
+}
+
+- (NSError *)binaryUploadError:(NSError *)error forOperation:(AFHTTPRequestOperation *)operation {
+    if ([[error domain] isEqualToString:NSURLErrorDomain]) {
+        if ([error code] == NSURLErrorUserCancelledAuthentication) {
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
+        } else {
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"A connection to the server was not able to be established.", NSLocalizedDescriptionKey, error, NSURLErrorKey, nil]];
+        }
+    }
+    
+    switch ([operation.response statusCode]) {
+        case 404:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorNotFound userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The application was not found. Is your application identifier correct?", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        case 401:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorUnauthorized userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was unauthorized. Is your API key correct?", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        case 400:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The request was malformed.", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        case 500:
+            error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The server experienced an error", NSLocalizedDescriptionKey, nil]];
+            break;
+            
+        default:
+            break;
+    }
+    
+    return error;
+}
+
+- (void)sendChunkOfUpload:(CMResumableUpload *)upload
+                 chunkURL:(NSURL *)chunkURL
+                 finalURL:(NSURL *)finalURL
+                 mimeType:(NSString *)mimeType
+                     user:(CMUser *)user
+              queryStatus:(BOOL)queryStatus
+                  attempt:(NSUInteger)attempt
+          progressHandler:(CMWebServiceProgressCallback)progressHandler
+           successHandler:(CMWebServiceFileUploadSuccessCallback)successHandler
+             errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    
+    void (^fail)(NSError *) = ^(NSError *error) {
         NSLog(@"CloudMine *** Unexpected error occurred during binary upload request. (%@)", [error localizedDescription]);
         if (errorHandler != nil) {
             void (^block)() = ^{ errorHandler(error); };
-            [self performSelectorOnMainThread:@selector(performBlock:) withObject:block waitUntilDone:YES];
+            [self deliverBlock:block];
+        }
+    };
+    
+    NSData *chunk = nil;
+    if (!queryStatus) {
+        NSError *readError = nil;
+        chunk = [upload nextChunk:&readError];
+        if (!chunk) {
+            fail([NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The file to upload could not be read.", NSLocalizedDescriptionKey, readError, NSUnderlyingErrorKey, nil]]);
+            return;
+        }
+    }
+    
+    BOOL isLastChunk = !queryStatus && upload.committedLength + chunk.length >= upload.fileSize;
+    NSMutableURLRequest *request = [self constructHTTPRequestWithVerb:@"PUT" URL:(isLastChunk ? finalURL : chunkURL) appSecret:_appSecret binaryData:YES user:user];
+    if (mimeType.length > 0) {
+        [request setValue:mimeType forHTTPHeaderField:@"Content-Type"];
+    }
+    [request setValue:upload.uploadIdentifier forHTTPHeaderField:CMUploadIdentifierHeader];
+    [request setValue:[upload contentRangeForChunkOfLength:chunk.length] forHTTPHeaderField:@"Content-Range"];
+    [request setHTTPBody:(chunk ?: [NSData data])];
+    
+    unsigned long long chunkStart = upload.committedLength;
+    
+    AFHTTPRequestOperation *requestOperation = [self HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        if ([operation.response statusCode] == 308) {
+            [upload commitRange:[[operation.response allHeaderFields] objectForKey:@"Range"]];
+            if (upload.isComplete) {
+                // Every byte arrived but the server never finished the file, so there's nothing left to send that would.
+                [upload remove];
+                fail([NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The server did not complete the upload.", NSLocalizedDescriptionKey, nil]]);
+                return;
+            }
+            
+            if (progressHandler != nil) {
+                long long committed = upload.committedLength;
+                long long total = upload.fileSize;
+                [self deliverBlock:^{ progressHandler(committed, total); }];
+            }
+            
+            // Only a chunk the server took resets the retry budget; a status query just tells us where to resume.
+            NSUInteger nextAttempt = attempt;
+            if (!queryStatus) {
+                nextAttempt = (upload.committedLength > chunkStart) ? 0 : attempt + 1;
+            }
+            if (nextAttempt > CMUploadChunkRetryLimit) {
+                fail([NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The server kept rejecting the same part of the upload.", NSLocalizedDescriptionKey, nil]]);
+                return;
+            }
+            
+            [self sendChunkOfUpload:upload chunkURL:chunkURL finalURL:finalURL mimeType:mimeType user:user queryStatus:NO attempt:nextAttempt
+                    progressHandler:progressHandler successHandler:successHandler errorHandler:errorHandler];
+            return;
         }
+        
+        [upload remove];
+        
+        // Only the last chunk can finish the file; a status query that isn't a 308 means an earlier attempt already did.
+        if (!queryStatus && chunkStart + chunk.length < upload.fileSize) {
+            fail([NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The server finished the upload before it was complete.", NSLocalizedDescriptionKey, nil]]);
+            return;
+        }
+        
+        NSError *parseError;
+        NSDictionary *results = [self parsedResponseObject:responseObject forOperation:operation error:&parseError];
+        if ([[parseError domain] isEqualToString:NSCocoaErrorDomain]) {
+            fail([NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidResponse userInfo:[NSDictionary dictionaryWithObjectsAndKeys:@"The response received from the server was malformed.", NSLocalizedDescriptionKey, parseError, JSONErrorKey, nil]]);
+            return;
+        }
+        
+        NSString *key = [results objectForKey:@"key"] ?: upload.key;
+        id snippetResult = [results objectForKey:@"result"] ?: [NSDictionary dictionary];
+        
+        if (successHandler != nil) {
+            void (^block)() = ^{ successHandler([operation.response statusCode] == 201 ? CMFileCreated : CMFileUpdated, key, snippetResult, [operation.response allHeaderFields]); };
+            [self deliverBlock:block];
+        }
+    } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+        NSInteger statusCode = [operation.response statusCode];
+        
+        if (queryStatus && statusCode == 404) {
+            // The server no longer has any of the upload, so it starts over under the same identifier.
+            upload.committedLength = 0;
+            [self sendChunkOfUpload:upload chunkURL:chunkURL finalURL:finalURL mimeType:mimeType user:user queryStatus:NO attempt:attempt
+                    progressHandler:progressHandler successHandler:successHandler errorHandler:errorHandler];
+            return;
+        }
+        
+        BOOL retryable = (operation.response == nil && [[error domain] isEqualToString:NSURLErrorDomain]) || statusCode >= 500;
+        if (retryable && attempt < CMUploadChunkRetryLimit) {
+            // Ask where to resume rather than resending blindly; the chunk may have arrived before the connection dropped.
+            dispatch_time_t when = dispatch_time(DISPATCH_TIME_NOW, (int64_t)((1 << attempt) * NSEC_PER_SEC));
+            dispatch_after(when, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                [self sendChunkOfUpload:upload chunkURL:chunkURL finalURL:finalURL mimeType:mimeType user:user queryStatus:YES attempt:attempt + 1
+                        progressHandler:progressHandler successHandler:successHandler errorHandler:errorHandler];
+            });
+            return;
+        }
+        
+        fail([self binaryUploadError:error forOperation:operation]);
     }];
     
+    NSMutableIndexSet *acceptableStatusCodes = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(200, 100)];
+    [acceptableStatusCodes addIndex:308];
+    requestOperation.responseSerializer = [AFHTTPResponseSerializer serializer];
+    requestOperation.responseSerializer.acceptableStatusCodes = acceptableStatusCodes;
+    
+    if (progressHandler != nil && chunk.length > 0) {
+        long long total = upload.fileSize;
+        [requestOperation setUploadProgressBlock:^(NSUInteger bytesWritten, long long totalBytesWritten, long long totalBytesExpectedToWrite) {
+            [self deliverBlock:^{ progressHandler(chunkStart + totalBytesWritten, total); }];
+        }];
+    }
+    
     [self enqueueHTTPRequestOperation:requestOperation];
 }
 
+#pragma - Revalidating responses
+
+/**
+ * Creates an operation for <tt>request</tt> that revalidates the response kept for it, if any. A <tt>304</tt> calls
+ * <tt>success</tt> with the kept body, parsed if <tt>parsed</tt> is <tt>YES</tt>, and its headers are available from
+ * <tt>responseHeadersForOperation:</tt>. Successful responses replace the kept one; object bodies are parsed here for
+ * that, once, and <tt>success</tt> gets the parsed object. Binary bodies are only kept within the cache's byte limit.
+ */
+- (AFHTTPRequestOperation *)revalidatedHTTPRequestOperationWithRequest:(NSURLRequest *)request
+                                                                parsed:(BOOL)parsed
+                                                               success:(void (^)(AFHTTPRequestOperation *operation, id responseObject))success
+                                                               failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure {
+    CMRevalidationCache *cache = self.revalidationCache;
+    if (!cache || ![[request HTTPMethod] isEqualToString:@"GET"]) {
+        return [self HTTPRequestOperationWithRequest:request success:success failure:failure];
+    }
+    
+    return [self HTTPRequestOperationWithRequest:[cache conditionalRequestForRequest:request] success:^(AFHTTPRequestOperation *operation, id responseObject) {
+        if (!parsed) {
+            [cache storeData:responseObject parsedObject:nil forResponse:operation.response request:request];
+            success(operation, responseObject);
+            return;
+        }
+        
+        NSError *parseError = nil;
+        id parsedObject = [self parsedResponseObject:responseObject forOperation:operation error:&parseError];
+        if (parsedObject) {
+            NSData *data = operation.responseData.length > 0 ? operation.responseData : [[self bodyCodecForResponse:operation.response] dataWithObject:parsedObject error:NULL];
+            [cache storeData:data parsedObject:parsedObject forResponse:operation.response request:request];
+        }
+        // A body that failed to parse is handed on as it was, so the caller reports the error as usual.
+        success(operation, parsedObject ?: responseObject);
+    } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+        if (operation.response.statusCode != 304) {
+            failure(operation, error);
+            return;
+        }
+        
+        NSString *spoolPath = [operation.userInfo objectForKey:CMResponseSpoolPathKey];
+        if (spoolPath) {
+            [[NSFileManager defaultManager] removeItemAtPath:spoolPath error:nil];
+        }
+        
+        NSDictionary *headers = nil;
+        id body = [cache bodyForNotModifiedResponse:operation.response request:request parsed:parsed headers:&headers];
+        if (!body) {
+            NSLog(@"CloudMine *** The server reported %@ as not modified, but no response to it is kept anymore", [request URL]);
+            failure(operation, error);
+            return;
+        }
+        
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:operation.userInfo];
+        [userInfo setObject:headers forKey:CMRevalidatedHeadersKey];
+        [userInfo removeObjectForKey:CMResponseSpoolPathKey];
+        operation.userInfo = userInfo;
+        success(operation, body);
+    }];
+}
+
+/**
+ * The headers of the response an operation's success was based on, which for a revalidated response are those kept
+ * with it, updated by the <tt>304</tt>.
+ */
+- (NSDictionary *)responseHeadersForOperation:(AFHTTPRequestOperation *)operation {
+    return [operation.userInfo objectForKey:CMRevalidatedHeadersKey] ?: [operation.response allHeaderFields];
+}
+
+#pragma - Coalescing identical requests
+
+/**
+ * The key identical GETs share in <tt>_inFlightRequests</tt>, or <tt>nil</tt> if <tt>request</tt> must be sent on its own.
+ * The session token is part of the key, so requests for different users never share a response.
+ */
+- (NSString *)inFlightKeyForRequest:(NSURLRequest *)request {
+    if (!self.coalescesIdenticalRequests || ![[request HTTPMethod] isEqualToString:@"GET"]) {
+        return nil;
+    }
+    
+    // Server-side code may have side effects, so every request that runs it is sent.
+    NSString *query = [@"&" stringByAppendingString:[[request URL] query] ?: @""];
+    if ([[[request URL] path] rangeOfString:@"/run/"].location != NSNotFound || [query rangeOfString:@"&f="].location != NSNotFound) {
+        return nil;
+    }
+    return [NSString stringWithFormat:@"GET %@ %@", [[request URL] absoluteString], [request valueForHTTPHeaderField:CM_SESSIONTOKEN_HEADER] ?: @""];
+}
+
+/**
+ * Adds a caller's handlers to the request with the given key. Returns <tt>YES</tt> if no such request was in flight,
+ * in which case the caller has to send it, or <tt>NO</tt> if the handlers will be called with the response of the one
+ * already in flight.
+ */
+- (BOOL)joinInFlightRequestWithKey:(NSString *)key successHandler:(id)successHandler errorHandler:(CMWebServiceFetchFailureCallback)errorHandler {
+    NSArray *handlers = @[successHandler ? [successHandler copy] : [NSNull null], errorHandler ? [errorHandler copy] : [NSNull null]];
+    @synchronized(_inFlightRequests) {
+        NSMutableArray *waiting = [_inFlightRequests objectForKey:key];
+        if (waiting) {
+            [waiting addObject:handlers];
+            return NO;
+        }
+        [_inFlightRequests setObject:[NSMutableArray arrayWithObject:handlers] forKey:key];
+        return YES;
+    }
+}
+
+/**
+ * Removes the request with the given key, returning the handlers of everyone waiting on it. Requests made from now on
+ * are sent anew.
+ */
+- (NSArray *)leaveInFlightRequestWithKey:(NSString *)key {
+    @synchronized(_inFlightRequests) {
+        NSArray *waiting = [_inFlightRequests objectForKey:key];
+        [_inFlightRequests removeObjectForKey:key];
+        return waiting;
+    }
+}
+
+- (CMWebServiceFetchFailureCallback)errorHandlerForInFlightRequestWithKey:(NSString *)key {
+    return ^(NSError *error) {
+        for (NSArray *handlers in [self leaveInFlightRequestWithKey:key]) {
+            if ([handlers lastObject] != [NSNull null]) {
+                ((CMWebServiceFetchFailureCallback)[handlers lastObject])(error);
+            }
+        }
+    };
+}
+
+- (AFHTTPRequestOperation *)HTTPRequestOperationWithRequest:(NSURLRequest *)request
+                                                    success:(void (^)(AFHTTPRequestOperation *operation, id responseObject))success
+                                                    failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure {
+    // Responses are handled on the processing queue; only the user's callbacks go to completionQueue.
+    if (self.transport != CMWebServiceTransportSession) {
+        return [self connectionRequestOperationWithRequest:request success:success failure:failure];
+    }
+
+    CMSessionRequestOperation *operation = [[CMSessionRequestOperation alloc] initWithRequest:request sessionManager:self.sessionManager];
+    operation.responseSerializer = self.responseSerializer;
+    operation.shouldUseCredentialStorage = self.shouldUseCredentialStorage;
+    operation.credential = self.credential;
+    operation.securityPolicy = self.securityPolicy;
+    [operation setCompletionBlockWithSuccess:success failure:failure];
+    operation.completionQueue = self.responseProcessingQueue;
+    operation.completionGroup = self.completionGroup;
+    return operation;
+}
+
+/**
+ * An operation that runs on its own connection whatever the transport, for requests that need its <tt>outputStream</tt>,
+ * which session operations don't write to.
+ */
+- (AFHTTPRequestOperation *)connectionRequestOperationWithRequest:(NSURLRequest *)request
+                                                          success:(void (^)(AFHTTPRequestOperation *operation, id responseObject))success
+                                                          failure:(void (^)(AFHTTPRequestOperation *operation, NSError *error))failure {
+    AFHTTPRequestOperation *operation = [super HTTPRequestOperationWithRequest:request success:success failure:failure];
+    operation.completionQueue = self.responseProcessingQueue;
+    return operation;
+}
+
 - (void)enqueueHTTPRequestOperation:(AFHTTPRequestOperation *)operation {
+    CMWebServiceRequestTag tag = [self requestTagForURL:operation.request.URL];
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:operation.userInfo];
+    [userInfo setObject:@(tag) forKey:CMRequestTagKey];
+    operation.userInfo = userInfo;
+    
+    @synchronized(self) {
+        NSNumber *priority = [_tagPriorities objectForKey:@(tag)];
+        NSNumber *qualityOfService = [_tagQualitiesOfService objectForKey:@(tag)];
+        operation.queuePriority = priority ? [priority integerValue] : NSOperationQueuePriorityNormal;
+        operation.qualityOfService = qualityOfService ? [qualityOfService integerValue] : NSQualityOfServiceUserInitiated;
+    }
+    
     [operation setShouldExecuteAsBackgroundTaskWithExpirationHandler:nil];
-    [operation start];
+    [self.operationQueue addOperation:operation];
+}
+
+#pragma - Request scheduling
+
+- (NSInteger)maxConcurrentRequests {
+    return self.operationQueue.maxConcurrentOperationCount;
 }
 
-- (void)performBlock:(void (^)())block {
-    block();
+- (void)setMaxConcurrentRequests:(NSInteger)maxConcurrentRequests {
+    NSParameterAssert(maxConcurrentRequests > 0);
+    if (maxConcurrentRequests == self.operationQueue.maxConcurrentOperationCount) {
+        return;
+    }
+    self.operationQueue.maxConcurrentOperationCount = maxConcurrentRequests;
+    [self retireSessionManager];
+}
+
+/**
+ * A session's connection limit can't change once it is created, so requests made after a new limit is set get a new
+ * session. The old one is invalidated once every operation already holding it has finished, from the main queue so that
+ * <tt>cancelAllRequests</tt> can't drop the invalidation.
+ */
+- (void)retireSessionManager {
+    AFURLSessionManager *retired = nil;
+    @synchronized(self) {
+        retired = _sessionManager;
+        _sessionManager = nil;
+    }
+    if (!retired) {
+        return;
+    }
+
+    NSBlockOperation *invalidation = [NSBlockOperation blockOperationWithBlock:^{
+        [retired invalidateSessionCancelingTasks:NO];
+    }];
+    for (NSOperation *operation in [self.operationQueue operations]) {
+        if ([operation isKindOfClass:[CMSessionRequestOperation class]] && [(CMSessionRequestOperation *)operation sessionManager] == retired) {
+            [invalidation addDependency:operation];
+        }
+    }
+    [[NSOperationQueue mainQueue] addOperation:invalidation];
+}
+
+- (void)setQueuePriority:(NSOperationQueuePriority)priority qualityOfService:(NSQualityOfService)qualityOfService forRequestTag:(CMWebServiceRequestTag)tag {
+    @synchronized(self) {
+        [_tagPriorities setObject:@(priority) forKey:@(tag)];
+        [_tagQualitiesOfService setObject:@(qualityOfService) forKey:@(tag)];
+    }
+}
+
+- (void)cancelRequestsWithTag:(CMWebServiceRequestTag)tag {
+    for (NSOperation *operation in [self.operationQueue operations]) {
+        if (![operation isKindOfClass:[AFHTTPRequestOperation class]]) {
+            continue;
+        }
+        NSNumber *operationTag = [[(AFHTTPRequestOperation *)operation userInfo] objectForKey:CMRequestTagKey];
+        if ([operationTag integerValue] == tag) {
+            [operation cancel];
+        }
+    }
+}
+
+- (void)cancelAllRequests {
+    [self.operationQueue cancelAllOperations];
+}
+
+- (AFURLSessionManager *)sessionManager {
+    @synchronized(self) {
+        if (!_sessionManager) {
+            NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+            configuration.HTTPMaximumConnectionsPerHost = self.maxConcurrentRequests;
+            _sessionManager = [[AFURLSessionManager alloc] initWithSessionConfiguration:configuration];
+            _sessionManager.securityPolicy = self.securityPolicy;
+            _sessionManager.completionQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+            // Hand back the raw bytes; each operation validates and parses them with its own response serializer.
+            AFHTTPResponseSerializer *passthroughSerializer = [AFHTTPResponseSerializer serializer];
+            passthroughSerializer.acceptableStatusCodes = nil;
+            passthroughSerializer.acceptableContentTypes = nil;
+            _sessionManager.responseSerializer = passthroughSerializer;
+        }
+        return _sessionManager;
+    }
+}
+
+- (CMWebServiceRequestTag)requestTagForURL:(NSURL *)url {
+    // Paths look like /v1/app/{appid}/[user/]{endpoint}/...
+    NSArray *components = [url pathComponents];
+    NSUInteger appIndex = [components indexOfObject:@"app"];
+    if (appIndex == NSNotFound || appIndex + 2 >= [components count]) {
+        return CMWebServiceRequestTagDefault;
+    }
+    
+    NSUInteger endpointIndex = appIndex + 2;
+    if ([[components objectAtIndex:endpointIndex] isEqualToString:@"user"] && endpointIndex + 1 < [components count]) {
+        endpointIndex++;
+    }
+    
+    NSString *endpoint = [components objectAtIndex:endpointIndex];
+    if ([endpoint isEqualToString:@"text"] || [endpoint isEqualToString:@"search"] || [endpoint isEqualToString:@"data"] || [endpoint isEqualToString:@"access"]) {
+        return CMWebServiceRequestTagObject;
+    } else if ([endpoint isEqualToString:@"binary"]) {
+        return CMWebServiceRequestTagFile;
+    } else if ([endpoint isEqualToString:@"account"]) {
+        return CMWebServiceRequestTagUser;
+    } else if ([endpoint isEqualToString:@"run"]) {
+        return CMWebServiceRequestTagSnippet;
+    }
+    return CMWebServiceRequestTagDefault;
+}
+
+- (void)deliverBlock:(void (^)())block {
+    dispatch_async(self.completionQueue ?: dispatch_get_main_queue(), block);
+}
+
+#pragma - Response parsing
+
++ (NSString *)responseSpoolDirectory {
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"CMResponseSpool"];
+}
+
++ (void)purgeStaleResponseSpools {
+    // Spools are removed as soon as they are parsed; anything left behind belongs to a request that failed.
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *directory = [self responseSpoolDirectory];
+    for (NSString *fileName in [fileManager contentsOfDirectoryAtPath:directory error:nil]) {
+        NSString *path = [directory stringByAppendingPathComponent:fileName];
+        NSDate *modified = [[fileManager attributesOfItemAtPath:path error:nil] fileModificationDate];
+        if (modified && -[modified timeIntervalSinceNow] > CMResponseSpoolMaximumAge) {
+            [fileManager removeItemAtPath:path error:nil];
+        }
+    }
+}
+
+- (void)prepareOperationForResponseSerialization:(AFHTTPRequestOperation *)operation {
+    if (self.responseSerialization != CMWebServiceResponseSerializationStreamed || operation.responseSerializer != self.responseSerializer ||
+        [operation isKindOfClass:[CMSessionRequestOperation class]]) {
+        return;
+    }
+    [self spoolResponseOfOperation:operation];
+}
+
+/**
+ * Has the body of a connection operation written to a new file in the spool directory as it arrives.
+ */
+- (void)spoolResponseOfOperation:(AFHTTPRequestOperation *)operation {
+    NSString *directory = [[self class] responseSpoolDirectory];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString *spoolPath = [directory stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+    operation.outputStream = [NSOutputStream outputStreamToFileAtPath:spoolPath append:NO];
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:operation.userInfo];
+    [userInfo setObject:spoolPath forKey:CMResponseSpoolPathKey];
+    operation.userInfo = userInfo;
+}
+
+/**
+ * The codec a response is in: <tt>bodyCodec</tt> if it came back in that format, or the built-in one for its MIME type.
+ */
+- (id<CMBodyCodec>)bodyCodecForResponse:(NSHTTPURLResponse *)response {
+    NSString *mimeType = [response MIMEType];
+    if (mimeType && [mimeType caseInsensitiveCompare:self.bodyCodec.contentType] == NSOrderedSame) {
+        return self.bodyCodec;
+    }
+    return CMBodyCodecForContentType(mimeType);
+}
+
+/**
+ * Returns the decoded body of a finished operation, in whichever format <tt>bodyCodecForResponse:</tt> says it is.
+ * Whatever the response serialization mode, the body is parsed at most once: an object already produced by the
+ * response serializer is returned as-is, raw bytes are parsed directly and a spooled body is parsed from a stream (or,
+ * for formats other than JSON, from the mapped file) and then removed. An empty body yields <tt>nil</tt> and a parse
+ * error, just as <tt>NSJSONSerialization</tt> would.
+ */
+- (id)parsedResponseObject:(id)responseObject forOperation:(AFHTTPRequestOperation *)operation error:(NSError **)error {
+    if (responseObject && ![responseObject isKindOfClass:[NSData class]]) {
+        return responseObject;
+    }
+
+    id<CMBodyCodec> codec = [self bodyCodecForResponse:operation.response];
+    NSString *spoolPath = [operation.userInfo objectForKey:CMResponseSpoolPathKey];
+    if (spoolPath) {
+        id parsed = nil;
+        if ([codec isKindOfClass:[CMJSONBodyCodec class]]) {
+            NSInputStream *stream = [NSInputStream inputStreamWithFileAtPath:spoolPath];
+            [stream open];
+            if ([stream hasBytesAvailable]) {
+                parsed = [NSJSONSerialization JSONObjectWithStream:stream options:0 error:error];
+            }
+            [stream close];
+        } else {
+            NSData *data = [NSData dataWithContentsOfFile:spoolPath options:NSDataReadingMappedIfSafe error:NULL];
+            if (data.length > 0) {
+                parsed = [codec objectWithData:data error:error];
+            }
+        }
+        [[NSFileManager defaultManager] removeItemAtPath:spoolPath error:nil];
+        if (parsed) {
+            return parsed;
+        }
+    } else {
+        NSData *data = [responseObject isKindOfClass:[NSData class]] ? responseObject : operation.responseData;
+        if (data.length > 0) {
+            return [codec objectWithData:data error:error];
+        }
+    }
+
+    if (error && !*error) {
+        *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:[NSDictionary dictionaryWithObject:@"No body was received." forKey:NSLocalizedDescriptionKey]];
+    }
+    return nil;
+}
+
+/**
+ * Like <tt>parsedResponseObject:forOperation:error:</tt>, but hands each entry of the <tt>success</tt> dictionary to
+ * <tt>entryHandler</tt> and returns the rest of the body without it. A JSON body is read a chunk at a time with
+ * <tt>CMJSONEntryParser</tt>, from the spool if there is one; other formats have to be decoded whole first.
+ */
+- (id)parsedResponseObject:(id)responseObject forOperation:(AFHTTPRequestOperation *)operation entryHandler:(CMWebServiceObjectEntryCallback)entryHandler error:(NSError **)error {
+    id<CMBodyCodec> codec = [self bodyCodecForResponse:operation.response];
+    NSString *spoolPath = [operation.userInfo objectForKey:CMResponseSpoolPathKey];
+    NSData *data = [responseObject isKindOfClass:[NSData class]] ? responseObject : operation.responseData;
+    BOOL streamable = (!responseObject || [responseObject isKindOfClass:[NSData class]]) && (spoolPath || data.length > 0);
+    
+    if (!streamable || ![codec isKindOfClass:[CMJSONBodyCodec class]]) {
+        NSDictionary *parsed = [self parsedResponseObject:responseObject forOperation:operation error:error];
+        NSDictionary *successes = [parsed isKindOfClass:[NSDictionary class]] ? [parsed objectForKey:@"success"] : nil;
+        if (![successes isKindOfClass:[NSDictionary class]]) {
+            return parsed;
+        }
+        [successes enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSDictionary *representation, BOOL *stop) {
+            entryHandler(key, representation);
+        }];
+        NSMutableDictionary *rest = [parsed mutableCopy];
+        [rest removeObjectForKey:@"success"];
+        return rest;
+    }
+    
+    CMJSONEntryParser *parser = [[CMJSONEntryParser alloc] initWithEntriesKey:@"success" entryHandler:entryHandler];
+    if (!spoolPath) {
+        return [parser parseData:data error:error];
+    }
+    NSDictionary *parsed = [parser parseStream:[NSInputStream inputStreamWithFileAtPath:spoolPath] error:error];
+    [[NSFileManager defaultManager] removeItemAtPath:spoolPath error:nil];
+    return parsed;
 }
 
 #pragma - Request construction
@@ -2132,13 +3017,15 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     }
     [request setValue:appSecret forHTTPHeaderField:CM_APIKEY_HEADER];
     
-    // TODO: This should be customizable to change between JSON, GZIP'd JSON, and MsgPack.
+    // Object fetches and saves switch to bodyCodec afterwards; everything else is JSON.
     
     // Don't do this for binary data since that requires further intervention by the developer.
     if (!isForBinaryData) {
         [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
         [request setValue:@"application/json" forHTTPHeaderField:@"Accept"];
     }
+    // The loading system decompresses either encoding transparently; stating it keeps every request consistent.
+    [request setValue:@"gzip, deflate" forHTTPHeaderField:@"Accept-Encoding"];
     
     // Add response times to user token string
     NSMutableArray *times = [NSMutableArray array];
@@ -2164,6 +3051,72 @@ NSString * const JSONErrorKey = @"JSONErrorKey";
     
 }
 
+/**
+ * Creates the request for an object update (<tt>POST</tt>) or replacement (<tt>PUT</tt>), set up for <tt>bodyCodec</tt>.
+ */
+- (NSMutableURLRequest *)objectSaveRequestWithVerb:(NSString *)verb
+                                serverSideFunction:(CMServerFunction *)function
+                                              user:(CMUser *)user
+                                   extraParameters:(NSDictionary *)params {
+    NSMutableURLRequest *request = [self constructHTTPRequestWithVerb:verb
+                                                                  URL:[self constructTextUrlAtUserLevel:(user != nil)
+                                                                                               withKeys:nil
+                                                                                                  query:nil
+                                                                                          pagingOptions:nil
+                                                                                         sortingOptions:nil
+                                                                                 withServerSideFunction:function
+                                                                                        extraParameters:params]
+                                                            appSecret:_appSecret
+                                                           binaryData:NO
+                                                                 user:user];
+    [self useBodyCodecForRequest:request];
+    return request;
+}
+
+/**
+ * Makes an object fetch or save send its body in the format of <tt>bodyCodec</tt> and ask for its response in it too.
+ * JSON stays acceptable, so a server that doesn't know the format can still answer.
+ */
+- (void)useBodyCodecForRequest:(NSMutableURLRequest *)request {
+    NSString *contentType = self.bodyCodec.contentType;
+    [request setValue:contentType forHTTPHeaderField:@"Content-Type"];
+    if ([self.bodyCodec isKindOfClass:[CMJSONBodyCodec class]]) {
+        [request setValue:contentType forHTTPHeaderField:@"Accept"];
+    } else {
+        [request setValue:[NSString stringWithFormat:@"%@, application/json;q=0.5", contentType] forHTTPHeaderField:@"Accept"];
+    }
+}
+
+/**
+ * Sets an encoded request body, compressed according to <tt>requestCompression</tt> if it is above the threshold and
+ * compressing actually makes it smaller.
+ */
+- (void)setBody:(NSData *)body ofRequest:(NSMutableURLRequest *)request {
+    NSData *compressed = nil;
+    NSString *encoding = nil;
+    if (body.length > self.requestCompressionThreshold) {
+        switch (self.requestCompression) {
+            case CMWebServiceRequestCompressionGzip:
+                compressed = [body gzippedData];
+                encoding = @"gzip";
+                break;
+            case CMWebServiceRequestCompressionDeflate:
+                compressed = [body deflatedData];
+                encoding = @"deflate";
+                break;
+            default:
+                break;
+        }
+    }
+    
+    if (compressed && compressed.length < body.length) {
+        [request setValue:encoding forHTTPHeaderField:@"Content-Encoding"];
+        [request setHTTPBody:compressed];
+    } else {
+        [request setHTTPBody:body];
+    }
+}
+
 - (NSMutableURLRequest *)constructHTTPRequestWithVerb:(NSString *)verb
                                                   URL:(NSURL *)url
                                            binaryData:(BOOL)isForBinaryData
@@ -8,12 +8,28 @@
 
 #import <Foundation/Foundation.h>
 
+/**
+ * The number of objects from which <tt>decodeObjects:</tt> spreads the work across cores.
+ */
+extern NSUInteger const CMObjectDecoderConcurrentDecodeThreshold;
+
 @interface CMObjectDecoder : NSCoder {
     NSDictionary *_dictionaryRepresentation;
 }
 
+/**
+ * Inflates the objects of a dictionary keyed by object ID. Sets of at least
+ * <tt>CMObjectDecoderConcurrentDecodeThreshold</tt> objects are decoded concurrently.
+ */
 + (NSArray *)decodeObjects:(NSDictionary *)serializedObjects;
 
+/**
+ * Inflates the objects of a dictionary keyed by object ID, in chunks spread across cores if <tt>concurrently</tt>
+ * is <tt>YES</tt>. The objects come out in the same order either way. If any representation is not a dictionary, no
+ * objects are returned at all.
+ */
++ (NSArray *)decodeObjects:(NSDictionary *)serializedObjects concurrently:(BOOL)concurrently;
+
 - (instancetype)initWithSerializedObjectRepresentation:(NSDictionary *)representation;
 
 @end
@@ -16,8 +16,12 @@
 #import "CMObjectClassNameRegistry.h"
 #import "CMFileMetadata.h"
 
+NSUInteger const CMObjectDecoderConcurrentDecodeThreshold = 100;
+static NSUInteger const CMObjectDecoderChunkSize = 50;
+
 @interface CMObjectDecoder (Private)
 + (Class)typeFromDictionaryRepresentation:(NSDictionary *)representation;
++ (NSArray *)decodeObjectsWithKeys:(NSArray *)keys inRange:(NSRange)range ofSerializedObjects:(NSDictionary *)serializedObjects;
 - (NSArray *)decodeAllInList:(NSArray *)list;
 - (NSDictionary *)decodeAllInDictionary:(NSDictionary *)dictionary;
 - (id)deserializeContentsOfObject:(id)objv;
@@ -28,14 +32,67 @@
 #pragma mark - Kickoff methods
 
 + (NSArray *)decodeObjects:(NSDictionary *)serializedObjects {
-    NSMutableArray *decodedObjects = [NSMutableArray arrayWithCapacity:[serializedObjects count]];
+    return [self decodeObjects:serializedObjects concurrently:([serializedObjects count] >= CMObjectDecoderConcurrentDecodeThreshold)];
+}
+
++ (NSArray *)decodeObjects:(NSDictionary *)serializedObjects concurrently:(BOOL)concurrently {
+    // Both paths work from the same list of keys, so the objects come out in the same order either way.
+    NSArray *keys = [serializedObjects allKeys];
+    if (!concurrently || [keys count] <= CMObjectDecoderChunkSize) {
+        return [self decodeObjectsWithKeys:keys inRange:NSMakeRange(0, [keys count]) ofSerializedObjects:serializedObjects] ?: @[];
+    }
+
+    size_t chunkCount = ([keys count] + CMObjectDecoderChunkSize - 1) / CMObjectDecoderChunkSize;
+    NSMutableArray *decodedChunks = [NSMutableArray arrayWithCapacity:chunkCount];
+    for (size_t i = 0; i < chunkCount; i++) {
+        [decodedChunks addObject:[NSNull null]];
+    }
 
-    for (id key in serializedObjects) {
+    dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        NSRange range = NSMakeRange(index * CMObjectDecoderChunkSize, MIN(CMObjectDecoderChunkSize, [keys count] - index * CMObjectDecoderChunkSize));
+
+        // An exception can't leave a dispatch_apply worker, so it is kept in place of the chunk and raised below.
+        // A chunk with an invalid representation stays NSNull, which fails the whole batch.
+        id decoded = nil;
+        @try {
+            decoded = [self decodeObjectsWithKeys:keys inRange:range ofSerializedObjects:serializedObjects];
+        } @catch (NSException *exception) {
+            decoded = exception;
+        }
+        @synchronized(decodedChunks) {
+            if (decoded) {
+                [decodedChunks replaceObjectAtIndex:index withObject:decoded];
+            }
+        }
+    });
+
+    NSMutableArray *decodedObjects = [NSMutableArray arrayWithCapacity:[keys count]];
+    for (id decoded in decodedChunks) {
+        if ([decoded isKindOfClass:[NSException class]]) {
+            [decoded raise];
+        }
+        if (decoded == [NSNull null]) {
+            return @[];
+        }
+        [decodedObjects addObjectsFromArray:decoded];
+    }
+    return decodedObjects;
+}
+
+/**
+ * Decodes the objects stored under a range of <tt>keys</tt>. Returns <tt>nil</tt> if any of their representations
+ * isn't a dictionary, which fails the whole batch.
+ */
++ (NSArray *)decodeObjectsWithKeys:(NSArray *)keys inRange:(NSRange)range ofSerializedObjects:(NSDictionary *)serializedObjects {
+    NSMutableArray *decodedObjects = [NSMutableArray arrayWithCapacity:range.length];
+
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+        id key = [keys objectAtIndex:i];
 
         // This prevents the SDK from throwing and catching an error but has the same effect,
         // namely: if any of the objects are invalid, we fail to decode all the objects
         if (![serializedObjects[key] conformsToProtocol:@protocol(NSMutableCopying)]) {
-            return @[];
+            return nil;
         }
 
         NSMutableDictionary *objectRepresentation = [serializedObjects[key] mutableCopy];
@@ -43,7 +100,7 @@
         // Again, this prevents the SDK from throw/catching an error intentionally, but maintains
         // the prior behavior: if this isn't a dictionary, fail to decode the objects
         if (![objectRepresentation isKindOfClass:[NSDictionary class]]) {
-            return @[];
+            return nil;
         }
 
         Class klass = [CMObjectDecoder typeFromDictionaryRepresentation:objectRepresentation];
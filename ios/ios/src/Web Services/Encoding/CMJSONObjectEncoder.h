@@ -0,0 +1,20 @@
+//
+//  CMJSONObjectEncoder.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMStreamingObjectEncoder.h"
+
+/**
+ * Encodes objects straight into UTF-8 JSON, as a <tt>CMStreamingObjectEncoder</tt>. The bytes are the same as
+ * <tt>NSJSONSerialization</tt> would write for the dictionaries of <tt>CMObjectEncoder</tt>, give or take the order of
+ * keys and the spelling of numbers, so large batches are sent without building and walking those dictionaries first.
+ *
+ * Like <tt>NSJSONSerialization</tt>, this raises an <tt>NSInvalidArgumentException</tt> for infinite and NaN numbers.
+ */
+@interface CMJSONObjectEncoder : CMStreamingObjectEncoder
+
+@end
@@ -0,0 +1,266 @@
+//
+//  CMJSONObjectEncoder.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMJSONObjectEncoder.h"
+
+/**
+ * Writes compact JSON into a growing buffer. Commas and colons are put in as values arrive, so the only state kept is
+ * whether each open container has had a value yet.
+ */
+@interface CMJSONWriter : NSObject <CMStreamingWriter>
+@end
+
+@implementation CMJSONWriter {
+    NSMutableData *_buffer;
+    BOOL *_openContainerHasValues;
+    NSUInteger _openContainerCount;
+    NSUInteger _openContainerCapacity;
+
+    // Set between a key and its value, which needs no comma of its own.
+    BOOL _afterKey;
+}
+
+- (instancetype)init;
+{
+    if (self = [super init]) {
+        _buffer = [NSMutableData dataWithCapacity:1024];
+    }
+    return self;
+}
+
+- (void)dealloc;
+{
+    free(_openContainerHasValues);
+}
+
+- (NSData *)data;
+{
+    return _buffer;
+}
+
+- (void)appendCString:(const char *)string length:(NSUInteger)length;
+{
+    [_buffer appendBytes:string length:length];
+}
+
+- (void)beginValue;
+{
+    if (_afterKey) {
+        _afterKey = NO;
+        return;
+    }
+    if (_openContainerCount > 0) {
+        if (_openContainerHasValues[_openContainerCount - 1]) {
+            [self appendCString:"," length:1];
+        }
+        _openContainerHasValues[_openContainerCount - 1] = YES;
+    }
+}
+
+#pragma mark - Containers
+
+- (void)beginContainer:(const char *)opening;
+{
+    [self beginValue];
+    if (_openContainerCount == _openContainerCapacity) {
+        _openContainerCapacity = MAX(16, _openContainerCapacity * 2);
+        _openContainerHasValues = realloc(_openContainerHasValues, _openContainerCapacity * sizeof(BOOL));
+    }
+    _openContainerHasValues[_openContainerCount++] = NO;
+    [self appendCString:opening length:1];
+}
+
+- (void)endContainer:(const char *)closing;
+{
+    NSAssert(_openContainerCount > 0 && !_afterKey, @"There is no container to end.");
+    _openContainerCount--;
+    [self appendCString:closing length:1];
+}
+
+- (void)beginMap;
+{
+    [self beginContainer:"{"];
+}
+
+- (void)writeKey:(NSString *)key;
+{
+    NSAssert(_openContainerCount > 0 && !_afterKey, @"Keys can only be written inside a map.");
+    [self beginValue];
+    [self appendQuotedString:key];
+    [self appendCString:":" length:1];
+    _afterKey = YES;
+}
+
+- (void)endMap;
+{
+    [self endContainer:"}"];
+}
+
+- (void)beginArrayWithCount:(NSUInteger)count;
+{
+    [self beginContainer:"["];
+}
+
+- (void)endArray;
+{
+    [self endContainer:"]"];
+}
+
+#pragma mark - Scalars
+
+- (void)writeNil;
+{
+    [self beginValue];
+    [self appendCString:"null" length:4];
+}
+
+- (void)writeBool:(BOOL)value;
+{
+    [self beginValue];
+    if (value) {
+        [self appendCString:"true" length:4];
+    } else {
+        [self appendCString:"false" length:5];
+    }
+}
+
+- (void)writeInteger:(int64_t)value;
+{
+    char text[24];
+    int length = snprintf(text, sizeof(text), "%lld", (long long)value);
+    [self beginValue];
+    [self appendCString:text length:length];
+}
+
+- (void)writeDouble:(double)value;
+{
+    if (!isfinite(value)) {
+        [[NSException exceptionWithName:NSInvalidArgumentException
+                                 reason:[NSString stringWithFormat:@"Invalid number value (%f) in JSON write", value]
+                               userInfo:nil]
+         raise];
+    }
+
+    // The shorter form when it reads back as the same double, and the one that always does otherwise.
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%.15g", value);
+    if (strtod(text, NULL) != value) {
+        length = snprintf(text, sizeof(text), "%.17g", value);
+    }
+    [self beginValue];
+    [self appendCString:text length:length];
+}
+
+- (void)writeFloat:(float)value;
+{
+    if (!isfinite(value)) {
+        [[NSException exceptionWithName:NSInvalidArgumentException
+                                 reason:[NSString stringWithFormat:@"Invalid number value (%f) in JSON write", value]
+                               userInfo:nil]
+         raise];
+    }
+
+    // Written from the float itself, so 0.1f goes out as 0.1 like NSJSONSerialization writes it, not as the double it widens to.
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%.*g", FLT_DIG, value);
+    if (strtof(text, NULL) != value) {
+        length = snprintf(text, sizeof(text), "%.*g", FLT_DECIMAL_DIG, value);
+    }
+    [self beginValue];
+    [self appendCString:text length:length];
+}
+
+- (void)writeNumber:(NSNumber *)number;
+{
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        [self writeBool:[number boolValue]];
+        return;
+    }
+
+    const char *type = [number objCType];
+    if (*type == 'f') {
+        [self writeFloat:[number floatValue]];
+    } else if (*type == 'd') {
+        [self writeDouble:[number doubleValue]];
+    } else if (*type == 'Q' && [number unsignedLongLongValue] > INT64_MAX) {
+        char text[24];
+        int length = snprintf(text, sizeof(text), "%llu", [number unsignedLongLongValue]);
+        [self beginValue];
+        [self appendCString:text length:length];
+    } else {
+        [self writeInteger:[number longLongValue]];
+    }
+}
+
+- (void)writeString:(NSString *)string;
+{
+    [self beginValue];
+    [self appendQuotedString:string];
+}
+
+- (void)appendQuotedString:(NSString *)string;
+{
+    // Transcode straight into the buffer, between the quotes, rather than through an intermediate NSData.
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    NSUInteger offset = _buffer.length;
+    [_buffer increaseLengthBy:length + 2];
+    uint8_t *bytes = (uint8_t *)_buffer.mutableBytes + offset;
+    bytes[0] = '"';
+    [string getBytes:bytes + 1 maxLength:length usedLength:NULL encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, string.length) remainingRange:NULL];
+    bytes[length + 1] = '"';
+
+    // Most strings have nothing to escape, so only those that do are written again from the first escape on.
+    NSUInteger clean = 0;
+    while (clean < length && bytes[1 + clean] >= 0x20 && bytes[1 + clean] != '"' && bytes[1 + clean] != '\\') {
+        clean++;
+    }
+    if (clean == length) {
+        return;
+    }
+
+    NSData *rest = [NSData dataWithBytes:bytes + 1 + clean length:length - clean];
+    [_buffer setLength:offset + 1 + clean];
+    const uint8_t *restBytes = rest.bytes;
+    NSUInteger runStart = 0;
+    for (NSUInteger i = 0; i < rest.length; i++) {
+        uint8_t c = restBytes[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        [_buffer appendBytes:restBytes + runStart length:i - runStart];
+        runStart = i + 1;
+
+        char escape[8];
+        switch (c) {
+            case '"': [self appendCString:"\\\"" length:2]; break;
+            case '\\': [self appendCString:"\\\\" length:2]; break;
+            case '\n': [self appendCString:"\\n" length:2]; break;
+            case '\r': [self appendCString:"\\r" length:2]; break;
+            case '\t': [self appendCString:"\\t" length:2]; break;
+            case '\b': [self appendCString:"\\b" length:2]; break;
+            case '\f': [self appendCString:"\\f" length:2]; break;
+            default:
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                [self appendCString:escape length:6];
+                break;
+        }
+    }
+    [_buffer appendBytes:restBytes + runStart length:rest.length - runStart];
+    [self appendCString:"\"" length:1];
+}
+
+@end
+
+@implementation CMJSONObjectEncoder
+
++ (id<CMStreamingWriter>)writer;
+{
+    return [[CMJSONWriter alloc] init];
+}
+
+@end
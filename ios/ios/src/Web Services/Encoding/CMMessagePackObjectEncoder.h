@@ -0,0 +1,16 @@
+//
+//  CMMessagePackObjectEncoder.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMStreamingObjectEncoder.h"
+
+/**
+ * Encodes objects straight into MessagePack, as a <tt>CMStreamingObjectEncoder</tt>.
+ */
+@interface CMMessagePackObjectEncoder : CMStreamingObjectEncoder
+
+@end
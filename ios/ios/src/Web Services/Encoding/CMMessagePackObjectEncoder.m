@@ -0,0 +1,31 @@
+//
+//  CMMessagePackObjectEncoder.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMMessagePackObjectEncoder.h"
+#import "CMMessagePackSerialization.h"
+
+@interface CMMessagePackWriter (CMStreamingWriter) <CMStreamingWriter>
+@end
+
+@implementation CMMessagePackWriter (CMStreamingWriter)
+
+- (void)endArray;
+{
+    // MessagePack arrays carry their count up front, so there is nothing to close.
+}
+
+@end
+
+@implementation CMMessagePackObjectEncoder
+
++ (id<CMStreamingWriter>)writer;
+{
+    return [[CMMessagePackWriter alloc] init];
+}
+
+@end
@@ -21,6 +21,7 @@
  */
 @interface CMObjectEncoder : NSCoder {
     NSMutableDictionary *_encodedData;
+    NSSet *_encodedKeys;
 }
 
 /**
@@ -49,4 +50,24 @@
  */
 + (NSDictionary *)encodeObjects:(id<NSFastEnumeration>)objects;
 
+/**
+ * Encodes a collection of objects like <tt>encodeObjects:</tt>, but keeps only some of the top-level fields of each.
+ * Nested objects are always encoded in full, as are the object ID and class name.
+ *
+ * @param objects The objects to encode.
+ * @param keysByObjectId The coder keys to keep, as an <tt>NSSet</tt> for each object ID. Objects whose IDs are missing
+ * are encoded in full.
+ * @return NSDictionary
+ */
++ (NSDictionary *)encodeObjects:(id<NSFastEnumeration>)objects keys:(NSDictionary *)keysByObjectId;
+
+/**
+ * Raises an <tt>NSInvalidArgumentException</tt> unless <tt>object</tt> can be encoded as a top-level object, which
+ * means it conforms to <tt>CMSerializable</tt> and has an object ID. Subclasses that write their own top level call
+ * this for every object.
+ *
+ * @param object The object about to be encoded.
+ */
++ (void)assertTopLevelObjectIsEncodable:(id)object;
+
 @end
@@ -14,6 +14,7 @@
 #import "CMACL.h"
 #import "CMFileMetadata.h"
 #import "CMCoding.h"
+#import "CMClassMetadata.h"
 
 @interface CMObjectEncoder (Private)
 - (NSArray *)encodeAllInList:(NSArray *)list;
@@ -26,26 +27,23 @@
 #pragma mark - Kickoff methods
 
 + (NSDictionary *)encodeObjects:(id<NSFastEnumeration>)objects;
+{
+    return [self encodeObjects:objects keys:nil];
+}
+
++ (NSDictionary *)encodeObjects:(id<NSFastEnumeration>)objects keys:(NSDictionary *)keysByObjectId;
 {
     NSMutableDictionary *topLevelObjectsDictionary = [NSMutableDictionary dictionary];
     for (id<NSObject,CMSerializable> object in objects) {
-        if (![object conformsToProtocol:@protocol(CMSerializable)]) {
-            [[NSException exceptionWithName:NSInvalidArgumentException
-                                     reason:@"All objects to be serialized to CloudMine must conform to CMSerializable"
-                                   userInfo:@{@"object": object}]
-             raise];
-        }
-
-        if (![object respondsToSelector:@selector(objectId)] || object.objectId == nil) {
-            [[NSException exceptionWithName:NSInvalidArgumentException
-                                     reason:@"All objects must supply their own unique, non-nil object identifier"
-                                   userInfo:@{@"object": object}]
-             raise];
-        }
+        [self assertTopLevelObjectIsEncodable:object];
 
         // Each top-level object gets its own encoder, and the result of each serialization is stored
         // at the key specified by the object.
         CMObjectEncoder *objectEncoder = [CMObjectEncoder new];
+        NSSet *keys = [keysByObjectId objectForKey:object.objectId];
+        if (keys) {
+            objectEncoder->_encodedKeys = [keys setByAddingObject:CMInternalObjectIdKey];
+        }
         [object encodeWithCoder:objectEncoder];
         
         NSMutableDictionary *encodedRepresentation = [NSMutableDictionary dictionaryWithDictionary:objectEncoder.encodedRepresentation];
@@ -55,7 +53,7 @@
         }
         
         if (![object isKindOfClass:[CMFileMetadata class]]) {
-            encodedRepresentation[CMInternalClassStorageKey] = [[object class] className];
+            encodedRepresentation[CMInternalClassStorageKey] = [CMClassMetadata metadataForClass:[object class]].className;
         }
         
         [topLevelObjectsDictionary setObject:encodedRepresentation forKey:object.objectId];
@@ -64,20 +62,30 @@
     return topLevelObjectsDictionary;
 }
 
++ (void)assertTopLevelObjectIsEncodable:(id)object;
+{
+    if (![object conformsToProtocol:@protocol(CMSerializable)]) {
+        [[NSException exceptionWithName:NSInvalidArgumentException
+                                 reason:@"All objects to be serialized to CloudMine must conform to CMSerializable"
+                               userInfo:@{@"object": object}]
+         raise];
+    }
+
+    if (![object respondsToSelector:@selector(objectId)] || [object objectId] == nil) {
+        [[NSException exceptionWithName:NSInvalidArgumentException
+                                 reason:@"All objects must supply their own unique, non-nil object identifier"
+                               userInfo:@{@"object": object}]
+         raise];
+    }
+}
+
 - (NSDictionary *)encodeCMCoding:(id<CMCoding>)object;
 {
     CMObjectEncoder *objectEncoder = [[CMObjectEncoder alloc] init];
     [object encodeWithCoder:objectEncoder];
     NSMutableDictionary *encodedRepresentation = [NSMutableDictionary dictionaryWithDictionary:objectEncoder.encodedRepresentation];
     
-    NSString *className = nil;
-    if ([[object class] respondsToSelector:@selector(className)]) {
-        className = [[object class] className];
-    } else {
-        className = NSStringFromClass([object class]);
-    }
-    
-    [encodedRepresentation setObject:className forKey:CMInternalClassStorageKey];
+    [encodedRepresentation setObject:[CMClassMetadata metadataForClass:[object class]].className forKey:CMInternalClassStorageKey];
     return encodedRepresentation;
 }
 
@@ -98,6 +106,9 @@
 
 - (void) encodeBytes:(const uint8_t *)bytesp length:(NSUInteger)lenv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     NSData *data = [NSData dataWithBytes:bytesp length:lenv];
     NSString *base64EncodedString = [data base64EncodedStringWithOptions:0];
     [_encodedData setObject:base64EncodedString forKey:key];
@@ -105,36 +116,57 @@
 
 - (void)encodeBool:(BOOL)boolv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     [_encodedData setObject:[NSNumber numberWithBool:boolv] forKey:key];
 }
 
 - (void)encodeDouble:(double)realv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     [_encodedData setObject:[NSNumber numberWithDouble:realv] forKey:key];
 }
 
 - (void)encodeFloat:(float)realv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     [_encodedData setObject:[NSNumber numberWithFloat:realv] forKey:key];
 }
 
 - (void)encodeInt:(int)intv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     [_encodedData setObject:[NSNumber numberWithInt:intv] forKey:key];
 }
 
 - (void)encodeInteger:(NSInteger)intv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     [_encodedData setObject:[NSNumber numberWithInteger:intv] forKey:key];
 }
 
 - (void)encodeInt32:(int32_t)intv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     [_encodedData setObject:[NSNumber numberWithInt:intv] forKey:key];
 }
 
 - (void)encodeObject:(id)objv forKey:(NSString *)key;
 {
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return;
+    }
     [_encodedData setObject:[self serializeContentsOfObject:objv] forKey:key];
 }
 
@@ -180,7 +212,7 @@
         [objv encodeWithCoder:newEncoder];
         NSMutableDictionary *serializedRepresentation = [NSMutableDictionary dictionaryWithDictionary:newEncoder.encodedRepresentation];
         
-        [serializedRepresentation setObject:[[objv class] className] forKey:CMInternalClassStorageKey];
+        [serializedRepresentation setObject:[CMClassMetadata metadataForClass:[objv class]].className forKey:CMInternalClassStorageKey];
         return serializedRepresentation;
     } else if ([objv isKindOfClass:[CMObject class]]) {
         return [CMObjectEncoder encodeObjects:@[objv]];
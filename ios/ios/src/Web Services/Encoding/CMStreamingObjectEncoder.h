@@ -0,0 +1,62 @@
+//
+//  CMStreamingObjectEncoder.h
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMObjectEncoder.h"
+
+/**
+ * Writes the values of one wire format into a growing buffer, one at a time, in the order they appear in the output.
+ */
+@protocol CMStreamingWriter <NSObject>
+
+/** The bytes written so far. Only a complete value once every container has ended. */
+@property (nonatomic, readonly) NSData *data;
+
+- (void)beginMap;
+- (void)writeKey:(NSString *)key;
+- (void)endMap;
+
+- (void)beginArrayWithCount:(NSUInteger)count;
+- (void)endArray;
+
+- (void)writeNil;
+- (void)writeBool:(BOOL)value;
+- (void)writeInteger:(int64_t)value;
+- (void)writeDouble:(double)value;
+- (void)writeNumber:(NSNumber *)number;
+- (void)writeString:(NSString *)string;
+
+@end
+
+/**
+ * Encodes objects straight into the bytes of a wire format. The output has the same shape as the dictionaries
+ * <tt>CMObjectEncoder</tt> produces, but every value is handed to a <tt>CMStreamingWriter</tt> as soon as the object
+ * encodes it, so no dictionary of any object is ever built.
+ *
+ * Subclasses pick the format by overriding <tt>writer</tt>. <tt>encodedRepresentation</tt> is the <tt>NSData</tt>
+ * written so far.
+ */
+@interface CMStreamingObjectEncoder : CMObjectEncoder
+
+/**
+ * Encodes a collection of objects the way <tt>encodeObjects:keys:</tt> does, as a map keyed by object ID.
+ *
+ * @param objects The objects to encode.
+ * @param keysByObjectId The coder keys to keep, as an <tt>NSSet</tt> for each object ID. Objects whose IDs are missing
+ * are encoded in full.
+ * @return NSData
+ */
++ (NSData *)dataWithObjects:(id<NSFastEnumeration>)objects keys:(NSDictionary *)keysByObjectId;
+
+/**
+ * A new, empty writer for each encoder. This <strong>MUST</strong> be overridden in subclasses.
+ *
+ * @return id<CMStreamingWriter>
+ */
++ (id<CMStreamingWriter>)writer;
+
+@end
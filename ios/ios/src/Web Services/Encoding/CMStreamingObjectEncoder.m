@@ -0,0 +1,285 @@
+//
+//  CMStreamingObjectEncoder.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "CMStreamingObjectEncoder.h"
+#import "CMSerializable.h"
+#import "CMObjectSerialization.h"
+#import "CMGeoPoint.h"
+#import "CMDate.h"
+#import "CMACL.h"
+#import "CMFileMetadata.h"
+#import "CMCoding.h"
+#import "CMClassMetadata.h"
+
+@implementation CMStreamingObjectEncoder {
+    id<CMStreamingWriter> _writer;
+
+    // Whether the map being written gets a class name at its end, which replaces any the object encodes itself.
+    BOOL _appendsClassName;
+
+    // Set while writing the fields of a top-level ACL, whose segments are sent without a class name.
+    BOOL _omitsSegmentsClassName;
+
+    // How often the object being written encodes each key, counted before anything of it is written. A key encoded
+    // more than once is only written the last time, since a dictionary would keep the last value too.
+    NSCountedSet *_keyCounts;
+    BOOL _countsKeys;
+}
+
+#pragma mark - Kickoff methods
+
++ (NSData *)dataWithObjects:(id<NSFastEnumeration>)objects keys:(NSDictionary *)keysByObjectId;
+{
+    // Objects sharing an ID would overwrite each other in a dictionary, so only the last of them is written.
+    NSMutableDictionary *lastObjects = [NSMutableDictionary dictionary];
+    for (id<NSObject,CMSerializable> object in objects) {
+        [self assertTopLevelObjectIsEncodable:object];
+        [lastObjects setObject:object forKey:object.objectId];
+    }
+
+    CMStreamingObjectEncoder *encoder = [[self alloc] init];
+    [encoder->_writer beginMap];
+    for (id<NSObject,CMSerializable> object in objects) {
+        if ([lastObjects objectForKey:object.objectId] != object) {
+            continue;
+        }
+        [lastObjects removeObjectForKey:object.objectId];
+        [encoder->_writer writeKey:object.objectId];
+        [encoder writeTopLevelObject:object keys:[keysByObjectId objectForKey:object.objectId]];
+    }
+    [encoder->_writer endMap];
+    return encoder.encodedRepresentation;
+}
+
+- (instancetype)init;
+{
+    if (self = [super init]) {
+        _writer = [[self class] writer];
+    }
+    return self;
+}
+
++ (id<CMStreamingWriter>)writer;
+{
+    [[NSException exceptionWithName:NSInternalInconsistencyException
+                             reason:[NSString stringWithFormat:@"%@ must override +writer to pick a wire format.", NSStringFromClass(self)]
+                           userInfo:nil]
+     raise];
+    return nil;
+}
+
+#pragma mark - Keyed archiving methods defined by NSCoder
+
+- (BOOL)shouldWriteKey:(NSString *)key;
+{
+    if (_encodedKeys && ![_encodedKeys containsObject:key]) {
+        return NO;
+    }
+    if (_appendsClassName && [key isEqualToString:CMInternalClassStorageKey]) {
+        return NO;
+    }
+    if (_countsKeys) {
+        [_keyCounts addObject:key];
+        return NO;
+    }
+    if ([_keyCounts countForObject:key] > 1) {
+        [_keyCounts removeObject:key];
+        return NO;
+    }
+    return YES;
+}
+
+- (void)encodeBytes:(const uint8_t *)bytesp length:(NSUInteger)lenv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    [_writer writeString:[[NSData dataWithBytes:bytesp length:lenv] base64EncodedStringWithOptions:0]];
+}
+
+- (void)encodeBool:(BOOL)boolv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    [_writer writeBool:boolv];
+}
+
+- (void)encodeDouble:(double)realv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    [_writer writeDouble:realv];
+}
+
+- (void)encodeFloat:(float)realv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    [_writer writeNumber:[NSNumber numberWithFloat:realv]];
+}
+
+- (void)encodeInt:(int)intv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    [_writer writeInteger:intv];
+}
+
+- (void)encodeInteger:(NSInteger)intv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    [_writer writeInteger:intv];
+}
+
+- (void)encodeInt32:(int32_t)intv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    [_writer writeInteger:intv];
+}
+
+- (void)encodeObject:(id)objv forKey:(NSString *)key;
+{
+    if (![self shouldWriteKey:key]) {
+        return;
+    }
+    [_writer writeKey:key];
+    if (_omitsSegmentsClassName && [key isEqualToString:@"segments"] && [objv isKindOfClass:[NSDictionary class]]) {
+        [self writeDictionary:objv withClassName:NO];
+    } else {
+        [self writeContentsOfObject:objv];
+    }
+}
+
+#pragma mark - Private encoding methods
+
+/**
+ * Writes the fields of an object as a map, with the coding state of the encoder set up for that object and put back
+ * afterwards, since nested objects are encoded by this same encoder.
+ */
+- (void)writeFieldsOfObject:(id)object keys:(NSSet *)keys appendingClassName:(BOOL)appendsClassName topLevelACL:(BOOL)topLevelACL;
+{
+    NSSet *outerKeys = _encodedKeys;
+    BOOL outerAppendsClassName = _appendsClassName;
+    BOOL outerOmitsSegmentsClassName = _omitsSegmentsClassName;
+    NSCountedSet *outerKeyCounts = _keyCounts;
+    _encodedKeys = keys;
+    _appendsClassName = appendsClassName;
+    _omitsSegmentsClassName = topLevelACL;
+
+    // Only the keys are counted on this pass; nothing is written and no nested object is visited.
+    _keyCounts = [NSCountedSet set];
+    _countsKeys = YES;
+    [object encodeWithCoder:self];
+    _countsKeys = NO;
+
+    [_writer beginMap];
+    [object encodeWithCoder:self];
+    if (appendsClassName) {
+        [_writer writeKey:CMInternalClassStorageKey];
+        [_writer writeString:[CMClassMetadata metadataForClass:[object class]].className];
+    }
+    [_writer endMap];
+
+    _encodedKeys = outerKeys;
+    _appendsClassName = outerAppendsClassName;
+    _omitsSegmentsClassName = outerOmitsSegmentsClassName;
+    _keyCounts = outerKeyCounts;
+}
+
+- (void)writeTopLevelObject:(id<NSObject,CMSerializable>)object keys:(NSSet *)keys;
+{
+    [self writeFieldsOfObject:object
+                         keys:(keys ? [keys setByAddingObject:CMInternalObjectIdKey] : nil)
+           appendingClassName:![object isKindOfClass:[CMFileMetadata class]]
+                  topLevelACL:[object isKindOfClass:[CMACL class]]];
+}
+
+- (void)writeDictionary:(NSDictionary *)dictionary withClassName:(BOOL)withClassName;
+{
+    [_writer beginMap];
+    for (id key in dictionary) {
+        if (![key isKindOfClass:[NSString class]]) {
+            [[NSException exceptionWithName:@"CMInternalInconsistencyException"
+                                     reason:@"Only dictionaries with string keys can be stored in CMObject instance variables."
+                                   userInfo:nil]
+             raise];
+        }
+        // The class name written at the end would replace this one anyway.
+        if ([key isEqualToString:CMInternalClassStorageKey]) {
+            continue;
+        }
+        [_writer writeKey:key];
+        [self writeContentsOfObject:[dictionary objectForKey:key]];
+    }
+    if (withClassName) {
+        [_writer writeKey:CMInternalClassStorageKey];
+        [_writer writeString:CMInternalHashClassName]; // to differentiate between a custom object and a dictionary.
+    }
+    [_writer endMap];
+}
+
+- (void)writeContentsOfObject:(id)objv;
+{
+    if (objv == NULL || [objv isKindOfClass:[NSNull class]]) {
+        [_writer writeNil];
+    } else if ([objv isKindOfClass:[NSString class]]) {
+        [_writer writeString:objv];
+    } else if ([objv isKindOfClass:[NSNumber class]]) {
+        [_writer writeNumber:objv];
+    } else if ([objv isKindOfClass:[NSDate class]] && ![objv isKindOfClass:[CMDate class]]) {
+        [self writeContentsOfObject:[[CMDate alloc] initWithDate:objv]];
+    } else if ([objv isKindOfClass:[NSArray class]] || [objv isKindOfClass:[NSSet class]]) {
+        [_writer beginArrayWithCount:[objv count]];
+        for (id item in objv) {
+            [self writeContentsOfObject:item];
+        }
+        [_writer endArray];
+    } else if ([objv isKindOfClass:[NSDictionary class]]) {
+        [self writeDictionary:objv withClassName:YES];
+    } else if ([objv isKindOfClass:[CMGeoPoint class]] || [objv isKindOfClass:[CMDate class]] || [objv isKindOfClass:[CMACL class]]) {
+        [self writeFieldsOfObject:objv keys:nil appendingClassName:YES topLevelACL:NO];
+    } else if ([objv isKindOfClass:[CMObject class]]) {
+        // Nested objects are wrapped in a map keyed by their ID, just like a collection of one.
+        [[self class] assertTopLevelObjectIsEncodable:objv];
+        [_writer beginMap];
+        [_writer writeKey:[objv objectId]];
+        [self writeTopLevelObject:objv keys:nil];
+        [_writer endMap];
+    } else if ([[objv class] conformsToProtocol:@protocol(CMCoding)]) {
+        [self writeFieldsOfObject:objv keys:nil appendingClassName:YES topLevelACL:NO];
+    } else {
+        [[NSException exceptionWithName:@"CMInternalInconsistencyException"
+                                 reason:@"You can only store simple values, dictionaries, and arrays in CMObject instance variables."
+                               userInfo:nil]
+         raise];
+    }
+}
+
+#pragma mark - Translation methods
+
+- (id)encodedRepresentation;
+{
+    return _writer.data;
+}
+
+@end
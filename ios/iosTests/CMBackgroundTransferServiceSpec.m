@@ -0,0 +1,196 @@
+//
+//  CMBackgroundTransferServiceSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMBackgroundTransferService.h"
+#import "CMStore.h"
+
+@interface CMBackgroundTransferService (Spec)
+- (void)_registerTask:(NSURLSessionTask *)task upload:(BOOL)upload named:(NSString *)name userLevel:(BOOL)userLevel location:(NSURL *)location successHandler:(id)successHandler errorHandler:(CMWebServiceFetchFailureCallback)errorHandler;
+- (void)_task:(NSURLSessionTask *)task didReceiveData:(NSData *)data;
+- (void)_downloadTask:(NSURLSessionDownloadTask *)task didFinishDownloadingToURL:(NSURL *)location;
+- (void)_task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error;
+@end
+
+SPEC_BEGIN(CMBackgroundTransferServiceSpec)
+
+describe(@"CMBackgroundTransferService", ^{
+
+    __block NSString *registryPath = nil;
+
+    beforeEach(^{
+        registryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    });
+
+    afterEach(^{
+        [[NSFileManager defaultManager] removeItemAtPath:registryPath error:nil];
+    });
+
+    it(@"should pick up pending transfers from its registry", ^{
+        NSString *location = [NSHomeDirectory() stringByAppendingPathComponent:@"Documents/movie.mov"];
+        NSDictionary *registry = @{@"7": @{CMBackgroundTransferIsUploadKey: @YES,
+                                           CMBackgroundTransferUserLevelKey: @NO,
+                                           CMBackgroundTransferFileNameKey: @"movie",
+                                           @"path": @"~/Documents/movie.mov"}};
+        [registry writeToFile:registryPath atomically:YES];
+
+        CMBackgroundTransferService *service = [[CMBackgroundTransferService alloc] initWithSessionIdentifier:[[NSUUID UUID] UUIDString] registryPath:registryPath];
+        NSArray *pending = service.pendingTransfers;
+        [[pending should] haveCountOf:1];
+
+        NSDictionary *transfer = [pending firstObject];
+        [[[transfer objectForKey:CMBackgroundTransferFileNameKey] should] equal:@"movie"];
+        [[[transfer objectForKey:CMBackgroundTransferIsUploadKey] should] equal:@YES];
+        [[[[transfer objectForKey:CMBackgroundTransferLocationKey] path] should] equal:location];
+        [[[transfer objectForKey:@"path"] should] beNil];
+    });
+
+    it(@"should only take the completion handler for its own session", ^{
+        NSString *identifier = [[NSUUID UUID] UUIDString];
+        CMBackgroundTransferService *service = [[CMBackgroundTransferService alloc] initWithSessionIdentifier:identifier registryPath:registryPath];
+        [[theValue([service handleEventsForBackgroundURLSession:identifier completionHandler:^{}]) should] beYes];
+        [[theValue([service handleEventsForBackgroundURLSession:@"other" completionHandler:^{}]) should] beNo];
+        [[service.pendingTransfers should] beEmpty];
+    });
+
+    context(@"when a transfer completes", ^{
+
+        __block CMBackgroundTransferService *service = nil;
+        __block NSURL *location = nil;
+        __block NSDictionary *postedInfo = nil;
+        __block id observer = nil;
+
+        NSURLSessionTask *(^taskWithStatus)(Class, NSUInteger, NSInteger, NSDictionary *) = ^NSURLSessionTask *(Class taskClass, NSUInteger identifier, NSInteger status, NSDictionary *headers) {
+            NSURLSessionTask *task = [taskClass nullMock];
+            [task stub:@selector(taskIdentifier) andReturn:theValue(identifier)];
+            [task stub:@selector(response) andReturn:[[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"https://api.cloudmine.io/"] statusCode:status HTTPVersion:@"HTTP/1.1" headerFields:headers]];
+            return task;
+        };
+
+        beforeEach(^{
+            service = [[CMBackgroundTransferService alloc] initWithSessionIdentifier:[[NSUUID UUID] UUIDString] registryPath:registryPath];
+            location = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+            postedInfo = nil;
+            observer = [[NSNotificationCenter defaultCenter] addObserverForName:CMBackgroundTransferDidFinishNotification object:service queue:nil usingBlock:^(NSNotification *note) {
+                postedInfo = note.userInfo;
+            }];
+        });
+
+        afterEach(^{
+            [[NSNotificationCenter defaultCenter] removeObserver:observer];
+            [[NSFileManager defaultManager] removeItemAtURL:location error:nil];
+        });
+
+        it(@"should report an upload with the key from the response and drop it from the registry", ^{
+            NSURLSessionTask *task = taskWithStatus([NSURLSessionUploadTask class], 3, 201, @{@"Content-Type": @"application/json"});
+            __block NSString *uploadedKey = nil;
+            __block CMFileUploadResult uploadResult = CMFileUploadFailed;
+            __block NSError *uploadError = nil;
+            [service _registerTask:task upload:YES named:nil userLevel:YES location:location successHandler:^(CMFileUploadResult result, NSString *fileKey, id snippetResult, NSDictionary *headers) {
+                uploadResult = result;
+                uploadedKey = fileKey;
+            } errorHandler:^(NSError *error) {
+                uploadError = error;
+            }];
+            [[service.pendingTransfers should] haveCountOf:1];
+
+            [service _task:task didReceiveData:[@"{\"key\":\"movie-" dataUsingEncoding:NSUTF8StringEncoding]];
+            [service _task:task didReceiveData:[@"1234\"}" dataUsingEncoding:NSUTF8StringEncoding]];
+            [service _task:task didCompleteWithError:nil];
+
+            [[uploadError should] beNil];
+            [[uploadedKey should] equal:@"movie-1234"];
+            [[theValue(uploadResult) should] equal:theValue(CMFileCreated)];
+            [[service.pendingTransfers should] beEmpty];
+            [[[NSDictionary dictionaryWithContentsOfFile:registryPath] should] beEmpty];
+
+            [[expectFutureValue(postedInfo) shouldEventually] beNonNil];
+            [[[postedInfo objectForKey:CMBackgroundTransferIsUploadKey] should] equal:@YES];
+            [[[postedInfo objectForKey:CMBackgroundTransferUserLevelKey] should] equal:@YES];
+            [[[postedInfo objectForKey:CMBackgroundTransferUploadedKeyKey] should] equal:@"movie-1234"];
+            [[[postedInfo objectForKey:CMBackgroundTransferUploadResultKey] should] equal:@(CMFileCreated)];
+            [[[[postedInfo objectForKey:CMBackgroundTransferLocationKey] path] should] equal:[location path]];
+            [[[postedInfo objectForKey:CMBackgroundTransferErrorKey] should] beNil];
+        });
+
+        it(@"should map failed responses to CloudMine errors", ^{
+            NSDictionary *codes = @{@400: @(CMErrorInvalidRequest), @401: @(CMErrorUnauthorized), @404: @(CMErrorNotFound), @500: @(CMErrorServerError)};
+            __block NSUInteger identifier = 10;
+            [codes enumerateKeysAndObjectsUsingBlock:^(NSNumber *status, NSNumber *code, BOOL *stop) {
+                NSURLSessionTask *task = taskWithStatus([NSURLSessionUploadTask class], identifier++, [status integerValue], @{});
+                __block NSError *uploadError = nil;
+                __block BOOL succeeded = NO;
+                [service _registerTask:task upload:YES named:@"movie" userLevel:NO location:location successHandler:^(CMFileUploadResult result, NSString *fileKey, id snippetResult, NSDictionary *headers) {
+                    succeeded = YES;
+                } errorHandler:^(NSError *error) {
+                    uploadError = error;
+                }];
+                [service _task:task didCompleteWithError:nil];
+
+                [[theValue(succeeded) should] beNo];
+                [[uploadError.domain should] equal:CMErrorDomain];
+                [[theValue(uploadError.code) should] equal:theValue([code integerValue])];
+            }];
+
+            NSURLSessionTask *task = taskWithStatus([NSURLSessionUploadTask class], identifier, 0, @{});
+            __block NSError *uploadError = nil;
+            [service _registerTask:task upload:YES named:@"movie" userLevel:NO location:location successHandler:nil errorHandler:^(NSError *error) {
+                uploadError = error;
+            }];
+            [service _task:task didCompleteWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil]];
+            [[theValue(uploadError.code) should] equal:theValue(CMErrorServerConnectionFailed)];
+            [[service.pendingTransfers should] beEmpty];
+
+            [[expectFutureValue([postedInfo objectForKey:CMBackgroundTransferErrorKey]) shouldEventually] beNonNil];
+            [[[postedInfo objectForKey:CMBackgroundTransferUploadedKeyKey] should] beNil];
+        });
+
+        it(@"should move a finished download into place", ^{
+            NSURL *downloaded = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+            [[@"file" dataUsingEncoding:NSUTF8StringEncoding] writeToURL:downloaded atomically:YES];
+            NSURLSessionTask *task = taskWithStatus([NSURLSessionDownloadTask class], 20, 200, @{@"Content-Type": @"text/plain"});
+            __block NSURL *downloadedTo = nil;
+            __block NSError *downloadError = nil;
+            [service _registerTask:task upload:NO named:@"file" userLevel:NO location:location successHandler:^(NSURL *url, NSString *mimeType, NSDictionary *headers) {
+                downloadedTo = url;
+            } errorHandler:^(NSError *error) {
+                downloadError = error;
+            }];
+
+            [service _downloadTask:(NSURLSessionDownloadTask *)task didFinishDownloadingToURL:downloaded];
+            [service _task:task didCompleteWithError:nil];
+
+            [[downloadError should] beNil];
+            [[[downloadedTo path] should] equal:[location path]];
+            [[[NSString stringWithContentsOfURL:location encoding:NSUTF8StringEncoding error:nil] should] equal:@"file"];
+        });
+
+        it(@"should fail a download that cannot be moved into place", ^{
+            NSURL *missing = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+            NSURLSessionTask *task = taskWithStatus([NSURLSessionDownloadTask class], 21, 200, @{});
+            __block NSError *downloadError = nil;
+            __block BOOL succeeded = NO;
+            [service _registerTask:task upload:NO named:@"file" userLevel:NO location:location successHandler:^(NSURL *url, NSString *mimeType, NSDictionary *headers) {
+                succeeded = YES;
+            } errorHandler:^(NSError *error) {
+                downloadError = error;
+            }];
+
+            [service _downloadTask:(NSURLSessionDownloadTask *)task didFinishDownloadingToURL:missing];
+            [service _task:task didCompleteWithError:nil];
+
+            [[theValue(succeeded) should] beNo];
+            [[downloadError.domain should] equal:CMErrorDomain];
+            [[[downloadError.userInfo objectForKey:NSUnderlyingErrorKey] should] beNonNil];
+            [[expectFutureValue([postedInfo objectForKey:CMBackgroundTransferErrorKey]) shouldEventually] equal:downloadError];
+        });
+    });
+});
+
+SPEC_END
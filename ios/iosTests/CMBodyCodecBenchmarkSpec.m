@@ -0,0 +1,133 @@
+//
+//  CMBodyCodecBenchmarkSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+#import "CMObject.h"
+#import "CMBodyCodec.h"
+#import "CMObjectDecoder.h"
+#import "CMObjectEncoder.h"
+#import "CMJSONObjectEncoder.h"
+#import "NSDictionary+CMJSON.h"
+
+/**
+ * Round-trips batches of typical objects through JSON and MessagePack locally: encoding straight from the objects,
+ * then decoding back into objects. Sizes and median times are logged for each format. JSON is also written both
+ * through the dictionaries of <tt>CMObjectEncoder</tt> and straight from the objects, to compare the two. Nothing runs
+ * unless <tt>BENCHMARK</tt> is set in the environment; CMBodyCodecSpec covers the encoders' output.
+ */
+
+#define BENCHMARK ([[NSProcessInfo processInfo] environment][@"BENCHMARK"])
+#define BENCHMARK_OBJECT_COUNT 1000
+#define BENCHMARK_RUN_COUNT 15
+
+@interface CMMeasurementObject : CMObject
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, assign) double value;
+@property (nonatomic, strong) NSDate *recorded;
+@property (nonatomic, strong) NSArray *tags;
+@property (nonatomic, strong) NSDictionary *details;
+@end
+
+@implementation CMMeasurementObject
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    if (self = [super initWithCoder:aDecoder]) {
+        _name = [aDecoder decodeObjectForKey:@"name"];
+        _value = [aDecoder decodeDoubleForKey:@"value"];
+        _recorded = [aDecoder decodeObjectForKey:@"recorded"];
+        _tags = [aDecoder decodeObjectForKey:@"tags"];
+        _details = [aDecoder decodeObjectForKey:@"details"];
+    }
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [super encodeWithCoder:aCoder];
+    [aCoder encodeObject:_name forKey:@"name"];
+    [aCoder encodeDouble:_value forKey:@"value"];
+    [aCoder encodeObject:_recorded forKey:@"recorded"];
+    [aCoder encodeObject:_tags forKey:@"tags"];
+    [aCoder encodeObject:_details forKey:@"details"];
+}
+
+@end
+
+static NSTimeInterval CMMedianTime(void (^block)(void)) {
+    NSMutableArray *times = [NSMutableArray arrayWithCapacity:BENCHMARK_RUN_COUNT];
+    for (NSUInteger i = 0; i < BENCHMARK_RUN_COUNT; i++) {
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        @autoreleasepool {
+            block();
+        }
+        [times addObject:@(CFAbsoluteTimeGetCurrent() - start)];
+    }
+    NSArray *sorted = [times sortedArrayUsingSelector:@selector(compare:)];
+    return [[sorted objectAtIndex:sorted.count / 2] doubleValue];
+}
+
+SPEC_BEGIN(CMBodyCodecBenchmarkSpec)
+
+describe(@"CMBodyCodecBenchmark", ^{
+    if (BENCHMARK.length == 0) {
+        return;
+    }
+
+    __block NSArray *objects = nil;
+
+    beforeAll(^{
+        NSMutableArray *measurements = [NSMutableArray arrayWithCapacity:BENCHMARK_OBJECT_COUNT];
+        for (NSUInteger i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+            CMMeasurementObject *object = [[CMMeasurementObject alloc] init];
+            object.name = [NSString stringWithFormat:@"Measurement %lu", (unsigned long)i];
+            object.value = i * 1.5;
+            object.recorded = [NSDate dateWithTimeIntervalSince1970:1454284800 + i];
+            object.tags = @[@"health", @"daily"];
+            object.details = @{@"device": @"watch", @"confidence": @0.95, @"samples": @(i % 60)};
+            [measurements addObject:object];
+        }
+        objects = measurements;
+    });
+
+    it(@"should round-trip typical objects through JSON and MessagePack", ^{
+        for (id<CMBodyCodec> codec in @[[CMJSONBodyCodec codec], [CMMessagePackBodyCodec codec]]) {
+            NSData *data = [codec dataWithObjects:objects keys:nil];
+            NSArray *decoded = [CMObjectDecoder decodeObjects:[codec objectWithData:data error:NULL]];
+            [[theValue(decoded.count) should] equal:theValue(objects.count)];
+
+            NSTimeInterval encodeTime = CMMedianTime(^{
+                [codec dataWithObjects:objects keys:nil];
+            });
+            NSTimeInterval decodeTime = CMMedianTime(^{
+                [CMObjectDecoder decodeObjects:[codec objectWithData:data error:NULL]];
+            });
+            NSLog(@"%@, %d objects: %lu bytes, median encode %.1f ms, decode %.1f ms", codec.contentType, BENCHMARK_OBJECT_COUNT,
+                  (unsigned long)data.length, encodeTime * 1000.0, decodeTime * 1000.0);
+        }
+
+        NSUInteger jsonLength = [[[CMJSONBodyCodec codec] dataWithObjects:objects keys:nil] length];
+        NSUInteger messagePackLength = [[[CMMessagePackBodyCodec codec] dataWithObjects:objects keys:nil] length];
+        [[theValue(messagePackLength) should] beLessThan:theValue(jsonLength)];
+    });
+
+    it(@"should write JSON straight from the objects", ^{
+        NSDictionary *dictionaries = [CMObjectEncoder encodeObjects:objects];
+        NSData *data = [CMJSONObjectEncoder dataWithObjects:objects keys:nil];
+        [[[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] should] equal:dictionaries];
+
+        NSTimeInterval dictionaryTime = CMMedianTime(^{
+            [[CMObjectEncoder encodeObjects:objects] jsonData];
+        });
+        NSTimeInterval streamingTime = CMMedianTime(^{
+            [CMJSONObjectEncoder dataWithObjects:objects keys:nil];
+        });
+        NSLog(@"JSON, %d objects: median encode %.1f ms through dictionaries, %.1f ms streamed", BENCHMARK_OBJECT_COUNT,
+              dictionaryTime * 1000.0, streamingTime * 1000.0);
+    });
+});
+
+SPEC_END
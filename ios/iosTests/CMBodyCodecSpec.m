@@ -0,0 +1,178 @@
+//
+//  CMBodyCodecSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMBodyCodec.h"
+#import "CMMessagePackSerialization.h"
+#import "CMMessagePackObjectEncoder.h"
+#import "CMJSONObjectEncoder.h"
+#import "CMObjectEncoder.h"
+#import "CMObjectDecoder.h"
+#import "CMGenericSerializableObject.h"
+#import "CMGeoPoint.h"
+#import "CMACL.h"
+#import "NSString+UUID.h"
+
+@interface CMTwiceEncodedObject : CMObject
+@end
+
+@implementation CMTwiceEncodedObject
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [super encodeWithCoder:aCoder];
+    [aCoder encodeObject:@"first" forKey:@"name"];
+    [aCoder encodeObject:@"last" forKey:@"name"];
+}
+
+@end
+
+SPEC_BEGIN(CMBodyCodecSpec)
+
+describe(@"CMMessagePackSerialization", ^{
+
+    it(@"should round-trip every supported type", ^{
+        NSMutableString *longString = [NSMutableString string];
+        for (int i = 0; i < 100; i++) {
+            [longString appendString:@"Grüße "];
+        }
+        NSDictionary *object = @{@"small": @1, @"negative": @-5, @"byte": @200, @"short": @-1000, @"int": @70000,
+                                 @"long": @(5000000000LL), @"min": @(INT64_MIN), @"double": @1.5, @"yes": @YES, @"no": @NO,
+                                 @"null": [NSNull null], @"short string": @"café", @"long string": longString,
+                                 @"data": [@"bytes" dataUsingEncoding:NSUTF8StringEncoding],
+                                 @"array": @[@1, @"two", @[@3], @{@"four": @4}], @"empty": @{}};
+
+        NSData *data = [CMMessagePackSerialization dataWithObject:object error:NULL];
+        id decoded = [CMMessagePackSerialization objectWithData:data error:NULL];
+        [[decoded should] equal:object];
+        [[[decoded objectForKey:@"yes"] should] beIdenticalTo:(__bridge id)kCFBooleanTrue];
+    });
+
+    it(@"should reject malformed data", ^{
+        NSData *data = [CMMessagePackSerialization dataWithObject:@{@"key": @"value"} error:NULL];
+        NSError *error = nil;
+
+        [[[CMMessagePackSerialization objectWithData:[data subdataWithRange:NSMakeRange(0, data.length - 1)] error:&error] should] beNil];
+        [[theValue(error.code) should] equal:theValue(NSPropertyListReadCorruptError)];
+
+        NSMutableData *trailing = [data mutableCopy];
+        [trailing appendBytes:"\xc0" length:1];
+        [[[CMMessagePackSerialization objectWithData:trailing error:NULL] should] beNil];
+        [[[CMMessagePackSerialization dataWithObject:@{@"date": [NSDate date]} error:NULL] should] beNil];
+    });
+});
+
+describe(@"CMMessagePackObjectEncoder", ^{
+
+    it(@"should encode objects to the same shape as CMObjectEncoder", ^{
+        CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+        [object fillPropertiesWithDefaults];
+        [object.dictionary setObject:@{@"nested": @[@1, [NSNull null]]} forKey:@"map"];
+        object.nestedObject = [[CMGeoPoint alloc] initWithLatitude:14.1247 andLongitude:-74.199887];
+        CMACL *acl = [[CMACL alloc] init];
+        acl.members = [NSSet setWithObject:@"member"];
+
+        NSArray *objects = @[object, acl];
+        NSData *data = [CMMessagePackObjectEncoder dataWithObjects:objects keys:nil];
+        [[[CMMessagePackSerialization objectWithData:data error:NULL] should] equal:[CMObjectEncoder encodeObjects:objects]];
+
+        NSDictionary *keys = @{object.objectId: [NSSet setWithObject:@"string1"]};
+        data = [CMMessagePackObjectEncoder dataWithObjects:objects keys:keys];
+        [[[CMMessagePackSerialization objectWithData:data error:NULL] should] equal:[CMObjectEncoder encodeObjects:objects keys:keys]];
+    });
+
+    it(@"should only write the last value of a key encoded twice", ^{
+        CMTwiceEncodedObject *object = [[CMTwiceEncodedObject alloc] initWithObjectId:[NSString stringWithUUID]];
+        CMTwiceEncodedObject *sameId = [[CMTwiceEncodedObject alloc] initWithObjectId:object.objectId];
+        NSArray *objects = @[object, sameId];
+
+        NSData *data = [CMMessagePackObjectEncoder dataWithObjects:objects keys:nil];
+        [[theValue([data rangeOfData:[@"first" dataUsingEncoding:NSUTF8StringEncoding] options:0 range:NSMakeRange(0, data.length)].location) should] equal:theValue(NSNotFound)];
+        [[[CMMessagePackSerialization objectWithData:data error:NULL] should] equal:[CMObjectEncoder encodeObjects:objects]];
+
+        data = [CMJSONObjectEncoder dataWithObjects:objects keys:nil];
+        NSString *json = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+        [[theValue([json rangeOfString:@"first"].location) should] equal:theValue(NSNotFound)];
+        [[theValue([json componentsSeparatedByString:object.objectId].count) should] equal:theValue(3)]; // once as the key, once as the ID
+        [[[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] should] equal:[CMObjectEncoder encodeObjects:objects]];
+    });
+
+    it(@"should decode back into equal objects", ^{
+        CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+        [object fillPropertiesWithDefaults];
+
+        NSData *data = [[CMMessagePackBodyCodec codec] dataWithObjects:@[object] keys:nil];
+        NSArray *decoded = [CMObjectDecoder decodeObjects:[[CMMessagePackBodyCodec codec] objectWithData:data error:NULL]];
+        [[decoded should] equal:@[object]];
+    });
+});
+
+describe(@"CMJSONObjectEncoder", ^{
+
+    it(@"should encode objects to the same JSON as CMObjectEncoder", ^{
+        CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+        [object fillPropertiesWithDefaults];
+        [object.dictionary setObject:@{@"nested": @[@1, [NSNull null], @0.1], @"empty": @[]} forKey:@"map"];
+        object.nestedObject = [[CMGeoPoint alloc] initWithLatitude:14.1247 andLongitude:-74.199887];
+        CMACL *acl = [[CMACL alloc] init];
+        acl.members = [NSSet setWithObject:@"member"];
+
+        NSArray *objects = @[object, acl];
+        NSData *data = [CMJSONObjectEncoder dataWithObjects:objects keys:nil];
+        [[[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] should] equal:[CMObjectEncoder encodeObjects:objects]];
+
+        NSDictionary *keys = @{object.objectId: [NSSet setWithObject:@"string1"]};
+        data = [CMJSONObjectEncoder dataWithObjects:objects keys:keys];
+        [[[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] should] equal:[CMObjectEncoder encodeObjects:objects keys:keys]];
+    });
+
+    it(@"should write floats the way NSJSONSerialization does", ^{
+        CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+        [object fillPropertiesWithDefaults];
+        [object.dictionary setObject:@[@0.1f, @(1.0f / 3.0f), @16777216.0f, @-2.5e-8f] forKey:@"floats"];
+
+        NSString *json = [[NSString alloc] initWithData:[CMJSONObjectEncoder dataWithObjects:@[object] keys:nil] encoding:NSUTF8StringEncoding];
+        [[json should] containString:@"[0.1,0.333333343,16777216,-2.5e-08]"];
+
+        NSArray *floats = [[[[NSJSONSerialization JSONObjectWithData:[json dataUsingEncoding:NSUTF8StringEncoding] options:0 error:NULL]
+                             objectForKey:object.objectId] objectForKey:@"dictionary"] objectForKey:@"floats"];
+        [[theValue([[floats objectAtIndex:2] floatValue]) should] equal:theValue(16777216.0f)];
+        [[theValue([[floats objectAtIndex:1] floatValue]) should] equal:theValue(1.0f / 3.0f)];
+    });
+
+    it(@"should escape strings", ^{
+        CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+        object.string1 = @"quote \" backslash \\ newline \n tab \t bell \a café";
+        object.string2 = @"plain";
+
+        NSData *data = [CMJSONObjectEncoder dataWithObjects:@[object] keys:nil];
+        NSDictionary *decoded = [[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] objectForKey:object.objectId];
+        [[[decoded objectForKey:@"string1"] should] equal:object.string1];
+        [[[decoded objectForKey:@"string2"] should] equal:object.string2];
+    });
+
+    it(@"should refuse numbers JSON can't hold", ^{
+        CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+        object.dictionary = [NSMutableDictionary dictionaryWithObject:@(NAN) forKey:@"value"];
+        [[theBlock(^{
+            [CMJSONObjectEncoder dataWithObjects:@[object] keys:nil];
+        }) should] raiseWithName:NSInvalidArgumentException];
+    });
+});
+
+describe(@"CMBodyCodecForContentType", ^{
+
+    it(@"should pick the codec by MIME type", ^{
+        [[(id)CMBodyCodecForContentType(@"application/x-msgpack") should] beKindOfClass:[CMMessagePackBodyCodec class]];
+        [[(id)CMBodyCodecForContentType(@"Application/MsgPack; charset=binary") should] beKindOfClass:[CMMessagePackBodyCodec class]];
+        [[(id)CMBodyCodecForContentType(@"application/json; charset=utf-8") should] beKindOfClass:[CMJSONBodyCodec class]];
+        [[(id)CMBodyCodecForContentType(nil) should] beKindOfClass:[CMJSONBodyCodec class]];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,53 @@
+//
+//  CMClassMetadataSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMClassMetadata.h"
+#import "Venue.h"
+#import "TestUser.h"
+
+SPEC_BEGIN(CMClassMetadataSpec)
+
+describe(@"CMClassMetadata", ^{
+
+    it(@"should build the metadata of a class once", ^{
+        [[[CMClassMetadata metadataForClass:[Venue class]] should] beIdenticalTo:[CMClassMetadata metadataForClass:[Venue class]]];
+    });
+
+    it(@"should use the custom class name of a CMObject subclass", ^{
+        [[[CMClassMetadata metadataForClass:[Venue class]].className should] equal:@"venue"];
+        [[[CMClassMetadata metadataForClass:[NSObject class]].className should] equal:@"NSObject"];
+    });
+
+    it(@"should list the user-defined properties of a CMObject subclass", ^{
+        NSArray *names = [CMClassMetadata metadataForClass:[Venue class]].userDefinedPropertyNames;
+        [[names should] containObjects:@"name", @"address", @"city", @"state", @"zip", @"location", @"categoryIcon", @"aclIds", nil];
+        [[names shouldNot] contain:@"objectId"];
+        [[names shouldNot] contain:@"store"];
+    });
+
+    it(@"should list the profile fields of a CMUser subclass", ^{
+        NSArray *names = [CMClassMetadata metadataForClass:[TestUser class]].userDefinedPropertyNames;
+        [[names should] haveCountOf:3];
+        [[names should] containObjects:@"firstName", @"lastName", @"aVenue", nil];
+    });
+
+    it(@"should be safe to look up from many threads at once", ^{
+        NSMutableSet *seen = [NSMutableSet set];
+        dispatch_apply(64, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+            CMClassMetadata *metadata = [CMClassMetadata metadataForClass:[TestUser class]];
+            @synchronized(seen) {
+                [seen addObject:[NSValue valueWithNonretainedObject:metadata]];
+            }
+        });
+        [[seen should] haveCountOf:1];
+    });
+});
+
+SPEC_END
@@ -143,6 +143,26 @@ describe(@"CMFile", ^{
             //uhhhh.... what.
         });
         
+        it(@"should read its data from disk when backed by a file URL", ^{
+            NSURL *url = [[NSBundle bundleForClass:[self class]] URLForResource:@"cloudmine" withExtension:@"png"];
+            CMFile *diskFile = [[CMFile alloc] initWithContentsOfURL:url named:fileName mimeType:@"image/png"];
+            
+            [[diskFile.fileURL should] equal:url];
+            [[diskFile.fileData should] equal:[NSData dataWithContentsOfURL:url]];
+            [[diskFile.mimeType should] equal:@"image/png"];
+        });
+        
+        it(@"should stream its contents from disk when saved", ^{
+            NSURL *url = [[NSBundle bundleForClass:[self class]] URLForResource:@"cloudmine" withExtension:@"png"];
+            CMFile *diskFile = [[CMFile alloc] initWithContentsOfURL:url named:fileName mimeType:@"image/png"];
+            store = [CMStore store];
+            store.webService = [CMWebService nullMock];
+            diskFile.store = store;
+            
+            [[store.webService should] receive:@selector(uploadFileAtPath:serverSideFunction:named:ofMimeType:user:extraParameters:successHandler:errorHandler:)];
+            [diskFile save:nil];
+        });
+        
     });
 
     context(@"given a user-level CMFile instance", ^{
@@ -0,0 +1,71 @@
+//
+//  CMJSONEntryParserSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMJSONEntryParser.h"
+
+SPEC_BEGIN(CMJSONEntryParserSpec)
+
+describe(@"CMJSONEntryParser", ^{
+
+    __block NSMutableArray *keys = nil;
+    __block NSMutableDictionary *entries = nil;
+    __block CMJSONEntryParser *parser = nil;
+
+    beforeEach(^{
+        keys = [NSMutableArray array];
+        entries = [NSMutableDictionary dictionary];
+        parser = [[CMJSONEntryParser alloc] initWithEntriesKey:@"success" entryHandler:^(NSString *key, id value) {
+            [keys addObject:key];
+            [entries setObject:value forKey:key];
+        }];
+    });
+
+    it(@"should hand out each entry and return the other members, however the body is split", ^{
+        NSDictionary *successes = @{@"plain": @{@"name": @"} { ] [ , :", @"list": @[@1, @{@"nested": [NSNull null]}]},
+                                    @"quote \" and \\ backslash": @{@"escaped": @"\"\\\n"},
+                                    @"café": @{}};
+        NSDictionary *body = @{@"meta": @{@"plain": @{@"owner": @"someone"}}, @"success": successes, @"errors": @{}, @"count": @3, @"result": @"}"};
+        NSData *data = [NSJSONSerialization dataWithJSONObject:body options:NSJSONWritingPrettyPrinted error:NULL];
+
+        const uint8_t *bytes = data.bytes;
+        for (NSUInteger offset = 0; offset < data.length; offset += 3) {
+            [[theValue([parser parseBytes:bytes + offset length:MIN(3, data.length - offset) error:NULL]) should] beYes];
+        }
+        NSDictionary *members = [parser finishWithError:NULL];
+
+        [[entries should] equal:successes];
+        [[theValue(keys.count) should] equal:theValue(successes.count)];
+        NSMutableDictionary *rest = [body mutableCopy];
+        [rest removeObjectForKey:@"success"];
+        [[members should] equal:rest];
+    });
+
+    it(@"should return a success member that isn't an object with the others", ^{
+        NSData *data = [@"{\"success\": [1, 2], \"count\": 2}" dataUsingEncoding:NSUTF8StringEncoding];
+        [[[parser parseData:data error:NULL] should] equal:@{@"success": @[@1, @2], @"count": @2}];
+        [[entries should] beEmpty];
+    });
+
+    it(@"should reject bodies that are malformed or cut short", ^{
+        NSError *error = nil;
+        NSData *data = [@"{\"success\": {\"a\": {\"name\": 1}, \"b\": {\"name\"" dataUsingEncoding:NSUTF8StringEncoding];
+        [[[parser parseData:data error:&error] should] beNil];
+        [[theValue(error.code) should] equal:theValue(NSPropertyListReadCorruptError)];
+        [[theValue(keys.count) should] equal:theValue(1)];
+
+        CMJSONEntryParser *other = [[CMJSONEntryParser alloc] initWithEntriesKey:@"success" entryHandler:nil];
+        [[[other parseData:[@"[1, 2]" dataUsingEncoding:NSUTF8StringEncoding] error:NULL] should] beNil];
+
+        other = [[CMJSONEntryParser alloc] initWithEntriesKey:@"success" entryHandler:nil];
+        [[[other parseData:[@"{\"success\": {\"a\": nope}}" dataUsingEncoding:NSUTF8StringEncoding] error:NULL] should] beNil];
+    });
+});
+
+SPEC_END
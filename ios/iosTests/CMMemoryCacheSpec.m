@@ -0,0 +1,102 @@
+//
+//  CMMemoryCacheSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMMemoryCache.h"
+
+SPEC_BEGIN(CMMemoryCacheSpec)
+
+describe(@"CMMemoryCache", ^{
+
+    __block CMMemoryCache *cache = nil;
+
+    beforeEach(^{
+        cache = [[CMMemoryCache alloc] init];
+        cache.costEstimator = ^NSUInteger(NSString *object) {
+            return object.length;
+        };
+    });
+
+    it(@"should evict the least recently used object past the count limit", ^{
+        cache.countLimit = 2;
+        [cache setObject:@"a" forKey:@"1"];
+        [cache setObject:@"b" forKey:@"2"];
+        [cache objectForKey:@"1"];
+        [cache setObject:@"c" forKey:@"3"];
+
+        [[theValue(cache.count) should] equal:theValue(2)];
+        [[[cache objectForKey:@"1"] should] equal:@"a"];
+        [[[cache objectForKey:@"2"] should] beNil];
+    });
+
+    it(@"should evict objects until the total cost fits", ^{
+        cache.totalCostLimit = 10;
+        [cache setObject:@"aaaa" forKey:@"1"];
+        [cache setObject:@"bbbb" forKey:@"2"];
+        [[theValue(cache.totalCost) should] equal:theValue(8)];
+
+        [cache setObject:@"cccccccc" forKey:@"3"];
+        [[theValue(cache.count) should] equal:theValue(1)];
+        [[theValue(cache.totalCost) should] equal:theValue(8)];
+    });
+
+    it(@"should take known costs over the estimate and update them in place", ^{
+        cache.totalCostLimit = 10;
+        [cache setObject:@"a" forKey:@"1" cost:4];
+        [cache setObject:@"b" forKey:@"2"];
+        [[theValue(cache.totalCost) should] equal:theValue(5)];
+
+        [cache setCost:2 ofObject:@"other" forKey:@"1"];
+        [[theValue(cache.totalCost) should] equal:theValue(5)];
+
+        [cache setCost:10 ofObject:[cache objectForKey:@"2"] forKey:@"2"];
+        [[theValue(cache.count) should] equal:theValue(1)];
+        [[[cache objectForKey:@"2"] should] equal:@"b"];
+        [[theValue(cache.totalCost) should] equal:theValue(10)];
+    });
+
+    it(@"should not evict objects the filter refuses", ^{
+        cache.countLimit = 1;
+        cache.evictionFilter = ^BOOL(NSString *object) {
+            return ![object isEqualToString:@"pinned"];
+        };
+        [cache setObject:@"pinned" forKey:@"1"];
+        [cache setObject:@"b" forKey:@"2"];
+
+        [[[cache objectForKey:@"1"] should] equal:@"pinned"];
+        [[[cache objectForKey:@"2"] should] beNil];
+    });
+
+    it(@"should report evicted objects to the handler", ^{
+        NSMutableArray *evicted = [NSMutableArray array];
+        cache.evictionHandler = ^(id key, id object) {
+            [evicted addObject:key];
+        };
+        cache.countLimit = 1;
+        [cache setObject:@"a" forKey:@"1"];
+        [cache setObject:@"b" forKey:@"2"];
+        [cache removeObjectForKey:@"2"];
+
+        [[evicted should] equal:@[@"1"]];
+    });
+
+    it(@"should trim to the low-water mark", ^{
+        cache.countLimit = 10;
+        for (NSUInteger i = 0; i < 10; i++) {
+            [cache setObject:@"x" forKey:@(i)];
+        }
+        [cache trimToLowWaterMark];
+
+        [[theValue(cache.count) should] equal:theValue(5)];
+        [[[cache objectForKey:@9] should] equal:@"x"];
+        [[[cache objectForKey:@0] should] beNil];
+    });
+});
+
+SPEC_END
@@ -34,6 +34,8 @@ describe(@"CMNullStore", ^{
         [[theBlock(^{ [null searchUserObjects:nil additionalOptions:nil callback:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
         [[theBlock(^{ [null fileWithName:nil additionalOptions:nil callback:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
         [[theBlock(^{ [null userFileWithName:nil additionalOptions:nil callback:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
+        [[theBlock(^{ [null fileWithName:nil toURL:nil additionalOptions:nil progress:nil callback:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
+        [[theBlock(^{ [null userFileWithName:nil toURL:nil additionalOptions:nil progress:nil callback:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
         [[theBlock(^{ [null saveAll:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
         [[theBlock(^{ [null saveAllWithOptions:nil callback:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
         [[theBlock(^{ [null saveAllAppObjects:nil]; }) should] raiseWithName:@"CMInvalidStoreException"];
@@ -0,0 +1,137 @@
+//
+//  CMObjectCacheSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMObjectCache.h"
+#import "CMObjectSerialization.h"
+
+SPEC_BEGIN(CMObjectCacheSpec)
+
+describe(@"CMObjectCache", ^{
+
+    __block CMObjectCache *cache = nil;
+    __block NSString *path = nil;
+    NSDictionary *venue = @{CMInternalObjectIdKey: @"venue1", CMInternalClassStorageKey: @"Venue", @"name": @"The Venue"};
+    NSDictionary *person = @{CMInternalObjectIdKey: @"person1", CMInternalClassStorageKey: @"Person", @"name": @"Someone"};
+
+    beforeEach(^{
+        path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"sqlite"]];
+        cache = [[CMObjectCache alloc] initWithPath:path];
+    });
+
+    afterEach(^{
+        cache = nil;
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    });
+
+    it(@"should return stored representations by key", ^{
+        [cache storeRepresentations:@{@"venue1": venue, @"person1": person} ownerIdentifier:nil];
+
+        NSDictionary *found = [cache representationsWithKeys:@[@"venue1", @"missing"] ownerIdentifier:nil maximumAge:0];
+        [[found should] equal:@{@"venue1": venue}];
+        [[[cache representationsWithKeys:nil ownerIdentifier:nil maximumAge:0] should] haveCountOf:2];
+    });
+
+    it(@"should return stored representations by class", ^{
+        [cache storeRepresentations:@{@"venue1": venue, @"person1": person} ownerIdentifier:nil];
+
+        [[[cache representationsOfClassNamed:@"Venue" ownerIdentifier:nil maximumAge:0] should] equal:@{@"venue1": venue}];
+    });
+
+    it(@"should keep the objects of each owner apart", ^{
+        [cache storeRepresentations:@{@"venue1": venue} ownerIdentifier:@"user1"];
+
+        [[[cache representationsWithKeys:@[@"venue1"] ownerIdentifier:nil maximumAge:0] should] beEmpty];
+        [[[cache representationsWithKeys:@[@"venue1"] ownerIdentifier:@"user2" maximumAge:0] should] beEmpty];
+        [[[cache representationsWithKeys:@[@"venue1"] ownerIdentifier:@"user1" maximumAge:0] should] haveCountOf:1];
+    });
+
+    it(@"should leave out representations older than the maximum age", ^{
+        [cache storeRepresentations:@{@"venue1": venue} ownerIdentifier:nil];
+        [NSThread sleepForTimeInterval:0.2];
+
+        [[[cache representationsWithKeys:@[@"venue1"] ownerIdentifier:nil maximumAge:0.1] should] beEmpty];
+        [[[cache representationsWithKeys:@[@"venue1"] ownerIdentifier:nil maximumAge:60] should] haveCountOf:1];
+    });
+
+    it(@"should remove representations", ^{
+        [cache storeRepresentations:@{@"venue1": venue, @"person1": person} ownerIdentifier:nil];
+        [cache removeRepresentationsWithKeys:@[@"venue1"] ownerIdentifier:nil];
+
+        [[[[cache representationsWithKeys:nil ownerIdentifier:nil maximumAge:0] allKeys] should] equal:@[@"person1"]];
+
+        [cache removeAllRepresentations];
+        [[[cache representationsWithKeys:nil ownerIdentifier:nil maximumAge:0] should] beEmpty];
+    });
+
+    it(@"should merge partial representations into stored ones", ^{
+        [cache storeRepresentations:@{@"venue1": venue} ownerIdentifier:nil];
+        [cache mergeRepresentations:@{@"venue1": @{@"name": @"Renamed"}, @"person1": @{@"name": @"Nobody"}} ownerIdentifier:nil];
+
+        NSDictionary *found = [cache representationsWithKeys:nil ownerIdentifier:nil maximumAge:0];
+        [[[found allKeys] should] equal:@[@"venue1"]];
+        [[found[@"venue1"][@"name"] should] equal:@"Renamed"];
+        [[found[@"venue1"][CMInternalClassStorageKey] should] equal:@"Venue"];
+    });
+
+    it(@"should remember when a query was last fetched", ^{
+        [[[cache lastFetchOfQuery:@"Venue" ownerIdentifier:nil] should] beNil];
+
+        [cache recordFetchOfQuery:@"Venue" ownerIdentifier:nil];
+        NSDate *lastFetch = [cache lastFetchOfQuery:@"Venue" ownerIdentifier:nil];
+        [[lastFetch should] beNonNil];
+        [[theValue(-[lastFetch timeIntervalSinceNow]) should] beLessThan:theValue(5.0)];
+        [[[cache lastFetchOfQuery:@"Venue" ownerIdentifier:@"user1"] should] beNil];
+    });
+
+    it(@"should keep objects shared with a user apart from their own", ^{
+        NSDictionary *sharedVenue = @{CMInternalObjectIdKey: @"venue2", CMInternalClassStorageKey: @"Venue", @"name": @"Shared"};
+        [cache storeRepresentations:@{@"venue1": venue, @"venue2": sharedVenue} sharedKeys:[NSSet setWithObject:@"venue2"] ownerIdentifier:@"user1"];
+        [cache storeRepresentations:@{@"venue2": sharedVenue} ownerIdentifier:@"user1"];
+
+        [[[[cache representationsOfClassNamed:@"Venue" scope:CMObjectCacheScopeOwned ownerIdentifier:@"user1" maximumAge:0] allKeys] should] equal:@[@"venue1"]];
+        [[[[cache representationsOfClassNamed:nil scope:CMObjectCacheScopeShared ownerIdentifier:@"user1" maximumAge:0] allKeys] should] equal:@[@"venue2"]];
+        [[[cache representationsOfClassNamed:@"Venue" scope:CMObjectCacheScopeAll ownerIdentifier:@"user1" maximumAge:0] should] haveCountOf:2];
+    });
+
+    it(@"should drop objects a complete fetch no longer returns, within its class and scope", ^{
+        NSDictionary *deletedVenue = @{CMInternalObjectIdKey: @"venue2", CMInternalClassStorageKey: @"Venue", @"name": @"Deleted"};
+        NSDictionary *sharedVenue = @{CMInternalObjectIdKey: @"venue3", CMInternalClassStorageKey: @"Venue", @"name": @"Shared"};
+        [cache storeRepresentations:@{@"venue1": venue, @"venue2": deletedVenue, @"person1": person, @"venue3": sharedVenue}
+                         sharedKeys:[NSSet setWithObject:@"venue3"]
+                    ownerIdentifier:@"user1"];
+
+        [cache recordCompleteFetchOfQuery:@"Venue" className:@"Venue" scope:CMObjectCacheScopeOwned keys:@[@"venue1"] ownerIdentifier:@"user1"];
+
+        NSDictionary *found = [cache representationsWithKeys:nil ownerIdentifier:@"user1" maximumAge:0];
+        [[[NSSet setWithArray:[found allKeys]] should] equal:[NSSet setWithObjects:@"venue1", @"person1", @"venue3", nil]];
+        [[[cache lastFetchOfQuery:@"Venue" ownerIdentifier:@"user1"] should] beNonNil];
+    });
+
+    it(@"should remove everything of one owner", ^{
+        [cache storeRepresentations:@{@"venue1": venue} ownerIdentifier:@"user1"];
+        [cache storeRepresentations:@{@"venue1": venue} ownerIdentifier:nil];
+        [cache recordFetchOfQuery:@"*" ownerIdentifier:@"user1"];
+
+        [cache removeAllRepresentationsOfOwner:@"user1"];
+        [[[cache representationsWithKeys:nil ownerIdentifier:@"user1" maximumAge:0] should] beEmpty];
+        [[[cache lastFetchOfQuery:@"*" ownerIdentifier:@"user1"] should] beNil];
+        [[[cache representationsWithKeys:nil ownerIdentifier:nil maximumAge:0] should] haveCountOf:1];
+    });
+
+    it(@"should persist across instances", ^{
+        [cache storeRepresentations:@{@"venue1": venue} ownerIdentifier:nil];
+        [[[cache representationsWithKeys:@[@"venue1"] ownerIdentifier:nil maximumAge:0] should] haveCountOf:1];
+
+        CMObjectCache *reopened = [[CMObjectCache alloc] initWithPath:path];
+        [[[reopened representationsWithKeys:@[@"venue1"] ownerIdentifier:nil maximumAge:0] should] equal:@{@"venue1": venue}];
+    });
+});
+
+SPEC_END
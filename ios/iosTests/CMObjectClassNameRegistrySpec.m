@@ -9,6 +9,26 @@
 #import "Kiwi.h"
 #import "CMObjectClassNameRegistry.h"
 #import "CMTestEncoder.h"
+#import "CMObject.h"
+#import "CMACL.h"
+#import "CMDate.h"
+
+@interface CMObjectClassNameRegistry (Spec)
+- (void)rebuildLookupTable;
+@end
+
+@interface CMRegisteredTestObject : CMObject
+@end
+
+@implementation CMRegisteredTestObject
+
++ (NSString *)className {
+    return @"RegisteredTestObject";
+}
+
+@end
+
+CM_REGISTER_CLASS(CMRegisteredTestObject)
 
 SPEC_BEGIN(CMObjectClassNameRegistrySpec)
 
@@ -53,6 +73,28 @@ describe(@"CMObjectClassNameRegistry", ^{
         Class anotherClass = [registry classForName:@"TestEncoderDeeper"];
         [[theValue(anotherClass == [CMTestEncoderNSCodingDeeper class]) should] equal:@YES];
     });
+
+    it(@"should find classes registered at load time under their custom names without a scan", ^{
+        CMObjectClassNameRegistry *registry = [CMObjectClassNameRegistry sharedInstance];
+        // Other examples may have scanned already, so the registry is taken back to what it knows without a scan.
+        @synchronized(registry) {
+            [registry setValue:nil forKey:@"scannedClasses"];
+            [registry rebuildLookupTable];
+        }
+
+        [[theValue([registry classForName:@"RegisteredTestObject"] == [CMRegisteredTestObject class]) should] equal:@YES];
+        [[theValue([registry classForName:@"acl"] == [CMACL class]) should] equal:@YES];
+        [[theValue([registry classForName:@"datetime"] == [CMDate class]) should] equal:@YES];
+        [[[registry valueForKey:@"scannedClasses"] should] beNil];
+    });
+
+    it(@"should remember names that match no class", ^{
+        CMObjectClassNameRegistry *registry = [CMObjectClassNameRegistry sharedInstance];
+        [[[registry classForName:@"CMNoSuchClass"] should] beNil];
+        [[[registry valueForKey:@"missingNames"] should] contain:@"CMNoSuchClass"];
+        [[[registry classForName:@"CMNoSuchClass"] should] beNil];
+        [[[registry classForName:nil] should] beNil];
+    });
    
 });
 
@@ -0,0 +1,69 @@
+//
+//  CMObjectDecoderBenchmarkSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+#import "CMObjectEncoder.h"
+#import "CMObjectDecoder.h"
+#import "CMGenericSerializableObject.h"
+#import "NSString+UUID.h"
+
+/**
+ * Decodes result sets of 1k, 10k and 50k objects serially and concurrently, and logs the median time of each
+ * along with the speedup and the number of cores it was spread across. Nothing runs unless <tt>BENCHMARK</tt> is set
+ * in the environment; CMObjectDecoderSpec checks that both ways decode the same objects.
+ */
+
+#define BENCHMARK ([[NSProcessInfo processInfo] environment][@"BENCHMARK"])
+#define BENCHMARK_RUN_COUNT 5
+
+static NSTimeInterval CMMedianDecodeTime(NSDictionary *encoded, BOOL concurrently) {
+    NSMutableArray *times = [NSMutableArray arrayWithCapacity:BENCHMARK_RUN_COUNT];
+    for (NSUInteger i = 0; i < BENCHMARK_RUN_COUNT; i++) {
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        @autoreleasepool {
+            [CMObjectDecoder decodeObjects:encoded concurrently:concurrently];
+        }
+        [times addObject:@(CFAbsoluteTimeGetCurrent() - start)];
+    }
+    NSArray *sorted = [times sortedArrayUsingSelector:@selector(compare:)];
+    return [[sorted objectAtIndex:sorted.count / 2] doubleValue];
+}
+
+SPEC_BEGIN(CMObjectDecoderBenchmarkSpec)
+
+describe(@"CMObjectDecoderBenchmark", ^{
+    if (BENCHMARK.length == 0) {
+        return;
+    }
+
+    it(@"should decode large result sets across cores", ^{
+        for (NSNumber *objectCount in @[@1000, @10000, @50000]) {
+            NSDictionary *encoded = nil;
+            @autoreleasepool {
+                NSMutableArray *objects = [NSMutableArray arrayWithCapacity:[objectCount unsignedIntegerValue]];
+                for (NSUInteger i = 0; i < [objectCount unsignedIntegerValue]; i++) {
+                    CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+                    [object fillPropertiesWithDefaults];
+                    [objects addObject:object];
+                }
+                encoded = [CMObjectEncoder encodeObjects:objects];
+            }
+
+            NSArray *decoded = [CMObjectDecoder decodeObjects:encoded concurrently:YES];
+            [[theValue(decoded.count) should] equal:objectCount];
+
+            NSTimeInterval serialTime = CMMedianDecodeTime(encoded, NO);
+            NSTimeInterval concurrentTime = CMMedianDecodeTime(encoded, YES);
+            NSLog(@"%@ objects on %lu cores: median decode %.1f ms serially, %.1f ms concurrently (%.2fx)", objectCount,
+                  (unsigned long)[[NSProcessInfo processInfo] activeProcessorCount], serialTime * 1000.0, concurrentTime * 1000.0,
+                  serialTime / concurrentTime);
+        }
+    });
+});
+
+SPEC_END
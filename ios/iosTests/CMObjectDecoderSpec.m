@@ -378,6 +378,25 @@ describe(@"CMObjectDecoder", ^{
         [[theValue(last.aFloat) should] equal:@42.5];
         
     });
+    
+    it(@"should decode large sets concurrently in the same order as serially", ^{
+        NSMutableArray *objects = [NSMutableArray array];
+        for (NSUInteger i = 0; i < CMObjectDecoderConcurrentDecodeThreshold * 3 + 7; i++) {
+            CMGenericSerializableObject *object = [[CMGenericSerializableObject alloc] initWithObjectId:[NSString stringWithUUID]];
+            [object fillPropertiesWithDefaults];
+            [objects addObject:object];
+        }
+        NSDictionary *encoded = [CMObjectEncoder encodeObjects:objects];
+        
+        NSArray *serial = [CMObjectDecoder decodeObjects:encoded concurrently:NO];
+        NSArray *concurrent = [CMObjectDecoder decodeObjects:encoded concurrently:YES];
+        [[[concurrent valueForKey:@"objectId"] should] equal:[encoded allKeys]];
+        [[concurrent should] equal:serial];
+        
+        NSMutableDictionary *invalid = [encoded mutableCopy];
+        [invalid setObject:@"not an object" forKey:[[encoded allKeys] lastObject]];
+        [[[CMObjectDecoder decodeObjects:invalid concurrently:YES] should] beEmpty];
+    });
 });
 
 SPEC_END
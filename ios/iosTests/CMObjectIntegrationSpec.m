@@ -454,7 +454,7 @@ describe(@"CMObject Integration", ^{
         [[expectFutureValue(aclResponse) shouldEventuallyBeforeTimingOutAfter(CM_TEST_TIMEOUT)] beNonNil];
         [[expectFutureValue(aclResponse.error.domain) shouldEventuallyBeforeTimingOutAfter(CM_TEST_TIMEOUT)] equal:CMErrorDomain];
         [[expectFutureValue(theValue(aclResponse.error.code)) shouldEventuallyBeforeTimingOutAfter(CM_TEST_TIMEOUT)] equal:@(CMErrorInvalidRequest)];
-        [[newStore.webService shouldNot] receive:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:)];
+        [[newStore.webService shouldNot] receive:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:)];
       });
       
       it(@"should let the original user remove the acl", ^{
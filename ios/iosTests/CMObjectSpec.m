@@ -11,6 +11,7 @@
 #import "CMStore.h"
 #import "CMNullStore.h"
 #import "CMObject.h"
+#import "CMObject+Private.h"
 #import "CMACL.h"
 #import "CMObjectDecoder.h"
 #import "CMObjectEncoder.h"
@@ -253,6 +254,40 @@ describe(@"CMObject", ^{
     });
     
     
+    context(@"when tracking changes", ^{
+        __block CustomObject *object = nil;
+
+        beforeEach(^{
+            object = [[CMObjectDecoder decodeObjects:[CMObjectEncoder encodeObjects:@[[[CustomObject alloc] init]]]] lastObject];
+        });
+
+        it(@"should start out with no changed keys", ^{
+            [[object.changedKeys should] beEmpty];
+        });
+
+        it(@"should record the changed keys and their original values", ^{
+            object.something = @"first";
+            object.something = @"second";
+
+            [[object.changedKeys should] equal:[NSSet setWithObject:@"something"]];
+            [[object.originalValuesOfChangedKeys should] equal:@{@"something": [NSNull null]}];
+            [[theValue(object.dirty) should] beYes];
+        });
+
+        it(@"should not record setting a property to the value it already has", ^{
+            object.something = nil;
+            [[object.changedKeys should] beEmpty];
+            [[theValue(object.dirty) should] beNo];
+        });
+
+        it(@"should forget the changes once the object is clean again", ^{
+            object.somethingElse = @"changed";
+            object.dirty = NO;
+
+            [[object.changedKeys should] beEmpty];
+        });
+    });
+
     context(@"given an object that is a custom subclass", ^{
         __block CustomObject *object = nil;
         __block CMStore *store = store;
@@ -294,7 +329,7 @@ describe(@"CMObject", ^{
                         
             // Prepare spy and wait for message
 //            [[store should] receive:@selector(saveObject:additionalOptions:callback:)];
-            KWCaptureSpy *spy = [(KWMock *)store.webService captureArgument:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:4];
+            KWCaptureSpy *spy = [(KWMock *)store.webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:5];
             
             [object save:^(CMObjectUploadResponse *response) { }];
             
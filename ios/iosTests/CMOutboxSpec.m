@@ -0,0 +1,207 @@
+//
+//  CMOutboxSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMOutbox.h"
+#import "CMStore.h"
+
+@interface CMTestOutboxDelegate : NSObject <CMOutboxDelegate>
+@property (atomic, strong) NSError *error;
+@property (atomic, strong) NSMutableArray *batches;
+/** Keeps the completion of each batch instead of calling it, so the batch stays in flight. */
+@property (atomic, assign) BOOL holdsBatches;
+@property (atomic, copy) void (^heldCompletion)(NSDictionary *, NSError *);
+@end
+
+@implementation CMTestOutboxDelegate
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _batches = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (BOOL)outbox:(CMOutbox *)outbox canSendOperationsOfOwner:(NSString *)ownerIdentifier {
+    return YES;
+}
+
+- (void)outbox:(CMOutbox *)outbox sendOperations:(NSArray *)operations completion:(void (^)(NSDictionary *, NSError *))completion {
+    @synchronized(self.batches) {
+        [self.batches addObject:operations];
+    }
+    if (self.holdsBatches) {
+        self.heldCompletion = completion;
+        return;
+    }
+    completion(nil, self.error);
+}
+
+@end
+
+SPEC_BEGIN(CMOutboxSpec)
+
+describe(@"CMOutbox", ^{
+
+    __block NSURL *directoryURL = nil;
+    __block CMOutbox *outbox = nil;
+    NSDictionary *venue = @{@"__id__": @"venue1", @"__class__": @"Venue", @"name": @"The Venue"};
+
+    beforeEach(^{
+        directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        outbox = [[CMOutbox alloc] initWithDirectoryURL:directoryURL];
+    });
+
+    afterEach(^{
+        outbox = nil;
+        [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:nil];
+    });
+
+    it(@"should merge successive writes of the same object", ^{
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:venue partial:NO] completion:nil];
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:@{@"rating": @5} partial:YES] completion:nil];
+
+        CMOutboxOperation *operation = [[outbox pendingOperations] lastObject];
+        [[[outbox pendingOperations] should] haveCountOf:1];
+        [[theValue(operation.type) should] equal:theValue(CMOutboxOperationSave)];
+        [[theValue(operation.isPartial) should] beNo];
+        [[[operation.representation objectForKey:@"name"] should] equal:@"The Venue"];
+        [[[operation.representation objectForKey:@"rating"] should] equal:@5];
+
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue1" ownerIdentifier:nil representation:nil partial:NO] completion:nil];
+        [[theValue([[[outbox pendingOperations] lastObject] type]) should] equal:theValue(CMOutboxOperationDelete)];
+
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:venue partial:YES] completion:nil];
+        [[theValue([[[outbox pendingOperations] lastObject] type]) should] equal:theValue(CMOutboxOperationReplace)];
+        [[[outbox pendingOperations] should] haveCountOf:1];
+    });
+
+    it(@"should merge a write into the last one queued for the object", ^{
+        CMTestOutboxDelegate *delegate = [[CMTestOutboxDelegate alloc] init];
+        delegate.holdsBatches = YES;
+        outbox.retryInterval = 60.0;
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:venue partial:NO] completion:nil];
+        outbox.delegate = delegate;
+        [[expectFutureValue(delegate.batches) shouldEventually] haveCountOf:1];
+
+        // The first write is being sent, so the second queues behind it, and the first then fails to connect.
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:@{@"name": @"Second"} partial:YES] completion:nil];
+        delegate.heldCompletion(nil, [NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:nil]);
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:@{@"name": @"Third"} partial:YES] completion:nil];
+
+        NSArray *operations = [outbox pendingOperations];
+        [[operations should] haveCountOf:2];
+        [[[[[operations objectAtIndex:0] representation] objectForKey:@"name"] should] equal:@"The Venue"];
+        [[[[[operations objectAtIndex:1] representation] objectForKey:@"name"] should] equal:@"Third"];
+    });
+
+    it(@"should keep the writes of each owner apart", ^{
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:venue partial:NO] completion:nil];
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue1" ownerIdentifier:@"user1" representation:nil partial:NO] completion:nil];
+
+        [[[outbox pendingOperations] should] haveCountOf:2];
+        [[theValue([outbox hasOperationsForObjectIds:@[@"venue1"] ownerIdentifier:@"user1"]) should] beYes];
+        [[theValue([outbox hasOperationsForObjectIds:@[@"venue1"] ownerIdentifier:@"user2"]) should] beNo];
+    });
+
+    it(@"should read queued writes back from its journals", ^{
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:venue partial:NO] completion:nil];
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue2" ownerIdentifier:@"user1" representation:nil partial:NO] completion:nil];
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:@{@"rating": @5} partial:YES] completion:nil];
+        outbox = nil;
+
+        CMOutbox *reopened = [[CMOutbox alloc] initWithDirectoryURL:directoryURL];
+        NSArray *operations = [reopened pendingOperations];
+        [[operations should] haveCountOf:2];
+        [[[[operations objectAtIndex:0] objectId] should] equal:@"venue1"];
+        [[[[[operations objectAtIndex:0] representation] objectForKey:@"rating"] should] equal:@5];
+        [[[[operations objectAtIndex:1] ownerIdentifier] should] equal:@"user1"];
+    });
+
+    it(@"should send queued writes and forget them once they are sent", ^{
+        CMTestOutboxDelegate *delegate = [[CMTestOutboxDelegate alloc] init];
+        __block BOOL finished = NO;
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationSave objectId:@"venue1" ownerIdentifier:nil representation:venue partial:NO] completion:^(NSError *error) {
+            finished = (error == nil);
+        }];
+
+        outbox.delegate = delegate;
+        [[expectFutureValue(theValue(finished)) shouldEventually] beYes];
+        [[delegate.batches should] haveCountOf:1];
+
+        outbox = nil;
+        [[[[[CMOutbox alloc] initWithDirectoryURL:directoryURL] pendingOperations] should] beEmpty];
+    });
+
+    it(@"should keep writes that couldn't connect", ^{
+        CMTestOutboxDelegate *delegate = [[CMTestOutboxDelegate alloc] init];
+        delegate.error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:nil];
+        outbox.retryInterval = 60.0;
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue1" ownerIdentifier:nil representation:nil partial:NO] completion:nil];
+
+        outbox.delegate = delegate;
+        [[expectFutureValue(delegate.batches) shouldEventually] haveCountOf:1];
+        [[[outbox pendingOperations] should] haveCountOf:1];
+    });
+
+    it(@"should keep writes that failed with a server error or an expired session", ^{
+        for (NSNumber *code in @[@(CMErrorServerError), @(CMErrorUnauthorized)]) {
+            CMTestOutboxDelegate *delegate = [[CMTestOutboxDelegate alloc] init];
+            delegate.error = [NSError errorWithDomain:CMErrorDomain code:[code integerValue] userInfo:nil];
+            CMOutbox *other = [[CMOutbox alloc] initWithDirectoryURL:[directoryURL URLByAppendingPathComponent:[code stringValue]]];
+            other.retryInterval = 60.0;
+            [other enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue1" ownerIdentifier:nil representation:nil partial:NO] completion:nil];
+
+            other.delegate = delegate;
+            [[expectFutureValue(delegate.batches) shouldEventually] haveCountOf:1];
+            [[[other pendingOperations] should] haveCountOf:1];
+        }
+    });
+
+    it(@"should drop a write that keeps failing with a server error, even across launches", ^{
+        CMTestOutboxDelegate *delegate = [[CMTestOutboxDelegate alloc] init];
+        delegate.error = [NSError errorWithDomain:CMErrorDomain code:CMErrorServerError userInfo:nil];
+        outbox.retryInterval = 60.0;
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue1" ownerIdentifier:nil representation:nil partial:NO] completion:nil];
+        outbox.delegate = delegate;
+        [[expectFutureValue(delegate.batches) shouldEventually] haveCountOf:1];
+        outbox.delegate = nil;
+        outbox = nil;
+
+        CMTestOutboxDelegate *relaunchedDelegate = [[CMTestOutboxDelegate alloc] init];
+        relaunchedDelegate.error = delegate.error;
+        __block NSError *failure = nil;
+        CMOutbox *reopened = [[CMOutbox alloc] initWithDirectoryURL:directoryURL];
+        reopened.retryInterval = 0.01;
+        [reopened enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue1" ownerIdentifier:nil representation:nil partial:NO] completion:^(NSError *error) {
+            failure = error;
+        }];
+        reopened.delegate = relaunchedDelegate;
+
+        [[expectFutureValue(failure) shouldEventually] beNonNil];
+        [[theValue(failure.code) should] equal:theValue(CMErrorServerError)];
+        [[relaunchedDelegate.batches should] haveCountOf:4];
+        [[[reopened pendingOperations] should] beEmpty];
+    });
+
+    it(@"should drop writes that were refused", ^{
+        CMTestOutboxDelegate *delegate = [[CMTestOutboxDelegate alloc] init];
+        delegate.error = [NSError errorWithDomain:CMErrorDomain code:CMErrorInvalidRequest userInfo:@{@"httpCode": @400}];
+        __block NSError *refusal = nil;
+        [outbox enqueueOperation:[[CMOutboxOperation alloc] initWithType:CMOutboxOperationDelete objectId:@"venue1" ownerIdentifier:nil representation:nil partial:NO] completion:^(NSError *error) {
+            refusal = error;
+        }];
+
+        outbox.delegate = delegate;
+        [[expectFutureValue(refusal) shouldEventually] beNonNil];
+        [[[outbox pendingOperations] should] beEmpty];
+    });
+});
+
+SPEC_END
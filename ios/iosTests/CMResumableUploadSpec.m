@@ -0,0 +1,253 @@
+//
+//  CMResumableUploadSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+#import "NSMutableData+RandomData.h"
+
+#import "CMResumableUpload.h"
+#import "CMWebService.h"
+#import "CMStore.h"
+#import "CMTestMacros.h"
+
+/**
+ * The last context uploads through a local stand-in server. Start it with
+ * <tt>ruby scripts/benchmark_server.rb 8080 0 0.2</tt> so a fifth of the chunks fail, and run the tests with
+ * <tt>BENCHMARK_URL</tt> set to the URL it prints.
+ */
+
+#define BENCHMARK_URL ([[NSProcessInfo processInfo] environment][@"BENCHMARK_URL"])
+
+SPEC_BEGIN(CMResumableUploadSpec)
+
+describe(@"CMResumableUpload", ^{
+
+    __block NSString *path = nil;
+    __block NSData *contents = nil;
+
+    beforeEach(^{
+        path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+        contents = [NSMutableData randomDataWithLength:1000];
+        [contents writeToFile:path atomically:YES];
+    });
+
+    afterEach(^{
+        [[CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400] remove];
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    });
+
+    it(@"should read the file one chunk at a time", ^{
+        CMResumableUpload *upload = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400];
+        [[theValue(upload.fileSize) should] equal:theValue(1000)];
+        [[[upload contentRangeForChunkOfLength:400] should] equal:@"bytes 0-399/1000"];
+        [[[upload nextChunk:NULL] should] equal:[contents subdataWithRange:NSMakeRange(0, 400)]];
+
+        upload.committedLength = 800;
+        [[[upload nextChunk:NULL] should] equal:[contents subdataWithRange:NSMakeRange(800, 200)]];
+        [[[upload contentRangeForChunkOfLength:0] should] equal:@"bytes */1000"];
+    });
+
+    it(@"should take the committed length from a Range header", ^{
+        CMResumableUpload *upload = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400];
+        [upload commitRange:@"bytes=0-399"];
+        [[theValue(upload.committedLength) should] equal:theValue(400)];
+        [upload commitRange:nil];
+        [[theValue(upload.committedLength) should] equal:theValue(0)];
+        [upload commitRange:@"bytes=0-999"];
+        [[theValue(upload.isComplete) should] beYes];
+    });
+
+    it(@"should treat a missing or malformed Range header as nothing received", ^{
+        CMResumableUpload *upload = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400];
+        upload.committedLength = 400;
+        [[theBlock(^{ [upload commitRange:nil]; }) shouldNot] raise];
+        [[theValue(upload.committedLength) should] equal:theValue(0)];
+
+        upload.committedLength = 400;
+        [upload commitRange:@""];
+        [[theValue(upload.committedLength) should] equal:theValue(0)];
+
+        upload.committedLength = 400;
+        [upload commitRange:@"bytes=0-"];
+        [[theValue(upload.committedLength) should] equal:theValue(0)];
+    });
+
+    it(@"should resume an upload of the same file", ^{
+        CMResumableUpload *first = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400];
+        first.committedLength = 400;
+
+        CMResumableUpload *second = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:100];
+        [[second.uploadIdentifier should] equal:first.uploadIdentifier];
+        [[theValue(second.committedLength) should] equal:theValue(400)];
+        [[theValue(second.chunkSize) should] equal:theValue(400)];
+    });
+
+    it(@"should start over once the state is removed or for another owner", ^{
+        CMResumableUpload *first = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400];
+        first.committedLength = 400;
+
+        CMResumableUpload *other = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:@"user" chunkSize:400];
+        [[other.uploadIdentifier shouldNot] equal:first.uploadIdentifier];
+        [other remove];
+
+        [first remove];
+        CMResumableUpload *again = [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400];
+        [[again.uploadIdentifier shouldNot] equal:first.uploadIdentifier];
+        [[theValue(again.committedLength) should] equal:theValue(0)];
+    });
+
+    it(@"should name unnamed uploads and not exist for missing files", ^{
+        CMResumableUpload *upload = [CMResumableUpload uploadForFileAtPath:path named:nil ownerIdentifier:nil chunkSize:400];
+        [[upload.key shouldNot] beNil];
+        [upload remove];
+
+        [[[CMResumableUpload uploadForFileAtPath:[path stringByAppendingString:@".missing"] named:nil ownerIdentifier:nil chunkSize:400] should] beNil];
+    });
+
+    context(@"when uploaded through a stubbed server", ^{
+        __block CMWebService *service = nil;
+        __block NSMutableArray *requests = nil;
+        __block NSMutableArray *successBlocks = nil;
+        __block NSMutableArray *failureBlocks = nil;
+        __block NSString *uploadedKey = nil;
+        __block NSError *uploadError = nil;
+
+        void (^respond)(NSInteger, NSDictionary *) = ^(NSInteger statusCode, NSDictionary *headers) {
+            NSURLRequest *request = [requests lastObject];
+            NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:headers];
+            AFHTTPRequestOperation *operation = [AFHTTPRequestOperation nullMock];
+            [operation stub:@selector(response) andReturn:response];
+            [operation stub:@selector(request) andReturn:request];
+            if (statusCode == 308 || (statusCode >= 200 && statusCode < 300)) {
+                void (^success)(AFHTTPRequestOperation *, id) = [successBlocks lastObject];
+                success(operation, [NSData data]);
+            } else {
+                void (^failure)(AFHTTPRequestOperation *, NSError *) = [failureBlocks lastObject];
+                failure(operation, [NSError errorWithDomain:AFURLResponseSerializationErrorDomain code:NSURLErrorBadServerResponse userInfo:nil]);
+            }
+        };
+
+        void (^startUpload)() = ^{
+            [service uploadFileAtPath:path
+                   serverSideFunction:nil
+                                named:@"file"
+                           ofMimeType:nil
+                                 user:nil
+                      extraParameters:nil
+                            chunkSize:400
+                      progressHandler:nil
+                       successHandler:^(CMFileUploadResult result, NSString *fileKey, id snippetResult, NSDictionary *headers) {
+                           uploadedKey = fileKey;
+                       } errorHandler:^(NSError *error) {
+                           uploadError = error;
+                       }];
+        };
+
+        beforeEach(^{
+            service = [[CMWebService alloc] initWithAppSecret:API_KEY appIdentifier:APP_ID baseURL:[NSURL URLWithString:@"https://api.cloudmine.io/"]];
+            requests = [NSMutableArray array];
+            successBlocks = [NSMutableArray array];
+            failureBlocks = [NSMutableArray array];
+            uploadedKey = nil;
+            uploadError = nil;
+
+            [service stub:@selector(HTTPRequestOperationWithRequest:success:failure:) withBlock:^id(NSArray *params) {
+                [requests addObject:params[0]];
+                [successBlocks addObject:params[1]];
+                [failureBlocks addObject:params[2]];
+                return [[AFHTTPRequestOperation alloc] initWithRequest:params[0]];
+            }];
+            [service stub:@selector(enqueueHTTPRequestOperation:)];
+        });
+
+        it(@"should resume from the range the server reports", ^{
+            [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400].committedLength = 400;
+            startUpload();
+            [[[[requests lastObject] valueForHTTPHeaderField:@"Content-Range"] should] equal:@"bytes */1000"];
+
+            respond(308, @{@"Range": @"bytes=0-799"});
+            [[theValue(requests.count) should] equal:theValue(2)];
+            [[[[requests lastObject] valueForHTTPHeaderField:@"Content-Range"] should] equal:@"bytes 800-999/1000"];
+            [[[[requests lastObject] HTTPBody] should] equal:[contents subdataWithRange:NSMakeRange(800, 200)]];
+
+            respond(201, @{});
+            [[expectFutureValue(uploadedKey) shouldEventually] equal:@"file"];
+            [[uploadError should] beNil];
+        });
+
+        it(@"should start over when the server no longer has the upload", ^{
+            [CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400].committedLength = 400;
+            startUpload();
+
+            respond(404, @{});
+            [[theValue(requests.count) should] equal:theValue(2)];
+            [[[[requests lastObject] valueForHTTPHeaderField:@"Content-Range"] should] equal:@"bytes 0-399/1000"];
+            [[[[requests lastObject] HTTPBody] should] equal:[contents subdataWithRange:NSMakeRange(0, 400)]];
+        });
+
+        it(@"should give up once the server keeps rejecting the same chunk", ^{
+            startUpload();
+            respond(308, @{@"Range": @"bytes=0-399"});
+
+            // Every further answer leaves the second chunk missing, which uses up the retry budget.
+            for (NSUInteger i = 0; i < 5; i++) {
+                respond(308, @{@"Range": @"bytes=0-399"});
+            }
+            [[theValue(requests.count) should] equal:theValue(6)];
+            [[expectFutureValue(uploadError) shouldEventually] beNonNil];
+            [[theValue(uploadError.code) should] equal:theValue(CMErrorServerError)];
+            [[uploadedKey should] beNil];
+        });
+
+        it(@"should fail rather than succeed when the server finishes before the last chunk", ^{
+            startUpload();
+            respond(200, @{});
+
+            [[expectFutureValue(uploadError) shouldEventually] beNonNil];
+            [[theValue(uploadError.code) should] equal:theValue(CMErrorServerError)];
+            [[uploadedKey should] beNil];
+            [[theValue([CMResumableUpload uploadForFileAtPath:path named:@"file" ownerIdentifier:nil chunkSize:400].committedLength) should] equal:theValue(0)];
+        });
+    });
+
+    context(@"against the stand-in server", ^{
+        if (BENCHMARK_URL.length == 0) {
+            return;
+        }
+
+        it(@"should upload a large file despite failing chunks", ^{
+            NSString *largePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+            [[NSMutableData randomDataWithLength:8 * 1024 * 1024] writeToFile:largePath atomically:YES];
+
+            CMWebService *service = [[CMWebService alloc] initWithAppSecret:API_KEY appIdentifier:APP_ID baseURL:[NSURL URLWithString:BENCHMARK_URL]];
+            __block NSString *uploadedKey = nil;
+            __block long long lastProgress = 0;
+            __block NSError *uploadError = nil;
+            [service uploadFileAtPath:largePath
+                   serverSideFunction:nil
+                                named:@"large"
+                           ofMimeType:nil
+                                 user:nil
+                      extraParameters:nil
+                            chunkSize:256 * 1024
+                      progressHandler:^(long long totalBytesTransferred, long long totalBytesExpected) {
+                          lastProgress = totalBytesTransferred;
+                      } successHandler:^(CMFileUploadResult result, NSString *fileKey, id snippetResult, NSDictionary *headers) {
+                          uploadedKey = fileKey;
+                      } errorHandler:^(NSError *error) {
+                          uploadError = error;
+                      }];
+
+            [[expectFutureValue(uploadedKey) shouldEventuallyBeforeTimingOutAfter(120.0)] equal:@"large"];
+            [[uploadError should] beNil];
+            [[theValue(lastProgress) should] beGreaterThan:theValue(0)];
+            [[NSFileManager defaultManager] removeItemAtPath:largePath error:nil];
+        });
+    });
+});
+
+SPEC_END
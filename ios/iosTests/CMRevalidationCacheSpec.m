@@ -0,0 +1,186 @@
+//
+//  CMRevalidationCacheSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "CMRevalidationCache.h"
+#import "CMWebService.h"
+#import "CMUser.h"
+#import "CMTestMacros.h"
+
+/**
+ * The last context fetches through a local stand-in server. Start it with <tt>ruby scripts/benchmark_server.rb</tt>
+ * and run the tests with <tt>BENCHMARK_URL</tt> set to the URL it prints.
+ */
+
+#define BENCHMARK_URL ([[NSProcessInfo processInfo] environment][@"BENCHMARK_URL"])
+
+SPEC_BEGIN(CMRevalidationCacheSpec)
+
+describe(@"CMRevalidationCache", ^{
+
+    __block CMRevalidationCache *cache = nil;
+    __block NSURL *url = nil;
+    __block NSData *body = nil;
+
+    beforeEach(^{
+        cache = [[CMRevalidationCache alloc] initWithDirectory:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+        url = [NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/text?keys=a"];
+        body = [@"{\"success\":{\"a\":{}},\"errors\":{}}" dataUsingEncoding:NSUTF8StringEncoding];
+    });
+
+    afterEach(^{
+        [[NSFileManager defaultManager] removeItemAtPath:cache.directory error:nil];
+    });
+
+    it(@"should send validators only for responses that had them", ^{
+        NSURLRequest *request = [NSURLRequest requestWithURL:url];
+        [[[cache conditionalRequestForRequest:request] should] equal:request];
+
+        NSHTTPURLResponse *plain = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type": @"application/json"}];
+        [cache storeData:body parsedObject:nil forResponse:plain request:request];
+        [[[[cache conditionalRequestForRequest:request] valueForHTTPHeaderField:@"If-None-Match"] should] beNil];
+
+        NSHTTPURLResponse *tagged = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\"", @"Last-Modified": @"Mon, 01 Feb 2016 00:00:00 GMT"}];
+        [cache storeData:body parsedObject:nil forResponse:tagged request:request];
+        NSURLRequest *conditional = [cache conditionalRequestForRequest:request];
+        [[[conditional valueForHTTPHeaderField:@"If-None-Match"] should] equal:@"\"v1\""];
+        [[[conditional valueForHTTPHeaderField:@"If-Modified-Since"] should] equal:@"Mon, 01 Feb 2016 00:00:00 GMT"];
+    });
+
+    it(@"should answer a 304 with the kept body and updated headers", ^{
+        NSURLRequest *request = [NSURLRequest requestWithURL:url];
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\"", @"Content-Type": @"application/json", @"X-Request-Id": @"1"}];
+        [cache storeData:body parsedObject:nil forResponse:response request:request];
+
+        NSHTTPURLResponse *notModified = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:304 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\"", @"X-Request-Id": @"2"}];
+        NSDictionary *headers = nil;
+        [[[cache bodyForNotModifiedResponse:notModified request:request parsed:NO headers:&headers] should] equal:body];
+        [[[headers objectForKey:@"Content-Type"] should] equal:@"application/json"];
+        [[[headers objectForKey:@"X-Request-Id"] should] equal:@"2"];
+
+        NSDictionary *parsed = [cache bodyForNotModifiedResponse:notModified request:request parsed:YES headers:NULL];
+        [[[parsed objectForKey:@"success"] should] equal:@{@"a": @{}}];
+    });
+
+    it(@"should keep the responses of different users apart", ^{
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+        [request setValue:@"token1" forHTTPHeaderField:@"X-CloudMine-SessionToken"];
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\""}];
+        [cache storeData:body parsedObject:nil forResponse:response request:request];
+
+        [request setValue:@"token2" forHTTPHeaderField:@"X-CloudMine-SessionToken"];
+        [[[[cache conditionalRequestForRequest:request] valueForHTTPHeaderField:@"If-None-Match"] should] beNil];
+    });
+
+    it(@"should forget the responses used least recently beyond its byte limit", ^{
+        cache.byteLimit = body.length * 2;
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\""}];
+        NSMutableArray *requests = [NSMutableArray array];
+        for (NSUInteger i = 0; i < 3; i++) {
+            NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:[NSString stringWithFormat:@"%@%lu", url.absoluteString, (unsigned long)i]]];
+            [cache storeData:body parsedObject:nil forResponse:response request:request];
+            [requests addObject:request];
+            [NSThread sleepForTimeInterval:1.1];
+        }
+
+        [[[[cache conditionalRequestForRequest:requests[0]] valueForHTTPHeaderField:@"If-None-Match"] should] beNil];
+        [[[[cache conditionalRequestForRequest:requests[1]] valueForHTTPHeaderField:@"If-None-Match"] should] equal:@"\"v1\""];
+        [[[[cache conditionalRequestForRequest:requests[2]] valueForHTTPHeaderField:@"If-None-Match"] should] equal:@"\"v1\""];
+
+        cache.byteLimit = body.length - 1;
+        NSURLRequest *large = [NSURLRequest requestWithURL:url];
+        [cache storeData:body parsedObject:nil forResponse:response request:large];
+        [[[[cache conditionalRequestForRequest:large] valueForHTTPHeaderField:@"If-None-Match"] should] beNil];
+    });
+
+    it(@"should keep a running total rather than look at every entry on each store", ^{
+        cache.byteLimit = body.length * 2;
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\""}];
+        NSURLRequest *first = [NSURLRequest requestWithURL:url];
+        [cache storeData:body parsedObject:nil forResponse:response request:first];
+
+        [[[NSFileManager defaultManager] shouldNot] receive:@selector(contentsOfDirectoryAtPath:error:)];
+        NSURLRequest *second = [NSURLRequest requestWithURL:[NSURL URLWithString:[url.absoluteString stringByAppendingString:@"b"]]];
+        for (NSUInteger i = 0; i < 5; i++) {
+            // Replacing a response doesn't add to the total, so the first one is never trimmed.
+            [cache storeData:body parsedObject:nil forResponse:response request:second];
+        }
+        [[[[cache conditionalRequestForRequest:first] valueForHTTPHeaderField:@"If-None-Match"] should] equal:@"\"v1\""];
+    });
+
+    it(@"should revalidate binary data fetched by web services", ^{
+        CMWebService *service = [[CMWebService alloc] initWithAppSecret:@"appSecret123" appIdentifier:@"appId123" baseURL:[NSURL URLWithString:@"https://api.cloudmine.io/"]];
+        service.revalidationCache = cache;
+        service.coalescesIdenticalRequests = NO;
+        NSMutableArray *requests = [NSMutableArray array];
+        [service stub:@selector(HTTPRequestOperationWithRequest:success:failure:) withBlock:^id(NSArray *params) {
+            [requests addObject:params[0]];
+            return [[AFHTTPRequestOperation alloc] initWithRequest:params[0]];
+        }];
+        [service stub:@selector(enqueueHTTPRequestOperation:)];
+        void (^fetch)(void) = ^{
+            [service getBinaryDataNamed:@"logo.png" serverSideFunction:nil user:nil extraParameters:nil successHandler:nil errorHandler:nil];
+        };
+
+        fetch();
+        NSURLRequest *request = [requests lastObject];
+        [[[request valueForHTTPHeaderField:@"If-None-Match"] should] beNil];
+
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\"", @"Content-Type": @"image/png"}];
+        [cache storeData:body parsedObject:nil forResponse:response request:request];
+        fetch();
+        [[theValue(requests.count) should] equal:theValue(2)];
+        [[[[requests lastObject] valueForHTTPHeaderField:@"If-None-Match"] should] equal:@"\"v1\""];
+    });
+
+    it(@"should be forgotten by web services when a user logs out", ^{
+        CMWebService *service = [[CMWebService alloc] initWithAppSecret:@"appSecret123" appIdentifier:@"appId123" baseURL:[NSURL URLWithString:@"https://api.cloudmine.io/"]];
+        [[service.revalidationCache should] beNil];
+        service.revalidationCache = cache;
+
+        NSURLRequest *request = [NSURLRequest requestWithURL:url];
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag": @"\"v1\""}];
+        [cache storeData:body parsedObject:nil forResponse:response request:request];
+        [[NSNotificationCenter defaultCenter] postNotificationName:CMUserDidLogOutNotification object:nil];
+
+        [[[[cache conditionalRequestForRequest:request] valueForHTTPHeaderField:@"If-None-Match"] should] beNil];
+    });
+
+    context(@"against the stand-in server", ^{
+        if (BENCHMARK_URL.length == 0) {
+            return;
+        }
+
+        it(@"should serve a 304 from the kept response", ^{
+            CMWebService *service = [[CMWebService alloc] initWithAppSecret:API_KEY appIdentifier:APP_ID baseURL:[NSURL URLWithString:BENCHMARK_URL]];
+            service.revalidationCache = cache;
+
+            __block NSMutableArray *fetchedHeaders = [NSMutableArray array];
+            void (^fetch)(void) = ^{
+                [service getValuesForKeys:@[@"a"] serverSideFunction:nil pagingOptions:nil sortingOptions:nil user:nil extraParameters:nil
+                           successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+                               [fetchedHeaders addObject:headers];
+                           } errorHandler:^(NSError *error) {
+                               [fetchedHeaders addObject:@{}];
+                           }];
+            };
+
+            fetch();
+            [[expectFutureValue(theValue(fetchedHeaders.count)) shouldEventuallyBeforeTimingOutAfter(10.0)] equal:theValue(1)];
+            fetch();
+            [[expectFutureValue(theValue(fetchedHeaders.count)) shouldEventuallyBeforeTimingOutAfter(10.0)] equal:theValue(2)];
+
+            [[[fetchedHeaders[0] objectForKey:@"X-Revalidated"] should] beNil];
+            [[[fetchedHeaders[1] objectForKey:@"X-Revalidated"] should] equal:@"true"];
+            [[[fetchedHeaders[1] objectForKey:@"Content-Type"] should] equal:@"application/json"];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,107 @@
+//
+//  CMStoreACLSaveBenchmarkSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+#import "CMStore.h"
+#import "CMACL.h"
+#import "CMUser.h"
+#import "CMWebService.h"
+#import "CMAPICredentials.h"
+#import "CMObjectSerialization.h"
+
+/**
+ * Saves a batch of ACLs one after another and with overlapping requests, against a web service stub that answers
+ * each ACL after a fixed simulated round trip. Median times of both are logged. Nothing runs unless
+ * <tt>BENCHMARK</tt> is set in the environment; CMStoreSpec checks that overlapping saves report every ACL.
+ */
+
+#define BENCHMARK ([[NSProcessInfo processInfo] environment][@"BENCHMARK"])
+#define BENCHMARK_ACL_COUNT 50
+#define BENCHMARK_RUN_COUNT 5
+#define BENCHMARK_ROUND_TRIP 0.02
+#define BENCHMARK_TIMEOUT 60.0
+
+static NSArray *CMDirtyACLs(void) {
+    NSMutableArray *acls = [NSMutableArray arrayWithCapacity:BENCHMARK_ACL_COUNT];
+    for (NSUInteger i = 0; i < BENCHMARK_ACL_COUNT; i++) {
+        CMACL *acl = [[CMACL alloc] init];
+        acl.members = [NSSet setWithObject:[NSString stringWithFormat:@"member%lu", (unsigned long)i]];
+        [acls addObject:acl];
+    }
+    return acls;
+}
+
+static NSTimeInterval CMMedianACLSaveTime(CMStore *store, NSUInteger *statusCount) {
+    NSMutableArray *times = [NSMutableArray arrayWithCapacity:BENCHMARK_RUN_COUNT];
+    for (NSUInteger i = 0; i < BENCHMARK_RUN_COUNT; i++) {
+        NSArray *acls = CMDirtyACLs();
+        dispatch_semaphore_t done = dispatch_semaphore_create(0);
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        [store saveACLs:acls callback:^(CMObjectUploadResponse *response) {
+            *statusCount = response.uploadStatuses.count;
+            dispatch_semaphore_signal(done);
+        }];
+        dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(BENCHMARK_TIMEOUT * NSEC_PER_SEC)));
+        [times addObject:@(CFAbsoluteTimeGetCurrent() - start)];
+    }
+
+    NSArray *sorted = [times sortedArrayUsingSelector:@selector(compare:)];
+    return [[sorted objectAtIndex:sorted.count / 2] doubleValue];
+}
+
+SPEC_BEGIN(CMStoreACLSaveBenchmarkSpec)
+
+describe(@"CMStoreACLSaveBenchmark", ^{
+    if (BENCHMARK.length == 0) {
+        return;
+    }
+
+    __block CMStore *store = nil;
+
+    beforeAll(^{
+        [[CMAPICredentials sharedInstance] setAppSecret:@"appSecret"];
+        [[CMAPICredentials sharedInstance] setAppIdentifier:@"appIdentifier"];
+    });
+
+    beforeEach(^{
+        CMUser *user = [[CMUser alloc] initWithEmail:@"userid@test.com" andPassword:@"password"];
+        user.token = @"token";
+        user.tokenExpiration = [NSDate dateWithTimeIntervalSinceNow:1000];
+        store = [CMStore storeWithUser:user];
+        store.completionQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+        CMWebService *webService = [CMWebService nullMock];
+        [webService stub:@selector(updateACL:user:successHandler:errorHandler:) withBlock:^id(NSArray *params) {
+            NSDictionary *acl = [params objectAtIndex:0];
+            CMWebServiceObjectFetchSuccessCallback successHandler = [params objectAtIndex:2];
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(BENCHMARK_ROUND_TRIP * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                successHandler(@{[acl objectForKey:CMInternalObjectIdKey]: acl}, @{}, nil, nil, @1, @{});
+            });
+            return nil;
+        }];
+        store.webService = webService;
+    });
+
+    it(@"should save ACLs faster with overlapping requests than one after another", ^{
+        NSUInteger serialCount = 0;
+        NSUInteger concurrentCount = 0;
+
+        store.maxConcurrentACLSaves = 1;
+        NSTimeInterval serialTime = CMMedianACLSaveTime(store, &serialCount);
+        store.maxConcurrentACLSaves = 4;
+        NSTimeInterval concurrentTime = CMMedianACLSaveTime(store, &concurrentCount);
+
+        NSLog(@"%d ACLs, %.0f ms round trip: median save %.1f ms one at a time, %.1f ms four at a time", BENCHMARK_ACL_COUNT,
+              BENCHMARK_ROUND_TRIP * 1000.0, serialTime * 1000.0, concurrentTime * 1000.0);
+        [[theValue(serialCount) should] equal:theValue(BENCHMARK_ACL_COUNT)];
+        [[theValue(concurrentCount) should] equal:theValue(BENCHMARK_ACL_COUNT)];
+        [[theValue(concurrentTime) should] beLessThan:theValue(serialTime)];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,124 @@
+//
+//  CMStoreDeltaSaveBenchmarkSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+#import "CMObject.h"
+#import "CMObjectEncoder.h"
+#import "CMObjectDecoder.h"
+#import "CMWebService.h"
+#import "CMTestMacros.h"
+
+/**
+ * Compares full and changed-fields-only saves of wide objects, where a single counter changes on an object that also
+ * holds a large array. The request sizes are always compared. Latencies are measured too when <tt>BENCHMARK_URL</tt>
+ * points at <tt>scripts/benchmark_server.rb</tt>.
+ */
+
+#define BENCHMARK_URL ([[NSProcessInfo processInfo] environment][@"BENCHMARK_URL"])
+#define BENCHMARK_OBJECT_COUNT 50
+#define BENCHMARK_SAMPLE_COUNT 1000
+#define BENCHMARK_REQUEST_COUNT 100
+#define BENCHMARK_TIMEOUT 120.0
+
+@interface CMWideObject : CMObject
+@property (nonatomic, assign) NSInteger counter;
+@property (nonatomic, strong) NSArray *samples;
+@end
+
+@implementation CMWideObject
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    if (self = [super initWithCoder:aDecoder]) {
+        _counter = [aDecoder decodeIntegerForKey:@"counter"];
+        _samples = [aDecoder decodeObjectForKey:@"samples"];
+    }
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [super encodeWithCoder:aCoder];
+    [aCoder encodeInteger:_counter forKey:@"counter"];
+    [aCoder encodeObject:_samples forKey:@"samples"];
+}
+
+@end
+
+static NSUInteger CMRequestBodyLength(NSDictionary *body) {
+    return [[NSJSONSerialization dataWithJSONObject:body options:0 error:nil] length];
+}
+
+static NSTimeInterval CMMedianUploadLatency(NSDictionary *body) {
+    CMWebService *service = [[CMWebService alloc] initWithAppSecret:API_KEY appIdentifier:APP_ID baseURL:[NSURL URLWithString:BENCHMARK_URL]];
+    service.completionQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    NSMutableArray *latencies = [NSMutableArray arrayWithCapacity:BENCHMARK_REQUEST_COUNT];
+    for (NSUInteger i = 0; i < BENCHMARK_REQUEST_COUNT; i++) {
+        dispatch_semaphore_t done = dispatch_semaphore_create(0);
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        [service updateValuesFromDictionary:body serverSideFunction:nil user:nil extraParameters:nil successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+            dispatch_semaphore_signal(done);
+        } errorHandler:^(NSError *error) {
+            dispatch_semaphore_signal(done);
+        }];
+        dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(BENCHMARK_TIMEOUT * NSEC_PER_SEC)));
+        [latencies addObject:@(CFAbsoluteTimeGetCurrent() - start)];
+    }
+
+    NSArray *sorted = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    return [[sorted objectAtIndex:sorted.count / 2] doubleValue];
+}
+
+SPEC_BEGIN(CMStoreDeltaSaveBenchmarkSpec)
+
+describe(@"CMStoreDeltaSaveBenchmark", ^{
+
+    __block NSArray *objects = nil;
+
+    beforeAll(^{
+        NSMutableArray *samples = [NSMutableArray arrayWithCapacity:BENCHMARK_SAMPLE_COUNT];
+        for (NSUInteger i = 0; i < BENCHMARK_SAMPLE_COUNT; i++) {
+            [samples addObject:@{@"timestamp": @(i), @"value": @(i * 0.5)}];
+        }
+
+        NSMutableArray *wideObjects = [NSMutableArray arrayWithCapacity:BENCHMARK_OBJECT_COUNT];
+        for (NSUInteger i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+            CMWideObject *object = [[CMWideObject alloc] init];
+            object.samples = samples;
+            [wideObjects addObject:object];
+        }
+
+        // Round-trip through the decoder so the objects look fetched, then bump each counter.
+        objects = [CMObjectDecoder decodeObjects:[CMObjectEncoder encodeObjects:wideObjects]];
+        for (CMWideObject *object in objects) {
+            object.counter++;
+        }
+    });
+
+    it(@"should send a fraction of the bytes when saving only changed fields", ^{
+        NSMutableDictionary *changedKeys = [NSMutableDictionary dictionary];
+        for (CMObject *object in objects) {
+            [changedKeys setObject:object.changedKeys forKey:object.objectId];
+        }
+
+        NSDictionary *full = [CMObjectEncoder encodeObjects:objects];
+        NSDictionary *delta = [CMObjectEncoder encodeObjects:objects keys:changedKeys];
+        NSUInteger fullLength = CMRequestBodyLength(full);
+        NSUInteger deltaLength = CMRequestBodyLength(delta);
+
+        NSLog(@"Full save: %lu bytes, changed fields only: %lu bytes (%.1f%%)", (unsigned long)fullLength, (unsigned long)deltaLength, 100.0 * deltaLength / fullLength);
+        [[theValue(deltaLength * 100) should] beLessThan:theValue(fullLength)];
+
+        if (BENCHMARK_URL.length > 0) {
+            NSTimeInterval fullLatency = CMMedianUploadLatency(full);
+            NSTimeInterval deltaLatency = CMMedianUploadLatency(delta);
+            NSLog(@"Median save latency: full %.1f ms, changed fields only %.1f ms", fullLatency * 1000.0, deltaLatency * 1000.0);
+        }
+    });
+});
+
+SPEC_END
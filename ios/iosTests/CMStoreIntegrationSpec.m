@@ -525,7 +525,7 @@ describe(@"CMStoreIntegration", ^{
             
             it(@"should return a 401 immediately for saving all user object's", ^{
                 [[store.webService shouldNot]
-                 receive:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:)];
+                 receive:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:)];
                 
                 __block CMObjectUploadResponse *res = nil;
                 [store saveAllUserObjects:^(CMObjectUploadResponse *response) {
@@ -540,7 +540,7 @@ describe(@"CMStoreIntegration", ^{
             
             it(@"should return a 401 immediately for saving a single user object", ^{
                 [[store.webService shouldNot]
-                 receive:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:)];
+                 receive:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:)];
                 
                 __block CMObjectUploadResponse *res = nil;
                 [store saveUserObject:[CMObject new] callback:^(CMObjectUploadResponse *response) {
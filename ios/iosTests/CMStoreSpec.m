@@ -14,11 +14,40 @@
 #import "CMWebService.h"
 #import "CMGenericSerializableObject.h"
 #import "CMAPICredentials.h"
+#import "CMObjectCache.h"
+#import "CMOutbox.h"
+#import "CMObjectSerialization.h"
+#import "CMObject+Private.h"
+#import "CMObjectDecoder.h"
+#import "CMObjectEncoder.h"
 #import "CMBlockValidationMessageSpy.h"
 #import "CMAppDelegateBase.h"
 #import "TestUser.h"
 #import "Venue.h"
 
+@interface CMRenamedFieldObject : CMObject
+@property (nonatomic, strong) NSString *title;
+@property (nonatomic, strong) NSString *body;
+@end
+
+@implementation CMRenamedFieldObject
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    if (self = [super initWithCoder:aDecoder]) {
+        _title = [aDecoder decodeObjectForKey:@"headline"];
+        _body = [aDecoder decodeObjectForKey:@"body"];
+    }
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [super encodeWithCoder:aCoder];
+    [aCoder encodeObject:_title forKey:@"headline"];
+    [aCoder encodeObject:_body forKey:@"body"];
+}
+
+@end
+
 SPEC_BEGIN(CMStoreSpec)
 
 describe(@"CMStore", ^{
@@ -89,6 +118,174 @@ describe(@"CMStore", ^{
 
         });
         
+        it(@"should decode fetched objects in the background and deliver the response on the completion queue", ^{
+            KWCaptureSpy *callbackBlockSpy = [store.webService
+                                              captureArgument:@selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:) atIndex:6];
+            [[store.webService should] receive:@selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:) withCount:1];
+            
+            __block CMObjectFetchResponse *fetchResponse = nil;
+            __block BOOL calledOnMainThread = NO;
+            [store objectsWithKeys:@[@"akey"] additionalOptions:nil callback:^(CMObjectFetchResponse *response) {
+                calledOnMainThread = [NSThread isMainThread];
+                fetchResponse = response;
+            }];
+            
+            CMWebServiceObjectFetchSuccessCallback callback = callbackBlockSpy.argument;
+            callback(@{@"akey": @{@"__id__": @"akey", @"name": @"The Venue"}}, @{}, @{}, @{}, @1, @{});
+            
+            [[fetchResponse should] beNil];
+            [[expectFutureValue(fetchResponse) shouldEventually] beNonNil];
+            [[expectFutureValue(theValue(fetchResponse.objects.count)) shouldEventually] equal:theValue(1)];
+            [[theValue(calledOnMainThread) should] beYes];
+        });
+        
+        it(@"should hand streamed objects to the object handler one at a time", ^{
+            SEL selector = @selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:entryHandler:successHandler:errorHandler:);
+            KWCaptureSpy *entryBlockSpy = [store.webService captureArgument:selector atIndex:6];
+            KWCaptureSpy *callbackBlockSpy = [store.webService captureArgument:selector atIndex:7];
+            [[store.webService should] receive:selector withCount:1];
+            
+            NSMutableArray *handledObjects = [NSMutableArray array];
+            __block CMObjectFetchResponse *fetchResponse = nil;
+            [store allObjectsWithOptions:nil objectHandler:^(id object) {
+                [handledObjects addObject:object];
+            } callback:^(CMObjectFetchResponse *response) {
+                fetchResponse = response;
+            }];
+            
+            CMWebServiceObjectEntryCallback entryHandler = entryBlockSpy.argument;
+            entryHandler(@"akey", @{@"__id__": @"akey", @"name": @"The Venue"});
+            [[theValue(handledObjects.count) should] equal:theValue(1)];
+            entryHandler(@"bkey", @{@"__id__": @"bkey", @"name": @"Another Venue"});
+            [[theValue(handledObjects.count) should] equal:theValue(2)];
+            
+            CMWebServiceObjectFetchSuccessCallback callback = callbackBlockSpy.argument;
+            callback(@{}, @{}, @{}, @{}, nil, @{});
+            [[expectFutureValue(fetchResponse) shouldEventually] beNonNil];
+            [[theValue(fetchResponse.objects.count) should] equal:theValue(0)];
+            [[theValue(fetchResponse.count) should] equal:theValue(2)];
+        });
+
+        it(@"should not keep streamed objects in memory, but still own them", ^{
+            SEL selector = @selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:entryHandler:successHandler:errorHandler:);
+            KWCaptureSpy *entryBlockSpy = [store.webService captureArgument:selector atIndex:6];
+
+            __block CMObjectOwnershipLevel level = CMObjectOwnershipUndefinedLevel;
+            __block __weak id streamedObject = nil;
+            [store allObjectsWithOptions:nil objectHandler:^(id object) {
+                level = [store objectOwnershipLevel:object];
+                [[[object store] should] beIdenticalTo:store];
+                streamedObject = object;
+            } callback:nil];
+
+            @autoreleasepool {
+                CMWebServiceObjectEntryCallback entryHandler = entryBlockSpy.argument;
+                entryHandler(@"akey", @{@"__id__": @"akey", @"name": @"The Venue"});
+            }
+            [[theValue(level) should] equal:theValue(CMObjectOwnershipAppLevel)];
+            [[streamedObject should] beNil];
+        });
+        
+        it(@"should cancel its requests through its web service", ^{
+            [[store.webService should] receive:@selector(cancelAllRequests)];
+            [store cancelAllRequests];
+        });
+        
+        it(@"should answer a cache-only fetch from the object cache without touching the network", ^{
+            NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"sqlite"]];
+            store.objectCache = [[CMObjectCache alloc] initWithPath:path];
+            [store.objectCache storeRepresentations:@{@"akey": @{@"__id__": @"akey", @"name": @"The Venue"}} ownerIdentifier:nil];
+            [[store.webService shouldNot] receive:@selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:)];
+            
+            CMStoreOptions *options = [[CMStoreOptions alloc] init];
+            options.cachePolicy = CMStoreCachePolicyCacheOnly;
+            __block CMObjectFetchResponse *fetchResponse = nil;
+            [store objectsWithKeys:@[@"akey"] additionalOptions:options callback:^(CMObjectFetchResponse *response) {
+                fetchResponse = response;
+            }];
+            
+            [[expectFutureValue(fetchResponse) shouldEventually] beNonNil];
+            [[theValue(fetchResponse.cached) should] beYes];
+            [[theValue(fetchResponse.objects.count) should] equal:theValue(1)];
+            [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        });
+        
+        it(@"should go to the network when cached objects are missing for a cache-if-fresh fetch", ^{
+            NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"sqlite"]];
+            store.objectCache = [[CMObjectCache alloc] initWithPath:path];
+            [[store.webService shouldEventually] receive:@selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:)];
+            
+            CMStoreOptions *options = [[CMStoreOptions alloc] init];
+            options.cachePolicy = CMStoreCachePolicyCacheIfFresh;
+            options.cacheMaximumAge = 60;
+            [store objectsWithKeys:@[@"akey"] additionalOptions:options callback:nil];
+            [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        });
+        
+        it(@"should only keep objects on disk when given an object cache", ^{
+            [[[CMStore store].objectCache should] beNil];
+        });
+
+        it(@"should drop what it cached on disk for a user once it switches to another user", ^{
+            NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"sqlite"]];
+            store.objectCache = [[CMObjectCache alloc] initWithPath:path];
+            CMUser *firstUser = [[CMUser alloc] initWithEmail:@"first@test.com" andPassword:@"password"];
+            store.user = firstUser;
+            [store.objectCache storeRepresentations:@{@"akey": @{@"__id__": @"akey", @"name": @"The Venue"}} ownerIdentifier:firstUser.objectId];
+            [store.objectCache storeRepresentations:@{@"akey": @{@"__id__": @"akey", @"name": @"The Venue"}} ownerIdentifier:nil];
+
+            store.user = [[CMUser alloc] initWithEmail:@"second@test.com" andPassword:@"password"];
+            [[[store.objectCache representationsWithKeys:nil ownerIdentifier:firstUser.objectId maximumAge:0] should] beEmpty];
+            [[[store.objectCache representationsWithKeys:nil ownerIdentifier:nil maximumAge:0] should] haveCountOf:1];
+            [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        });
+
+        it(@"should stream saves with an object cache and keep only what was saved", ^{
+            NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"sqlite"]];
+            store.objectCache = [[CMObjectCache alloc] initWithPath:path];
+            KWCaptureSpy *successSpy = [store.webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:5];
+            [[store.webService shouldNot] receive:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:)];
+
+            Venue *saved = [[Venue alloc] init];
+            saved.name = @"The Venue";
+            Venue *refused = [[Venue alloc] init];
+            [store addObject:saved];
+            [store addObject:refused];
+            [store saveAllAppObjects:nil];
+
+            CMWebServiceObjectFetchSuccessCallback success = successSpy.argument;
+            success(@{saved.objectId: @"created"}, @{refused.objectId: @"refused"}, nil, nil, @1, @{});
+            NSDictionary *cached = [store.objectCache representationsWithKeys:nil ownerIdentifier:nil maximumAge:0];
+            [[[cached allKeys] should] equal:@[saved.objectId]];
+            [[[[cached objectForKey:saved.objectId] objectForKey:@"name"] should] equal:@"The Venue"];
+            [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        });
+
+        it(@"should deliver web service responses on a custom completion queue", ^{
+            KWCaptureSpy *callbackBlockSpy = [store.webService
+                                              captureArgument:@selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:) atIndex:7];
+            [[store.webService should] receive:@selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:) withCount:1];
+            
+            static void *CMStoreSpecQueueKey = &CMStoreSpecQueueKey;
+            dispatch_queue_t queue = dispatch_queue_create("com.cloudmine.store.spec", DISPATCH_QUEUE_SERIAL);
+            dispatch_queue_set_specific(queue, CMStoreSpecQueueKey, CMStoreSpecQueueKey, NULL);
+            store.completionQueue = queue;
+            
+            __block CMObjectFetchResponse *fetchResponse = nil;
+            __block BOOL calledOnQueue = NO;
+            [store objectsWithKeys:@[@"akey"] additionalOptions:nil callback:^(CMObjectFetchResponse *response) {
+                calledOnQueue = dispatch_get_specific(CMStoreSpecQueueKey) != NULL;
+                fetchResponse = response;
+            }];
+            
+            CMWebServiceFetchFailureCallback callback = callbackBlockSpy.argument;
+            callback([NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:nil]);
+            
+            [[store.lastError shouldNot] beNil];
+            [[expectFutureValue(fetchResponse.error) shouldEventually] beNonNil];
+            [[expectFutureValue(theValue(calledOnQueue)) shouldEventually] beYes];
+        });
+        
         it(@"should return an error for saving a file if the webserver has issues", ^{
             KWCaptureSpy *callbackBlockSpy = [store.webService
                                               captureArgument:@selector(uploadFileAtPath:serverSideFunction:named:ofMimeType:user:extraParameters:successHandler:errorHandler:) atIndex:7];
@@ -213,8 +410,8 @@ describe(@"CMStore", ^{
         
         it(@"should return an error for saving objects", ^{
             KWCaptureSpy *callbackBlockSpy = [store.webService
-                                              captureArgument:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:5];
-            [[store.webService should] receive:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:) withCount:1];
+                                              captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:6];
+            [[store.webService should] receive:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) withCount:1];
             
             // This first call should trigger the web service call.
             [store saveObject:[CMObject new] additionalOptions:nil callback:^(CMObjectUploadResponse *response) {
@@ -269,6 +466,184 @@ describe(@"CMStore", ^{
                 [[theBlock(^{ [store addACL:acl]; }) should] raiseWithName:NSInternalInconsistencyException];
             });
         });
+
+        context(@"when saving only changed fields", ^{
+            __block Venue *venue = nil;
+            __block CMStoreOptions *options = nil;
+            __block KWCaptureSpy *objectsSpy = nil;
+            __block KWCaptureSpy *keysSpy = nil;
+            NSDictionary *(^sentBody)(void) = ^{
+                return [CMObjectEncoder encodeObjects:objectsSpy.argument keys:keysSpy.argument];
+            };
+
+            beforeEach(^{
+                Venue *original = [[Venue alloc] init];
+                original.name = @"The Venue";
+                original.city = @"Philadelphia";
+                venue = [[CMObjectDecoder decodeObjects:[CMObjectEncoder encodeObjects:@[original]]] lastObject];
+                options = [[CMStoreOptions alloc] init];
+                options.saveChangedFieldsOnly = YES;
+                objectsSpy = [webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:0];
+                keysSpy = [webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:1];
+            });
+
+            it(@"should send only the changed fields of a stored object", ^{
+                venue.name = @"Another Venue";
+                [store saveObject:venue additionalOptions:options callback:nil];
+
+                NSDictionary *body = [sentBody() objectForKey:venue.objectId];
+                [[[NSSet setWithArray:[body allKeys]] should] equal:[NSSet setWithObjects:@"name", CMInternalObjectIdKey, CMInternalClassStorageKey, nil]];
+                [[body[@"name"] should] equal:@"Another Venue"];
+            });
+
+            it(@"should send new objects in full", ^{
+                Venue *newVenue = [[Venue alloc] init];
+                newVenue.name = @"New Venue";
+                [store saveObject:newVenue additionalOptions:options callback:nil];
+
+                NSDictionary *body = [sentBody() objectForKey:newVenue.objectId];
+                [[body[@"city"] should] equal:[NSNull null]];
+                [[body[@"zip"] should] equal:@0];
+            });
+
+            it(@"should send objects in full when a changed property is encoded under another key", ^{
+                CMRenamedFieldObject *original = [[CMRenamedFieldObject alloc] init];
+                original.title = @"Title";
+                original.body = @"Body";
+                CMRenamedFieldObject *post = [[CMObjectDecoder decodeObjects:[CMObjectEncoder encodeObjects:@[original]]] lastObject];
+                post.title = @"Another Title";
+                [store saveObject:post additionalOptions:options callback:nil];
+
+                NSDictionary *body = [sentBody() objectForKey:post.objectId];
+                [[body[@"headline"] should] equal:@"Another Title"];
+                [[body[@"body"] should] equal:@"Body"];
+            });
+        });
+
+        context(@"when queueing writes that couldn't connect", ^{
+            __block NSURL *directoryURL = nil;
+
+            beforeEach(^{
+                directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+                store.outbox = [[CMOutbox alloc] initWithDirectoryURL:directoryURL];
+            });
+
+            afterEach(^{
+                store.outbox = nil;
+                [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:nil];
+            });
+
+            it(@"should fail cancelled saves instead of queueing them", ^{
+                KWCaptureSpy *errorSpy = [webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:6];
+                __block NSError *saveError = nil;
+                [store saveObject:[[Venue alloc] init] callback:^(CMObjectUploadResponse *response) {
+                    saveError = response.error;
+                }];
+
+                CMWebServiceFetchFailureCallback failure = errorSpy.argument;
+                NSError *cancelled = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+                failure([NSError errorWithDomain:CMErrorDomain code:CMErrorServerConnectionFailed userInfo:@{NSURLErrorKey: cancelled}]);
+
+                [[expectFutureValue(saveError) shouldEventually] beNonNil];
+                [[[store.outbox pendingOperations] should] beEmpty];
+            });
+        });
+
+        context(@"when coalescing saves", ^{
+            it(@"should send saves made within the window in one request and split the statuses", ^{
+                KWCaptureSpy *objectsSpy = [webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:0];
+                KWCaptureSpy *successSpy = [webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:5];
+                [[webService should] receive:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) withCount:1];
+                store.saveCoalescingInterval = 60.0;
+
+                Venue *first = [[Venue alloc] init];
+                Venue *second = [[Venue alloc] init];
+                __block NSDictionary *firstStatuses = nil;
+                __block NSDictionary *secondStatuses = nil;
+                [store saveObject:first callback:^(CMObjectUploadResponse *response) {
+                    firstStatuses = response.uploadStatuses;
+                }];
+                [store saveObject:second callback:^(CMObjectUploadResponse *response) {
+                    secondStatuses = response.uploadStatuses;
+                }];
+                [store flushPendingSaves];
+
+                [[[NSSet setWithArray:[objectsSpy.argument valueForKey:@"objectId"]] should] equal:[NSSet setWithObjects:first.objectId, second.objectId, nil]];
+                CMWebServiceObjectFetchSuccessCallback success = successSpy.argument;
+                success(@{first.objectId: @"created", second.objectId: @"updated"}, @{}, nil, nil, @2, @{});
+                [[firstStatuses should] equal:@{first.objectId: @"created"}];
+                [[secondStatuses should] equal:@{second.objectId: @"updated"}];
+            });
+        });
+
+        context(@"when downloading a file to disk", ^{
+            it(@"should hand back a file backed by the destination URL", ^{
+                NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"download.bin"]];
+                KWCaptureSpy *successSpy = [store.webService captureArgument:@selector(downloadBinaryDataNamed:serverSideFunction:user:extraParameters:toURL:progressHandler:successHandler:errorHandler:) atIndex:6];
+
+                __block CMFile *downloaded = nil;
+                [store fileWithName:@"video" toURL:url additionalOptions:nil progress:nil callback:^(CMFileFetchResponse *response) {
+                    downloaded = response.file;
+                }];
+
+                CMWebServiceFileDownloadSuccessCallback success = successSpy.argument;
+                success(url, @"video/mp4", @{});
+
+                [[downloaded.fileURL should] equal:url];
+                [[downloaded.fileName should] equal:@"video"];
+                [[downloaded.mimeType should] equal:@"video/mp4"];
+                [[theValue([store objectOwnershipLevel:downloaded]) should] equal:theValue(CMObjectOwnershipAppLevel)];
+            });
+        });
+
+        context(@"when bounding the in-memory caches", ^{
+            beforeEach(^{
+                [store setCountLimit:1 totalCostLimit:0 forMemoryCache:CMStoreMemoryCacheAppObjects];
+            });
+
+            it(@"should never evict objects with unsaved changes", ^{
+                CMObject *first = [[CMObject alloc] init];
+                CMObject *second = [[CMObject alloc] init];
+                [store addObject:first];
+                [store addObject:second];
+
+                [[theValue([store objectOwnershipLevel:first]) should] equal:theValue(CMObjectOwnershipAppLevel)];
+                [[theValue([store objectOwnershipLevel:second]) should] equal:theValue(CMObjectOwnershipAppLevel)];
+            });
+
+            it(@"should estimate the cost of cached objects without encoding them", ^{
+                [[CMObjectEncoder shouldNot] receive:@selector(encodeObjects:)];
+                [store addObject:[[CMObject alloc] init]];
+            });
+
+            it(@"should cost fetched objects by the size of their representation", ^{
+                [store setCountLimit:0 totalCostLimit:0 forMemoryCache:CMStoreMemoryCacheAppObjects];
+                KWCaptureSpy *callbackBlockSpy = [store.webService captureArgument:@selector(getValuesForKeys:serverSideFunction:pagingOptions:sortingOptions:user:extraParameters:successHandler:errorHandler:) atIndex:6];
+                __block CMObjectFetchResponse *fetchResponse = nil;
+                [store objectsWithKeys:@[@"akey"] additionalOptions:nil callback:^(CMObjectFetchResponse *response) {
+                    fetchResponse = response;
+                }];
+
+                NSString *name = [@"" stringByPaddingToLength:4096 withString:@"x" startingAtIndex:0];
+                CMWebServiceObjectFetchSuccessCallback callback = callbackBlockSpy.argument;
+                callback(@{@"akey": @{@"__id__": @"akey", @"__class__": @"Venue", @"name": name}}, @{}, @{}, @{}, @1, @{});
+
+                [[expectFutureValue(fetchResponse) shouldEventually] beNonNil];
+                [[theValue([[store valueForKey:@"cachedAppObjects"] totalCost]) should] beGreaterThan:theValue(4096)];
+            });
+
+            it(@"should keep the ownership level of evicted objects", ^{
+                CMObject *first = [[CMObject alloc] init];
+                CMObject *second = [[CMObject alloc] init];
+                first.dirty = NO;
+                second.dirty = NO;
+                [store addObject:first];
+                [store addObject:second];
+
+                [[theValue([store objectOwnershipLevel:first]) should] equal:theValue(CMObjectOwnershipAppLevel)];
+                [[first.store should] equal:store];
+            });
+        });
     });
 
     context(@"given a user-level store", ^{
@@ -396,6 +771,51 @@ describe(@"CMStore", ^{
             [[store.lastError should] beNil]; // should be the error created above
         });
         
+        it(@"should report an ACL whose saved copy cannot be decoded", ^{
+            [store.webService stub:@selector(updateACL:user:successHandler:errorHandler:) withBlock:^id(NSArray *params) {
+                CMWebServiceObjectFetchSuccessCallback successHandler = [params objectAtIndex:2];
+                successHandler(@{}, @{}, nil, nil, @0, @{});
+                return nil;
+            }];
+
+            CMACL *acl = [[CMACL alloc] init];
+            acl.members = [NSSet setWithObject:@"member"];
+            __block NSDictionary *statuses = nil;
+            [store saveACLs:@[acl] callback:^(CMObjectUploadResponse *response) {
+                statuses = response.uploadStatuses;
+            }];
+
+            [[expectFutureValue(statuses) shouldEventually] haveCountOf:1];
+            [[[statuses objectForKey:acl.objectId] shouldNot] equal:@"updated"];
+            [[[statuses objectForKey:acl.objectId] should] beNonNil];
+        });
+
+        it(@"should report every ACL when saving them with overlapping requests", ^{
+            store.maxConcurrentACLSaves = 4;
+            [store.webService stub:@selector(updateACL:user:successHandler:errorHandler:) withBlock:^id(NSArray *params) {
+                NSDictionary *acl = [params objectAtIndex:0];
+                CMWebServiceObjectFetchSuccessCallback successHandler = [params objectAtIndex:2];
+                dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                    successHandler(@{[acl objectForKey:CMInternalObjectIdKey]: acl}, @{}, nil, nil, @1, @{});
+                });
+                return nil;
+            }];
+
+            NSMutableArray *acls = [NSMutableArray array];
+            for (NSUInteger i = 0; i < 10; i++) {
+                CMACL *acl = [[CMACL alloc] init];
+                acl.members = [NSSet setWithObject:[NSString stringWithFormat:@"member%lu", (unsigned long)i]];
+                [acls addObject:acl];
+            }
+            __block NSDictionary *statuses = nil;
+            [store saveACLs:acls callback:^(CMObjectUploadResponse *response) {
+                statuses = response.uploadStatuses;
+            }];
+
+            [[expectFutureValue(statuses) shouldEventually] haveCountOf:10];
+            [[[NSSet setWithArray:[statuses allKeys]] should] equal:[NSSet setWithArray:[acls valueForKey:@"objectId"]]];
+        });
+
         it(@"should return the proper error when deleting ACL's", ^{
             KWCaptureSpy *callbackBlockSpy = [store.webService
                                               captureArgument:@selector(deleteACLWithKey:user:successHandler:errorHandler:) atIndex:3];
@@ -470,7 +890,7 @@ describe(@"CMStore", ^{
                 CMObject *obj = [[CMObject alloc] init];
                 [[user should] receive:@selector(isLoggedIn)];
                 [[user shouldNot] receive:@selector(loginWithCallback:)];
-                [webService captureArgument:@selector(updateValuesFromDictionary:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:0];
+                [webService captureArgument:@selector(updateValuesFromObjects:keys:serverSideFunction:user:extraParameters:successHandler:errorHandler:) atIndex:0];
                 [store saveUserObject:obj callback:nil];
             });
 
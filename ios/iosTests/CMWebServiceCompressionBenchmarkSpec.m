@@ -0,0 +1,87 @@
+//
+//  CMWebServiceCompressionBenchmarkSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+#import "CMWebService.h"
+#import "NSDictionary+CMJSON.h"
+#import "NSData+CMCompression.h"
+#import "CMTestMacros.h"
+
+/**
+ * Compares the bytes on the wire of object saves of growing size with and without request compression. The sizes are
+ * always compared. Total latencies, compression included, are measured too when <tt>BENCHMARK_URL</tt> points at
+ * <tt>scripts/benchmark_server.rb</tt>.
+ */
+
+#define BENCHMARK_URL ([[NSProcessInfo processInfo] environment][@"BENCHMARK_URL"])
+#define BENCHMARK_REQUEST_COUNT 20
+#define BENCHMARK_TIMEOUT 120.0
+
+/** A bulk save of <tt>count</tt> objects shaped like typical app data. */
+static NSDictionary *CMBulkSavePayload(NSUInteger count) {
+    NSMutableDictionary *objects = [NSMutableDictionary dictionaryWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *objectId = [[NSUUID UUID] UUIDString];
+        [objects setObject:@{@"__id__": objectId,
+                             @"__class__": @"Measurement",
+                             @"name": [NSString stringWithFormat:@"Measurement %lu", (unsigned long)i],
+                             @"value": @(i * 1.5),
+                             @"tags": @[@"health", @"daily"],
+                             @"recorded": @{@"__type__": @"datetime", @"timestamp": @(1454284800 + i)}}
+                    forKey:objectId];
+    }
+    return objects;
+}
+
+static NSTimeInterval CMMedianSaveLatency(NSDictionary *body, CMWebServiceRequestCompression compression) {
+    CMWebService *service = [[CMWebService alloc] initWithAppSecret:API_KEY appIdentifier:APP_ID baseURL:[NSURL URLWithString:BENCHMARK_URL]];
+    service.completionQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    service.requestCompression = compression;
+
+    NSMutableArray *latencies = [NSMutableArray arrayWithCapacity:BENCHMARK_REQUEST_COUNT];
+    for (NSUInteger i = 0; i < BENCHMARK_REQUEST_COUNT; i++) {
+        dispatch_semaphore_t done = dispatch_semaphore_create(0);
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        [service updateValuesFromDictionary:body serverSideFunction:nil user:nil extraParameters:nil successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+            dispatch_semaphore_signal(done);
+        } errorHandler:^(NSError *error) {
+            dispatch_semaphore_signal(done);
+        }];
+        dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(BENCHMARK_TIMEOUT * NSEC_PER_SEC)));
+        [latencies addObject:@(CFAbsoluteTimeGetCurrent() - start)];
+    }
+
+    NSArray *sorted = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    return [[sorted objectAtIndex:sorted.count / 2] doubleValue];
+}
+
+SPEC_BEGIN(CMWebServiceCompressionBenchmarkSpec)
+
+describe(@"CMWebServiceCompressionBenchmark", ^{
+
+    it(@"should send a fraction of the bytes for large saves", ^{
+        for (NSNumber *count in @[@10, @100, @1000, @10000]) {
+            NSDictionary *payload = CMBulkSavePayload([count unsignedIntegerValue]);
+            NSData *json = [payload jsonData];
+            NSUInteger gzipLength = [[json gzippedData] length];
+            NSUInteger deflateLength = [[json deflatedData] length];
+
+            NSLog(@"%@ objects: %lu bytes raw, %lu gzip (%.1f%%), %lu deflate (%.1f%%)", count, (unsigned long)json.length,
+                  (unsigned long)gzipLength, 100.0 * gzipLength / json.length, (unsigned long)deflateLength, 100.0 * deflateLength / json.length);
+            [[theValue(gzipLength * 2) should] beLessThan:theValue(json.length)];
+
+            if (BENCHMARK_URL.length > 0) {
+                NSTimeInterval rawLatency = CMMedianSaveLatency(payload, CMWebServiceRequestCompressionNone);
+                NSTimeInterval gzipLatency = CMMedianSaveLatency(payload, CMWebServiceRequestCompressionGzip);
+                NSLog(@"%@ objects: median save latency raw %.1f ms, gzip %.1f ms", count, rawLatency * 1000.0, gzipLatency * 1000.0);
+            }
+        }
+    });
+});
+
+SPEC_END
@@ -19,6 +19,17 @@
 #import "CMConstants.h"
 #import "NSDictionary+CMJSON.h"
 #import "CMStore.h"
+#import "CMSessionRequestOperation.h"
+#import "CMBodyCodec.h"
+#import "CMMessagePackSerialization.h"
+
+@interface CMWebService (ResponseParsing)
+- (id)parsedResponseObject:(id)responseObject forOperation:(AFHTTPRequestOperation *)operation error:(NSError **)error;
+@end
+
+@interface CMWebService (CallbackDelivery)
+- (void)deliverBlock:(void (^)())block;
+@end
 
 SPEC_BEGIN(CMWebServiceSpec)
 
@@ -108,6 +119,48 @@ describe(@"CMWebService", ^{
             [[[[request allHTTPHeaderFields] objectForKey:@"X-CloudMine-ApiKey"] should] equal:appSecret];            
         });
 
+        it(@"only once for identical requests in flight", ^{
+            __block NSUInteger calls = 0;
+            for (int i = 0; i < 3; i++) {
+                [service getBinaryDataNamed:@"logo.png"
+                         serverSideFunction:nil
+                                       user:nil
+                            extraParameters:nil
+                             successHandler:^(NSData *data, NSString *contentType, NSDictionary *headers) {
+                                 calls++;
+                             } errorHandler:^(NSError *error) {
+                                 calls++;
+                             }
+                 ];
+            }
+
+            NSDictionary *inFlight = [service valueForKey:@"_inFlightRequests"];
+            [[inFlight should] haveCountOf:1];
+            [[[[inFlight allValues] firstObject] should] haveCountOf:3];
+            [[theValue(calls) should] equal:theValue(0)];
+        });
+
+        it(@"binary data download URLs at the app level correctly", ^{
+            NSString *binaryKey = @"filename";
+            NSURL *expectedUrl = [NSURL URLWithString:[NSString stringWithFormat:@"https://api.cloudmine.io/v1/app/%@/binary/%@", appId, binaryKey]];
+
+            [service downloadBinaryDataNamed:binaryKey
+                          serverSideFunction:nil
+                                        user:nil
+                             extraParameters:nil
+                                       toURL:[NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:binaryKey]]
+                             progressHandler:nil
+                              successHandler:^(NSURL *location, NSString *contentType, NSDictionary *headers) {
+                              } errorHandler:^(NSError *error) {
+                              }
+             ];
+
+            NSURLRequest *request = spy.argument;
+            [[[request URL] should] equal:expectedUrl];
+            [[[request HTTPMethod] should] equal:@"GET"];
+            [[[[request allHTTPHeaderFields] objectForKey:@"X-CloudMine-ApiKey"] should] equal:appSecret];
+        });
+
         it(@"JSON URLs at the app level with keys correctly", ^{
             NSURL *expectedUrl = [NSURL URLWithString:[NSString stringWithFormat:@"https://api.cloudmine.io/v1/app/%@/text?keys=k1%%2Ck2", appId]];
 
@@ -283,6 +336,50 @@ describe(@"CMWebService", ^{
             [[[[request allHTTPHeaderFields] objectForKey:@"X-CloudMine-ApiKey"] should] equal:appSecret];
         });
 
+        it(@"JSON bodies compressed above the threshold", ^{
+            NSMutableArray *values = [NSMutableArray array];
+            for (int i = 0; i < 1000; i++) {
+                [values addObject:@"repeated value"];
+            }
+            service.requestCompression = CMWebServiceRequestCompressionGzip;
+            service.requestCompressionThreshold = 1024;
+
+            [service updateValuesFromDictionary:@{@"key1": values}
+                             serverSideFunction:nil
+                                           user:nil
+                                extraParameters:nil
+                                 successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+                                 } errorHandler:^(NSError *error) {
+                                 }
+             ];
+
+            NSURLRequest *request = spy.argument;
+            const unsigned char *bytes = [[request HTTPBody] bytes];
+            [[[request valueForHTTPHeaderField:@"Content-Encoding"] should] equal:@"gzip"];
+            [[[request valueForHTTPHeaderField:@"Accept-Encoding"] should] equal:@"gzip, deflate"];
+            [[theValue(bytes[0] == 0x1f && bytes[1] == 0x8b) should] beYes];
+            [[theValue([[request HTTPBody] length]) should] beLessThan:theValue([[@{@"key1": values} jsonData] length])];
+        });
+
+        it(@"object saves in the format of the body codec", ^{
+            NSDictionary *body = @{@"key1": @{@"name": @"value", @"count": @3}};
+            service.bodyCodec = [CMMessagePackBodyCodec codec];
+
+            [service updateValuesFromDictionary:body
+                             serverSideFunction:nil
+                                           user:nil
+                                extraParameters:nil
+                                 successHandler:^(NSDictionary *results, NSDictionary *errors, NSDictionary *meta, id snippetResult, NSNumber *count, NSDictionary *headers) {
+                                 } errorHandler:^(NSError *error) {
+                                 }
+             ];
+
+            NSURLRequest *request = spy.argument;
+            [[[request valueForHTTPHeaderField:@"Content-Type"] should] equal:@"application/msgpack"];
+            [[[request valueForHTTPHeaderField:@"Accept"] should] equal:@"application/msgpack, application/json;q=0.5"];
+            [[[CMMessagePackSerialization objectWithData:[request HTTPBody] error:NULL] should] equal:body];
+        });
+
         it(@"binary data URLs at the app level correctly", ^{
             NSString *binaryKey = @"filename";
             NSData *data = [NSMutableData randomDataWithLength:100];
@@ -1185,5 +1282,230 @@ describe(@"CMWebServiceBaseUrl", ^{
     
 });
 
-SPEC_END
+describe(@"CMWebServiceResponseSerialization", ^{
+    
+    __block CMWebService *service = nil;
+    
+    beforeEach(^{
+        service = [[CMWebService alloc] initWithAppSecret:@"appSecret123" appIdentifier:@"appId123" baseURL:[NSURL URLWithString:@"https://api.cloudmine.io/"]];
+    });
+    
+    it(@"should parse responses with the JSON serializer by default", ^{
+        [[theValue(service.responseSerialization) should] equal:theValue(CMWebServiceResponseSerializationParsedOnce)];
+        [[service.responseSerializer should] beKindOfClass:[AFJSONResponseSerializer class]];
+    });
+    
+    it(@"should keep the raw bytes when asked to", ^{
+        service.responseSerialization = CMWebServiceResponseSerializationRawData;
+        [[service.responseSerializer shouldNot] beKindOfClass:[AFJSONResponseSerializer class]];
+        [[service.responseSerializer.acceptableContentTypes should] equal:[AFJSONResponseSerializer serializer].acceptableContentTypes];
+    });
+    
+    it(@"should reuse an object that was already parsed instead of parsing the body again", ^{
+        NSDictionary *parsed = @{@"success": @{@"key": @"value"}};
+        AFHTTPRequestOperation *operation = [AFHTTPRequestOperation nullMock];
+        [[operation shouldNot] receive:@selector(responseData)];
+        
+        NSError *error = nil;
+        id result = [service parsedResponseObject:parsed forOperation:operation error:&error];
+        [[theValue(result == parsed) should] beYes];
+        [[error should] beNil];
+    });
+    
+    it(@"should parse raw bytes exactly once", ^{
+        NSData *data = [@"{\"success\":{\"key\":\"value\"}}" dataUsingEncoding:NSUTF8StringEncoding];
+        
+        NSError *error = nil;
+        NSDictionary *result = [service parsedResponseObject:data forOperation:nil error:&error];
+        [[result[@"success"][@"key"] should] equal:@"value"];
+        [[error should] beNil];
+    });
+    
+    it(@"should report a parse error for an empty body", ^{
+        NSError *error = nil;
+        id result = [service parsedResponseObject:[NSData data] forOperation:nil error:&error];
+        [[result should] beNil];
+        [[error.domain should] equal:NSCocoaErrorDomain];
+    });
+});
 
+describe(@"CMWebServiceRequestScheduling", ^{
+    
+    __block CMWebService *service = nil;
+    
+    beforeEach(^{
+        service = [[CMWebService alloc] initWithAppSecret:@"appSecret123" appIdentifier:@"appId123" baseURL:[NSURL URLWithString:@"https://api.cloudmine.io/"]];
+    });
+    
+    afterEach(^{
+        [service cancelAllRequests];
+    });
+    
+    it(@"should bound the number of concurrent requests", ^{
+        [[theValue(service.maxConcurrentRequests) should] equal:theValue(4)];
+        service.maxConcurrentRequests = 2;
+        [[theValue(service.operationQueue.maxConcurrentOperationCount) should] equal:theValue(2)];
+    });
+    
+    it(@"should tag requests by the endpoint they call", ^{
+        [[theValue([service requestTagForURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/text?keys=a"]]) should] equal:theValue(CMWebServiceRequestTagObject)];
+        [[theValue([service requestTagForURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/user/search?q=x"]]) should] equal:theValue(CMWebServiceRequestTagObject)];
+        [[theValue([service requestTagForURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/user/binary/photo.png"]]) should] equal:theValue(CMWebServiceRequestTagFile)];
+        [[theValue([service requestTagForURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/account/login"]]) should] equal:theValue(CMWebServiceRequestTagUser)];
+        [[theValue([service requestTagForURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/run/my_snippet"]]) should] equal:theValue(CMWebServiceRequestTagSnippet)];
+        [[theValue([service requestTagForURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/device"]]) should] equal:theValue(CMWebServiceRequestTagDefault)];
+    });
+    
+    it(@"should schedule file transfers behind other requests", ^{
+        service.operationQueue.suspended = YES;
+        
+        NSURLRequest *fileRequest = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/binary/photo.png"]];
+        NSURLRequest *objectRequest = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/text"]];
+        AFHTTPRequestOperation *fileOperation = [[AFHTTPRequestOperation alloc] initWithRequest:fileRequest];
+        AFHTTPRequestOperation *objectOperation = [[AFHTTPRequestOperation alloc] initWithRequest:objectRequest];
+        [service enqueueHTTPRequestOperation:fileOperation];
+        [service enqueueHTTPRequestOperation:objectOperation];
+        
+        [[theValue(fileOperation.queuePriority) should] equal:theValue(NSOperationQueuePriorityLow)];
+        [[theValue(objectOperation.queuePriority) should] equal:theValue(NSOperationQueuePriorityNormal)];
+    });
+    
+    it(@"should cancel only the requests with the given tag", ^{
+        service.operationQueue.suspended = YES;
+        
+        NSURLRequest *fileRequest = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/binary/photo.png"]];
+        NSURLRequest *objectRequest = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/text"]];
+        AFHTTPRequestOperation *fileOperation = [[AFHTTPRequestOperation alloc] initWithRequest:fileRequest];
+        AFHTTPRequestOperation *objectOperation = [[AFHTTPRequestOperation alloc] initWithRequest:objectRequest];
+        [service enqueueHTTPRequestOperation:fileOperation];
+        [service enqueueHTTPRequestOperation:objectOperation];
+        
+        [service cancelRequestsWithTag:CMWebServiceRequestTagFile];
+        [[theValue(fileOperation.isCancelled) should] beYes];
+        [[theValue(objectOperation.isCancelled) should] beNo];
+    });
+});
+
+describe(@"CMWebServiceCallbackDelivery", ^{
+    
+    __block CMWebService *service = nil;
+    
+    beforeEach(^{
+        service = [[CMWebService alloc] initWithAppSecret:@"appSecret123" appIdentifier:@"appId123" baseURL:[NSURL URLWithString:@"https://api.cloudmine.io/"]];
+    });
+    
+    it(@"should handle responses off the main queue", ^{
+        NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/text"]];
+        AFHTTPRequestOperation *operation = [service HTTPRequestOperationWithRequest:request success:nil failure:nil];
+        [[(id)operation.completionQueue shouldNot] beNil];
+        [[theValue(operation.completionQueue == dispatch_get_main_queue()) should] beNo];
+    });
+    
+    it(@"should deliver callbacks asynchronously on the main queue by default", ^{
+        __block BOOL called = NO;
+        __block BOOL calledOnMainThread = NO;
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [service deliverBlock:^{
+                calledOnMainThread = [NSThread isMainThread];
+                called = YES;
+            }];
+        });
+        
+        [[expectFutureValue(theValue(called)) shouldEventually] beYes];
+        [[theValue(calledOnMainThread) should] beYes];
+    });
+    
+    it(@"should deliver callbacks on the completion queue", ^{
+        static void *CMWebServiceSpecQueueKey = &CMWebServiceSpecQueueKey;
+        dispatch_queue_t queue = dispatch_queue_create("com.cloudmine.webservice.spec", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(queue, CMWebServiceSpecQueueKey, CMWebServiceSpecQueueKey, NULL);
+        service.completionQueue = queue;
+        
+        __block BOOL calledOnQueue = NO;
+        [service deliverBlock:^{
+            calledOnQueue = dispatch_get_specific(CMWebServiceSpecQueueKey) != NULL;
+        }];
+        
+        [[expectFutureValue(theValue(calledOnQueue)) shouldEventually] beYes];
+    });
+});
+
+describe(@"CMWebServiceTransport", ^{
+    
+    __block CMWebService *service = nil;
+    __block NSURLRequest *request = nil;
+    
+    beforeEach(^{
+        service = [[CMWebService alloc] initWithAppSecret:@"appSecret123" appIdentifier:@"appId123" baseURL:[NSURL URLWithString:@"https://api.cloudmine.io/"]];
+        request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://api.cloudmine.io/v1/app/appId123/text"]];
+    });
+    
+    afterEach(^{
+        [service cancelAllRequests];
+    });
+    
+    it(@"should use connection based operations by default", ^{
+        [[theValue(service.transport) should] equal:theValue(CMWebServiceTransportConnection)];
+        AFHTTPRequestOperation *operation = [service HTTPRequestOperationWithRequest:request success:nil failure:nil];
+        [[operation shouldNot] beKindOfClass:[CMSessionRequestOperation class]];
+    });
+    
+    it(@"should run every request on one shared session when using the session transport", ^{
+        service.transport = CMWebServiceTransportSession;
+        CMSessionRequestOperation *first = (CMSessionRequestOperation *)[service HTTPRequestOperationWithRequest:request success:nil failure:nil];
+        CMSessionRequestOperation *second = (CMSessionRequestOperation *)[service HTTPRequestOperationWithRequest:request success:nil failure:nil];
+        
+        [[first should] beKindOfClass:[CMSessionRequestOperation class]];
+        [[first.sessionManager should] beIdenticalTo:second.sessionManager];
+        [[first.responseSerializer should] beIdenticalTo:service.responseSerializer];
+        [[theValue(first.sessionManager.session.configuration.HTTPMaximumConnectionsPerHost) should] equal:theValue(service.maxConcurrentRequests)];
+    });
+
+    it(@"should give requests made after the concurrency limit changes a session with the new limit", ^{
+        service.transport = CMWebServiceTransportSession;
+        CMSessionRequestOperation *before = (CMSessionRequestOperation *)[service HTTPRequestOperationWithRequest:request success:nil failure:nil];
+        service.maxConcurrentRequests = 8;
+        CMSessionRequestOperation *after = (CMSessionRequestOperation *)[service HTTPRequestOperationWithRequest:request success:nil failure:nil];
+
+        [[after.sessionManager shouldNot] beIdenticalTo:before.sessionManager];
+        [[theValue(after.sessionManager.session.configuration.HTTPMaximumConnectionsPerHost) should] equal:theValue(8)];
+        [[theValue(service.operationQueue.maxConcurrentOperationCount) should] equal:theValue(8)];
+    });
+    
+    it(@"should download binary data to a file on a connection even when using the session transport", ^{
+        service.transport = CMWebServiceTransportSession;
+        KWCaptureSpy *spy = [service captureArgument:@selector(enqueueHTTPRequestOperation:) atIndex:0];
+        [service downloadBinaryDataNamed:@"filename"
+                      serverSideFunction:nil
+                                    user:nil
+                         extraParameters:nil
+                                   toURL:[NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"filename"]]
+                         progressHandler:nil
+                          successHandler:nil
+                            errorHandler:nil];
+        
+        AFHTTPRequestOperation *operation = spy.argument;
+        [[operation shouldNot] beKindOfClass:[CMSessionRequestOperation class]];
+        [[operation.outputStream shouldNot] beNil];
+    });
+    
+    it(@"should fail a session request that is cancelled before it starts", ^{
+        service.transport = CMWebServiceTransportSession;
+        service.operationQueue.suspended = YES;
+        
+        __block NSError *failure = nil;
+        AFHTTPRequestOperation *operation = [service HTTPRequestOperationWithRequest:request success:nil failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+            failure = error;
+        }];
+        [service enqueueHTTPRequestOperation:operation];
+        [service cancelAllRequests];
+        service.operationQueue.suspended = NO;
+        
+        [[expectFutureValue(failure) shouldEventually] beNonNil];
+        [[expectFutureValue(theValue(failure.code)) shouldEventually] equal:theValue(NSURLErrorCancelled)];
+        [[theValue(operation.isCancelled) should] beYes];
+        [[((CMSessionRequestOperation *)operation).dataTask should] beNil];
+    });
+});
+
+SPEC_END
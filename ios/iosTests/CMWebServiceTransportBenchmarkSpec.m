@@ -0,0 +1,84 @@
+//
+//  CMWebServiceTransportBenchmarkSpec.m
+//  cloudmine-ios
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+#import "CMWebService.h"
+#import "CMTestMacros.h"
+
+/**
+ * Compares the connection and session transports against a local mock server. Start the server with
+ * <tt>ruby scripts/benchmark_server.rb</tt> and run the tests with <tt>BENCHMARK_URL</tt> set to the URL it prints. Put an
+ * HTTP/2 terminating proxy in front of the server to measure multiplexing. Without <tt>BENCHMARK_URL</tt> nothing runs.
+ */
+
+#define BENCHMARK_URL ([[NSProcessInfo processInfo] environment][@"BENCHMARK_URL"])
+#define BENCHMARK_REQUEST_COUNT 500
+#define BENCHMARK_TIMEOUT 120.0
+
+typedef struct {
+    NSTimeInterval wallTime;
+    NSTimeInterval p99Latency;
+    NSUInteger failures;
+} CMTransportBenchmarkResult;
+
+static CMTransportBenchmarkResult CMRunTransportBenchmark(CMWebServiceTransport transport) {
+    CMWebService *service = [[CMWebService alloc] initWithAppSecret:API_KEY appIdentifier:APP_ID baseURL:[NSURL URLWithString:BENCHMARK_URL]];
+    service.transport = transport;
+    service.maxConcurrentRequests = 16;
+
+    NSMutableArray *latencies = [NSMutableArray arrayWithCapacity:BENCHMARK_REQUEST_COUNT];
+    __block NSUInteger failures = 0;
+    dispatch_group_t group = dispatch_group_create();
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@%@/app/%@/text", BENCHMARK_URL, CM_DEFAULT_API_VERSION, APP_ID]];
+
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < BENCHMARK_REQUEST_COUNT; i++) {
+        NSMutableURLRequest *request = [service constructHTTPRequestWithVerb:@"GET" URL:url binaryData:NO user:nil];
+        CFAbsoluteTime enqueued = CFAbsoluteTimeGetCurrent();
+        dispatch_group_enter(group);
+        AFHTTPRequestOperation *operation = [service HTTPRequestOperationWithRequest:request success:^(AFHTTPRequestOperation *operation, id responseObject) {
+            // Response handlers run on the service's serial processing queue, so the latencies need no further locking.
+            [latencies addObject:@(CFAbsoluteTimeGetCurrent() - enqueued)];
+            dispatch_group_leave(group);
+        } failure:^(AFHTTPRequestOperation *operation, NSError *error) {
+            failures++;
+            dispatch_group_leave(group);
+        }];
+        [service enqueueHTTPRequestOperation:operation];
+    }
+    dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(BENCHMARK_TIMEOUT * NSEC_PER_SEC)));
+
+    CMTransportBenchmarkResult result;
+    result.wallTime = CFAbsoluteTimeGetCurrent() - start;
+    result.failures = failures;
+    NSArray *sorted = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    result.p99Latency = sorted.count > 0 ? [[sorted objectAtIndex:(NSUInteger)((sorted.count - 1) * 0.99)] doubleValue] : 0;
+    return result;
+}
+
+SPEC_BEGIN(CMWebServiceTransportBenchmarkSpec)
+
+describe(@"CMWebServiceTransportBenchmark", ^{
+
+    if (BENCHMARK_URL.length == 0) {
+        return;
+    }
+
+    it(@"should report throughput and p99 latency for both transports", ^{
+        CMTransportBenchmarkResult connection = CMRunTransportBenchmark(CMWebServiceTransportConnection);
+        CMTransportBenchmarkResult session = CMRunTransportBenchmark(CMWebServiceTransportSession);
+
+        NSLog(@"Connection transport: %.1f requests/s, p99 %.1f ms", BENCHMARK_REQUEST_COUNT / connection.wallTime, connection.p99Latency * 1000.0);
+        NSLog(@"Session transport: %.1f requests/s, p99 %.1f ms", BENCHMARK_REQUEST_COUNT / session.wallTime, session.p99Latency * 1000.0);
+
+        [[theValue(connection.failures) should] equal:theValue(0)];
+        [[theValue(session.failures) should] equal:theValue(0)];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,80 @@
+//
+//  UIImageViewCloudMineSpec.m
+//  cloudmine-iosTests
+//
+//  Copyright (c) 2016 CloudMine, Inc. All rights reserved.
+//  See LICENSE file included with SDK for details.
+//
+
+#import "Kiwi.h"
+
+#import "UIImageView+CloudMine.h"
+#import "CMStore.h"
+#import "CMFile.h"
+
+static NSData *CMPhotoData(CGSize size) {
+    UIGraphicsBeginImageContextWithOptions(size, YES, 1.0);
+    [[UIColor redColor] setFill];
+    UIRectFill(CGRectMake(0, 0, size.width, size.height));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    return UIImagePNGRepresentation(image);
+}
+
+SPEC_BEGIN(UIImageViewCloudMineSpec)
+
+describe(@"UIImageView+CloudMine", ^{
+
+    __block NSMutableDictionary *callbacks = nil;
+    __block UIImageView *imageView = nil;
+    CGFloat scale = [[UIScreen mainScreen] scale];
+
+    beforeEach(^{
+        callbacks = [NSMutableDictionary dictionary];
+        [[CMStore defaultStore] stub:@selector(fileWithName:additionalOptions:callback:) withBlock:^id(NSArray *params) {
+            [callbacks setObject:[params objectAtIndex:2] forKey:[params objectAtIndex:0]];
+            return nil;
+        }];
+        imageView = [[UIImageView alloc] initWithFrame:CGRectMake(0, 0, 100, 100)];
+        imageView.contentMode = UIViewContentModeScaleAspectFill;
+    });
+
+    void (^respond)(NSString *, CGSize) = ^(NSString *fileKey, CGSize size) {
+        CMFile *file = [[CMFile alloc] initWithData:CMPhotoData(size) named:fileKey mimeType:@"image/png"];
+        CMStoreFileFetchCallback callback = [callbacks objectForKey:fileKey];
+        callback([[CMFileFetchResponse alloc] initWithFile:file]);
+    };
+
+    it(@"should decode the image just large enough to fill the view when downsampling", ^{
+        [imageView setImageWithFileKey:@"downsampled" placeholderImage:nil user:nil downsample:YES];
+        respond(@"downsampled", CGSizeMake(1200, 900));
+
+        [[expectFutureValue(imageView.image) shouldEventually] beNonNil];
+        [[theValue(CGImageGetHeight(imageView.image.CGImage)) should] beWithin:theValue(1) of:theValue(100 * scale)];
+        [[theValue(imageView.image.scale) should] equal:theValue(scale)];
+    });
+
+    it(@"should decode the image at full size otherwise, and keep it for the next view", ^{
+        [imageView setImageWithFileKey:@"fullSize"];
+        respond(@"fullSize", CGSizeMake(1200, 900));
+
+        [[expectFutureValue(imageView.image) shouldEventually] beNonNil];
+        [[theValue(CGImageGetWidth(imageView.image.CGImage)) should] equal:theValue(1200)];
+
+        UIImageView *otherView = [[UIImageView alloc] initWithFrame:CGRectMake(0, 0, 100, 100)];
+        [otherView setImageWithFileKey:@"fullSize"];
+        [[otherView.image should] beIdenticalTo:imageView.image];
+    });
+
+    it(@"should not show a file that arrives after another one was requested", ^{
+        [imageView setImageWithFileKey:@"first" placeholderImage:nil user:nil downsample:YES];
+        [imageView setImageWithFileKey:@"second" placeholderImage:nil user:nil downsample:YES];
+        respond(@"second", CGSizeMake(1200, 1200));
+        respond(@"first", CGSizeMake(1200, 900));
+
+        [[expectFutureValue(imageView.image) shouldEventually] beNonNil];
+        [[theValue(CGImageGetWidth(imageView.image.CGImage)) should] beWithin:theValue(1) of:theValue(100 * scale)];
+    });
+});
+
+SPEC_END
@@ -0,0 +1,115 @@
+require 'webrick'
+require 'json'
+
+#
+# A mock CloudMine API for the benchmark specs. Every request gets
+# an empty object fetch response after a fixed delay that stands in for server time.
+#
+# GETs carry an ETag, and a GET sending it back in If-None-Match gets a 304 with an
+# X-Revalidated header, so conditional requests can be told apart from full ones.
+#
+# Chunked uploads (PUTs carrying X-CloudMine-Upload-Id) are assembled in memory and
+# answered with 308 and a Range header until the last byte arrives. A failure rate
+# between 0 and 1 makes that share of chunks fail with a 503 to exercise retries.
+#
+def main
+  port = (ARGV[0] || 8080).to_i
+  delay = (ARGV[1] || 20).to_i / 1000.0
+  failure_rate = (ARGV[2] || 0).to_f
+
+  usage() and return if port <= 0
+
+  body = JSON.generate({ "success" => {}, "errors" => {} })
+  etag = %Q{"#{body.hash.abs.to_s(16)}"}
+  uploads = {}
+  lock = Mutex.new
+
+  server = WEBrick::HTTPServer.new(:Port => port, :Logger => WEBrick::Log.new($stderr, WEBrick::Log::WARN), :AccessLog => [])
+  server.mount '/', MockServlet, lambda { |req, res|
+    sleep delay
+    upload_id = req['X-CloudMine-Upload-Id']
+
+    if req.request_method == 'PUT' && upload_id
+      lock.synchronize { upload_chunk(req, res, uploads, upload_id, failure_rate) }
+    elsif req.request_method == 'GET' && req['If-None-Match'] == etag
+      res.status = 304
+      res['ETag'] = etag
+      res['X-Revalidated'] = 'true'
+    else
+      res.status = 200
+      res['Content-Type'] = 'application/json'
+      res['ETag'] = etag if req.request_method == 'GET'
+      res.body = body
+    end
+  }
+
+  trap('INT') { server.shutdown }
+  puts "BENCHMARK_URL=http://localhost:#{port}/"
+  server.start
+end
+
+# Unlike mount_proc, answers every method, PUT included.
+class MockServlet < WEBrick::HTTPServlet::AbstractServlet
+  def initialize(server, handler)
+    super(server)
+    @handler = handler
+  end
+
+  def service(req, res)
+    @handler.call(req, res)
+  end
+end
+
+def upload_chunk(req, res, uploads, upload_id, failure_rate)
+  range = req['Content-Range'].to_s
+
+  if range =~ %r{\Abytes \*/(\d+)\z}
+    data = uploads[upload_id]
+    if data.nil?
+      res.status = 404
+      return
+    end
+    resume_incomplete(res, data)
+    return
+  end
+
+  match = range.match(%r{\Abytes (\d+)-(\d+)/(\d+)\z})
+  if match.nil?
+    res.status = 400
+    return
+  end
+
+  if rand < failure_rate
+    res.status = 503
+    return
+  end
+
+  first, total = match[1].to_i, match[3].to_i
+  data = (uploads[upload_id] ||= ''.b)
+  if first > data.bytesize
+    resume_incomplete(res, data)
+    return
+  end
+  data[first..-1] = req.body.to_s.b
+
+  if data.bytesize < total
+    resume_incomplete(res, data)
+  else
+    uploads.delete(upload_id)
+    res.status = 201
+    res['Content-Type'] = 'application/json'
+    res.body = JSON.generate({ "key" => File.basename(req.path) })
+  end
+end
+
+def resume_incomplete(res, data)
+  res.status = 308
+  res['Range'] = "bytes=0-#{data.bytesize - 1}" if data.bytesize > 0
+end
+
+def usage
+  puts "usage: 'ruby benchmark_server.rb [port] [delay_ms] [upload_failure_rate]'"
+  true
+end
+
+main